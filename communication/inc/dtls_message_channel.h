@@ -80,6 +80,11 @@ public:
 
 		uint32_t (*calculate_crc)(const uint8_t* data, uint32_t length);
 		void (*notify_client_messages_processed)(void* reserved);
+
+		/**
+		 * Sends the given buffer over both the current and the redundant path. Optional.
+		 */
+		int (*send_redundant)(const unsigned char *buf, uint32_t buflen, void* handle);
 	};
 
 private:
@@ -103,6 +108,7 @@ private:
 	const uint8_t* device_id;
 	bool move_session;
 	bool debug_enabled;
+	bool redundant;
 
     void init();
     void dispose();
@@ -120,8 +126,17 @@ private:
 
 	void cancel_move_session();
 
+	/**
+	 * Discards the current session, including its persisted state.
+	 */
 	void reset_session();
 
+	/**
+	 * Closes the current session. The persisted session is kept so that the next connection
+	 * can resume it without a full handshake.
+	 */
+	void close_session();
+
  public:
 	DTLSMessageChannel() :
 			ssl_context(),
@@ -136,7 +151,8 @@ private:
 			coap_state(nullptr),
 			device_id(nullptr),
 			move_session(false),
-			debug_enabled(false) {
+			debug_enabled(false),
+			redundant(false) {
 	}
 
 	ProtocolError init(const uint8_t* core_private, size_t core_private_len,
@@ -41,6 +41,7 @@ class Message
     int id;                     // if < 0 then not-defined.
     bool confirm_received;
     bool passthrough_;
+    bool redundant_;
 
 	size_t trim_capacity()
 	{
@@ -65,7 +66,7 @@ class Message
 public:
 	Message() : Message(nullptr, 0, 0) {}
 
-	Message(uint8_t* buf, size_t buflen, size_t msglen=0) : buffer(buf), buffer_length(buflen), message_length(msglen), id(-1), confirm_received(false), passthrough_(false) {}
+	Message(uint8_t* buf, size_t buflen, size_t msglen=0) : buffer(buf), buffer_length(buflen), message_length(msglen), id(-1), confirm_received(false), passthrough_(false), redundant_(false) {}
 
 	void clear() { id = -1; }
 
@@ -99,6 +100,18 @@ public:
     	return passthrough_;
     }
 
+    // If enabled, instructs the transport layer to also send this message over the redundant path,
+    // if one is available
+    void redundant(bool enabled)
+    {
+    	redundant_ = enabled;
+    }
+
+    bool redundant() const
+    {
+    	return redundant_;
+    }
+
     CoAPType::Enum get_type() const
     {
     		return length()>=MINIMUM_COAP_MESSAGE_LENGTH ? CoAP::type(buf()): CoAPType::ERROR;
@@ -156,6 +169,7 @@ public:
 		this->id = msg.id;
 		this->confirm_received = msg.confirm_received;
 		this->passthrough_ = msg.passthrough_;
+		this->redundant_ = msg.redundant_;
 		return *this;
 	}
 
@@ -165,6 +179,9 @@ struct Channel
 {
 	enum Command
 	{
+		/**
+		 * Close the channel and discard the current session.
+		 */
 		CLOSE = 0,
 
 		/**
@@ -188,6 +205,12 @@ struct Channel
 		 * Save session - saves the session to persistent store.
 		 */
 		SAVE_SESSION = 4,
+
+		/**
+		 * Close the channel but keep the persisted session so that
+		 * the next connection can resume it.
+		 */
+		CLOSE_KEEP_SESSION = 5,
 	};
 
 
@@ -339,6 +339,21 @@ protected:
 	 */
 	AppStateDescriptor app_state_descriptor(uint32_t stateFlags = AppStateDescriptor::ALL);
 
+	/**
+	 * Returns true if the protocol layer is waiting for the server to continue an exchange:
+	 * a ping or time request is pending, or a Describe, firmware or CoAP API transfer is in progress.
+	 */
+	bool has_pending_exchanges() const
+	{
+#if HAL_PLATFORM_OTA_PROTOCOL_V3
+		const bool updating = firmwareUpdate.isRunning();
+#else
+		const bool updating = chunkedTransfer.is_updating();
+#endif
+		return updating || pinger.is_expecting_ping_ack() || timesync_.is_request_pending() ||
+				description.hasPendingTransfers() || v2::CoapChannel::instance()->hasPendingExchanges();
+	}
+
 public:
 	Protocol(MessageChannel& channel) :
 			channel(channel),
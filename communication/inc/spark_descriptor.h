@@ -53,7 +53,8 @@ namespace SparkAppStateSelector {
 		SYSTEM_MODULE_VERSION = 5,
 		MAX_MESSAGE_SIZE = 6,
 		MAX_BINARY_SIZE = 7,
-		OTA_CHUNK_SIZE = 8
+		OTA_CHUNK_SIZE = 8,
+		DESCRIBE_METRICS = 9
 	};
 }
 
@@ -62,7 +63,8 @@ namespace SparkAppStateUpdate {
 		COMPUTE = 1,
 		PERSIST = 2,
 		COMPUTE_AND_PERSIST = 3,
-		RESET = 4
+		RESET = 4,
+		SENT = 5
 	};
 }
 
@@ -108,6 +110,8 @@ struct SparkDescriptor
      * 	subscriptions crc can be set.
      * 	The descriptor state (DESCRIBE_APP/DESCRIBE_SYSTEM) can be computed by the callback and can be used with COMPUTE and COMPUTE_AND_PERSIST operations.
      * 	The subscription state (SUBSCRIPTIONS) is computed by the caller and passed to the callback (secifying PERSIST as the operation.)
+     * 	DESCRIBE_METRICS is passed with SENT when the metrics have been sent, with PERSIST when the server acknowledges them
+     * 	and with RESET when the server rejects them. `data` is the ID of the message that carried the metrics.
      * @param data		when operation==1 this is the value ot set. otherwise unused.
      * @return when operation==COMPUTE, the crc of the application state is retrieved when operation is COMPUTE. Otherwise the return value is 0.
      */
@@ -118,6 +122,7 @@ struct SparkDescriptor
      * @param appender	The appender function to call with the "append" data and the string to append
      * @param append		Opaque data to be passed to appender
      * @param flags		0x01 - append as binary daata, otherwise append as json
+     * 					0x02 - the metrics are requested by the server and must not depend on the metrics sent previously
      * @param page		A key to select which metrics data to output. Presently unused and should be 0, which means the default metrics.
      * @param reserved	For future expansion.
      * @return
@@ -143,9 +143,17 @@ struct SparkCallbacks
             void* context);
 
     // size == 60
+
+    /**
+     * Sends the given buffer over both the current and the redundant path of the cloud connection.
+     * Optional, `send` is used if not set.
+     */
+    int (*send_redundant)(const unsigned char *buf, uint32_t buflen, void* handle);
+
+    // size == 64
 };
 
-PARTICLE_STATIC_ASSERT(SparkCallbacks_size, sizeof(SparkCallbacks)==(sizeof(void*)*15));
+PARTICLE_STATIC_ASSERT(SparkCallbacks_size, sizeof(SparkCallbacks)==(sizeof(void*)*16));
 
 /**
  * Application-supplied callbacks. (Deliberately distinct from the system-supplied
@@ -248,7 +256,8 @@ namespace ProtocolCommands {
     WAKE = 1, // Deprecated, use PING instead
     DISCONNECT = 2,
     TERMINATE = 3,
-    PING = 4
+    PING = 4,
+    MOVE_SESSION = 5 // The cloud connection has moved to another network path
   };
 };
 
@@ -277,7 +286,13 @@ typedef enum protocol_status_flag {
      *
      * @see `SparkCallbacks::notify_client_messages_processed`
      */
-    PROTOCOL_STATUS_HAS_PENDING_CLIENT_MESSAGES = 0x01
+    PROTOCOL_STATUS_HAS_PENDING_CLIENT_MESSAGES = 0x01,
+    /**
+     * This flag is set if the protocol is in the middle of an exchange with the server and needs
+     * to be polled frequently: there are messages waiting for an acknowledgement, a ping or time
+     * request is pending, or a Describe or firmware transfer is in progress.
+     */
+    PROTOCOL_STATUS_BUSY = 0x02
 } protocol_status_flag;
 
 /**
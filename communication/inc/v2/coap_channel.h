@@ -111,6 +111,9 @@ public:
 
     int run();
 
+    // Returns true if a message exchange with the server is in progress
+    bool hasPendingExchanges() const;
+
     // Methods called by the old protocol implementation
 
     int handleCon(const MessageBuffer& buf);
@@ -160,7 +160,7 @@ public:
 		fast_ota_override = true;
 	}
 
-	bool is_updating()
+	bool is_updating() const
 	{
 		return updating;
 	}
@@ -25,11 +25,47 @@
 #include "messages.h"
 #include "communication_diagnostic.h"
 #include "system_error.h"
+#include "simple_pool_allocator.h"
 
 namespace particle { namespace protocol {
 
+#if COAP_MESSAGE_POOL_SIZE > 0
+
+namespace {
+
+alignas(uintptr_t) uint8_t g_messagePoolBuffer[COAP_MESSAGE_POOL_SIZE];
+SimpleStaticPool g_messagePool(g_messagePoolBuffer, sizeof(g_messagePoolBuffer));
+
+} // namespace
+
+#endif // COAP_MESSAGE_POOL_SIZE > 0
+
 uint16_t CoAPMessage::message_count = 0;
 
+const size_t CoAPMessageStore::BUCKET_COUNT;
+
+void* CoAPMessage::allocate(size_t size)
+{
+#if COAP_MESSAGE_POOL_SIZE > 0
+	void* ptr = g_messagePool.alloc(size);
+	if (ptr) {
+		return ptr;
+	}
+#endif
+	return malloc(size);
+}
+
+void CoAPMessage::operator delete(void* ptr)
+{
+#if COAP_MESSAGE_POOL_SIZE > 0
+	if ((uint8_t*)ptr >= g_messagePoolBuffer && (uint8_t*)ptr < g_messagePoolBuffer + sizeof(g_messagePoolBuffer)) {
+		g_messagePool.free(ptr);
+		return;
+	}
+#endif
+	free(ptr);
+}
+
 bool is_ack_or_reset(const uint8_t* buf, size_t len)
 {
 	if (!buf || len<1)
@@ -38,13 +74,14 @@ bool is_ack_or_reset(const uint8_t* buf, size_t len)
 	return type==CoAPType::ACK || type==CoAPType::RESET;
 }
 
-ProtocolError CoAPMessageStore::send_message(CoAPMessage* msg, Channel& channel)
+ProtocolError CoAPMessageStore::send_message(CoAPMessage* msg, Channel& channel, bool redundant)
 {
 	if (!msg) {
 		return INVALID_MESSAGE;
 	}
 	Message m((uint8_t*)msg->get_data(), msg->get_data_length(), msg->get_data_length());
 	m.decode_id();
+	m.redundant(redundant);
 	return channel.send(m);
 }
 
@@ -61,7 +98,10 @@ bool CoAPMessageStore::retransmit(CoAPMessage* msg, Channel& channel, system_tic
 	{
 		LOG(TRACE, "Retransmitting CoAP message; ID: %d; attempt %d of %d", (int)msg->get_id(),
 				(int)msg->get_transmit_count() - 1, (int)MAX_RETRANSMIT);
-		send_message(msg, channel);
+		++retransmissions;
+		// A message that missed its acknowledgement is likely to be in the tail of the latency
+		// distribution, so its retransmissions also take the redundant path
+		send_message(msg, channel, true /* redundant */);
 	}
 	return retransmit;
 }
@@ -75,7 +115,9 @@ void CoAPMessageStore::message_timeout(CoAPMessage& msg, Channel& channel)
 		// XXX: This will cancel _all_ messages with a timeout error, not just the timed out one.
 		// That's not ideal but should be okay while we're transitioning to the new CoAP API
 		v2::CoapChannel::instance()->close(SYSTEM_ERROR_COAP_TIMEOUT);
-		channel.command(MessageChannel::CLOSE);
+		// Keep the session: with the connection ID, it remains valid after a change of the
+		// device's address, which is the typical cause of a timeout on a cellular network
+		channel.command(MessageChannel::CLOSE_KEEP_SESSION);
 	}
 }
 
@@ -84,21 +126,24 @@ void CoAPMessageStore::message_timeout(CoAPMessage& msg, Channel& channel)
  */
 void CoAPMessageStore::process(system_tick_t time, Channel& channel)
 {
-	CoAPMessage* msg = head;
-	CoAPMessage* prev = nullptr;
-	while (msg!=nullptr)
+	for (CoAPMessage*& head: buckets)
 	{
-		if (time_has_passed(time, msg->get_timeout()) && !retransmit(msg, channel, time))
-		{
-			remove(msg, prev);
-			message_timeout(*msg, channel);
-			delete msg;
-			msg = (prev==nullptr) ? head : prev->get_next();
-		}
-		else
+		CoAPMessage* msg = head;
+		CoAPMessage* prev = nullptr;
+		while (msg!=nullptr)
 		{
-			prev = msg;
-			msg = msg->get_next();
+			if (time_has_passed(time, msg->get_timeout()) && !retransmit(msg, channel, time))
+			{
+				remove(msg, prev);
+				message_timeout(*msg, channel);
+				delete msg;
+				msg = (prev==nullptr) ? head : prev->get_next();
+			}
+			else
+			{
+				prev = msg;
+				msg = msg->get_next();
+			}
 		}
 	}
 }
@@ -148,7 +193,9 @@ ProtocolError CoAPMessageStore::receive(Message& msg, Channel& channel, system_t
 		message_id_t id = msg.get_id();
 		CoAPMessage* coap_msg = from_id(id);
 		if (coap_msg) {
-			g_coapRoundTripMSec = time - coap_msg->get_send_time();
+			const system_tick_t roundTrip = time - coap_msg->get_send_time();
+			g_coapRoundTripMSec = roundTrip;
+			g_coapRoundTripHistogram.record(roundTrip);
 		}
 		if (msgtype==CoAPType::RESET) {
 			LOG(WARN, "Received RST message; discarding session");
@@ -197,9 +244,11 @@ ProtocolError CoAPMessageStore::receive(Message& msg, Channel& channel, system_t
 bool CoAPMessageStore::has_unacknowledged_requests() const
 {
 	// TODO: Use a message counter
-	for (const CoAPMessage* msg = head; msg != nullptr; msg = msg->get_next()) {
-		if (is_confirmable((uint8_t*)msg->get_data()))
-			return true;
+	for (const CoAPMessage* head: buckets) {
+		for (const CoAPMessage* msg = head; msg != nullptr; msg = msg->get_next()) {
+			if (is_confirmable((uint8_t*)msg->get_data()))
+				return true;
+		}
 	}
 
 	return false;
@@ -25,6 +25,7 @@
 #include "service_debug.h"
 
 #include "communication_diagnostic.h"
+#include <algorithm>
 #include <limits>
 
 namespace particle
@@ -39,9 +40,40 @@ const uint8_t MAX_RETRANSMIT = 3;
 const uint16_t MAX_TRANSMIT_SPAN = 45*1000;
 
 /**
- * The number of outstanding messages allowed.
+ * The default number of outstanding confirmable requests allowed. 0 means there's no limit.
  */
-const uint8_t NSTART = 1;
+#ifndef COAP_NSTART
+#define COAP_NSTART 4
+#endif
+
+const uint8_t NSTART = COAP_NSTART;
+
+/**
+ * The maximum number of confirmable requests waiting for a free slot in the transmission window.
+ */
+#ifndef COAP_MAX_QUEUED_REQUESTS
+#define COAP_MAX_QUEUED_REQUESTS 16
+#endif
+
+const size_t MAX_QUEUED_REQUESTS = COAP_MAX_QUEUED_REQUESTS;
+
+/**
+ * Size of the memory pool for the messages kept for retransmission. The heap is used when the
+ * pool is exhausted, or for all messages if the size is 0. The size is set per platform since the
+ * pool is allocated statically.
+ */
+#ifndef COAP_MESSAGE_POOL_SIZE
+#define COAP_MESSAGE_POOL_SIZE HAL_PLATFORM_COAP_MESSAGE_POOL_SIZE
+#endif
+
+/**
+ * Returns true if the message is a confirmable request, i.e. a CON message with a method code as
+ * opposed to a confirmable separate response.
+ */
+inline bool is_confirmable_request(const uint8_t* buf, size_t size)
+{
+	return size>1 && CoAP::type(buf)==CoAPType::CON && buf[1]!=0 && (buf[1]>>5)==0;
+}
 
 /**
  * Determines the transmit timeout for the given transmission count.
@@ -168,6 +200,11 @@ private:
 
 	static uint16_t message_count;
 
+	/**
+	 * Allocates memory for a message from the message pool, or from the heap if the pool is exhausted.
+	 */
+	static void* allocate(size_t size);
+
 	/**
 	 * Notification that the message has been delivered to the server.
 	 */
@@ -183,6 +220,19 @@ public:
 		message_count++;
 	}
 
+	// The allocation functions are non-throwing so that a failed allocation yields nullptr
+	static void* operator new(size_t size) noexcept
+	{
+		return allocate(size);
+	}
+
+	static void* operator new(size_t size, void* ptr) noexcept
+	{
+		return ptr;
+	}
+
+	static void operator delete(void* ptr);
+
 	/**
 	 * Create a new CoAPMessage from the given Message instance. The returned CoAPMessage is dynamically allocated
 	 * and has an independent lifetime from the Message
@@ -191,7 +241,7 @@ public:
 	static CoAPMessage* create(Message& msg, size_t data_len = 0)
 	{
 		size_t len = data_len && data_len<msg.length() ? data_len : msg.length();
-		uint8_t* memory = new uint8_t[sizeof(CoAPMessage)+len];
+		void* memory = allocate(sizeof(CoAPMessage)+len);
 		if (memory) {
 			CoAPMessage* coapmsg = new (memory)CoAPMessage(msg.get_id());		// in-place new
 			coapmsg->set_data(msg.buf(), len);
@@ -304,6 +354,11 @@ public:
 			}
 	}
 
+	bool is_confirmable_request() const
+	{
+		return particle::protocol::is_confirmable_request(data, data_len);
+	}
+
 	int get_transmit_count() const
 	{
 		return transmit_count;
@@ -332,19 +387,47 @@ class CoAPMessageStore
 {
 	LOG_CATEGORY(COAP_LOG_CATEGORY);
 
+public:
 	/**
-	 * The head of the list of messages.
+	 * The number of buckets in the message index. Message IDs are assigned sequentially so the
+	 * low bits of the ID spread the messages evenly across the buckets.
 	 */
-	CoAPMessage* head;
+	static const size_t BUCKET_COUNT = 16;
 
+private:
 	/**
-	 * Retrieves the message with the given ID and the previous message.
+	 * The heads of the lists of messages, indexed by the message ID.
+	 */
+	CoAPMessage* buckets[BUCKET_COUNT];
+
+	/**
+	 * The number of messages in the store.
+	 */
+	size_t count;
+
+	/**
+	 * The number of confirmable requests in the store.
+	 */
+	size_t request_count;
+
+	/**
+	 * The number of retransmissions made by this store.
+	 */
+	unsigned retransmissions;
+
+	static size_t bucket(message_id_t id)
+	{
+		return id % BUCKET_COUNT;
+	}
+
+	/**
+	 * Retrieves the message with the given ID and the previous message in its bucket.
 	 * If no message exists with the given id, nullptr is returned.
 	 */
 	CoAPMessage* for_id(message_id_t id, CoAPMessage*& prev) const
 	{
 		prev = nullptr;
-		CoAPMessage* next = head;
+		CoAPMessage* next = buckets[bucket(id)];
 		while (next)
 		{
 			if (next->matches(id))
@@ -356,22 +439,25 @@ class CoAPMessageStore
 	}
 
 	/**
-	 * Removes a message given the message to remove and the previous entry in the list.
+	 * Removes a message given the message to remove and the previous entry in its bucket.
 	 */
 	void remove(CoAPMessage* message, CoAPMessage* previous)
 	{
 		if (previous)
 			previous->set_next(message->get_next());
 		else
-			head = message->get_next();
+			buckets[bucket(message->get_id())] = message->get_next();
+		if (message->is_confirmable_request())
+			--request_count;
 		message->removed();
+		--count;
 	}
 
 	void message_timeout(CoAPMessage& msg, Channel& channel);
 
 public:
 
-	CoAPMessageStore() : head(nullptr) {}
+	CoAPMessageStore() : buckets(), count(0), request_count(0), retransmissions(0) {}
 
 	~CoAPMessageStore() {
 		clear();
@@ -379,7 +465,43 @@ public:
 
 	bool has_messages() const
 	{
-		return head!=nullptr;
+		return count!=0;
+	}
+
+	/**
+	 * Returns the number of messages in the store.
+	 */
+	size_t size() const
+	{
+		return count;
+	}
+
+	/**
+	 * Returns the number of confirmable requests in the store.
+	 */
+	size_t confirmable_request_count() const
+	{
+		return request_count;
+	}
+
+	/**
+	 * Returns the number of messages that are looked at to find the message with the given ID,
+	 * i.e. the number of messages in the same bucket.
+	 */
+	size_t bucket_size(message_id_t id) const
+	{
+		size_t n = 0;
+		for (CoAPMessage* msg = buckets[bucket(id)]; msg; msg = msg->get_next())
+			++n;
+		return n;
+	}
+
+	/**
+	 * Returns the number of retransmissions made by this store.
+	 */
+	unsigned retransmission_count() const
+	{
+		return retransmissions;
 	}
 
 	bool has_unacknowledged_requests() const;
@@ -413,8 +535,12 @@ public:
 		clear_message(message.get_id());
 		if (message.get_next())
 			return INVALID_STATE;
+		CoAPMessage*& head = buckets[bucket(message.get_id())];
 		message.set_next(head);
 		head = &message;
+		++count;
+		if (message.is_confirmable_request())
+			++request_count;
 		return NO_ERROR;
 	}
 
@@ -450,8 +576,10 @@ public:
 
 	/**
 	 * Sends the given CoAPMessage to the channel.
+	 *
+	 * @param redundant Whether the message should also be sent over the redundant path.
 	 */
-	ProtocolError send_message(CoAPMessage* msg, Channel& channel);
+	ProtocolError send_message(CoAPMessage* msg, Channel& channel, bool redundant = false);
 
 	/**
 	 * Registers that this message has been sent from the application.
@@ -476,9 +604,12 @@ public:
 	 */
 	void clear()
 	{
-		while (head!=nullptr)
+		for (CoAPMessage*& head: buckets)
 		{
-			delete remove(head->get_id());
+			while (head!=nullptr)
+			{
+				delete remove(head->get_id());
+			}
 		}
 	}
 
@@ -507,6 +638,25 @@ class CoAPReliableChannel : public T
 	 */
 	CoAPMessageStore client;
 
+	/**
+	 * Confirmable requests from the client waiting for a free slot in the transmission window,
+	 * oldest first.
+	 */
+	CoAPMessage* queue_head;
+	CoAPMessage* queue_tail;
+	size_t queue_size;
+
+	/**
+	 * The maximum number of outstanding confirmable requests, or 0 if there's no limit.
+	 */
+	uint8_t max_window;
+
+	/**
+	 * The current number of outstanding confirmable requests allowed. The window is halved when
+	 * a request needs to be retransmitted and grows back by one for every acknowledged request.
+	 */
+	uint8_t window;
+
 
 	ProtocolError base_send(Message& msg)
 	{
@@ -553,14 +703,41 @@ class CoAPReliableChannel : public T
 
 public:
 
-	CoAPReliableChannel(M m=0) : millis(m) {
+	CoAPReliableChannel(M m=0) : millis(m), queue_head(nullptr), queue_tail(nullptr), queue_size(0), max_window(NSTART), window(NSTART) {
 		delegateChannel.init(this);
 	}
 
+	~CoAPReliableChannel() {
+		clear_queue();
+	}
+
 	void set_millis(M m) {
 		this->millis = m;
 	}
 
+	/**
+	 * Sets the maximum number of outstanding confirmable requests. 0 means there's no limit.
+	 *
+	 * Separate responses are not limited by the window.
+	 */
+	void set_window_size(uint8_t size) {
+		max_window = size;
+		window = max_window;
+		if (!max_window)
+			send_queued();
+	}
+
+	uint8_t window_size() const {
+		return window;
+	}
+
+	/**
+	 * Returns the number of requests waiting for a free slot in the transmission window.
+	 */
+	size_t queued_request_count() const {
+		return queue_size;
+	}
+
 	const CoAPMessageStore& client_messages() const {
 		return client;
 	}
@@ -585,6 +762,8 @@ public:
 	{
 		server.clear();
 		client.clear();
+		clear_queue();
+		window = max_window;
 		channel::reset();
 	}
 
@@ -601,6 +780,10 @@ public:
 		if (msg.is_request() && msg.get_confirm_received())
 			return send_synchronous(msg);
 
+		if (max_window && is_confirmable_request(msg.buf(), msg.length()) &&
+				(queue_head || client.confirmable_request_count()>=window))
+			return enqueue(msg);
+
 		// determine the type of message.
 		CoAPMessageStore& store = msg.is_request() ? client : server;
 		ProtocolError error = store.send(msg, millis());
@@ -632,11 +815,11 @@ public:
 
 	bool has_unacknowledged_requests() const
 	{
-		return client.has_messages() || server.has_unacknowledged_requests();
+		return has_unacknowledged_client_requests() || server.has_unacknowledged_requests();
 	}
 
 	bool has_unacknowledged_client_requests() const {
-		return client.has_messages();
+		return client.has_messages() || queue_head;
 	}
 
 	/**
@@ -648,20 +831,34 @@ public:
 	 */
 	ProtocolError receive(Message& msg, bool requests)
 	{
-		const bool had_client_messages = client.has_messages();
+		const bool had_client_messages = has_unacknowledged_client_requests();
+		const unsigned retransmissions = client.retransmission_count();
+		bool acknowledged = false;
 		ProtocolError error = channel::receive(msg);
 		if (!error && msg.length())
 		{
 			// is it a request from the server or a response from the server?
 			// responses are paired with the original client request
-			CoAPMessageStore& store = msg.is_request() ? server : client;
-			if (!msg.is_request() || requests) {
-				error = store.receive(msg, delegateChannel, millis());
+			if (!msg.is_request()) {
+				const size_t in_flight = client.size();
+				error = client.receive(msg, delegateChannel, millis());
+				acknowledged = client.size()<in_flight;
+			} else if (requests) {
+				error = server.receive(msg, delegateChannel, millis());
 			}
 		}
 		client.process(millis(), delegateChannel);
 		server.process(millis(), delegateChannel);
-		if (had_client_messages && !client.has_messages()) {
+		if (!max_window) {
+			// the window is disabled
+		} else if (client.retransmission_count()!=retransmissions) {
+			// back off when the requests are getting lost
+			window = std::max(window / 2, 1);
+		} else if (acknowledged && window<max_window) {
+			++window;
+		}
+		send_queued();
+		if (had_client_messages && !has_unacknowledged_client_requests()) {
 			channel::notify_client_messages_processed();
 		}
 		return error;
@@ -675,7 +872,7 @@ public:
 		message_id_t id = msg.get_id();
 		DEBUG("sending message id=%x synchronously", id);
 		CoAPType::Enum coapType = CoAP::type(msg.buf());
-		const bool had_client_messages = client.has_messages();
+		const bool had_client_messages = has_unacknowledged_client_requests();
 		ProtocolError error = client.send(msg, millis());
 		if (!error)
 			error = delegateChannel.send(msg);
@@ -710,12 +907,67 @@ public:
 			}
 		}
 		client.clear_message(id);
-		if (had_client_messages && !client.has_messages()) {
+		if (had_client_messages && !has_unacknowledged_client_requests()) {
 			channel::notify_client_messages_processed();
 		}
 		// todo - if msg contains a delivery callback then call that with the outcome of this
 		return error;
 	}
+
+private:
+	/**
+	 * Queues a confirmable request until there's a free slot in the transmission window.
+	 */
+	ProtocolError enqueue(Message& msg)
+	{
+		if (!msg.has_id())
+			return MISSING_MESSAGE_ID;
+		if (queue_size>=MAX_QUEUED_REQUESTS)
+			return NO_MEMORY;
+		CoAPMessage* coapmsg = CoAPMessage::create(msg);
+		if (coapmsg==nullptr)
+			return INSUFFICIENT_STORAGE;
+		if (queue_tail)
+			queue_tail->set_next(coapmsg);
+		else
+			queue_head = coapmsg;
+		queue_tail = coapmsg;
+		++queue_size;
+		return NO_ERROR;
+	}
+
+	/**
+	 * Sends the queued requests while there are free slots in the transmission window.
+	 */
+	void send_queued()
+	{
+		while (queue_head && (!max_window || client.confirmable_request_count()<window))
+		{
+			CoAPMessage* msg = queue_head;
+			queue_head = msg->get_next();
+			if (!queue_head)
+				queue_tail = nullptr;
+			--queue_size;
+			msg->removed();
+			const system_tick_t now = millis();
+			msg->set_send_time(now);
+			msg->prepare_retransmit(now);
+			client.add(*msg);
+			client.send_message(msg, delegateChannel);
+		}
+	}
+
+	void clear_queue()
+	{
+		while (queue_head)
+		{
+			CoAPMessage* msg = queue_head;
+			queue_head = msg->get_next();
+			delete msg;
+		}
+		queue_tail = nullptr;
+		queue_size = 0;
+	}
 };
 
 
@@ -5,3 +5,7 @@ particle::SimpleUnsignedIntegerDiagnosticData g_unacknowledgedMessageCounter(DIA
 particle::SimpleUnsignedIntegerDiagnosticData g_trasmittedMessageCounter(DIAG_ID_CLOUD_TRANSMITTED_MESSAGES, DIAG_NAME_CLOUD_TRANSMITTED_MESSAGES);
 particle::SimpleUnsignedIntegerDiagnosticData g_retransmittedMessageCounter(DIAG_ID_CLOUD_RETRANSMITTED_MESSAGES, DIAG_NAME_CLOUD_RETRANSMITTED_MESSAGES);
 particle::SimpleUnsignedIntegerDiagnosticData g_coapRoundTripMSec(DIAG_ID_CLOUD_COAP_ROUND_TRIP, DIAG_NAME_CLOUD_COAP_ROUND_TRIP);
+particle::HistogramDiagnosticData g_coapRoundTripHistogram(DIAG_ID_CLOUD_COAP_ROUND_TRIP_HISTOGRAM, DIAG_NAME_CLOUD_COAP_ROUND_TRIP_HISTOGRAM);
+particle::HistogramDiagnosticData g_dtlsHandshakeTime(DIAG_ID_CLOUD_DTLS_HANDSHAKE_TIME, DIAG_NAME_CLOUD_DTLS_HANDSHAKE_TIME);
+particle::SimpleUnsignedIntegerDiagnosticData g_dtlsHandshakeCounter(DIAG_ID_CLOUD_DTLS_HANDSHAKES, DIAG_NAME_CLOUD_DTLS_HANDSHAKES);
+particle::SimpleUnsignedIntegerDiagnosticData g_dtlsSessionResumptionCounter(DIAG_ID_CLOUD_DTLS_SESSION_RESUMPTIONS, DIAG_NAME_CLOUD_DTLS_SESSION_RESUMPTIONS);
@@ -5,3 +5,7 @@ extern particle::SimpleUnsignedIntegerDiagnosticData g_unacknowledgedMessageCoun
 extern particle::SimpleUnsignedIntegerDiagnosticData g_trasmittedMessageCounter;
 extern particle::SimpleUnsignedIntegerDiagnosticData g_retransmittedMessageCounter;
 extern particle::SimpleUnsignedIntegerDiagnosticData g_coapRoundTripMSec;
+extern particle::HistogramDiagnosticData g_coapRoundTripHistogram;
+extern particle::HistogramDiagnosticData g_dtlsHandshakeTime;
+extern particle::SimpleUnsignedIntegerDiagnosticData g_dtlsHandshakeCounter;
+extern particle::SimpleUnsignedIntegerDiagnosticData g_dtlsSessionResumptionCounter;
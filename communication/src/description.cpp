@@ -319,7 +319,7 @@ ProtocolError Description::receiveRequest(const Message& msg) {
         }
         const size_t msgOffs = enc.payloadData() - (char*)respMsg.buf();
         Vector<char> buf;
-        CHECK_PROTOCOL(getDescribeData(flags, &respMsg, msgOffs, &buf, &payloadSize));
+        CHECK_PROTOCOL(getDescribeData(flags, true /* response */, &respMsg, msgOffs, &buf, &payloadSize));
         if (!buf.isEmpty()) {
             // Prepare a blockwise response
             if (flags & DescriptionType::DESCRIBE_SYSTEM) {
@@ -364,6 +364,7 @@ ProtocolError Description::receiveRequest(const Message& msg) {
     }
     if (!resp || blockIndex == resp->blockCount - 1) {
         // Sent a regular response or the last block of a blockwise response
+        updateMetricsState(flags, SparkAppStateUpdate::SENT, respMsg.get_id());
         Ack ack = {};
         ack.msgId = respMsg.get_id();
         ack.flags = flags;
@@ -401,6 +402,7 @@ ProtocolError Description::receiveAckOrRst(const Message& msg, int* descFlags, b
     if (activeReq_.has_value() && activeReq_->msgId == ackId) {
         *handled = true;
         if (isRst) {
+            updateMetricsState(activeReq_->flags, SparkAppStateUpdate::RESET, ackId);
             activeReq_.reset();
             return ProtocolError::MESSAGE_RESET;
         }
@@ -410,9 +412,13 @@ ProtocolError Description::receiveAckOrRst(const Message& msg, int* descFlags, b
             CHECK_PROTOCOL(proto_->get_channel().create(msg));
             const auto token = proto_->get_next_token();
             CHECK_PROTOCOL(sendNextRequestBlock(&*activeReq_, &msg, token));
+            if (activeReq_->data.isEmpty()) {
+                updateMetricsState(activeReq_->flags, SparkAppStateUpdate::SENT, activeReq_->msgId);
+            }
         } else {
             // Received an ACK for the last block of the current blockwise request
             const auto flags = activeReq_->flags;
+            updateMetricsState(flags, SparkAppStateUpdate::PERSIST, ackId);
             activeReq_.reset();
             if (!reqQueue_.isEmpty()) {
                 CHECK_PROTOCOL(sendNextRequest(reqQueue_.takeFirst()));
@@ -428,8 +434,10 @@ ProtocolError Description::receiveAckOrRst(const Message& msg, int* descFlags, b
                 const auto flags = acks_[i].flags;
                 acks_.removeAt(i);
                 if (isRst) {
+                    updateMetricsState(flags, SparkAppStateUpdate::RESET, ackId);
                     return ProtocolError::MESSAGE_RESET;
                 }
+                updateMetricsState(flags, SparkAppStateUpdate::PERSIST, ackId);
                 *descFlags = flags;
                 break;
             }
@@ -456,7 +464,11 @@ ProtocolError Description::processTimeouts() {
     return ProtocolError::NO_ERROR;
 }
 
-ProtocolError Description::serialize(Appender* appender, int descFlags) {
+bool Description::hasPendingTransfers() const {
+    return activeReq_.has_value() || !activeResps_.isEmpty() || !reqQueue_.isEmpty();
+}
+
+ProtocolError Description::serialize(Appender* appender, int descFlags, bool response) {
     const auto& descriptor = proto_->get_descriptor();
     switch (descFlags) {
     case DescriptionType::DESCRIBE_METRICS: {
@@ -467,7 +479,11 @@ ProtocolError Description::serialize(Appender* appender, int descFlags) {
         // 16-bit Describe type
         appender->append((char)DescriptionType::DESCRIBE_METRICS);
         appender->append((char)0);
-        const int flags = 1; // Use binary encoding
+        int flags = 1; // Use binary encoding
+        if (response) {
+            // The server doesn't necessarily have the metrics sent previously
+            flags |= 2;
+        }
         const int page = 0; // Page number (unused)
         const bool ok = descriptor.append_metrics(Appender::callback, appender, flags, page, nullptr /* reserved */);
         if (!ok) {
@@ -550,7 +566,7 @@ ProtocolError Description::sendNextRequest(int flags) {
     const size_t msgOffs = enc.payloadData() - (char*)msg.buf();
     Vector<char> buf;
     size_t payloadSize = 0;
-    CHECK_PROTOCOL(getDescribeData(flags, &msg, msgOffs, &buf, &payloadSize));
+    CHECK_PROTOCOL(getDescribeData(flags, false /* response */, &msg, msgOffs, &buf, &payloadSize));
     if (!buf.isEmpty()) {
         // Send a blockwise request
         Request req = {};
@@ -563,6 +579,7 @@ ProtocolError Description::sendNextRequest(int flags) {
         // Send a regular request
         enc.payloadSize(payloadSize);
         CHECK_PROTOCOL(encodeAndSend(&enc, &msg));
+        updateMetricsState(flags, SparkAppStateUpdate::SENT, msg.get_id());
         Ack ack = {};
         ack.msgId = msg.get_id();
         ack.flags = flags;
@@ -664,11 +681,11 @@ ProtocolError Description::encodeAndSend(CoapMessageEncoder* enc, Message* msg)
     return ProtocolError::NO_ERROR;
 }
 
-ProtocolError Description::getDescribeData(int flags, Message* msg, size_t msgOffs, Vector<char>* buf, size_t* size) {
+ProtocolError Description::getDescribeData(int flags, bool response, Message* msg, size_t msgOffs, Vector<char>* buf, size_t* size) {
     const size_t maxMsgSize = proto_->get_max_transmit_message_size();
     SPARK_ASSERT(msgOffs <= maxMsgSize);
     BufferAppender2 appender((char*)msg->buf() + msgOffs, maxMsgSize - msgOffs, buf);
-    CHECK_PROTOCOL(serialize(&appender, flags));
+    CHECK_PROTOCOL(serialize(&appender, flags, response));
     if (!appender.ok()) {
         return ProtocolError::NO_MEMORY;
     }
@@ -694,6 +711,13 @@ ProtocolError Description::getBlockSize(size_t* size) {
     return ProtocolError::NO_ERROR;
 }
 
+void Description::updateMetricsState(int flags, SparkAppStateUpdate::Enum operation, message_id_t msgId) {
+    const auto& descriptor = proto_->get_descriptor();
+    if ((flags & DescriptionType::DESCRIBE_METRICS) && descriptor.app_state_selector_info) {
+        descriptor.app_state_selector_info(SparkAppStateSelector::DESCRIBE_METRICS, operation, msgId, nullptr);
+    }
+}
+
 system_tick_t Description::millis() const {
     return proto_->get_callbacks().millis();
 }
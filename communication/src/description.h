@@ -19,6 +19,7 @@
 
 #include "protocol_defs.h"
 #include "coap_defs.h"
+#include "spark_descriptor.h"
 
 #include "spark_wiring_vector.h"
 
@@ -50,8 +51,9 @@ public:
     ProtocolError receiveRequest(const Message& msg);
     ProtocolError receiveAckOrRst(const Message& msg, int* descFlags, bool* handled);
     ProtocolError processTimeouts();
+    bool hasPendingTransfers() const;
 
-    ProtocolError serialize(Appender* appender, int descFlags);
+    ProtocolError serialize(Appender* appender, int descFlags, bool response = false);
 
     void reset();
 
@@ -91,8 +93,9 @@ private:
     ProtocolError sendErrorResponse(const CoapMessageDecoder& reqDec, CoapCode code);
     ProtocolError sendEmptyAck(message_id_t msgId);
     ProtocolError encodeAndSend(CoapMessageEncoder* enc, Message* msg);
-    ProtocolError getDescribeData(int flags, Message* msg, size_t msgOffs, Vector<char>* buf, size_t* size);
+    ProtocolError getDescribeData(int flags, bool response, Message* msg, size_t msgOffs, Vector<char>* buf, size_t* size);
     ProtocolError getBlockSize(size_t* size);
+    void updateMetricsState(int flags, SparkAppStateUpdate::Enum operation, message_id_t msgId);
     system_tick_t millis() const;
 };
 
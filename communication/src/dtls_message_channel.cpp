@@ -45,6 +45,8 @@ void mbedtls_ssl_update_out_pointers(mbedtls_ssl_context *ssl, mbedtls_ssl_trans
 #include "mbedtls_util.h"
 #include "mbedtls/version.h"
 #include "timer_hal.h"
+#include "communication_diagnostic.h"
+#include "trace_marker.h"
 #include <stdio.h>
 #include <string.h>
 #include "dtls_session_persist.h"
@@ -279,14 +281,15 @@ ProtocolError DTLSMessageChannel::init(
 
 inline int DTLSMessageChannel::send(const uint8_t* data, size_t len)
 {
+	const auto sendFn = (redundant && callbacks.send_redundant) ? callbacks.send_redundant : callbacks.send;
 	if (move_session && len > 0 && data[0] == MBEDTLS_SSL_MSG_CID) {
 		const auto d = const_cast<uint8_t*>(data);
 		d[0] = ALT_CID_CONTENT_TYPE;
-		const auto r = callbacks.send(d, len, callbacks.tx_context);
+		const auto r = sendFn(d, len, callbacks.tx_context);
 		d[0] = MBEDTLS_SSL_MSG_CID;
 		return r;
 	}
-	return callbacks.send(data, len, callbacks.tx_context);
+	return sendFn(data, len, callbacks.tx_context);
 }
 
 void DTLSMessageChannel::reset_session()
@@ -297,6 +300,15 @@ void DTLSMessageChannel::reset_session()
 	sessionPersist.clear(callbacks.save);
 }
 
+void DTLSMessageChannel::close_session()
+{
+	v2::CoapChannel::instance()->close();
+	// The use counter is not cleared here so that a session the server no longer recognizes
+	// eventually expires and a full handshake is performed
+	move_session = false;
+	mbedtls_ssl_session_reset(&ssl_context);
+}
+
 inline int DTLSMessageChannel::recv(uint8_t* data, size_t len)
 {
 	int size = callbacks.receive(data, len, callbacks.tx_context);
@@ -412,6 +424,7 @@ ProtocolError DTLSMessageChannel::establish()
 				sessionPersist.out_ctr[7], sessionPersist.next_coap_id);
 		sessionPersist.make_persistent();
 		LOG(INFO,"restored session from persisted session data. next_msg_id=%d", *coap_state);
+		g_dtlsSessionResumptionCounter++;
 		return SESSION_RESUMED;
 	}
 	else if (restoreStatus==SessionPersist::RENEGOTIATE)
@@ -426,6 +439,8 @@ ProtocolError DTLSMessageChannel::establish()
 			return error;
 	}
 	uint8_t random[64];
+	const system_tick_t handshakeStart = callbacks.millis();
+	PARTICLE_TRACE_SCOPE("dtls:handshake");
 
 	do
 	{
@@ -457,6 +472,8 @@ ProtocolError DTLSMessageChannel::establish()
 		reset_session();
 		return IO_ERROR_GENERIC_ESTABLISH;
 	}
+	g_dtlsHandshakeTime.record(callbacks.millis() - handshakeStart);
+	g_dtlsHandshakeCounter++;
 
 	return NO_ERROR;
 }
@@ -492,7 +509,8 @@ ProtocolError DTLSMessageChannel::receive(Message& message)
 				// Do not invalidate the session on network errors
 				return IO_ERROR_SOCKET_RECV_FAILED;
 			case MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY:
-				command(CLOSE);
+				// The server has discarded the session
+				reset_session();
 				return IO_ERROR_REMOTE_END_CLOSED;
 			default:
 				reset_session();
@@ -543,7 +561,10 @@ ProtocolError DTLSMessageChannel::send(Message& message)
 		logCoapMessage(LOG_LEVEL_TRACE, COAP_LOG_CATEGORY, (const char*)message.buf(), message.length());
 	}
 
+	// The record is written to the transport synchronously
+	redundant = message.redundant();
 	int ret = mbedtls_ssl_write(&ssl_context, message.buf(), message.length());
+	redundant = false;
 	if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
 		LOG(ERROR, "mbedtls_ssl_write() failed: -0x%x", -ret);
 		if (ret == MBEDTLS_ERR_NET_SEND_FAILED) {
@@ -564,13 +585,17 @@ bool DTLSMessageChannel::is_unreliable()
 
 ProtocolError DTLSMessageChannel::command(Command command, void* arg)
 {
-	LOG(INFO,"session cmd (CLS,DIS,MOV,LOD,SAV): %d", command);
+	LOG(INFO,"session cmd (CLS,DIS,MOV,LOD,SAV,CLK): %d", command);
 	switch (command)
 	{
 	case CLOSE:
 		reset_session();
 		break;
 
+	case CLOSE_KEEP_SESSION:
+		close_session();
+		break;
+
 	case DISCARD_SESSION:
 		reset_session();
 		return IO_ERROR_DISCARD_SESSION; //force re-establish
@@ -29,6 +29,9 @@ void DTLSProtocol::init(const char *id,
 	if (offsetof(SparkCallbacks, notify_client_messages_processed) + sizeof(SparkCallbacks::notify_client_messages_processed) <= callbacks.size) {
 		channelCallbacks.notify_client_messages_processed = callbacks.notify_client_messages_processed;
 	}
+	if (offsetof(SparkCallbacks, send_redundant) + sizeof(SparkCallbacks::send_redundant) <= callbacks.size) {
+		channelCallbacks.send_redundant = callbacks.send_redundant;
+	}
 
 	// TODO: Ideally, the next token value should be stored in the session data
 	mbedtls_default_rng(nullptr, &next_token, sizeof(next_token));
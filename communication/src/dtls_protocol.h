@@ -115,6 +115,18 @@ public:
 			}
 			return r;
 		}
+		case ProtocolCommands::MOVE_SESSION: {
+			// Mark the outgoing records so that the server updates the session's address, and
+			// send a ping to let it know about the new path right away
+			int r = channel.command(MessageChannel::MOVE_SESSION);
+			if (r == ProtocolError::NO_ERROR && !pinger.is_expecting_ping_ack()) {
+				LOG(INFO, "Moving the cloud session");
+				r = pinger.process(std::numeric_limits<system_tick_t>::max(), [this] {
+					return ping(true);
+				});
+			}
+			return r;
+		}
 		default:
 			return ProtocolError::UNKNOWN;
 		}
@@ -126,6 +138,9 @@ public:
 		if (channel.has_unacknowledged_client_requests()) {
 			status->flags |= PROTOCOL_STATUS_HAS_PENDING_CLIENT_MESSAGES;
 		}
+		if (channel.has_unacknowledged_requests() || has_pending_exchanges()) {
+			status->flags |= PROTOCOL_STATUS_BUSY;
+		}
 		return NO_ERROR;
 	}
 
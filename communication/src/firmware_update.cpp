@@ -28,14 +28,18 @@
 #include "coap_message_decoder.h"
 #include "protocol_util.h"
 
-#include "sha256.h"
+#include "inflate.h"
 #include "endian_util.h"
+#include "varint.h"
+#include "scope_guard.h"
 #include "check.h"
 
 // JSON classes are not available on platforms where the system part containing the comms library
 // is not linked with Wiring
 #include "spark_wiring_json.h"
 
+#include <algorithm>
+
 LOG_SOURCE_CATEGORY("comm.ota")
 
 namespace particle {
@@ -46,6 +50,10 @@ namespace {
 
 const system_tick_t TRANSFER_STATE_LOG_INTERVAL = 3000;
 
+// Maximum size of the list of ranges in an acknowledgement. The ranges that don't fit are left
+// unacknowledged and will be retransmitted by the server
+const size_t MAX_CHUNK_ACK_RANGES_SIZE = 64;
+
 static_assert(PARTICLE_LITTLE_ENDIAN, "This code is optimized for little-endian architectures");
 
 // Protocol-specific CoAP options
@@ -57,7 +65,22 @@ enum OtaCoapOption {
     CHUNK_SIZE = 2065,
     DISCARD_DATA = 2069,
     CANCEL_UPDATE = 2073,
-    MODULE_FUNCTION_OPT = 2077
+    MODULE_FUNCTION_OPT = 2077,
+    TRANSFER_ENCODING = 2081,
+    TRANSFER_SIZE = 2085,
+    ACK_FORMAT = 2089
+};
+
+// Encodings of the transferred file data
+enum OtaTransferEncoding {
+    IDENTITY = 0,
+    DEFLATE = 1 // Raw DEFLATE stream (RFC 1951)
+};
+
+// Formats of the chunk acknowledgements
+enum OtaAckFormat {
+    BITMAP = 0, // Bitmap of the received chunks
+    RANGES = 1 // Run lengths of the missing and received chunks, and the receiver window size
 };
 
 inline unsigned trailingOneBits(uint32_t v) {
@@ -68,6 +91,52 @@ inline unsigned trailingOneBits(uint32_t v) {
     return __builtin_ctz(v);
 }
 
+// Returns the position of the first bit with the given value at or after `pos`, or `size` if
+// there's no such bit
+size_t findBit(const uint32_t* bitmap, size_t size, size_t pos, bool val) {
+    while (pos < size) {
+        uint32_t w = bitmap[pos / 32];
+        if (!val) {
+            w = ~w;
+        }
+        w >>= pos % 32;
+        if (w) {
+            return std::min(pos + __builtin_ctz(w), size);
+        }
+        pos = (pos / 32 + 1) * 32;
+    }
+    return size;
+}
+
+// Encodes the bitmap of received chunks as a list of varints, alternating the number of missing
+// chunks and the number of received chunks that follow them
+size_t encodeChunkRanges(const uint32_t* bitmap, size_t size, char* buf, size_t bufSize) {
+    size_t n = 0;
+    size_t pos = 0;
+    for (;;) {
+        const size_t start = findBit(bitmap, size, pos, true);
+        if (start == size) {
+            break;
+        }
+        const size_t end = findBit(bitmap, size, start, false);
+        char range[maxUnsignedVarintSize<unsigned>() * 2];
+        size_t len = encodeUnsignedVarint(range, sizeof(range), (unsigned)(start - pos));
+        len += encodeUnsignedVarint(range + len, sizeof(range) - len, (unsigned)(end - start));
+        if (n + len > bufSize) {
+            break;
+        }
+        memcpy(buf + n, range, len);
+        n += len;
+        pos = end;
+    }
+    return n;
+}
+
+int unexpectedDataError() {
+    SYSTEM_ERROR_MESSAGE("Unexpected data after the end of the compressed data");
+    return SYSTEM_ERROR_BAD_DATA;
+}
+
 } // namespace
 
 ProtocolError FirmwareUpdate::init(MessageChannel* channel, const SparkCallbacks& callbacks) {
@@ -113,6 +182,8 @@ ProtocolError FirmwareUpdate::responseAck(Message* msg, bool* handled) {
         LOG(INFO, "Chunk ACKs sent: %u", stats_.sentChunkAcks);
         LOG(INFO, "Duplicate chunks: %u", stats_.duplicateChunks);
         LOG(INFO, "Out-of-order chunks: %u", stats_.outOfOrderChunks);
+        LOG(INFO, "Max window size: %u", stats_.maxWindowSize);
+        LOG(INFO, "Round trip time: %u", (unsigned)stats_.roundTripTime);
         LOG(INFO, "Applying firmware update");
         FirmwareUpdateFlags flags;
         if (discardData_) {
@@ -140,7 +211,7 @@ ProtocolError FirmwareUpdate::process() {
     if (!updating_) {
         return ProtocolError::NO_ERROR;
     }
-    if (unackChunks_ > 0 && millis() - lastChunkTime_ >= OTA_CHUNK_ACK_DELAY) {
+    if (unackChunks_ > 0 && millis() - lastChunkTime_ >= chunkAckDelay()) {
         // Send an UpdateAck
         Message msg;
         int r = channel_->create(msg);
@@ -298,7 +369,10 @@ int FirmwareUpdate::handleStartRequest(const CoapMessageDecoder& d, CoapMessageE
     size_t chunkSize = 0;
     bool discardData = false;
     int moduleFunction = -1;
-    CHECK(decodeStartRequest(d, &fileSize, &fileHash, &chunkSize, &discardData, &moduleFunction));
+    size_t transferSize = 0; // Size of the compressed data
+    bool ackRanges = false;
+    CHECK(decodeStartRequest(d, &fileSize, &fileHash, &chunkSize, &discardData, &moduleFunction, &transferSize,
+            &ackRanges));
     if (validateOnly) {
         return 0;
     }
@@ -311,30 +385,67 @@ int FirmwareUpdate::handleStartRequest(const CoapMessageDecoder& d, CoapMessageE
     stats_.updateStartTime = startTime;
     LOG(INFO, "File size: %u", (unsigned)fileSize);
     LOG(INFO, "Chunk size: %u", (unsigned)chunkSize);
+    if (transferSize) {
+        LOG(INFO, "Transfer size: %u (compressed)", (unsigned)transferSize);
+    }
     if (discardData) {
         LOG(INFO, "Discard data: %u", (unsigned)discardData);
     }
+    if (ackRanges) {
+        LOG(INFO, "Acknowledgement format: ranges");
+    }
     if (fileHash) {
         LOG(INFO, "File checksum:");
         LOG_DUMP(INFO, fileHash, Sha256::HASH_SIZE);
         LOG_PRINT(INFO, "\r\n");
     }
     LOG(INFO, "Starting firmware update");
-    fileSize_ = fileSize;
     chunkSize_ = chunkSize;
     FirmwareUpdateFlags flags;
     if (discardData) {
         flags |= FirmwareUpdateFlag::DISCARD_DATA;
     }
-    if (!fileHash) {
+    if (!fileHash || transferSize) {
+        // The state of the decompressor is not persisted, so a compressed transfer always starts
+        // from the beginning of the file
         flags |= FirmwareUpdateFlag::NON_RESUMABLE;
     }
+    if (transferSize) {
+        compressed_ = true;
+        if (fileHash) {
+            memcpy(fileHash_, fileHash, sizeof(fileHash_));
+            hasFileHash_ = true;
+        }
+        decodedSize_ = fileSize;
+        CHECK(initDecoder());
+    }
     const auto t1 = millis();
-    CHECK(callbacks_->start_firmware_update(fileSize_, fileHash, &fileOffset_, flags.value(), moduleFunction));
+    const int r = callbacks_->start_firmware_update(fileSize, fileHash, &fileOffset_, flags.value(), moduleFunction);
+    if (r < 0) {
+        destroyDecoder();
+        return r;
+    }
     stats_.processingTime += millis() - t1;
+    if (compressed_) {
+        // Chunks are transferred and acknowledged in terms of the compressed data
+        fileSize_ = transferSize;
+        fileOffset_ = 0;
+        windowSize_ = OTA_COMPRESSED_RECEIVE_WINDOW_SIZE / chunkSize_;
+        maxWindowSize_ = windowSize_; // Limited by the size of the buffer for out-of-order chunks
+    } else {
+        fileSize_ = fileSize;
+        windowSize_ = OTA_RECEIVE_WINDOW_SIZE / chunkSize_;
+        // The window can only grow if the server is able to receive window updates
+        maxWindowSize_ = ackRanges ? OTA_MAX_RECEIVE_WINDOW_SIZE / chunkSize_ : windowSize_;
+    }
+    ackRanges_ = ackRanges;
+    stats_.maxWindowSize = windowSize_;
+    // No chunks are in flight yet, so the first sample is not inflated by queuing along the path
+    rttChunkIndex_ = chunkIndex_;
+    rttStartTime_ = millis();
+    rttPending_ = true;
     transferSize_ = fileSize_ - fileOffset_;
     chunkCount_ = (transferSize_ + chunkSize_ - 1) / chunkSize_;
-    windowSize_ = OTA_RECEIVE_WINDOW_SIZE / chunkSize_;
     LOG(INFO, "Start offset: %u", (unsigned)fileOffset_);
     LOG(INFO, "Chunk count: %u", (unsigned)chunkCount_);
     LOG(TRACE, "Window size (chunks): %u", (unsigned)windowSize_);
@@ -378,6 +489,10 @@ int FirmwareUpdate::handleFinishRequest(const CoapMessageDecoder& d, CoapMessage
             SYSTEM_ERROR_MESSAGE("Incomplete file transfer");
             return SYSTEM_ERROR_PROTOCOL;
         }
+        if (compressed_ && !decodeDone_) {
+            SYSTEM_ERROR_MESSAGE("Incomplete compressed data");
+            return SYSTEM_ERROR_BAD_DATA;
+        }
         LOG(INFO, "Validating firmware update");
         flags |= FirmwareUpdateFlag::VALIDATE_ONLY;
         // The DISCARD_DATA flag has no effect when combined with VALIDATE_ONLY. The flag will be
@@ -451,6 +566,8 @@ int FirmwareUpdate::handleChunkRequest(const CoapMessageDecoder& d, CoapMessageE
         return SYSTEM_ERROR_PROTOCOL;
     }
     bool isDupChunk = false;
+    bool windowChanged = false;
+    bool ackNow = false;
     if (index <= chunkIndex_) {
         isDupChunk = true;
     } else if (index > chunkIndex_ + windowSize_) {
@@ -467,16 +584,27 @@ int FirmwareUpdate::handleChunkRequest(const CoapMessageDecoder& d, CoapMessageE
         } else {
             w |= (1 << bitIndex);
             chunks_[wordIndex] = w;
+            windowChanged = updateWindow(chunkIndex_ + index + 1, chunkTime);
+            // A chunk that is followed by an already received chunk fills a gap
+            const size_t nextIndex = index + 1;
+            if (nextIndex < windowSize_ && (chunks_[nextIndex / 32] & (1 << (nextIndex % 32)))) {
+                ackNow = true;
+            }
             const size_t offs = fileOffset_ + index * chunkSize_; // Chunk offset in the file
+            if (compressed_) {
+                // Compressed data needs to be decoded before the receiver window is shifted
+                const auto t1 = millis();
+                CHECK(decodeChunk(index, data, size));
+                stats_.processingTime += millis() - t1;
+            }
             if (index == 0) {
                 // Shift the receiver window
                 unsigned bits = 0;
                 while ((bits = trailingOneBits(chunks_[0]))) {
                     for (size_t i = 0; i < OTA_CHUNK_BITMAP_ELEMENTS; ++i) {
-                        chunks_[i] >>= bits;
-                        if (i < OTA_CHUNK_BITMAP_ELEMENTS - 1) {
-                            chunks_[i] |= chunks_[i + 1] << (32 - bits);
-                        }
+                        const uint32_t next = (i < OTA_CHUNK_BITMAP_ELEMENTS - 1) ? chunks_[i + 1] : 0;
+                        // Shifting a 32-bit value by 32 bits is undefined
+                        chunks_[i] = (bits < 32) ? (chunks_[i] >> bits) | (next << (32 - bits)) : next;
                     }
                     fileOffset_ += bits * chunkSize_;
                     chunkIndex_ += bits;
@@ -488,10 +616,13 @@ int FirmwareUpdate::handleChunkRequest(const CoapMessageDecoder& d, CoapMessageE
             } else if ((bitIndex > 0 && !(w & (1 << (bitIndex - 1)))) ||
                     (bitIndex == 0 && wordIndex > 0 && !(chunks_[wordIndex - 1] & (1 << 31)))) {
                 ++stats_.outOfOrderChunks;
+                ackNow = true;
+            }
+            if (!compressed_) {
+                const auto t1 = millis();
+                CHECK(callbacks_->save_firmware_chunk(data, size, offs, fileOffset_));
+                stats_.processingTime += millis() - t1;
             }
-            const auto t1 = millis();
-            CHECK(callbacks_->save_firmware_chunk(data, size, offs, fileOffset_));
-            stats_.processingTime += millis() - t1;
         }
     }
     if (isDupChunk) {
@@ -506,8 +637,12 @@ int FirmwareUpdate::handleChunkRequest(const CoapMessageDecoder& d, CoapMessageE
         }
     }
     ++unackChunks_;
-    if (isDupChunk || hasGaps || hasGaps != hasGaps_ || chunkIndex_ == chunkCount_ || unackChunks_ >= OTA_CHUNK_ACK_COUNT ||
-            millis() - lastChunkTime_ >= OTA_CHUNK_ACK_DELAY) {
+    if (!ackRanges_) {
+        // Every chunk that is received while there are gaps is acknowledged immediately
+        ackNow = hasGaps;
+    }
+    if (isDupChunk || ackNow || hasGaps != hasGaps_ || windowChanged || chunkIndex_ == chunkCount_ ||
+            unackChunks_ >= chunkAckCount() || millis() - lastChunkTime_ >= chunkAckDelay()) {
         // Send an UpdateAck
         initChunkAck(e);
         unackChunks_ = 0;
@@ -531,8 +666,174 @@ int FirmwareUpdate::handleChunkRequest(const CoapMessageDecoder& d, CoapMessageE
     return 0;
 }
 
+int FirmwareUpdate::initDecoder() {
+#if HAL_PLATFORM_COMPRESSED_OTA
+    NAMED_SCOPE_GUARD(sg, {
+        destroyDecoder();
+    });
+    chunkBuf_ = new(std::nothrow) char[OTA_COMPRESSED_RECEIVE_WINDOW_SIZE];
+    if (!chunkBuf_) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    CHECK(inflate_create(&inflate_, nullptr /* opts */, [](const char* data, size_t size, void* ctx) -> int {
+        const auto self = static_cast<FirmwareUpdate*>(ctx);
+        CHECK(self->saveDecodedData(data, size));
+        return size;
+    }, this));
+    if (hasFileHash_) {
+        CHECK(decodedHash_.init());
+        CHECK(decodedHash_.start());
+    }
+    sg.dismiss();
+    return 0;
+#else
+    SYSTEM_ERROR_MESSAGE("Compressed transfers are not supported");
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+#endif // !HAL_PLATFORM_COMPRESSED_OTA
+}
+
+int FirmwareUpdate::decodeChunk(unsigned index, const char* data, size_t size) {
+    if (decodeDone_) {
+        return unexpectedDataError(); // The decoder has been destroyed
+    }
+    if (index > 0) {
+        // Keep the chunk until the chunks preceding it are received
+        memcpy(chunkBuf_ + (chunkIndex_ + index) % windowSize_ * chunkSize_, data, size);
+        return 0;
+    }
+    CHECK(decodeData(data, size));
+    // Decode the chunks that were received ahead of this one
+    for (size_t i = 1; i < windowSize_ && (chunks_[i / 32] & (1u << (i % 32))); ++i) {
+        if (decodeDone_) {
+            return unexpectedDataError();
+        }
+        const size_t offs = (chunkIndex_ + i) * chunkSize_; // Chunk offset in the compressed data
+        CHECK(decodeData(chunkBuf_ + (chunkIndex_ + i) % windowSize_ * chunkSize_, std::min(chunkSize_, fileSize_ - offs)));
+    }
+    return 0;
+}
+
+int FirmwareUpdate::decodeData(const char* data, size_t size) {
+#if HAL_PLATFORM_COMPRESSED_OTA
+    int r = 0;
+    do {
+        if (decodeDone_) {
+            return unexpectedDataError();
+        }
+        size_t n = size;
+        r = inflate_input(inflate_, data, &n, INFLATE_HAS_MORE_INPUT);
+        if (r < 0) {
+            if (r == SYSTEM_ERROR_BAD_DATA) {
+                SYSTEM_ERROR_MESSAGE("Invalid compressed data");
+            }
+            return r;
+        }
+        data += n;
+        size -= n;
+        if (r == INFLATE_DONE) {
+            if (decodedOffset_ != decodedSize_) {
+                SYSTEM_ERROR_MESSAGE("Invalid size of the decompressed data: %u", (unsigned)decodedOffset_);
+                return SYSTEM_ERROR_OTA_INVALID_SIZE;
+            }
+            if (hasFileHash_) {
+                char hash[Sha256::HASH_SIZE] = {};
+                CHECK(decodedHash_.finish(hash));
+                if (memcmp(hash, fileHash_, sizeof(hash)) != 0) {
+                    SYSTEM_ERROR_MESSAGE("Invalid checksum of the decompressed data");
+                    return SYSTEM_ERROR_OTA_INTEGRITY_CHECK_FAILED;
+                }
+            }
+            LOG(INFO, "Decompressed %u bytes", (unsigned)decodedOffset_);
+            decodeDone_ = true;
+            // Free the decompressor and chunk buffers before the module gets validated. Note that
+            // `data` may point to the chunk buffer but it is not accessed after this point
+            destroyDecoder();
+        }
+    } while (size > 0 || r == INFLATE_HAS_MORE_OUTPUT);
+    return 0;
+#else
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+#endif // !HAL_PLATFORM_COMPRESSED_OTA
+}
+
+int FirmwareUpdate::saveDecodedData(const char* data, size_t size) {
+    if (size > decodedSize_ - decodedOffset_) {
+        SYSTEM_ERROR_MESSAGE("Decompressed data is too large");
+        return SYSTEM_ERROR_OTA_INVALID_SIZE;
+    }
+    const size_t offs = decodedOffset_;
+    decodedOffset_ += size;
+    CHECK(callbacks_->save_firmware_chunk(data, size, offs, decodedOffset_));
+    if (hasFileHash_) {
+        CHECK(decodedHash_.update(data, size));
+    }
+    return 0;
+}
+
+void FirmwareUpdate::destroyDecoder() {
+#if HAL_PLATFORM_COMPRESSED_OTA
+    if (inflate_) {
+        inflate_destroy(inflate_);
+        inflate_ = nullptr;
+    }
+#endif // HAL_PLATFORM_COMPRESSED_OTA
+    delete[] chunkBuf_;
+    chunkBuf_ = nullptr;
+    decodedHash_.destroy();
+}
+
+bool FirmwareUpdate::updateWindow(unsigned index, system_tick_t now) {
+    // The sender can't send a chunk beyond the right edge of the window advertised in an
+    // acknowledgement before it receives that acknowledgement. The samples include the time the
+    // sender spent sending other chunks, so only the minimum sample is used
+    if (rttPending_ && index > rttChunkIndex_) {
+        lastRtt_ = now - rttStartTime_;
+        if (!rtt_ || lastRtt_ < rtt_) {
+            rtt_ = lastRtt_;
+            stats_.roundTripTime = rtt_;
+        }
+        rttPending_ = false;
+    }
+    if (!rateStartTime_) {
+        rateStartTime_ = now;
+    }
+    ++rateChunks_;
+    if (!rtt_ || now - rateStartTime_ < rtt_) {
+        return false;
+    }
+    // Let the sender have up to two round trips worth of data in flight. The window never shrinks
+    const size_t size = std::min<size_t>(rateChunks_ * 2, maxWindowSize_);
+    rateChunks_ = 0;
+    rateStartTime_ = now;
+    if (lastRtt_ > rtt_ * 2) {
+        // The chunks are queuing up along the path, so a larger window would only add delay
+        return false;
+    }
+    if (size <= windowSize_) {
+        return false;
+    }
+    windowSize_ = size;
+    stats_.maxWindowSize = size;
+    LOG(TRACE, "Window size (chunks): %u", (unsigned)windowSize_);
+    return true;
+}
+
+unsigned FirmwareUpdate::chunkAckCount() const {
+    if (!ackRanges_) {
+        return OTA_CHUNK_ACK_COUNT;
+    }
+    return std::max<unsigned>(windowSize_ / OTA_CHUNK_ACKS_PER_WINDOW, OTA_CHUNK_ACK_COUNT);
+}
+
+system_tick_t FirmwareUpdate::chunkAckDelay() const {
+    if (!ackRanges_ || !rtt_) {
+        return OTA_CHUNK_ACK_DELAY;
+    }
+    return std::min(std::max(rtt_ / 4, OTA_MIN_CHUNK_ACK_DELAY), OTA_CHUNK_ACK_DELAY);
+}
+
 int FirmwareUpdate::decodeStartRequest(const CoapMessageDecoder& d, size_t* fileSize, const char** fileHash,
-        size_t* chunkSize, bool* discardData, int* moduleFunction) {
+        size_t* chunkSize, bool* discardData, int* moduleFunction, size_t* transferSize, bool* ackRanges) {
     if (d.type() != CoapType::CON) {
         SYSTEM_ERROR_MESSAGE("Invalid message type");
         return SYSTEM_ERROR_PROTOCOL;
@@ -545,6 +846,9 @@ int FirmwareUpdate::decodeStartRequest(const CoapMessageDecoder& d, size_t* file
     bool hasFileHash = false;
     bool hasChunkSize = false;
     bool hasDiscardData = false;
+    bool compressed = false;
+    bool hasAckFormat = false;
+    size_t encodedSize = 0;
     auto it = d.options();
     while (it.next()) {
         switch (it.option()) {
@@ -592,20 +896,56 @@ int FirmwareUpdate::decodeStartRequest(const CoapMessageDecoder& d, size_t* file
             // No need to validate here, we will do that in `start_firmware_update`
             break;
         }
+        case OtaCoapOption::TRANSFER_ENCODING: {
+            const unsigned enc = it.toUInt();
+            if (enc == OtaTransferEncoding::DEFLATE) {
+                if (!HAL_PLATFORM_COMPRESSED_OTA) {
+                    SYSTEM_ERROR_MESSAGE("Unsupported transfer encoding: %u", enc);
+                    return SYSTEM_ERROR_NOT_SUPPORTED;
+                }
+                compressed = true;
+            } else if (enc != OtaTransferEncoding::IDENTITY) {
+                SYSTEM_ERROR_MESSAGE("Unsupported transfer encoding: %u", enc);
+                return SYSTEM_ERROR_NOT_SUPPORTED;
+            }
+            break;
+        }
+        case OtaCoapOption::TRANSFER_SIZE: {
+            encodedSize = it.toUInt();
+            if (!encodedSize) {
+                SYSTEM_ERROR_MESSAGE("Invalid transfer size: %u", (unsigned)encodedSize);
+                return SYSTEM_ERROR_PROTOCOL;
+            }
+            break;
+        }
+        case OtaCoapOption::ACK_FORMAT: {
+            const unsigned fmt = it.toUInt();
+            if (fmt != OtaAckFormat::BITMAP && fmt != OtaAckFormat::RANGES) {
+                SYSTEM_ERROR_MESSAGE("Unsupported acknowledgement format: %u", fmt);
+                return SYSTEM_ERROR_NOT_SUPPORTED;
+            }
+            *ackRanges = (fmt == OtaAckFormat::RANGES);
+            hasAckFormat = true;
+            break;
+        }
         default:
             break;
         }
     }
-    if (!hasFileSize || !hasChunkSize) {
+    if (!hasFileSize || !hasChunkSize || (compressed && !encodedSize)) {
         SYSTEM_ERROR_MESSAGE("Invalid message options");
         return SYSTEM_ERROR_PROTOCOL;
     }
+    *transferSize = compressed ? encodedSize : 0;
     if (!hasFileHash) {
         *fileHash = nullptr;
     }
     if (!hasDiscardData) {
         *discardData = false;
     }
+    if (!hasAckFormat) {
+        *ackRanges = false;
+    }
     return 0;
 }
 
@@ -680,19 +1020,32 @@ int FirmwareUpdate::decodeChunkRequest(const CoapMessageDecoder& d, const char**
 }
 
 void FirmwareUpdate::initChunkAck(CoapMessageEncoder* e) {
-    size_t payloadSize = 0;
-    for (int i = OTA_CHUNK_BITMAP_ELEMENTS - 1; i >= 0; --i) {
-        if (chunks_[i]) {
-            payloadSize = (i + 1) * sizeof(uint32_t);
-            break;
-        }
-    }
     e->type(CoapType::NON);
     e->code(CoapCode::POST);
     e->id(0); // Will be set by the message channel
     e->option(CoapOption::URI_PATH, "A");
     e->option(OtaCoapOption::CHUNK_INDEX, chunkIndex_);
-    e->payload((const char*)chunks_, payloadSize);
+    if (ackRanges_) {
+        e->option(OtaCoapOption::WINDOW_SIZE, (unsigned)windowSize_);
+        char ranges[MAX_CHUNK_ACK_RANGES_SIZE];
+        const size_t n = encodeChunkRanges(chunks_, windowSize_, ranges, sizeof(ranges));
+        e->payload(ranges, n);
+    } else {
+        size_t payloadSize = 0;
+        for (int i = OTA_CHUNK_BITMAP_ELEMENTS - 1; i >= 0; --i) {
+            if (chunks_[i]) {
+                payloadSize = (i + 1) * sizeof(uint32_t);
+                break;
+            }
+        }
+        e->payload((const char*)chunks_, payloadSize);
+    }
+    if (!rttPending_) {
+        // Start measuring the round trip time
+        rttChunkIndex_ = chunkIndex_ + windowSize_;
+        rttStartTime_ = millis();
+        rttPending_ = true;
+    }
 }
 
 int FirmwareUpdate::sendErrorResponse(Message* msg, int error, CoapType type, int id, const char* token,
@@ -765,6 +1118,7 @@ void FirmwareUpdate::cancelUpdate() {
         }
         updating_ = false;
     }
+    destroyDecoder();
 }
 
 void FirmwareUpdate::reset() {
@@ -779,12 +1133,26 @@ void FirmwareUpdate::reset() {
     chunkSize_ = 0;
     chunkCount_ = 0;
     windowSize_ = 0;
+    maxWindowSize_ = 0;
+    decodedSize_ = 0;
+    decodedOffset_ = 0;
     chunkIndex_ = 0;
     unackChunks_ = 0;
     stateLogChunks_ = 0;
+    rttChunkIndex_ = 0;
+    rateChunks_ = 0;
+    rttStartTime_ = 0;
+    rateStartTime_ = 0;
+    rtt_ = 0;
+    lastRtt_ = 0;
     finishRespId_ = -1;
     errorRespId_ = -1;
     hasGaps_ = false;
+    rttPending_ = false;
+    ackRanges_ = false;
+    compressed_ = false;
+    hasFileHash_ = false;
+    decodeDone_ = false;
     discardData_ = false;
     // updating_ is cleared separately
 }
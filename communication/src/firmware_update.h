@@ -27,11 +27,14 @@
 
 #include "system_defs.h"
 
+#include "sha256.h"
 #include "mbedtls_config.h"
 
 #include <cstdint>
 #include <cstddef>
 
+struct inflate_ctx;
+
 namespace particle {
 
 namespace protocol {
@@ -69,25 +72,60 @@ static_assert(MAX_OTA_CHUNK_SIZE >= MIN_OTA_CHUNK_SIZE, "Invalid MAX_OTA_CHUNK_S
  * Size of the receiver window in bytes.
  *
  * Received chunks get consumed immediately, so the receiver window can be relatively large.
- * This parameter affects the size of the chunk bitmap maintained by the protocol implementation.
+ * This is the initial size of the window. If the server supports window updates, the window can
+ * grow up to `OTA_MAX_RECEIVE_WINDOW_SIZE`.
  */
 const size_t OTA_RECEIVE_WINDOW_SIZE = 128 * 1024;
 
 static_assert(OTA_RECEIVE_WINDOW_SIZE > MAX_OTA_CHUNK_SIZE, "Invalid OTA_RECEIVE_WINDOW_SIZE");
 
+/**
+ * Maximum size of the receiver window in bytes.
+ *
+ * The receiver window grows to twice the amount of data received per round trip, so that a sender
+ * limited by the window can keep a link with a large bandwidth-delay product busy. The window stops
+ * growing once the round trip time exceeds twice its minimum, as chunks are then queuing up along
+ * the path. This parameter affects the size of the chunk bitmap maintained by the protocol
+ * implementation.
+ */
+const size_t OTA_MAX_RECEIVE_WINDOW_SIZE = 512 * 1024;
+
+static_assert(OTA_MAX_RECEIVE_WINDOW_SIZE >= OTA_RECEIVE_WINDOW_SIZE, "Invalid OTA_MAX_RECEIVE_WINDOW_SIZE");
+
+/**
+ * Size of the receiver window in bytes for compressed transfers.
+ *
+ * Compressed data can only be decoded in order, so the chunks received ahead of a missing chunk
+ * are kept in RAM until the gap is filled. This parameter determines the size of that buffer.
+ */
+const size_t OTA_COMPRESSED_RECEIVE_WINDOW_SIZE = 16 * 1024;
+
+static_assert(OTA_COMPRESSED_RECEIVE_WINDOW_SIZE > MAX_OTA_CHUNK_SIZE && OTA_COMPRESSED_RECEIVE_WINDOW_SIZE <= OTA_RECEIVE_WINDOW_SIZE,
+        "Invalid OTA_COMPRESSED_RECEIVE_WINDOW_SIZE");
+
 /**
  * Size of the chunk bitmap in 32-bit words.
  */
-const size_t OTA_CHUNK_BITMAP_ELEMENTS = (OTA_RECEIVE_WINDOW_SIZE / MIN_OTA_CHUNK_SIZE + 31) / 32;
+const size_t OTA_CHUNK_BITMAP_ELEMENTS = (OTA_MAX_RECEIVE_WINDOW_SIZE / MIN_OTA_CHUNK_SIZE + 31) / 32;
 
 /**
  * Acknowledgement delay in milliseconds.
  *
  * SCTP recommends using a delay of 200ms with 500ms being the absolute maximum. Setting this
  * parameter to 0 disables delayed acknowledgements.
+ *
+ * If the server supports window updates, the delay is reduced to a quarter of the measured round
+ * trip time, but not below `OTA_MIN_CHUNK_ACK_DELAY`.
  */
 const system_tick_t OTA_CHUNK_ACK_DELAY = 200;
 
+/**
+ * Minimum acknowledgement delay in milliseconds.
+ */
+const system_tick_t OTA_MIN_CHUNK_ACK_DELAY = 20;
+
+static_assert(OTA_MIN_CHUNK_ACK_DELAY <= OTA_CHUNK_ACK_DELAY, "Invalid OTA_MIN_CHUNK_ACK_DELAY");
+
 /**
  * Minimum number of chunks to receive before generating an acknowledgement.
  *
@@ -95,6 +133,15 @@ const system_tick_t OTA_CHUNK_ACK_DELAY = 200;
  */
 const unsigned OTA_CHUNK_ACK_COUNT = 2;
 
+/**
+ * Number of acknowledgements to generate per receiver window.
+ *
+ * If the server supports window updates, the number of chunks to receive before generating an
+ * acknowledgement grows with the window, so that a large window doesn't cost more uplink traffic
+ * than necessary to keep the sender busy.
+ */
+const unsigned OTA_CHUNK_ACKS_PER_WINDOW = 16;
+
 /**
  * Maximum time to wait for the next chunk before timing out the transfer.
  */
@@ -118,6 +165,8 @@ struct FirmwareUpdateStats {
     unsigned sentChunkAcks; // Number of sent acknowledgements
     unsigned outOfOrderChunks; // Number of chunks received out of order
     unsigned duplicateChunks; // Number of duplicate chunks received
+    unsigned maxWindowSize; // Maximum size of the receiver window in chunks
+    system_tick_t roundTripTime; // Round trip time measured by the receiver
 };
 
 /**
@@ -148,6 +197,10 @@ private:
             bool validateOnly);
 
     uint32_t chunks_[OTA_CHUNK_BITMAP_ELEMENTS]; // Bitmap of received chunks within the receiver window
+    char fileHash_[Sha256::HASH_SIZE]; // Expected hash of the decompressed file (compressed transfers only)
+    Sha256 decodedHash_; // Hash of the decompressed data (compressed transfers only)
+    inflate_ctx* inflate_; // Decompressor (compressed transfers only)
+    char* chunkBuf_; // Chunks received out of order (compressed transfers only)
     FirmwareUpdateStats stats_; // Protocol statistics
     const SparkCallbacks* callbacks_; // System callbacks
     MessageChannel* channel_; // Message channel
@@ -159,12 +212,26 @@ private:
     size_t chunkSize_; // Chunk size
     size_t chunkCount_; // Total number of chunks to transfer
     size_t windowSize_; // Size of the receiver window in chunks
+    size_t maxWindowSize_; // Maximum size of the receiver window in chunks
+    size_t decodedSize_; // Size of the decompressed file (compressed transfers only)
+    size_t decodedOffset_; // Number of decompressed bytes saved (compressed transfers only)
     unsigned chunkIndex_; // Number of cumulatively acknowledged chunks
     unsigned unackChunks_; // Number or chunks received since the last acknowledgement
     unsigned stateLogChunks_; // Number of cumulatively acknowledged chunks at the time when the transfer state was last logged
+    unsigned rttChunkIndex_; // Right edge of the receiver window at the time when the RTT measurement started
+    unsigned rateChunks_; // Number of chunks received since the rate measurement started
+    system_tick_t rttStartTime_; // Time when the RTT measurement started
+    system_tick_t rateStartTime_; // Time when the rate measurement started
+    system_tick_t rtt_; // Minimum measured round trip time
+    system_tick_t lastRtt_; // Last measured round trip time
     int finishRespId_; // Message ID of the UpdateFinish response
     int errorRespId_; // Message ID of the last confirmable error response sent to the server
     bool hasGaps_; // Whether the sequence of received chunks has gaps
+    bool rttPending_; // Whether the RTT measurement is in progress
+    bool ackRanges_; // Whether the server supports acknowledgements with ranges and window updates
+    bool compressed_; // Whether the file is transferred compressed
+    bool hasFileHash_; // Whether the hash of the decompressed file is known
+    bool decodeDone_; // Whether the compressed data has been fully decoded and validated
     bool discardData_; // Whether to discard the cached module data after the update
     bool updating_; // Whether an update is in progress
 
@@ -174,8 +241,18 @@ private:
     int handleFinishRequest(const CoapMessageDecoder& d, CoapMessageEncoder* e, int** respId, bool validateOnly);
     int handleChunkRequest(const CoapMessageDecoder& d, CoapMessageEncoder* e, int** respId, bool validateOnly);
 
+    int initDecoder();
+    int decodeChunk(unsigned index, const char* data, size_t size);
+    int decodeData(const char* data, size_t size);
+    int saveDecodedData(const char* data, size_t size);
+    void destroyDecoder();
+
+    bool updateWindow(unsigned index, system_tick_t now);
+    unsigned chunkAckCount() const;
+    system_tick_t chunkAckDelay() const;
+
     static int decodeStartRequest(const CoapMessageDecoder& d, size_t* fileSize, const char** fileHash, size_t* chunkSize,
-            bool* discardData, int* moduleFunction);
+            bool* discardData, int* moduleFunction, size_t* transferSize, bool* ackRanges);
     static int decodeFinishRequest(const CoapMessageDecoder& d, bool* cancelUpdate, bool* discardData);
     static int decodeChunkRequest(const CoapMessageDecoder& d, const char** chunkData, size_t* chunkSize,
             unsigned* chunkIndex);
@@ -191,6 +268,8 @@ private:
 };
 
 inline FirmwareUpdate::FirmwareUpdate() :
+        inflate_(nullptr),
+        chunkBuf_(nullptr),
         callbacks_(nullptr),
         channel_(nullptr),
         updating_(false) {
@@ -85,6 +85,9 @@ public:
 	{
 		SPARK_ASSERT(status);
 		status->flags = 0;
+		if (has_pending_exchanges()) {
+			status->flags |= PROTOCOL_STATUS_BUSY;
+		}
 		return 0;
 	}
 
@@ -34,6 +34,7 @@ LOG_SOURCE_CATEGORY("comm.protocol")
 #include "v2/coap_channel.h"
 #include "coap_message_decoder.h"
 #include "coap_message_encoder.h"
+#include "trace_marker.h"
 
 namespace particle { namespace protocol {
 
@@ -47,7 +48,9 @@ enum HelloFlag {
 	HELLO_FLAG_GOODBYE_SUPPORT = 0x10,
 	HELLO_FLAG_DEVICE_INITIATED_DESCRIBE = 0x20,
 	HELLO_FLAG_COMPRESSED_OTA = 0x40,
-	HELLO_FLAG_OTA_PROTOCOL_V3 = 0x80
+	HELLO_FLAG_OTA_PROTOCOL_V3 = 0x80,
+	HELLO_FLAG_OTA_TRANSFER_ENCODING = 0x100, // Firmware files can be transferred compressed
+	HELLO_FLAG_OTA_ACK_RANGES = 0x200 // Firmware chunks can be acknowledged with ranges and window updates
 };
 
 struct ServerMovedContext {
@@ -599,7 +602,10 @@ ProtocolError Protocol::hello(bool was_ota_upgrade_successful)
 		flags |= HELLO_FLAG_COMPRESSED_OTA;
 	}
 #if HAL_PLATFORM_OTA_PROTOCOL_V3
-	flags |= HELLO_FLAG_OTA_PROTOCOL_V3;
+	flags |= HELLO_FLAG_OTA_PROTOCOL_V3 | HELLO_FLAG_OTA_ACK_RANGES;
+#if HAL_PLATFORM_COMPRESSED_OTA
+	flags |= HELLO_FLAG_OTA_TRANSFER_ENCODING;
+#endif
 #endif
 	size_t len = build_hello(message, flags);
 	message.set_length(len);
@@ -654,6 +660,7 @@ ProtocolError Protocol::event_loop(CoAPMessageType::Enum message_type,
  */
 ProtocolError Protocol::event_loop(CoAPMessageType::Enum& message_type)
 {
+	PARTICLE_TRACE_SCOPE("protocol:event_loop");
 	// Process expired completion handlers
 	const system_tick_t t = callbacks.millis();
 	ack_handlers.update(t - last_ack_handlers_update);
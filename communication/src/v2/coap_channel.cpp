@@ -1093,6 +1093,13 @@ int CoapChannel::run() {
     return 0;
 }
 
+bool CoapChannel::hasPendingExchanges() const {
+    if (state_ != State::OPEN) {
+        return false;
+    }
+    return sentReqs_ || recvBlockReqs_ || blockResps_ || unackMsgs_ || pendingCloseError_;
+}
+
 CoapChannel* CoapChannel::instance() {
     static CoapChannel channel;
     return &channel;
@@ -1503,7 +1510,9 @@ int CoapChannel::handleAck(CoapMessageDecoder& d) {
         // Messages with a payload object bypass the old CoAP implementation so the related diagnostics
         // need to be updated separately
         auto req = staticPtrCast<RequestMessage>(msg);
-        g_coapRoundTripMSec = millis() - req->transmitTime;
+        const auto roundTrip = millis() - req->transmitTime;
+        g_coapRoundTripMSec = roundTrip;
+        g_coapRoundTripHistogram.record(roundTrip);
     }
     // For a blockwise request, the ACK callback is invoked when the last message block is acknowledged
     if (msg->ackCallback && ((msg->type == MessageType::REQUEST && !msg->hasMore.value_or(false)) ||
@@ -1624,6 +1633,8 @@ int CoapChannel::sendMessage(RefCountPtr<Message> msg, bool retransmit, bool pas
     assert(curMsgId_ == msg->id);
     msgBuf_.set_length(msg->pos - (char*)msgBuf_.buf());
     msgBuf_.passthrough(passthrough);
+    // Retransmissions also take the redundant path, if there's one
+    msgBuf_.redundant(retransmit);
     if (retransmit) {
         msgBuf_.set_id(msg->coapId);
     }
@@ -1771,6 +1782,7 @@ int CoapChannel::handleProtocolError(ProtocolError error) {
     LOG(ERROR, "Protocol error: %d", (int)error);
     int err = toSystemError(error);
     close(err);
+    // Unlike a message timeout, a protocol error may indicate that the session is no longer valid
     error = protocol_->get_channel().command(Channel::CLOSE);
     if (error != ProtocolError::NO_ERROR) {
         LOG(ERROR, "Channel CLOSE command failed: %d", (int)error);
@@ -1,45 +1,792 @@
-#include "crypto.h"
-#include <iostream>
-#include <string>
-#include <vector>
-#include <iomanip>
+/**
+ * @file aes.c
+ * @brief AES-128/256 block cipher with CTR and GCM streaming modes.
+ */
 
-// Simple AES-like block cipher placeholder for demonstration (not secure, just for structure)
-namespace {
-    constexpr size_t BLOCK_SIZE = 16;
+#include "aes.h"
 
-    void xor_block(std::vector<uint8_t>& block, const std::vector<uint8_t>& key) {
-        for (size_t i = 0; i < block.size(); ++i) {
-            block[i] ^= key[i % key.size()];
+#include "system_error.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRYPTO_AES_X86_64 1
+#include <immintrin.h>
+#else
+#define CRYPTO_AES_X86_64 0
+#endif
+
+// Number of blocks processed by the portable implementation in one pass. The S-box is evaluated
+// over bit planes, so processing several blocks at once amortizes its fixed cost
+#define AES_CT_BLOCKS 4
+
+enum {
+    GCM_STATE_AAD = 0,
+    GCM_STATE_DATA = 1,
+    GCM_STATE_DONE = 2
+};
+
+typedef void (*ctr_blocks_func)(const crypto_aes_key* key, uint8_t* counter, int inc32,
+        const uint8_t* in, uint8_t* out, size_t blocks);
+typedef void (*ghash_blocks_func)(uint8_t* y, const uint8_t* h, const uint8_t* data, size_t blocks);
+
+static void ctr_blocks_ct(const crypto_aes_key* key, uint8_t* counter, int inc32, const uint8_t* in,
+        uint8_t* out, size_t blocks);
+static void ghash_blocks_ct(uint8_t* y, const uint8_t* h, const uint8_t* data, size_t blocks);
+
+#if CRYPTO_AES_X86_64
+static void ctr_blocks_ni(const crypto_aes_key* key, uint8_t* counter, int inc32, const uint8_t* in,
+        uint8_t* out, size_t blocks);
+static void ghash_blocks_ni(uint8_t* y, const uint8_t* h, const uint8_t* data, size_t blocks);
+#endif
+
+// -1: not initialized, 0: portable implementation, 1: AES-NI
+static int s_hwAccel = -1;
+
+static int hw_accel_supported(void) {
+#if CRYPTO_AES_X86_64
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul") &&
+            __builtin_cpu_supports("ssse3");
+#else
+    return 0;
+#endif
+}
+
+static int use_hw_accel(void) {
+    if (s_hwAccel < 0) {
+        s_hwAccel = hw_accel_supported();
+    }
+    return s_hwAccel;
+}
+
+static ctr_blocks_func ctr_blocks_impl(void) {
+#if CRYPTO_AES_X86_64
+    if (use_hw_accel()) {
+        return ctr_blocks_ni;
+    }
+#endif
+    return ctr_blocks_ct;
+}
+
+static ghash_blocks_func ghash_blocks_impl(void) {
+#if CRYPTO_AES_X86_64
+    if (use_hw_accel()) {
+        return ghash_blocks_ni;
+    }
+#endif
+    return ghash_blocks_ct;
+}
+
+static inline uint64_t load_be64(const uint8_t* p) {
+    return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) |
+            ((uint64_t)p[3] << 32) | ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+            ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+}
+
+static inline void store_be64(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+static inline void xor_block(uint8_t* dest, const uint8_t* a, const uint8_t* b) {
+    for (size_t i = 0; i < CRYPTO_AES_BLOCK_SIZE; ++i) {
+        dest[i] = a[i] ^ b[i];
+    }
+}
+
+static inline void increment_counter(uint8_t* counter, int inc32) {
+    // Increments the last 4 bytes (GCM) or the entire block (CTR) as a big-endian integer.
+    // Runs in constant time with respect to the counter value
+    const size_t first = inc32 ? CRYPTO_AES_BLOCK_SIZE - 4 : 0;
+    unsigned carry = 1;
+    for (size_t i = CRYPTO_AES_BLOCK_SIZE; i > first; --i) {
+        carry += counter[i - 1];
+        counter[i - 1] = (uint8_t)carry;
+        carry >>= 8;
+    }
+}
+
+// Portable constant-time implementation.
+//
+// The cipher state is kept in bitsliced form: up to AES_CT_BLOCKS blocks are transposed into 8
+// bit planes, where bit (16 * block + byte) of plane i holds bit i of that byte. The S-box is
+// computed arithmetically as an inversion in GF(2^8) over the planes rather than looked up in a
+// table, and ShiftRows/MixColumns become fixed shifts and masks, so neither the memory access
+// pattern nor the timing depends on secret data.
+
+typedef uint64_t aes_planes[8];
+
+typedef struct aes_sliced_key {
+    aes_planes rk[CRYPTO_AES_MAX_ROUNDS + 1];
+    unsigned rounds;
+} aes_sliced_key;
+
+// Transposes an 8x8 bit matrix: bit i of byte j becomes bit j of byte i
+static inline uint64_t transpose8x8(uint64_t x) {
+    uint64_t t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+    return x ^ t ^ (t << 28);
+}
+
+// Converts up to 64 bytes to bit planes
+static void planes_pack(aes_planes x, const uint8_t* data, size_t size) {
+    memset(x, 0, sizeof(aes_planes));
+    for (size_t g = 0; g * 8 < size; ++g) {
+        const size_t n = (size - g * 8 < 8) ? size - g * 8 : 8;
+        uint64_t v = 0;
+        for (size_t j = 0; j < n; ++j) {
+            v |= (uint64_t)data[g * 8 + j] << (8 * j);
+        }
+        v = transpose8x8(v);
+        for (int i = 0; i < 8; ++i) {
+            x[i] |= ((v >> (8 * i)) & 0xff) << (8 * g);
+        }
+    }
+}
+
+static void planes_unpack(uint8_t* data, size_t size, const aes_planes x) {
+    for (size_t g = 0; g * 8 < size; ++g) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) {
+            v |= ((x[i] >> (8 * g)) & 0xff) << (8 * i);
+        }
+        v = transpose8x8(v);
+        const size_t n = (size - g * 8 < 8) ? size - g * 8 : 8;
+        for (size_t j = 0; j < n; ++j) {
+            data[g * 8 + j] = (uint8_t)(v >> (8 * j));
+        }
+    }
+}
+
+// Reduces a 15-bit polynomial product modulo x^8 + x^4 + x^3 + x + 1
+static inline void gf_reduce_planes(uint64_t* r, uint64_t* p) {
+    for (int k = 14; k >= 8; --k) {
+        p[k - 4] ^= p[k];
+        p[k - 5] ^= p[k];
+        p[k - 7] ^= p[k];
+        p[k - 8] ^= p[k];
+    }
+    for (int i = 0; i < 8; ++i) {
+        r[i] = p[i];
+    }
+}
+
+static void gf_mul_planes(aes_planes r, const aes_planes a, const aes_planes b) {
+    uint64_t p[15] = {};
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            p[i + j] ^= a[i] & b[j];
+        }
+    }
+    gf_reduce_planes(r, p);
+}
+
+static void gf_sqr_planes(aes_planes r, const aes_planes a, int times) {
+    for (int i = 0; i < 8; ++i) {
+        r[i] = a[i];
+    }
+    while (times-- > 0) {
+        // Squaring is linear in GF(2^8): bit i moves to bit 2i
+        uint64_t p[15] = {};
+        for (int i = 0; i < 8; ++i) {
+            p[2 * i] = r[i];
+        }
+        gf_reduce_planes(r, p);
+    }
+}
+
+static void sub_bytes_planes(aes_planes x) {
+    // Multiplicative inverse as x^254: x^2, x^3, x^12, x^15, x^240, x^252, x^254
+    aes_planes x2, x3, x12, x15, t;
+    gf_sqr_planes(x2, x, 1);
+    gf_mul_planes(x3, x2, x);
+    gf_sqr_planes(x12, x3, 2);
+    gf_mul_planes(x15, x12, x3);
+    gf_sqr_planes(t, x15, 4);
+    gf_mul_planes(t, t, x12);
+    gf_mul_planes(t, t, x2);
+    // Affine transform: b ^ rotl(b, 1) ^ rotl(b, 2) ^ rotl(b, 3) ^ rotl(b, 4) ^ 0x63
+    for (int i = 0; i < 8; ++i) {
+        x[i] = t[i] ^ t[(i + 7) & 7] ^ t[(i + 6) & 7] ^ t[(i + 5) & 7] ^ t[(i + 4) & 7];
+        if ((0x63 >> i) & 1) {
+            x[i] = ~x[i];
+        }
+    }
+}
+
+static void sub_bytes_ct(uint8_t* data, size_t size) {
+    aes_planes x;
+    planes_pack(x, data, size);
+    sub_bytes_planes(x);
+    planes_unpack(data, size, x);
+}
+
+static void shift_rows_planes(aes_planes x) {
+    // Byte r + 4c of a block lives at bit r + 4c of its 16-bit lane. Row r is rotated left by r
+    // columns, i.e. bit p takes the value of bit (p + 4r) mod 16 of the same lane
+    static const uint64_t ROW = 0x1111111111111111ull;
+    static const uint64_t LOW[4] = { 0, 0x0fff0fff0fff0fffull, 0x00ff00ff00ff00ffull,
+            0x000f000f000f000full };
+    for (int i = 0; i < 8; ++i) {
+        uint64_t v = x[i] & ROW;
+        for (int r = 1; r < 4; ++r) {
+            const uint64_t row = x[i] & (ROW << r);
+            v |= ((row >> (4 * r)) & LOW[r] & (ROW << r)) |
+                    ((row << (16 - 4 * r)) & ~LOW[r] & (ROW << r));
+        }
+        x[i] = v;
+    }
+}
+
+// Rotates the 4 bytes of each column so that byte r takes the value of byte r + n
+static inline uint64_t rotate_column(uint64_t x, int n) {
+    static const uint64_t MASK[4] = { 0, 0x7777777777777777ull, 0x3333333333333333ull,
+            0x1111111111111111ull };
+    return ((x >> n) & MASK[n]) | ((x << (4 - n)) & ~MASK[n]);
+}
+
+static void mix_columns_planes(aes_planes x) {
+    // b[r] = a[r] ^ t ^ xtime(a[r] ^ a[r + 1]), where t = a[0] ^ a[1] ^ a[2] ^ a[3]
+    aes_planes u, t;
+    for (int i = 0; i < 8; ++i) {
+        u[i] = x[i] ^ rotate_column(x[i], 1);
+        t[i] = u[i] ^ rotate_column(u[i], 2);
+    }
+    // xtime() multiplies by x and reduces by 0x1b (bits 0, 1, 3 and 4)
+    const uint64_t hi = u[7];
+    for (int i = 7; i > 0; --i) {
+        u[i] = u[i - 1];
+    }
+    u[0] = hi;
+    u[1] ^= hi;
+    u[3] ^= hi;
+    u[4] ^= hi;
+    for (int i = 0; i < 8; ++i) {
+        x[i] ^= t[i] ^ u[i];
+    }
+}
+
+static void sliced_key_init(aes_sliced_key* sk, const crypto_aes_key* key) {
+    sk->rounds = key->rounds;
+    for (unsigned r = 0; r <= key->rounds; ++r) {
+        planes_pack(sk->rk[r], key->round_keys + r * CRYPTO_AES_BLOCK_SIZE, CRYPTO_AES_BLOCK_SIZE);
+        // Replicate the round key to all block lanes
+        for (int i = 0; i < 8; ++i) {
+            sk->rk[r][i] *= 0x0001000100010001ull;
         }
     }
 }
 
-std::string encrypt(const std::string& plaintext, const std::string& key) {
-    std::vector<uint8_t> data(plaintext.begin(), plaintext.end());
-    std::vector<uint8_t> k(key.begin(), key.end());
-    std::string encrypted;
-    for (size_t i = 0; i < data.size(); i += BLOCK_SIZE) {
-        std::vector<uint8_t> block(data.begin() + i, data.begin() + std::min(i + BLOCK_SIZE, data.size()));
-        block.resize(BLOCK_SIZE, 0); // pad block
-        xor_block(block, k);
-        for (auto b : block) {
-            encrypted += static_cast<char>(b);
+// Encrypts `blocks` (1 to AES_CT_BLOCKS) consecutive blocks in place
+static void encrypt_blocks_ct(const aes_sliced_key* sk, uint8_t* data, size_t blocks) {
+    const size_t size = blocks * CRYPTO_AES_BLOCK_SIZE;
+    aes_planes x;
+    planes_pack(x, data, size);
+    for (int i = 0; i < 8; ++i) {
+        x[i] ^= sk->rk[0][i];
+    }
+    for (unsigned round = 1; round <= sk->rounds; ++round) {
+        sub_bytes_planes(x);
+        shift_rows_planes(x);
+        if (round != sk->rounds) {
+            mix_columns_planes(x);
+        }
+        for (int i = 0; i < 8; ++i) {
+            x[i] ^= sk->rk[round][i];
         }
     }
-    return encrypted;
+    planes_unpack(data, size, x);
 }
 
-std::string decrypt(const std::string& ciphertext, const std::string& key) {
-    std::vector<uint8_t> data(ciphertext.begin(), ciphertext.end());
-    std::vector<uint8_t> k(key.begin(), key.end());
-    std::string decrypted;
-    for (size_t i = 0; i < data.size(); i += BLOCK_SIZE) {
-        std::vector<uint8_t> block(data.begin() + i, data.begin() + std::min(i + BLOCK_SIZE, data.size()));
-        xor_block(block, k);
-        for (auto b : block) {
-            decrypted += static_cast<char>(b);
+static inline uint8_t xtime(uint8_t x) {
+    return (uint8_t)((x << 1) ^ (0x1b & -(x >> 7)));
+}
+
+static void ctr_blocks_ct(const crypto_aes_key* key, uint8_t* counter, int inc32, const uint8_t* in,
+        uint8_t* out, size_t blocks) {
+    aes_sliced_key sk;
+    sliced_key_init(&sk, key);
+    uint8_t ks[AES_CT_BLOCKS * CRYPTO_AES_BLOCK_SIZE];
+    while (blocks > 0) {
+        const size_t n = (blocks < AES_CT_BLOCKS) ? blocks : AES_CT_BLOCKS;
+        for (size_t b = 0; b < n; ++b) {
+            memcpy(ks + b * CRYPTO_AES_BLOCK_SIZE, counter, CRYPTO_AES_BLOCK_SIZE);
+            increment_counter(counter, inc32);
+        }
+        encrypt_blocks_ct(&sk, ks, n);
+        for (size_t i = 0; i < n * CRYPTO_AES_BLOCK_SIZE; ++i) {
+            out[i] = in[i] ^ ks[i];
         }
+        in += n * CRYPTO_AES_BLOCK_SIZE;
+        out += n * CRYPTO_AES_BLOCK_SIZE;
+        blocks -= n;
     }
-    return decrypted;
+}
+
+static void ghash_blocks_ct(uint8_t* y, const uint8_t* h, const uint8_t* data, size_t blocks) {
+    const uint64_t hHi = load_be64(h);
+    const uint64_t hLo = load_be64(h + 8);
+    uint64_t yHi = load_be64(y);
+    uint64_t yLo = load_be64(y + 8);
+    for (size_t b = 0; b < blocks; ++b, data += CRYPTO_AES_BLOCK_SIZE) {
+        const uint64_t xHi = yHi ^ load_be64(data);
+        const uint64_t xLo = yLo ^ load_be64(data + 8);
+        uint64_t zHi = 0, zLo = 0;
+        uint64_t vHi = hHi, vLo = hLo;
+        for (int i = 0; i < 128; ++i) {
+            const uint64_t bit = (i < 64) ? (xHi >> (63 - i)) & 1 : (xLo >> (127 - i)) & 1;
+            const uint64_t mask = -bit;
+            zHi ^= vHi & mask;
+            zLo ^= vLo & mask;
+            const uint64_t lsb = -(vLo & 1);
+            vLo = (vLo >> 1) | (vHi << 63);
+            vHi = (vHi >> 1) ^ (0xe100000000000000ull & lsb);
+        }
+        yHi = zHi;
+        yLo = zLo;
+    }
+    store_be64(y, yHi);
+    store_be64(y + 8, yLo);
+}
+
+// AES-NI/PCLMULQDQ implementation
+
+#if CRYPTO_AES_X86_64
+
+#define AES_NI_TARGET __attribute__((target("aes,pclmul,ssse3")))
+
+AES_NI_TARGET
+static inline __m128i aes_ni_encrypt(const __m128i* rk, unsigned rounds, __m128i x) {
+    x = _mm_xor_si128(x, rk[0]);
+    for (unsigned i = 1; i < rounds; ++i) {
+        x = _mm_aesenc_si128(x, rk[i]);
+    }
+    return _mm_aesenclast_si128(x, rk[rounds]);
+}
+
+AES_NI_TARGET
+static void ctr_blocks_ni(const crypto_aes_key* key, uint8_t* counter, int inc32, const uint8_t* in,
+        uint8_t* out, size_t blocks) {
+    __m128i rk[CRYPTO_AES_MAX_ROUNDS + 1];
+    for (unsigned i = 0; i <= key->rounds; ++i) {
+        rk[i] = _mm_loadu_si128((const __m128i*)(key->round_keys + i * CRYPTO_AES_BLOCK_SIZE));
+    }
+    const unsigned rounds = key->rounds;
+    // Encrypt 4 independent counter blocks per iteration to hide the AESENC latency
+    while (blocks >= 4) {
+        __m128i x[4];
+        for (int b = 0; b < 4; ++b) {
+            x[b] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)counter), rk[0]);
+            increment_counter(counter, inc32);
+        }
+        for (unsigned i = 1; i < rounds; ++i) {
+            for (int b = 0; b < 4; ++b) {
+                x[b] = _mm_aesenc_si128(x[b], rk[i]);
+            }
+        }
+        for (int b = 0; b < 4; ++b) {
+            x[b] = _mm_aesenclast_si128(x[b], rk[rounds]);
+            const __m128i d = _mm_loadu_si128((const __m128i*)(in + b * CRYPTO_AES_BLOCK_SIZE));
+            _mm_storeu_si128((__m128i*)(out + b * CRYPTO_AES_BLOCK_SIZE), _mm_xor_si128(d, x[b]));
+        }
+        in += 4 * CRYPTO_AES_BLOCK_SIZE;
+        out += 4 * CRYPTO_AES_BLOCK_SIZE;
+        blocks -= 4;
+    }
+    while (blocks-- > 0) {
+        const __m128i x = aes_ni_encrypt(rk, rounds, _mm_loadu_si128((const __m128i*)counter));
+        increment_counter(counter, inc32);
+        _mm_storeu_si128((__m128i*)out, _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), x));
+        in += CRYPTO_AES_BLOCK_SIZE;
+        out += CRYPTO_AES_BLOCK_SIZE;
+    }
+}
+
+// Carry-less multiplication in GF(2^128) on byte-reflected operands, see Intel's "Carry-Less
+// Multiplication Instruction and its Usage for Computing the GCM Mode", algorithm 5
+AES_NI_TARGET
+static inline __m128i ghash_mul_ni(__m128i a, __m128i b) {
+    __m128i t3 = _mm_clmulepi64_si128(a, b, 0x00);
+    __m128i t4 = _mm_clmulepi64_si128(a, b, 0x10);
+    __m128i t5 = _mm_clmulepi64_si128(a, b, 0x01);
+    __m128i t6 = _mm_clmulepi64_si128(a, b, 0x11);
+    t4 = _mm_xor_si128(t4, t5);
+    t5 = _mm_slli_si128(t4, 8);
+    t4 = _mm_srli_si128(t4, 8);
+    t3 = _mm_xor_si128(t3, t5);
+    t6 = _mm_xor_si128(t6, t4);
+    // Shift the 256-bit product left by one bit
+    __m128i t7 = _mm_srli_epi32(t3, 31);
+    __m128i t8 = _mm_srli_epi32(t6, 31);
+    t3 = _mm_slli_epi32(t3, 1);
+    t6 = _mm_slli_epi32(t6, 1);
+    __m128i t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    t3 = _mm_or_si128(t3, t7);
+    t6 = _mm_or_si128(t6, t8);
+    t6 = _mm_or_si128(t6, t9);
+    // Reduce modulo x^128 + x^7 + x^2 + x + 1
+    t7 = _mm_slli_epi32(t3, 31);
+    t8 = _mm_slli_epi32(t3, 30);
+    t9 = _mm_slli_epi32(t3, 25);
+    t7 = _mm_xor_si128(t7, t8);
+    t7 = _mm_xor_si128(t7, t9);
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    t3 = _mm_xor_si128(t3, t7);
+    __m128i t2 = _mm_srli_epi32(t3, 1);
+    t4 = _mm_srli_epi32(t3, 2);
+    t5 = _mm_srli_epi32(t3, 7);
+    t2 = _mm_xor_si128(t2, t4);
+    t2 = _mm_xor_si128(t2, t5);
+    t2 = _mm_xor_si128(t2, t8);
+    t3 = _mm_xor_si128(t3, t2);
+    return _mm_xor_si128(t6, t3);
+}
+
+AES_NI_TARGET
+static void ghash_blocks_ni(uint8_t* y, const uint8_t* h, const uint8_t* data, size_t blocks) {
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i hr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)h), bswap);
+    __m128i yr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)y), bswap);
+    for (size_t b = 0; b < blocks; ++b, data += CRYPTO_AES_BLOCK_SIZE) {
+        const __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)data), bswap);
+        yr = ghash_mul_ni(_mm_xor_si128(yr, x), hr);
+    }
+    _mm_storeu_si128((__m128i*)y, _mm_shuffle_epi8(yr, bswap));
+}
+
+AES_NI_TARGET
+static inline __m128i aes_ni_expand_step(__m128i k, __m128i assist) {
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    return _mm_xor_si128(k, assist);
+}
+
+AES_NI_TARGET
+static void set_key_ni(crypto_aes_key* key, const uint8_t* data, size_t size) {
+    __m128i* rk = (__m128i*)key->round_keys;
+    __m128i k1 = _mm_loadu_si128((const __m128i*)data);
+    _mm_storeu_si128(rk, k1);
+    // The round constant must be an immediate value
+#define AES_NI_EXPAND_128(i, rcon) \
+        k1 = aes_ni_expand_step(k1, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k1, rcon), 0xff)); \
+        _mm_storeu_si128(rk + i, k1)
+#define AES_NI_EXPAND_256(i, rcon) \
+        k1 = aes_ni_expand_step(k1, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k2, rcon), 0xff)); \
+        _mm_storeu_si128(rk + i, k1); \
+        if (i < 14) { \
+            k2 = aes_ni_expand_step(k2, _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k1, 0), 0xaa)); \
+            _mm_storeu_si128(rk + i + 1, k2); \
+        }
+    if (size == 16) {
+        AES_NI_EXPAND_128(1, 0x01);
+        AES_NI_EXPAND_128(2, 0x02);
+        AES_NI_EXPAND_128(3, 0x04);
+        AES_NI_EXPAND_128(4, 0x08);
+        AES_NI_EXPAND_128(5, 0x10);
+        AES_NI_EXPAND_128(6, 0x20);
+        AES_NI_EXPAND_128(7, 0x40);
+        AES_NI_EXPAND_128(8, 0x80);
+        AES_NI_EXPAND_128(9, 0x1b);
+        AES_NI_EXPAND_128(10, 0x36);
+    } else {
+        __m128i k2 = _mm_loadu_si128((const __m128i*)(data + 16));
+        _mm_storeu_si128(rk + 1, k2);
+        AES_NI_EXPAND_256(2, 0x01);
+        AES_NI_EXPAND_256(4, 0x02);
+        AES_NI_EXPAND_256(6, 0x04);
+        AES_NI_EXPAND_256(8, 0x08);
+        AES_NI_EXPAND_256(10, 0x10);
+        AES_NI_EXPAND_256(12, 0x20);
+        AES_NI_EXPAND_256(14, 0x40);
+    }
+#undef AES_NI_EXPAND_128
+#undef AES_NI_EXPAND_256
+}
+
+#endif // CRYPTO_AES_X86_64
+
+// Key schedule
+
+int crypto_aes_set_key(crypto_aes_key* key, const uint8_t* data, size_t size) {
+    if (!key || !data || (size != 16 && size != 24 && size != 32)) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const size_t nk = size / 4;
+    key->rounds = (unsigned)nk + 6;
+#if CRYPTO_AES_X86_64
+    // AES-192 keys are expanded in software; the round keys are used with AES-NI as is
+    if (use_hw_accel() && size != 24) {
+        set_key_ni(key, data, size);
+        return 0;
+    }
+#endif
+    uint8_t* w = key->round_keys;
+    memcpy(w, data, size);
+    const size_t words = 4 * (key->rounds + 1);
+    uint8_t rcon = 0x01;
+    for (size_t i = nk; i < words; ++i) {
+        uint8_t t[4];
+        memcpy(t, w + 4 * (i - 1), 4);
+        if (i % nk == 0) {
+            const uint8_t t0 = t[0];
+            t[0] = t[1];
+            t[1] = t[2];
+            t[2] = t[3];
+            t[3] = t0;
+            sub_bytes_ct(t, 4);
+            t[0] ^= rcon;
+            rcon = xtime(rcon);
+        } else if (nk > 6 && i % nk == 4) {
+            sub_bytes_ct(t, 4);
+        }
+        for (size_t j = 0; j < 4; ++j) {
+            w[4 * i + j] = w[4 * (i - nk) + j] ^ t[j];
+        }
+    }
+    return 0;
+}
+
+void crypto_aes_encrypt_block(const crypto_aes_key* key, const uint8_t in[CRYPTO_AES_BLOCK_SIZE],
+        uint8_t out[CRYPTO_AES_BLOCK_SIZE]) {
+#if CRYPTO_AES_X86_64
+    if (use_hw_accel()) {
+        // CTR over a single all-zero block with the input as the counter yields E(in)
+        uint8_t ctr[CRYPTO_AES_BLOCK_SIZE];
+        const uint8_t zero[CRYPTO_AES_BLOCK_SIZE] = {};
+        memcpy(ctr, in, sizeof(ctr));
+        ctr_blocks_ni(key, ctr, 0, zero, out, 1);
+        return;
+    }
+#endif
+    uint8_t ctr[CRYPTO_AES_BLOCK_SIZE];
+    const uint8_t zero[CRYPTO_AES_BLOCK_SIZE] = {};
+    memcpy(ctr, in, sizeof(ctr));
+    ctr_blocks_ct(key, ctr, 0, zero, out, 1);
+}
+
+// CTR
+
+static void ctr_process(const crypto_aes_key* key, uint8_t* counter, int inc32, uint8_t* stream,
+        size_t* streamPos, const uint8_t* in, uint8_t* out, size_t size) {
+    // Use the leftover keystream from a previous call first
+    while (size > 0 && *streamPos < CRYPTO_AES_BLOCK_SIZE) {
+        *out++ = *in++ ^ stream[(*streamPos)++];
+        --size;
+    }
+    const size_t blocks = size / CRYPTO_AES_BLOCK_SIZE;
+    if (blocks > 0) {
+        ctr_blocks_impl()(key, counter, inc32, in, out, blocks);
+        in += blocks * CRYPTO_AES_BLOCK_SIZE;
+        out += blocks * CRYPTO_AES_BLOCK_SIZE;
+        size -= blocks * CRYPTO_AES_BLOCK_SIZE;
+    }
+    if (size > 0) {
+        const uint8_t zero[CRYPTO_AES_BLOCK_SIZE] = {};
+        ctr_blocks_impl()(key, counter, inc32, zero, stream, 1);
+        for (*streamPos = 0; *streamPos < size; ++(*streamPos)) {
+            out[*streamPos] = in[*streamPos] ^ stream[*streamPos];
+        }
+    }
+}
+
+int crypto_aes_ctr_init(crypto_aes_ctr_ctx* ctx, const uint8_t* key, size_t key_size,
+        const uint8_t iv[CRYPTO_AES_BLOCK_SIZE]) {
+    if (!ctx || !iv) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const int r = crypto_aes_set_key(&ctx->key, key, key_size);
+    if (r < 0) {
+        return r;
+    }
+    memcpy(ctx->counter, iv, CRYPTO_AES_BLOCK_SIZE);
+    ctx->stream_pos = CRYPTO_AES_BLOCK_SIZE;
+    return 0;
+}
+
+void crypto_aes_ctr_update(crypto_aes_ctr_ctx* ctx, const uint8_t* in, uint8_t* out, size_t size) {
+    ctr_process(&ctx->key, ctx->counter, 0 /* inc32 */, ctx->stream, &ctx->stream_pos, in, out,
+            size);
+}
+
+// GCM
+
+static void gcm_ghash_update(crypto_aes_gcm_ctx* ctx, const uint8_t* data, size_t size) {
+    const ghash_blocks_func ghash = ghash_blocks_impl();
+    if (ctx->ghash_buf_len > 0) {
+        size_t n = CRYPTO_AES_BLOCK_SIZE - ctx->ghash_buf_len;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(ctx->ghash_buf + ctx->ghash_buf_len, data, n);
+        ctx->ghash_buf_len += n;
+        data += n;
+        size -= n;
+        if (ctx->ghash_buf_len < CRYPTO_AES_BLOCK_SIZE) {
+            return;
+        }
+        ghash(ctx->ghash, ctx->h, ctx->ghash_buf, 1);
+        ctx->ghash_buf_len = 0;
+    }
+    const size_t blocks = size / CRYPTO_AES_BLOCK_SIZE;
+    if (blocks > 0) {
+        ghash(ctx->ghash, ctx->h, data, blocks);
+        data += blocks * CRYPTO_AES_BLOCK_SIZE;
+        size -= blocks * CRYPTO_AES_BLOCK_SIZE;
+    }
+    if (size > 0) {
+        memcpy(ctx->ghash_buf, data, size);
+        ctx->ghash_buf_len = size;
+    }
+}
+
+static void gcm_ghash_pad(crypto_aes_gcm_ctx* ctx) {
+    if (ctx->ghash_buf_len > 0) {
+        memset(ctx->ghash_buf + ctx->ghash_buf_len, 0, CRYPTO_AES_BLOCK_SIZE - ctx->ghash_buf_len);
+        ghash_blocks_impl()(ctx->ghash, ctx->h, ctx->ghash_buf, 1);
+        ctx->ghash_buf_len = 0;
+    }
+}
+
+static void gcm_ghash_lengths(crypto_aes_gcm_ctx* ctx, uint64_t aadLen, uint64_t dataLen) {
+    uint8_t block[CRYPTO_AES_BLOCK_SIZE];
+    store_be64(block, aadLen * 8);
+    store_be64(block + 8, dataLen * 8);
+    ghash_blocks_impl()(ctx->ghash, ctx->h, block, 1);
+}
+
+static int gcm_begin_data(crypto_aes_gcm_ctx* ctx, size_t size) {
+    if (ctx->state == GCM_STATE_DONE) {
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+    if (ctx->state == GCM_STATE_AAD) {
+        gcm_ghash_pad(ctx);
+        ctx->state = GCM_STATE_DATA;
+    }
+    // NIST SP 800-38D limits the plaintext to 2^39 - 256 bits
+    if (size > ((1ull << 36) - 32) - ctx->data_len) {
+        return SYSTEM_ERROR_TOO_LARGE;
+    }
+    ctx->data_len += size;
+    return 0;
+}
+
+int crypto_aes_gcm_init(crypto_aes_gcm_ctx* ctx, const uint8_t* key, size_t key_size,
+        const uint8_t* iv, size_t iv_size) {
+    if (!ctx || !iv || iv_size == 0) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    memset(ctx, 0, sizeof(*ctx));
+    const int r = crypto_aes_set_key(&ctx->key, key, key_size);
+    if (r < 0) {
+        return r;
+    }
+    crypto_aes_encrypt_block(&ctx->key, ctx->h /* all zeros */, ctx->h);
+    if (iv_size == CRYPTO_AES_GCM_IV_SIZE) {
+        memcpy(ctx->j0, iv, iv_size);
+        ctx->j0[CRYPTO_AES_BLOCK_SIZE - 1] = 1;
+    } else {
+        gcm_ghash_update(ctx, iv, iv_size);
+        gcm_ghash_pad(ctx);
+        gcm_ghash_lengths(ctx, 0, iv_size);
+        memcpy(ctx->j0, ctx->ghash, CRYPTO_AES_BLOCK_SIZE);
+        memset(ctx->ghash, 0, CRYPTO_AES_BLOCK_SIZE);
+    }
+    memcpy(ctx->counter, ctx->j0, CRYPTO_AES_BLOCK_SIZE);
+    increment_counter(ctx->counter, 1 /* inc32 */);
+    ctx->stream_pos = CRYPTO_AES_BLOCK_SIZE;
+    ctx->state = GCM_STATE_AAD;
+    return 0;
+}
+
+int crypto_aes_gcm_update_aad(crypto_aes_gcm_ctx* ctx, const uint8_t* aad, size_t size) {
+    if (ctx->state != GCM_STATE_AAD) {
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+    ctx->aad_len += size;
+    gcm_ghash_update(ctx, aad, size);
+    return 0;
+}
+
+int crypto_aes_gcm_encrypt_update(crypto_aes_gcm_ctx* ctx, const uint8_t* in, uint8_t* out,
+        size_t size) {
+    const int r = gcm_begin_data(ctx, size);
+    if (r < 0) {
+        return r;
+    }
+    ctr_process(&ctx->key, ctx->counter, 1 /* inc32 */, ctx->stream, &ctx->stream_pos, in, out,
+            size);
+    gcm_ghash_update(ctx, out, size);
+    return 0;
+}
+
+int crypto_aes_gcm_decrypt_update(crypto_aes_gcm_ctx* ctx, const uint8_t* in, uint8_t* out,
+        size_t size) {
+    const int r = gcm_begin_data(ctx, size);
+    if (r < 0) {
+        return r;
+    }
+    // Hash the ciphertext before it gets overwritten in case of in-place decryption
+    gcm_ghash_update(ctx, in, size);
+    ctr_process(&ctx->key, ctx->counter, 1 /* inc32 */, ctx->stream, &ctx->stream_pos, in, out,
+            size);
+    return 0;
+}
+
+static int gcm_compute_tag(crypto_aes_gcm_ctx* ctx, uint8_t* tag) {
+    if (ctx->state == GCM_STATE_DONE) {
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+    gcm_ghash_pad(ctx);
+    gcm_ghash_lengths(ctx, ctx->aad_len, ctx->data_len);
+    crypto_aes_encrypt_block(&ctx->key, ctx->j0, tag);
+    xor_block(tag, tag, ctx->ghash);
+    ctx->state = GCM_STATE_DONE;
+    return 0;
+}
+
+int crypto_aes_gcm_finish(crypto_aes_gcm_ctx* ctx, uint8_t* tag, size_t tag_size) {
+    if (!tag || tag_size < 4 || tag_size > CRYPTO_AES_GCM_TAG_SIZE) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    uint8_t t[CRYPTO_AES_GCM_TAG_SIZE];
+    const int r = gcm_compute_tag(ctx, t);
+    if (r < 0) {
+        return r;
+    }
+    memcpy(tag, t, tag_size);
+    return 0;
+}
+
+int crypto_aes_gcm_verify(crypto_aes_gcm_ctx* ctx, const uint8_t* tag, size_t tag_size) {
+    if (!tag || tag_size < 4 || tag_size > CRYPTO_AES_GCM_TAG_SIZE) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    uint8_t t[CRYPTO_AES_GCM_TAG_SIZE];
+    const int r = gcm_compute_tag(ctx, t);
+    if (r < 0) {
+        return r;
+    }
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_size; ++i) {
+        diff |= t[i] ^ tag[i];
+    }
+    return diff ? SYSTEM_ERROR_BAD_DATA : 0;
+}
+
+int crypto_aes_hw_accel_enabled(void) {
+    return use_hw_accel();
+}
+
+void crypto_aes_set_hw_accel(int enabled) {
+    s_hwAccel = enabled ? hw_accel_supported() : 0;
 }
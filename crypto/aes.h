@@ -0,0 +1,199 @@
+/**
+ * @file aes.h
+ * @brief AES-128/192/256 block cipher with CTR and GCM streaming modes.
+ *
+ * All functions operate on caller-provided buffers and never allocate. Input and output buffers
+ * may be the same (in-place processing) but must not otherwise overlap.
+ *
+ * On x86-64 hosts the implementation uses AES-NI and PCLMULQDQ when the CPU supports them;
+ * everywhere else a portable, table-free constant-time implementation is used.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRYPTO_AES_BLOCK_SIZE 16
+#define CRYPTO_AES_MAX_ROUNDS 14
+#define CRYPTO_AES_GCM_IV_SIZE 12
+#define CRYPTO_AES_GCM_TAG_SIZE 16
+
+/**
+ * Expanded AES key.
+ */
+typedef struct crypto_aes_key {
+    uint8_t round_keys[(CRYPTO_AES_MAX_ROUNDS + 1) * CRYPTO_AES_BLOCK_SIZE];
+    unsigned rounds;
+} crypto_aes_key;
+
+/**
+ * AES-CTR streaming context.
+ */
+typedef struct crypto_aes_ctr_ctx {
+    crypto_aes_key key;
+    uint8_t counter[CRYPTO_AES_BLOCK_SIZE];
+    uint8_t stream[CRYPTO_AES_BLOCK_SIZE];
+    size_t stream_pos;
+} crypto_aes_ctr_ctx;
+
+/**
+ * AES-GCM streaming context.
+ */
+typedef struct crypto_aes_gcm_ctx {
+    crypto_aes_key key;
+    uint8_t h[CRYPTO_AES_BLOCK_SIZE];
+    uint8_t j0[CRYPTO_AES_BLOCK_SIZE];
+    uint8_t counter[CRYPTO_AES_BLOCK_SIZE];
+    uint8_t stream[CRYPTO_AES_BLOCK_SIZE];
+    uint8_t ghash[CRYPTO_AES_BLOCK_SIZE];
+    uint8_t ghash_buf[CRYPTO_AES_BLOCK_SIZE];
+    size_t stream_pos;
+    size_t ghash_buf_len;
+    uint64_t aad_len;
+    uint64_t data_len;
+    int state;
+} crypto_aes_gcm_ctx;
+
+/**
+ * Expand an AES key.
+ *
+ * @param key Key context.
+ * @param data Key data.
+ * @param size Key size in bytes (16, 24 or 32).
+ * @return 0 on success, or a negative result code in case of an error.
+ */
+int crypto_aes_set_key(crypto_aes_key* key, const uint8_t* data, size_t size);
+
+/**
+ * Encrypt a single block.
+ *
+ * @param key Key context.
+ * @param in Input block.
+ * @param out Output block.
+ */
+void crypto_aes_encrypt_block(const crypto_aes_key* key, const uint8_t in[CRYPTO_AES_BLOCK_SIZE],
+        uint8_t out[CRYPTO_AES_BLOCK_SIZE]);
+
+/**
+ * Initialize a CTR context.
+ *
+ * The counter block is treated as a 128-bit big-endian integer.
+ *
+ * @param ctx Context.
+ * @param key Key data.
+ * @param key_size Key size in bytes (16, 24 or 32).
+ * @param iv Initial counter block.
+ * @return 0 on success, or a negative result code in case of an error.
+ */
+int crypto_aes_ctr_init(crypto_aes_ctr_ctx* ctx, const uint8_t* key, size_t key_size,
+        const uint8_t iv[CRYPTO_AES_BLOCK_SIZE]);
+
+/**
+ * Encrypt or decrypt data in CTR mode.
+ *
+ * Can be called any number of times with arbitrary data sizes.
+ *
+ * @param ctx Context.
+ * @param in Input data.
+ * @param out Output buffer.
+ * @param size Data size.
+ */
+void crypto_aes_ctr_update(crypto_aes_ctr_ctx* ctx, const uint8_t* in, uint8_t* out, size_t size);
+
+/**
+ * Initialize a GCM context.
+ *
+ * @param ctx Context.
+ * @param key Key data.
+ * @param key_size Key size in bytes (16, 24 or 32).
+ * @param iv Initialization vector. 12 bytes is the recommended size.
+ * @param iv_size IV size.
+ * @return 0 on success, or a negative result code in case of an error.
+ */
+int crypto_aes_gcm_init(crypto_aes_gcm_ctx* ctx, const uint8_t* key, size_t key_size,
+        const uint8_t* iv, size_t iv_size);
+
+/**
+ * Process additional authenticated data.
+ *
+ * Must be called before any data is encrypted or decrypted.
+ *
+ * @param ctx Context.
+ * @param aad Data.
+ * @param size Data size.
+ * @return 0 on success, or a negative result code in case of an error.
+ */
+int crypto_aes_gcm_update_aad(crypto_aes_gcm_ctx* ctx, const uint8_t* aad, size_t size);
+
+/**
+ * Encrypt data in GCM mode.
+ *
+ * @param ctx Context.
+ * @param in Plaintext.
+ * @param out Output buffer for the ciphertext.
+ * @param size Data size.
+ * @return 0 on success, or a negative result code in case of an error.
+ */
+int crypto_aes_gcm_encrypt_update(crypto_aes_gcm_ctx* ctx, const uint8_t* in, uint8_t* out,
+        size_t size);
+
+/**
+ * Decrypt data in GCM mode.
+ *
+ * The decrypted data must not be used until the tag is verified with `crypto_aes_gcm_verify()`.
+ *
+ * @param ctx Context.
+ * @param in Ciphertext.
+ * @param out Output buffer for the plaintext.
+ * @param size Data size.
+ * @return 0 on success, or a negative result code in case of an error.
+ */
+int crypto_aes_gcm_decrypt_update(crypto_aes_gcm_ctx* ctx, const uint8_t* in, uint8_t* out,
+        size_t size);
+
+/**
+ * Finish the GCM operation and get the authentication tag.
+ *
+ * @param ctx Context.
+ * @param tag Output buffer for the tag.
+ * @param tag_size Tag size (4 to 16 bytes).
+ * @return 0 on success, or a negative result code in case of an error.
+ */
+int crypto_aes_gcm_finish(crypto_aes_gcm_ctx* ctx, uint8_t* tag, size_t tag_size);
+
+/**
+ * Finish the GCM operation and verify the authentication tag in constant time.
+ *
+ * @param ctx Context.
+ * @param tag Expected tag.
+ * @param tag_size Tag size (4 to 16 bytes).
+ * @return 0 if the tag matches, `SYSTEM_ERROR_BAD_DATA` if it doesn't, or another negative result
+ *         code in case of an error.
+ */
+int crypto_aes_gcm_verify(crypto_aes_gcm_ctx* ctx, const uint8_t* tag, size_t tag_size);
+
+/**
+ * Check whether hardware acceleration is available and enabled.
+ *
+ * @return `1` if the AES-NI/PCLMULQDQ path is in use, or `0` otherwise.
+ */
+int crypto_aes_hw_accel_enabled(void);
+
+/**
+ * Enable or disable hardware acceleration.
+ *
+ * Hardware acceleration is enabled by default if supported by the CPU. This function is mostly
+ * useful for testing and benchmarking the portable implementation.
+ *
+ * @param enabled `1` to enable, `0` to disable.
+ */
+void crypto_aes_set_hw_accel(int enabled);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
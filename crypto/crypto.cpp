@@ -6,24 +6,57 @@
  */
 
 #include "crypto.h"
-#include <iostream>
+#include "aes.h"
+#include "system_error.h"
+
+#include <random>
 #include <string>
 
+namespace {
+
+bool isValidKeySize(size_t size) {
+    return size == 16 || size == 24 || size == 32;
+}
 
-extern "C" {
-#include "aes.c"
+void setError(int* error, int value) {
+    if (error) {
+        *error = value;
+    }
 }
 
+} // namespace
+
 /**
  * @brief AES encryption function.
  *
  * @param plaintext The input text to encrypt.
  * @param key The encryption key.
+ * @param error Error code.
  * @return std::string The encrypted text.
  */
-std::string encrypt(const std::string& plaintext, const std::string& key) {
-    // Using optimized AES from aes.c
-    return ::encrypt(plaintext, key);
+std::string encrypt(const std::string& plaintext, const std::string& key, int* error) {
+    if (!isValidKeySize(key.size())) {
+        setError(error, SYSTEM_ERROR_INVALID_ARGUMENT);
+        return std::string();
+    }
+    std::string out(CRYPTO_AES_GCM_IV_SIZE + plaintext.size() + CRYPTO_AES_GCM_TAG_SIZE, '\0');
+    auto d = reinterpret_cast<uint8_t*>(&out[0]);
+    std::random_device rd;
+    for (size_t i = 0; i < CRYPTO_AES_GCM_IV_SIZE; ++i) {
+        d[i] = (uint8_t)rd();
+    }
+    const auto in = reinterpret_cast<const uint8_t*>(plaintext.data());
+    const size_t size = plaintext.size();
+    crypto_aes_gcm_ctx ctx;
+    int r = crypto_aes_gcm_init(&ctx, (const uint8_t*)key.data(), key.size(), d, CRYPTO_AES_GCM_IV_SIZE);
+    if (r < 0) {
+        setError(error, r);
+        return std::string();
+    }
+    crypto_aes_gcm_encrypt_update(&ctx, in, d + CRYPTO_AES_GCM_IV_SIZE, size);
+    crypto_aes_gcm_finish(&ctx, d + CRYPTO_AES_GCM_IV_SIZE + size, CRYPTO_AES_GCM_TAG_SIZE);
+    setError(error, 0);
+    return out;
 }
 
 /**
@@ -31,11 +64,33 @@ std::string encrypt(const std::string& plaintext, const std::string& key) {
  *
  * @param ciphertext The input text to decrypt.
  * @param key The decryption key.
+ * @param error Error code.
  * @return std::string The decrypted text.
  */
-std::string decrypt(const std::string& ciphertext, const std::string& key) {
-    // Using optimized AES from aes.c
-    return ::decrypt(ciphertext, key);
+std::string decrypt(const std::string& ciphertext, const std::string& key, int* error) {
+    if (!isValidKeySize(key.size())) {
+        setError(error, SYSTEM_ERROR_INVALID_ARGUMENT);
+        return std::string();
+    }
+    if (ciphertext.size() < CRYPTO_AES_GCM_IV_SIZE + CRYPTO_AES_GCM_TAG_SIZE) {
+        setError(error, SYSTEM_ERROR_BAD_DATA);
+        return std::string();
+    }
+    const size_t size = ciphertext.size() - CRYPTO_AES_GCM_IV_SIZE - CRYPTO_AES_GCM_TAG_SIZE;
+    const auto d = reinterpret_cast<const uint8_t*>(ciphertext.data());
+    std::string out(size, '\0');
+    crypto_aes_gcm_ctx ctx;
+    int r = crypto_aes_gcm_init(&ctx, (const uint8_t*)key.data(), key.size(), d, CRYPTO_AES_GCM_IV_SIZE);
+    if (r < 0) {
+        setError(error, r);
+        return std::string();
+    }
+    crypto_aes_gcm_decrypt_update(&ctx, d + CRYPTO_AES_GCM_IV_SIZE, (uint8_t*)&out[0], size);
+    r = crypto_aes_gcm_verify(&ctx, d + CRYPTO_AES_GCM_IV_SIZE + size, CRYPTO_AES_GCM_TAG_SIZE);
+    if (r < 0) {
+        setError(error, r);
+        return std::string();
+    }
+    setError(error, 0);
+    return out;
 }
-
-
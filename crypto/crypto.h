@@ -12,21 +12,27 @@
 /**
  * @brief Encrypts the given plaintext using the specified key.
  *
- * This function logs the plaintext, key, and encrypted result for debugging purposes.
+ * The data is encrypted with AES-GCM using a random nonce. The result contains the nonce, the
+ * ciphertext and the authentication tag. The key must be 16, 24 or 32 bytes long, which selects
+ * AES-128, AES-192 or AES-256 respectively. Use the API in `aes.h` to encrypt data in place or
+ * in chunks.
  *
  * @param plaintext The input text to encrypt.
  * @param key The encryption key.
- * @return std::string The encrypted text.
+ * @param error If not `nullptr`, set to 0 on success, or to a negative result code in case of an
+ *        error. `SYSTEM_ERROR_INVALID_ARGUMENT` is reported for a key of an unsupported size.
+ * @return std::string The encrypted text, or an empty string in case of an error.
  */
-std::string encrypt(const std::string& plaintext, const std::string& key);
+std::string encrypt(const std::string& plaintext, const std::string& key, int* error = nullptr);
 
 /**
  * @brief Decrypts the given ciphertext using the specified key.
  *
- * This function logs the ciphertext, key, and decrypted result for debugging purposes.
- *
- * @param ciphertext The input text to decrypt.
- * @param key The decryption key.
- * @return std::string The decrypted text.
+ * @param ciphertext Data produced by `encrypt()`.
+ * @param key The decryption key. The same key sizes as for `encrypt()` are supported.
+ * @param error If not `nullptr`, set to 0 on success, or to a negative result code in case of an
+ *        error. `SYSTEM_ERROR_INVALID_ARGUMENT` is reported for a key of an unsupported size and
+ *        `SYSTEM_ERROR_BAD_DATA` if the data could not be authenticated.
+ * @return std::string The decrypted text, or an empty string in case of an error.
  */
-std::string decrypt(const std::string& ciphertext, const std::string& key);
+std::string decrypt(const std::string& ciphertext, const std::string& key, int* error = nullptr);
@@ -211,6 +211,37 @@ typedef struct compressed_module_header {
     uint32_t original_size;
 } __attribute__((__packed__)) compressed_module_header;
 
+/**
+ * Magic number of the restart point index of a compressed module ("INDX").
+ */
+#define COMPRESSED_MODULE_INDEX_MAGIC 0x58444e49
+
+/**
+ * Restart point index of a compressed module.
+ *
+ * The index is optional. If present, it immediately follows the compressed module header and is
+ * included in the header size. The compressed data is then a sequence of segments that each
+ * decompress to `segment_size` bytes, except for the last one, and end with a full flush, so that
+ * decompression can be started at the beginning of any segment. The index is followed by an array
+ * of `segment_count` 32-bit offsets of the segments relative to the beginning of the compressed data.
+ *
+ * The compressed data remains a valid raw Deflate stream and can be decompressed without the index.
+ */
+typedef struct compressed_module_index {
+    /**
+     * Magic number (`COMPRESSED_MODULE_INDEX_MAGIC`).
+     */
+    uint32_t magic;
+    /**
+     * Size of a decompressed segment.
+     */
+    uint32_t segment_size;
+    /**
+     * Number of segments.
+     */
+    uint32_t segment_count;
+} __attribute__((__packed__)) compressed_module_index;
+
 typedef enum module_info_extension_type_t {
     MODULE_INFO_EXTENSION_END = 0x0000, // May be padded with size reflecting the padding amount
     MODULE_INFO_EXTENSION_PRODUCT_DATA = 0x0001,
@@ -304,6 +304,10 @@
 #define HAL_PLATFORM_COMPRESSED_OTA (0)
 #endif // HAL_PLATFORM_COMPRESSED_OTA
 
+#ifndef HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+#define HAL_PLATFORM_MODULE_INTEGRITY_CACHE (0)
+#endif // HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+
 #ifndef HAL_PLATFORM_NETWORK_MULTICAST
 #define HAL_PLATFORM_NETWORK_MULTICAST (0)
 #endif // HAL_PLATFORM_NETWORK_MULTICAST
@@ -423,6 +427,11 @@
 #define HAL_PLATFORM_NEWLIB (0)
 #endif // HAL_PLATFORM_NEWLIB
 
+// Size of the static pool for CoAP messages kept for retransmission, 0 to use the heap only
+#ifndef HAL_PLATFORM_COAP_MESSAGE_POOL_SIZE
+#define HAL_PLATFORM_COAP_MESSAGE_POOL_SIZE (0)
+#endif // HAL_PLATFORM_COAP_MESSAGE_POOL_SIZE
+
 #ifndef HAL_PLATFORM_SPI_NUM
 #define HAL_PLATFORM_SPI_NUM (0)
 #endif // HAL_PLATFORM_SPI_NUM
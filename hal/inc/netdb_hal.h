@@ -96,6 +96,34 @@ int netdb_getaddrinfo(const char* hostname, const char* servname,
 int netdb_getaddrinfo_ex(const char* hostname, const char* servname,
                       const struct addrinfo* hints, struct addrinfo** res, if_t iface);
 
+/**
+ * Completion callback of netdb_resolve_async().
+ *
+ * @param[in]  error    0 on success or a negative system error code. SYSTEM_ERROR_NOT_FOUND if the
+ *                      name doesn't resolve, or SYSTEM_ERROR_TIMEOUT if the DNS server didn't answer
+ * @param[in]  addrs    resolved addresses, IPv6 addresses first (the port is set to 0)
+ * @param[in]  count    number of addresses
+ * @param[in]  arg      user argument
+ */
+typedef void (*netdb_resolve_callback)(int error, const struct sockaddr_storage* addrs, size_t count, void* arg);
+
+/**
+ * Starts resolving a host name without blocking the calling thread.
+ *
+ * For AF_UNSPEC, the A and AAAA queries are sent at the same time and the callback is invoked
+ * once both of them complete. The callback is invoked either synchronously, if the addresses
+ * are already known, or from the networking thread, in which case it should not block.
+ *
+ * @param[in]  hostname host name
+ * @param[in]  family   AF_INET, AF_INET6 or AF_UNSPEC
+ * @param[in]  callback completion callback
+ * @param[in]  arg      user argument passed to the callback
+ * @param[in]  reserved reserved argument (should be set to NULL)
+ *
+ * @return     0 if the callback will be invoked, or a negative system error code otherwise
+ */
+int netdb_resolve_async(const char* hostname, int family, netdb_resolve_callback callback, void* arg, void* reserved);
+
 /**
  * Converts a sockaddr structure to a pair of host name and service strings.
  *
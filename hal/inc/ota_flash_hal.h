@@ -170,6 +170,17 @@ typedef enum {
  */
 int HAL_FLASH_End(void* reserved);
 
+/**
+ * Get the revision of the module storage.
+ *
+ * The revision changes every time HAL_FLASH_Begin(), HAL_FLASH_Update() or HAL_FLASH_End() is
+ * called. The modules reported by HAL_System_Info() can only change when the revision changes.
+ *
+ * @param reserved Reserved argument. Must be set to `NULL`.
+ * @return Revision number.
+ */
+uint32_t HAL_FLASH_Revision(void* reserved);
+
 /**
  * @param module Optional pointer to a module that receives the module definition of the firmware that was flashed.
  * @param dryRun when true, only test that the system has a pending update in memory. When false, the test is performed and the module
@@ -40,6 +40,11 @@ extern "C" {
 
 #define SOCKET_WAIT_FOREVER (0xffffffff)
 
+/**
+ * Flag for socket_send_ex(): send only as much of the data as the socket accepts without blocking.
+ */
+#define SOCKET_SEND_NO_WAIT (0x01)
+
 typedef struct _sockaddr_t
 {
     union {
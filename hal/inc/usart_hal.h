@@ -163,6 +163,13 @@ void hal_usart_send_break(hal_usart_interface_t serial, void* reserved);
 uint8_t hal_usart_break_detected(hal_usart_interface_t serial);
 int hal_usart_sleep(hal_usart_interface_t serial, bool sleep, void* reserved);
 
+/**
+ * Bulk counterparts of `hal_usart_write()`, `hal_usart_read()` and `hal_usart_peek()`. These functions
+ * never block and transfer as many elements as the ring buffers allow.
+ *
+ * @return Number of elements transferred, `SYSTEM_ERROR_NO_MEMORY` if the buffer is full (write) or
+ *         empty (read/peek), or another negative result code in case of an error.
+ */
 ssize_t hal_usart_write_buffer(hal_usart_interface_t serial, const void* buffer, size_t size, size_t elementSize);
 ssize_t hal_usart_read_buffer(hal_usart_interface_t serial, void* buffer, size_t size, size_t elementSize);
 ssize_t hal_usart_peek_buffer(hal_usart_interface_t serial, void* buffer, size_t size, size_t elementSize);
@@ -29,6 +29,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 /* Exported types ------------------------------------------------------------*/
 
@@ -211,6 +212,19 @@ SECURITY_MODE_PROTECTED_FN(int32_t, HAL_USB_USART_Available_Data_For_Write, (HAL
 SECURITY_MODE_PROTECTED_FN(int32_t, HAL_USB_USART_Receive_Data, (HAL_USB_USART_Serial serial, uint8_t peek));
 SECURITY_MODE_PROTECTED_FN(int32_t, HAL_USB_USART_Send_Data, (HAL_USB_USART_Serial serial, uint8_t data));
 SECURITY_MODE_PROTECTED_FN(void, HAL_USB_USART_Flush_Data, (HAL_USB_USART_Serial serial));
+/**
+ * Reads up to `size` bytes from the receive buffer.
+ *
+ * @return Number of bytes read (0 if no data is available) or a negative result code in case of an error.
+ */
+SECURITY_MODE_PROTECTED_FN(int32_t, HAL_USB_USART_Receive_Data_Buffer, (HAL_USB_USART_Serial serial, uint8_t* data, size_t size));
+/**
+ * Queues `size` bytes for transmission. Blocks while the transmit buffer is full, same as
+ * `HAL_USB_USART_Send_Data()`.
+ *
+ * @return Number of bytes queued or a negative result code in case of an error.
+ */
+SECURITY_MODE_PROTECTED_FN(int32_t, HAL_USB_USART_Send_Data_Buffer, (HAL_USB_USART_Serial serial, const uint8_t* data, size_t size));
 bool HAL_USB_USART_Is_Enabled(HAL_USB_USART_Serial serial);
 bool HAL_USB_USART_Is_Connected(HAL_USB_USART_Serial serial);
 int32_t HAL_USB_USART_LineCoding_BitRate_Handler(void (*handler)(uint32_t bitRate), void* reserved);
@@ -24,9 +24,16 @@
 /* netdb_hal_impl.h should get included from netdb_hal.h automagically */
 #include "netdb_hal.h"
 #include <lwip/sockets.h>
+#include <lwip/dns.h>
 #include <errno.h>
 #include <algorithm>
+#include <memory>
+#include <new>
 #include "resolvapi.h"
+#include "lwiplock.h"
+#include "ipsockaddr.h"
+#include "timer_hal.h"
+#include "system_error.h"
 
 struct hostent* netdb_gethostbyname(const char *name) {
     return lwip_gethostbyname(name);
@@ -46,8 +53,79 @@ int netdb_getaddrinfo(const char* hostname, const char* servname,
     return netdb_getaddrinfo_ex(hostname, servname, hints, res, nullptr);
 }
 
+namespace {
+
+using namespace particle::net;
+
+struct ResolveRequest {
+    netdb_resolve_callback callback;
+    void* arg;
+    sockaddr_storage addrs[2]; // IPv6 and IPv4 address
+    bool found[2];
+    unsigned pending; // Number of pending queries plus one reference held by netdb_resolve_async()
+    int error;
+    system_tick_t startTime;
+};
+
+// LwIP reports a query that timed out the same way as a name that doesn't exist. A query times out
+// only after all its retransmissions, so a failure that is reported sooner is an answer from the server
+bool isDnsTimeout(system_tick_t startTime) {
+    return HAL_Timer_Get_Milli_Seconds() - startTime >= (DNS_MAX_RETRIES - 1) * DNS_TMR_INTERVAL;
+}
+
+// Requests are only accessed with the core lock held or after all the queries have completed
+void completeResolveRequest(ResolveRequest* req) {
+    std::unique_ptr<ResolveRequest> r(req);
+    sockaddr_storage addrs[2] = {};
+    size_t count = 0;
+    for (size_t i = 0; i < 2; ++i) {
+        if (r->found[i]) {
+            addrs[count++] = r->addrs[i];
+        }
+    }
+    int error = 0;
+    if (!count) {
+        if (r->error) {
+            error = r->error;
+        } else if (isDnsTimeout(r->startTime)) {
+            error = SYSTEM_ERROR_TIMEOUT;
+        } else {
+            error = SYSTEM_ERROR_NOT_FOUND;
+        }
+    }
+    r->callback(error, addrs, count, r->arg);
+}
+
+void addResolvedAddress(ResolveRequest* req, const ip_addr_t* addr) {
+    if (!addr) {
+        return;
+    }
+    const size_t i = IP_IS_V6(addr) ? 0 : 1;
+    ipaddr_port_to_sockaddr(addr, 0, (sockaddr*)&req->addrs[i]);
+    req->found[i] = true;
+}
+
+void dnsFoundCallback(const char* name, const ip_addr_t* addr, void* arg) {
+    // Invoked by the networking thread with the core lock held
+    const auto req = static_cast<ResolveRequest*>(arg);
+    addResolvedAddress(req, addr);
+    if (--req->pending == 0) {
+        completeResolveRequest(req);
+    }
+}
+
+int getaddrinfoResult(int r, system_tick_t startTime) {
+    if (r == EAI_FAIL && isDnsTimeout(startTime)) {
+        return EAI_AGAIN;
+    }
+    return r;
+}
+
+} // anonymous
+
 int netdb_getaddrinfo_ex(const char* hostname, const char* servname,
                          const struct addrinfo* hints, struct addrinfo** res, if_t iface) {
+    const auto startTime = HAL_Timer_Get_Milli_Seconds();
     uint8_t ifaceIndex = 0;
     if (iface) {
         if_get_index(iface, &ifaceIndex);
@@ -72,10 +150,69 @@ int netdb_getaddrinfo_ex(const char* hostname, const char* servname,
                 return 0;
             }
 
-            return std::max(rinet, rinet6);
+            return getaddrinfoResult(std::max(rinet, rinet6), startTime);
         }
     }
-    return lwip_getaddrinfo_ex(hostname, servname, hints, res, ifaceIndex);
+    return getaddrinfoResult(lwip_getaddrinfo_ex(hostname, servname, hints, res, ifaceIndex), startTime);
+}
+
+int netdb_resolve_async(const char* hostname, int family, netdb_resolve_callback callback, void* arg, void* reserved) {
+    if (!hostname || !callback) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    uint8_t addrTypes[2] = {};
+    size_t addrTypeCount = 0;
+    switch (family) {
+    case AF_UNSPEC: {
+#if LWIP_IPV6
+        addrTypes[addrTypeCount++] = LWIP_DNS_ADDRTYPE_IPV6;
+#endif // LWIP_IPV6
+        addrTypes[addrTypeCount++] = LWIP_DNS_ADDRTYPE_IPV4;
+        break;
+    }
+    case AF_INET: {
+        addrTypes[addrTypeCount++] = LWIP_DNS_ADDRTYPE_IPV4;
+        break;
+    }
+#if LWIP_IPV6
+    case AF_INET6: {
+        addrTypes[addrTypeCount++] = LWIP_DNS_ADDRTYPE_IPV6;
+        break;
+    }
+#endif // LWIP_IPV6
+    default:
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+    std::unique_ptr<ResolveRequest> req(new(std::nothrow) ResolveRequest());
+    if (!req) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    req->callback = callback;
+    req->arg = arg;
+    req->pending = addrTypeCount + 1;
+    req->startTime = HAL_Timer_Get_Milli_Seconds();
+    LwipTcpIpCoreLock lock; // LwIP's DNS client API is not thread-safe
+    // Send all the queries before waiting for any of them
+    for (size_t i = 0; i < addrTypeCount; ++i) {
+        ip_addr_t addr = {};
+        const auto r = dns_gethostbyname_addrtype(hostname, &addr, dnsFoundCallback, req.get(), addrTypes[i]);
+        if (r == ERR_INPROGRESS) {
+            continue;
+        }
+        if (r == ERR_OK) {
+            addResolvedAddress(req.get(), &addr); // Cached by lwIP
+        } else {
+            req->error = SYSTEM_ERROR_NETWORK;
+        }
+        --req->pending;
+    }
+    const bool done = (--req->pending == 0);
+    const auto r = req.release(); // Deleted by the last query to complete
+    lock.unlock();
+    if (done) {
+        completeResolveRequest(r);
+    }
+    return 0;
 }
 
 int netdb_getnameinfo(const struct sockaddr* sa, socklen_t salen, char* host,
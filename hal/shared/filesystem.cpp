@@ -30,11 +30,28 @@ using namespace particle::fs;
 #if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
 
 #include "static_recursive_mutex.h"
+#include "spark_wiring_diagnostics.h"
+#include "timer_hal.h"
 
 namespace {
 
 static StaticRecursiveMutex s_lfs_mutex;
 
+particle::HistogramDiagnosticData s_progTime(DIAG_ID_SYSTEM_FS_PROG_TIME, DIAG_NAME_SYSTEM_FS_PROG_TIME);
+particle::HistogramDiagnosticData s_eraseTime(DIAG_ID_SYSTEM_FS_ERASE_TIME, DIAG_NAME_SYSTEM_FS_ERASE_TIME);
+
+inline system_tick_t fs_op_start() {
+    return HAL_Timer_Get_Micro_Seconds();
+}
+
+inline void fs_prog_done(system_tick_t start) {
+    s_progTime.record(HAL_Timer_Get_Micro_Seconds() - start);
+}
+
+inline void fs_erase_done(system_tick_t start) {
+    s_eraseTime.record(HAL_Timer_Get_Micro_Seconds() - start);
+}
+
 } /* anonymous */
 
 int filesystem_lock(filesystem_t* fs) {
@@ -59,6 +76,21 @@ __attribute__((weak)) int filesystem_unlock(filesystem_t* fs) {
     return 0;
 }
 
+namespace {
+
+// Flash operation timing is not collected in the bootloader
+inline uint32_t fs_op_start() {
+    return 0;
+}
+
+inline void fs_prog_done(uint32_t) {
+}
+
+inline void fs_erase_done(uint32_t) {
+}
+
+} /* anonymous */
+
 #endif /* MODULE_FUNCTION != MOD_FUNC_BOOTLOADER */
 
 
@@ -83,7 +115,9 @@ int fs_prog(const struct lfs_config* c, lfs_block_t block,
     if (!((filesystem_t*)c->context)->state) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
+    const auto start = fs_op_start();
     int r = hal_exflash_write((block + ((filesystem_t*)c->context)->first_block) * c->block_size + off, (const uint8_t*)buffer, size);
+    fs_prog_done(start);
     if (r) {
         LOG_DEBUG(ERROR, "fs_prog error %d", r);
     }
@@ -95,7 +129,9 @@ int fs_erase(const struct lfs_config* c, lfs_block_t block)
     if (!((filesystem_t*)c->context)->state) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
+    const auto start = fs_op_start();
     int r = hal_exflash_erase_sector((block + ((filesystem_t*)c->context)->first_block) * c->block_size, 1);
+    fs_erase_done(start);
     if (r) {
         LOG_DEBUG(ERROR, "fs_erase error %d", r);
     }
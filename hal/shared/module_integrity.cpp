@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hal_platform.h"
+
+#include "module_integrity.h"
+
+#include "flash_hal.h"
+#include "exflash_hal.h"
+#include "crc32.h"
+#include "endian_util.h"
+#include "check.h"
+
+#if HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+#include "system_cache.h"
+#include "static_recursive_mutex.h"
+#endif // HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+using namespace particle;
+
+namespace {
+
+// Size of the blocks in which the module data is read. The external flash is read via DMA, so
+// fewer and larger transfers take considerably less time than many small ones
+const size_t READ_BLOCK_SIZE = 4096;
+// Block size used if the above buffer can't be allocated
+const size_t FALLBACK_READ_BLOCK_SIZE = 256;
+
+int readFlash(const module_bounds_t* bounds, uintptr_t addr, uint8_t* data, size_t size) {
+    switch (bounds->location) {
+    case MODULE_BOUNDS_LOC_INTERNAL_FLASH:
+        return hal_flash_read(addr, data, size);
+    case MODULE_BOUNDS_LOC_EXTERNAL_FLASH:
+        return hal_exflash_read(addr, data, size);
+    default:
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+}
+
+int readStoredCrc32(const module_bounds_t* bounds, const module_info_t* info, uint32_t* crc) {
+    uint32_t val = 0;
+    CHECK(readFlash(bounds, bounds->start_address + module_length(info), (uint8_t*)&val, sizeof(val)));
+    *crc = bigEndianToNative(val);
+    return 0;
+}
+
+int computeModuleCrc32(const module_bounds_t* bounds, const module_info_t* info, uint32_t* crc) {
+    std::unique_ptr<uint8_t[]> heapBuf(new(std::nothrow) uint8_t[READ_BLOCK_SIZE]);
+    uint8_t stackBuf[FALLBACK_READ_BLOCK_SIZE] __attribute__((aligned(4)));
+    uint8_t* buf = heapBuf ? heapBuf.get() : stackBuf;
+    const size_t bufSize = heapBuf ? READ_BLOCK_SIZE : sizeof(stackBuf);
+    uintptr_t addr = bounds->start_address;
+    const uintptr_t endAddr = addr + module_length(info);
+    uint32_t val = 0;
+    while (addr < endAddr) {
+        const size_t n = std::min<size_t>(endAddr - addr, bufSize);
+        CHECK(readFlash(bounds, addr, buf, n));
+        val = computeCrc32(buf, n, val);
+        addr += n;
+    }
+    *crc = val;
+    return 0;
+}
+
+#if HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+
+// A module that passed the integrity check
+struct VerifiedModule {
+    uint32_t address; // Start address of the module
+    uint32_t infoCrc; // CRC-32 of the module info
+    uint32_t crc; // CRC-32 stored after the module data
+};
+
+// One entry per module slot in internal flash is enough
+const size_t MAX_VERIFIED_MODULES = 8;
+
+class VerifiedModuleCache {
+public:
+    VerifiedModuleCache() :
+            modules_(),
+            gen_(0),
+            loaded_(false),
+            persist_(true) {
+    }
+
+    bool contains(const VerifiedModule& module, unsigned* gen) {
+        std::lock_guard<StaticRecursiveMutex> lock(mutex_);
+        load();
+        *gen = gen_;
+        for (const auto& m: modules_) {
+            if (!memcmp(&m, &module, sizeof(module))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void add(const VerifiedModule& module, unsigned gen) {
+        std::lock_guard<StaticRecursiveMutex> lock(mutex_);
+        if (gen != gen_) {
+            return; // The flash has been modified while the module was being verified
+        }
+        load();
+        // Replace the entry for the same address, or the oldest entry if there's none
+        size_t i = 0;
+        while (i < MAX_VERIFIED_MODULES - 1 && modules_[i].address != module.address) {
+            ++i;
+        }
+        memmove(&modules_[1], &modules_[0], sizeof(VerifiedModule) * i);
+        modules_[0] = module;
+        if (persist_) {
+            services::SystemCache::instance().set(services::SystemCacheKey::MODULE_INTEGRITY, modules_, sizeof(modules_));
+        }
+    }
+
+    void invalidate() {
+        std::lock_guard<StaticRecursiveMutex> lock(mutex_);
+        ++gen_;
+        memset(modules_, 0, sizeof(modules_));
+        loaded_ = true;
+        if (persist_) {
+            // The bootloader may rewrite the internal flash on the next reset when it applies
+            // an update, so the results are kept only in RAM until then
+            services::SystemCache::instance().del(services::SystemCacheKey::MODULE_INTEGRITY);
+            persist_ = false;
+        }
+    }
+
+private:
+    VerifiedModule modules_[MAX_VERIFIED_MODULES];
+    StaticRecursiveMutex mutex_;
+    unsigned gen_; // Incremented every time the flash is modified
+    bool loaded_;
+    bool persist_;
+
+    void load() {
+        if (loaded_) {
+            return;
+        }
+        const int r = services::SystemCache::instance().get(services::SystemCacheKey::MODULE_INTEGRITY, modules_, sizeof(modules_));
+        if (r != (int)sizeof(modules_)) {
+            memset(modules_, 0, sizeof(modules_));
+        }
+        loaded_ = true;
+    }
+};
+
+VerifiedModuleCache g_verifiedModules;
+
+#endif // HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+
+} // anonymous
+
+bool verify_module_crc32(const module_bounds_t* bounds, const module_info_t* info) {
+    if (!module_length(info)) {
+        return false;
+    }
+    uint32_t expectedCrc = 0;
+    if (readStoredCrc32(bounds, info, &expectedCrc) < 0) {
+        return false;
+    }
+#if HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+    // Modules in external flash are usually pending updates that will be verified only once
+    const bool useCache = (bounds->location == MODULE_BOUNDS_LOC_INTERNAL_FLASH);
+    VerifiedModule module = {};
+    unsigned gen = 0;
+    if (useCache) {
+        module.address = bounds->start_address;
+        module.infoCrc = computeCrc32(info, sizeof(module_info_t));
+        module.crc = expectedCrc;
+        if (g_verifiedModules.contains(module, &gen)) {
+            return true;
+        }
+    }
+#endif // HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+    uint32_t crc = 0;
+    if (computeModuleCrc32(bounds, info, &crc) < 0 || crc != expectedCrc) {
+        return false;
+    }
+#if HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+    if (useCache) {
+        g_verifiedModules.add(module, gen);
+    }
+#endif // HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+    return true;
+}
+
+void invalidate_module_crc32_cache() {
+#if HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+    g_verifiedModules.invalidate();
+#endif // HAL_PLATFORM_MODULE_INTEGRITY_CACHE
+}
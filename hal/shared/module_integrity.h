@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ota_flash_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Verify the CRC-32 of a module stored in internal or external flash.
+ *
+ * The module data is read in large blocks. If `HAL_PLATFORM_MODULE_INTEGRITY_CACHE` is enabled,
+ * modules in internal flash that passed the check are remembered across reboots and are not
+ * read again as long as their address, module info and stored CRC stay the same, and the flash
+ * has not been modified since (see `invalidate_module_crc32_cache()`).
+ *
+ * @param bounds Module bounds.
+ * @param info Module info.
+ * @return `true` if the computed CRC matches the one stored after the module data.
+ */
+bool verify_module_crc32(const module_bounds_t* bounds, const module_info_t* info);
+
+/**
+ * Forget the modules that passed the integrity check.
+ *
+ * This function needs to be called every time the flash is modified. The results of the checks
+ * performed after that are kept only in RAM until the next reset.
+ */
+void invalidate_module_crc32_cache();
+
+#ifdef __cplusplus
+}
+#endif
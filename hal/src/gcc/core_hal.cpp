@@ -42,6 +42,7 @@
 #include "../../../system/inc/system_mode.h" // FIXME
 
 #include "eeprom_file.h"
+#include "profiler.h"
 #include "eeprom_hal.h"
 #include "rtc_hal.h"
 
@@ -178,6 +179,7 @@ extern "C" int main(int argc, char* argv[])
     try {
         log_set_callbacks(log_message_callback, log_write_callback, log_enabled_callback, nullptr);
         if (read_device_config(argc, argv)) {
+                Profiler::instance()->start(deviceConfig.profiler);
                 if (!HAL_Core_Validate_Modules(0 /* flags */, nullptr /* reserved */)) {
                     set_system_mode(SAFE_MODE);
                 }
@@ -288,6 +290,8 @@ void HAL_Core_System_Reset(void)
             argv.push_back(arg.data());
         }
         argv.push_back(nullptr);
+        // Flush the profiling data before the process image is replaced
+        Profiler::instance()->stop();
         LOG(INFO, "Resetting device");
         LOG_PRINT(INFO, "\r\n\r\n\r\n");
         execvp(argv[0], argv.data());
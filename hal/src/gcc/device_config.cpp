@@ -111,6 +111,9 @@ public:
             ("describe", po::value<std::string>(&config.describe), "the filename containing the device description")
             ("protocol,p", po::value<ProtocolFactory>(&config.protocol)->default_value(PROTOCOL_NONE), "the cloud communication protocol to use")
             ("flash_file", po::value<std::string>(&config.flash_file), "the filename to use to store the contents of the external flash")
+            ("profile", po::value<std::string>(&config.profile_file), "the filename to write sampled call stacks to, in the folded stacks format")
+            ("profile_rate", po::value<unsigned>(&config.profile_rate)->default_value(particle::Profiler::DEFAULT_SAMPLE_RATE), "the sampling rate of the profiler in Hz")
+            ("trace", po::value<std::string>(&config.trace_file), "the filename to write trace events to, in the Chrome trace event format")
             ;
 
         command_line_options.add(program_options).add(device_options);
@@ -376,5 +379,9 @@ void DeviceConfig::read(Configuration& config)
         this->flash_file = fs::absolute(config.flash_file);
     }
 
+    this->profiler.profileFile = config.profile_file;
+    this->profiler.traceFile = config.trace_file;
+    this->profiler.sampleRate = config.profile_rate;
+
     setLoggerLevel((LoggerOutputLevel)(NO_LOG_LEVEL - config.log_level));
 }
@@ -27,6 +27,7 @@
 
 #include "spark_protocol_functions.h"
 #include "module_info.h"
+#include "profiler.h"
 
 namespace particle {
 
@@ -256,6 +257,9 @@ struct Configuration
     std::string server_key;
     std::string describe;
     std::string flash_file;
+    std::string profile_file;
+    std::string trace_file;
+    unsigned profile_rate;
     uint16_t log_level;
     ProtocolFactory protocol;
     uint16_t platform_id;
@@ -276,6 +280,7 @@ struct DeviceConfig
     ProtocolFactory protocol;
     uint16_t platform_id;
     uint16_t product_version;
+    particle::Profiler::Config profiler;
 
     void read(Configuration& configuration);
 
@@ -27,6 +27,10 @@
 #define HAL_PLATFORM_CLOUD_UDP 1
 #define HAL_PLATFORM_CLOUD_TCP 1
 
+#ifndef HAL_PLATFORM_COAP_MESSAGE_POOL_SIZE
+#define HAL_PLATFORM_COAP_MESSAGE_POOL_SIZE (2560)
+#endif
+
 #ifndef HAL_PLATFORM_WIFI
 #define HAL_PLATFORM_WIFI 0
 #endif
@@ -11,6 +11,9 @@ INCLUDE_DIRS += $(HAL_SRC_GCC_PATH)/littlefs
 INCLUDE_DIRS += $(HAL_INCL_NETWORK_UTIL_PATH)
 INCLUDE_DIRS += $(HAL_INCL_NETWORK_PATH)
 
+# Trace markers are recorded by the profiler of the virtual device (see profiler.h)
+CFLAGS += -DPARTICLE_TRACE_MARKERS=1
+
 ifneq (,$(findstring hal,$(MAKE_DEPENDENCIES)))
 
 LDFLAGS += -lc
@@ -24,6 +27,12 @@ LIBS += boost_system
 endif
 LIBS += boost_program_options boost_random boost_thread boost_json
 
+ifndef SYSTEMROOT
+# Export the symbols of the executable so that the profiler can symbolize call stacks
+LDFLAGS += -rdynamic
+LIBS += dl
+endif
+
 LIB_DIRS += $(BOOST_ROOT)/stage/lib
 
 # gcc HAL is different for test driver and test subject
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <algorithm>
 #include <memory>
+#include <atomic>
 #include <cstring>
 
 #include <boost/endian.hpp>
@@ -146,6 +147,9 @@ std::ofstream g_updateStream;
 std::string g_updateFile;
 size_t g_updateSize = 0;
 
+// Incremented every time the module storage is modified
+std::atomic<uint32_t> g_flashRevision(0);
+
 } // namespace
 
 int HAL_System_Info(hal_system_info_t* info, bool create, void* reserved)
@@ -243,6 +247,7 @@ uint16_t HAL_OTA_ChunkSize()
 
 bool HAL_FLASH_Begin(uint32_t sFLASH_Address, uint32_t fileSize, void* reserved)
 {
+    ++g_flashRevision;
     try {
         if (g_updateStream.is_open()) {
             g_updateStream.close();
@@ -264,6 +269,7 @@ bool HAL_FLASH_Begin(uint32_t sFLASH_Address, uint32_t fileSize, void* reserved)
 
 int HAL_FLASH_Update(const uint8_t *pBuffer, uint32_t address, uint32_t length, void* reserved)
 {
+    ++g_flashRevision;
     try {
         if (!g_updateStream.is_open()) {
             throw std::runtime_error("File is not open");
@@ -286,6 +292,11 @@ int HAL_FLASH_Update(const uint8_t *pBuffer, uint32_t address, uint32_t length,
     }
 }
 
+uint32_t HAL_FLASH_Revision(void* reserved)
+{
+    return g_flashRevision;
+}
+
 int HAL_FLASH_OTA_Validate(bool userDepsOptional, module_validation_flags_t flags, void* reserved)
 {
     return 0; // FIXME
@@ -293,6 +304,7 @@ int HAL_FLASH_OTA_Validate(bool userDepsOptional, module_validation_flags_t flag
 
 int HAL_FLASH_End(void* reserved)
 {
+    ++g_flashRevision;
     try {
         if (!g_updateStream.is_open()) {
             throw std::runtime_error("File is not open");
@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.h"
+
+#include "trace_marker.h"
+#include "logging.h"
+
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <csignal>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace particle {
+
+namespace {
+
+const size_t MAX_STACK_DEPTH = 48;
+// Frames of the signal handler and the signal trampoline
+const size_t SKIPPED_FRAMES = 2;
+// Capacity of the sample buffer. Samples are moved out of it by the background thread every
+// DRAIN_INTERVAL_MS milliseconds
+const size_t SAMPLE_BUFFER_SIZE = 4096;
+const unsigned DRAIN_INTERVAL_MS = 100;
+// Environment variable with the number of process images started so far. The variable is inherited
+// by the image that replaces the current one when the device resets
+const char* const BOOT_COUNT_ENV_VAR = "PARTICLE_PROFILER_BOOT_COUNT";
+
+struct Sample {
+    std::atomic<size_t> seq; // Set to the sample index + 1 when the sample is complete
+    uint64_t tid;
+    unsigned depth;
+    void* frames[MAX_STACK_DEPTH + SKIPPED_FRAMES];
+};
+
+// This function is async-signal-safe
+inline uint64_t currentThreadId() {
+#if defined(__linux__)
+    return (uint64_t)syscall(SYS_gettid);
+#elif defined(__APPLE__)
+    uint64_t tid = 0;
+    pthread_threadid_np(nullptr, &tid);
+    return tid;
+#else
+    return (uint64_t)(uintptr_t)pthread_self();
+#endif
+}
+
+std::string threadName(uint64_t tid) {
+#ifdef __linux__
+    std::ifstream f("/proc/self/task/" + std::to_string(tid) + "/comm");
+    std::string name;
+    if (f && std::getline(f, name) && !name.empty()) {
+        return name + '-' + std::to_string(tid);
+    }
+#endif
+    return "thread-" + std::to_string(tid);
+}
+
+std::string symbolName(void* addr) {
+    Dl_info info = {};
+    if (!dladdr(addr, &info)) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%p", addr);
+        return buf;
+    }
+    if (info.dli_sname) {
+        int status = 0;
+        std::unique_ptr<char, decltype(&free)> name(abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &free);
+        return (status == 0 && name) ? name.get() : info.dli_sname;
+    }
+    // Symbols that are not exported can be resolved with addr2line
+    const char* module = info.dli_fname ? strrchr(info.dli_fname, '/') : nullptr;
+    module = module ? module + 1 : (info.dli_fname ? info.dli_fname : "?");
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s+0x%" PRIxPTR, module, (uintptr_t)addr - (uintptr_t)info.dli_fbase);
+    return buf;
+}
+
+} // namespace
+
+class Profiler::Impl {
+public:
+    Impl() :
+            samples_(nullptr),
+            writePos_(0),
+            readPos_(0),
+            dropped_(0),
+            sampling_(false),
+            tracing_(false),
+            stopRequested_(false),
+            termSignal_(0),
+            traceFile_(nullptr),
+            firstEvent_(true),
+            bootIndex_(0),
+            started_(false) {
+    }
+
+    void start(const Config& conf) {
+        if (started_ || (conf.profileFile.empty() && conf.traceFile.empty())) {
+            return;
+        }
+        startTime_ = std::chrono::steady_clock::now();
+        // The output files are truncated by the first process image and appended to after a reset
+        const char* bootCount = getenv(BOOT_COUNT_ENV_VAR);
+        bootIndex_ = bootCount ? strtoul(bootCount, nullptr, 10) : 0;
+        setenv(BOOT_COUNT_ENV_VAR, std::to_string(bootIndex_ + 1).data(), 1 /* overwrite */);
+        if (!conf.traceFile.empty()) {
+            traceFile_ = fopen(conf.traceFile.data(), bootIndex_ ? "a" : "w");
+            if (!traceFile_) {
+                throw std::runtime_error("Unable to open trace file: " + conf.traceFile);
+            }
+            if (!bootIndex_) {
+                fputs("[", traceFile_);
+            } else {
+                // The events of the previous process image have already been written
+                firstEvent_ = false;
+            }
+            tracing_.store(true, std::memory_order_release);
+        }
+        profileFile_ = conf.profileFile;
+        if (!profileFile_.empty()) {
+            if (!conf.sampleRate || conf.sampleRate > 100000) {
+                throw std::runtime_error("Invalid sampling rate");
+            }
+            samples_.reset(new Sample[SAMPLE_BUFFER_SIZE]);
+            for (size_t i = 0; i < SAMPLE_BUFFER_SIZE; ++i) {
+                samples_[i].seq.store(0, std::memory_order_relaxed);
+            }
+            // The first call to backtrace() may load libgcc and allocate memory, which is not
+            // safe to do in a signal handler
+            void* frames[4];
+            backtrace(frames, 4);
+            struct sigaction sa = {};
+            sa.sa_handler = sampleSignalHandler;
+            sa.sa_flags = SA_RESTART;
+            sigemptyset(&sa.sa_mask);
+            if (sigaction(SIGPROF, &sa, nullptr) != 0) {
+                throw std::runtime_error("Unable to install SIGPROF handler");
+            }
+            sampling_.store(true, std::memory_order_release);
+            const long intervalUs = 1000000 / conf.sampleRate;
+            itimerval timer = {};
+            timer.it_interval.tv_sec = intervalUs / 1000000;
+            timer.it_interval.tv_usec = intervalUs % 1000000;
+            timer.it_value = timer.it_interval;
+            if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+                throw std::runtime_error("Unable to start profiling timer");
+            }
+        }
+        struct sigaction sa = {};
+        sa.sa_handler = termSignalHandler;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, nullptr);
+        sigaction(SIGTERM, &sa, nullptr);
+        std::atexit([]() {
+            Profiler::instance()->stop();
+        });
+        thread_ = std::thread([this]() {
+            run();
+        });
+        started_ = true;
+        LOG(INFO, "Profiler started");
+    }
+
+    void stop() {
+        if (!started_) {
+            return;
+        }
+        stopRequested_.store(true, std::memory_order_relaxed);
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+            thread_.join();
+        }
+        finish();
+    }
+
+    bool isTracing() const {
+        return tracing_.load(std::memory_order_relaxed);
+    }
+
+    void traceEvent(const char* name, char phase) {
+        const auto ts = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime_).count();
+        const auto tid = currentThreadId();
+        std::lock_guard<std::mutex> lock(traceMutex_);
+        if (!tracing_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        fputs(eventSeparator(), traceFile_);
+        fputs("{\"name\":\"", traceFile_);
+        for (const char* p = name; *p; ++p) {
+            if (*p == '"' || *p == '\\') {
+                fputc('\\', traceFile_);
+            }
+            fputc(*p, traceFile_);
+        }
+        fprintf(traceFile_, "\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":%u,\"tid\":%" PRIu64 "}", phase, (long long)ts,
+                bootIndex_ + 1, tid);
+        traceThreads_.insert(tid);
+    }
+
+private:
+    typedef std::vector<void*> Stack;
+
+    std::unique_ptr<Sample[]> samples_;
+    std::atomic<size_t> writePos_;
+    std::atomic<size_t> readPos_;
+    std::atomic<size_t> dropped_;
+    std::atomic<bool> sampling_;
+    std::atomic<bool> tracing_;
+    std::atomic<bool> stopRequested_;
+    std::atomic<int> termSignal_;
+
+    std::map<std::pair<uint64_t, Stack>, uint64_t> stacks_; // Accessed by the background thread
+    std::map<uint64_t, std::string> threadNames_;
+    std::string profileFile_;
+
+    FILE* traceFile_;
+    std::set<uint64_t> traceThreads_;
+    std::mutex traceMutex_;
+    bool firstEvent_;
+    unsigned bootIndex_;
+
+    std::chrono::steady_clock::time_point startTime_;
+    std::thread thread_;
+    std::once_flag finishOnce_;
+    bool started_;
+
+    void run() {
+        while (!stopRequested_.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+            drainSamples();
+            {
+                std::lock_guard<std::mutex> lock(traceMutex_);
+                if (traceFile_) {
+                    fflush(traceFile_);
+                }
+            }
+            const int sig = termSignal_.load(std::memory_order_relaxed);
+            if (sig) {
+                finish();
+                // Terminate the process the same way it would have been terminated without the profiler
+                signal(sig, SIG_DFL);
+                raise(sig);
+                return;
+            }
+        }
+    }
+
+    const char* eventSeparator() {
+        const char* sep = firstEvent_ ? "\n" : ",\n";
+        firstEvent_ = false;
+        return sep;
+    }
+
+    void drainSamples() {
+        if (!samples_) {
+            return;
+        }
+        size_t pos = readPos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Sample& s = samples_[pos % SAMPLE_BUFFER_SIZE];
+            if (s.seq.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            if (s.depth > SKIPPED_FRAMES) {
+                Stack stack(s.frames + SKIPPED_FRAMES, s.frames + s.depth);
+                ++stacks_[std::make_pair(s.tid, std::move(stack))];
+                if (!threadNames_.count(s.tid)) {
+                    // Resolve the name while the thread is still likely to be running
+                    threadNames_[s.tid] = threadName(s.tid);
+                }
+            }
+            readPos_.store(++pos, std::memory_order_release);
+        }
+    }
+
+    void finish() {
+        std::call_once(finishOnce_, [this]() {
+            if (sampling_.exchange(false)) {
+                itimerval timer = {};
+                setitimer(ITIMER_PROF, &timer, nullptr);
+                drainSamples();
+                writeProfile();
+            }
+            std::lock_guard<std::mutex> lock(traceMutex_);
+            if (tracing_.exchange(false)) {
+                // Each process image is shown as a separate process
+                fprintf(traceFile_, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"boot-%u\"}}",
+                        eventSeparator(), bootIndex_ + 1, bootIndex_);
+                for (auto tid: traceThreads_) {
+                    const auto name = threadName(tid);
+                    fprintf(traceFile_, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%" PRIu64 ",\"args\":{\"name\":\"%s\"}}",
+                            eventSeparator(), bootIndex_ + 1, tid, name.data());
+                }
+                // The closing bracket is optional in the trace event format. It's omitted so that
+                // the events of the next process image can be appended to the file
+                fputs("\n", traceFile_);
+                fclose(traceFile_);
+                traceFile_ = nullptr;
+            }
+        });
+    }
+
+    void writeProfile() {
+        // Repeated stacks of different process images are summed up by the visualization tools
+        FILE* f = fopen(profileFile_.data(), bootIndex_ ? "a" : "w");
+        if (!f) {
+            LOG(ERROR, "Unable to open profile file: %s", profileFile_.data());
+            return;
+        }
+        std::map<void*, std::string> symbols;
+        uint64_t total = 0;
+        for (const auto& entry: stacks_) {
+            const auto& stack = entry.first.second;
+            auto it = threadNames_.find(entry.first.first);
+            fputs(it != threadNames_.end() ? it->second.data() : "?", f);
+            // Stacks are stored leaf first
+            for (size_t i = stack.size(); i > 0; --i) {
+                // Return addresses point past the call instruction
+                void* addr = (i > 1) ? (void*)((uintptr_t)stack[i - 1] - 1) : stack[i - 1];
+                auto sym = symbols.find(addr);
+                if (sym == symbols.end()) {
+                    sym = symbols.emplace(addr, symbolName(addr)).first;
+                }
+                fputc(';', f);
+                fputs(sym->second.data(), f);
+            }
+            fprintf(f, " %" PRIu64 "\n", entry.second);
+            total += entry.second;
+        }
+        fclose(f);
+        LOG(INFO, "Profiler: %" PRIu64 " samples written to %s, %u dropped", total, profileFile_.data(),
+                (unsigned)dropped_.load(std::memory_order_relaxed));
+    }
+
+    bool claimSample(size_t* pos) {
+        if (!sampling_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        size_t p = writePos_.load(std::memory_order_relaxed);
+        do {
+            if (p - readPos_.load(std::memory_order_acquire) >= SAMPLE_BUFFER_SIZE) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!writePos_.compare_exchange_weak(p, p + 1, std::memory_order_relaxed));
+        *pos = p;
+        return true;
+    }
+
+    static void sampleSignalHandler(int) {
+        const int err = errno;
+        const auto self = Profiler::instance()->impl_;
+        size_t pos = 0;
+        if (self->claimSample(&pos)) {
+            Sample& s = self->samples_[pos % SAMPLE_BUFFER_SIZE];
+            s.tid = currentThreadId();
+            // backtrace() is called directly from the handler so that the number of frames to
+            // skip is fixed
+            const int n = backtrace(s.frames, MAX_STACK_DEPTH + SKIPPED_FRAMES);
+            s.depth = (n > 0) ? n : 0;
+            s.seq.store(pos + 1, std::memory_order_release);
+        }
+        errno = err;
+    }
+
+    static void termSignalHandler(int sig) {
+        // The output files are written by the background thread
+        Profiler::instance()->impl_->termSignal_.store(sig, std::memory_order_relaxed);
+    }
+};
+
+Profiler::Profiler() :
+        impl_(new Impl()) {
+}
+
+Profiler::~Profiler() {
+    // The implementation is intentionally leaked as it may still be accessed by signal handlers
+    // and other threads during process shutdown
+}
+
+void Profiler::start(const Config& conf) {
+    impl_->start(conf);
+}
+
+void Profiler::stop() {
+    impl_->stop();
+}
+
+bool Profiler::isTracing() const {
+    return impl_->isTracing();
+}
+
+void Profiler::traceEvent(const char* name, char phase) {
+    impl_->traceEvent(name, phase);
+}
+
+Profiler* Profiler::instance() {
+    static Profiler profiler;
+    return &profiler;
+}
+
+} // namespace particle
+
+#else // !(defined(__unix__) || defined(__APPLE__))
+
+namespace particle {
+
+class Profiler::Impl {
+};
+
+Profiler::Profiler() :
+        impl_(nullptr) {
+}
+
+Profiler::~Profiler() {
+}
+
+void Profiler::start(const Config& conf) {
+    if (!conf.profileFile.empty() || !conf.traceFile.empty()) {
+        throw std::runtime_error("Profiling is not supported on this system");
+    }
+}
+
+void Profiler::stop() {
+}
+
+bool Profiler::isTracing() const {
+    return false;
+}
+
+void Profiler::traceEvent(const char* name, char phase) {
+}
+
+Profiler* Profiler::instance() {
+    static Profiler profiler;
+    return &profiler;
+}
+
+} // namespace particle
+
+#endif // !(defined(__unix__) || defined(__APPLE__))
+
+#if PARTICLE_TRACE_MARKERS
+
+void trace_marker_begin(const char* name, void* /* reserved */) {
+    const auto p = particle::Profiler::instance();
+    if (p->isTracing()) {
+        p->traceEvent(name, 'B');
+    }
+}
+
+void trace_marker_end(const char* name, void* /* reserved */) {
+    const auto p = particle::Profiler::instance();
+    if (p->isTracing()) {
+        p->traceEvent(name, 'E');
+    }
+}
+
+#endif // PARTICLE_TRACE_MARKERS
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace particle {
+
+/**
+ * Sampling profiler and trace event recorder of the virtual device.
+ *
+ * The profiler samples the call stacks of the running threads using a CPU time timer signal and
+ * writes them to a file in the "folded stacks" format (one line per unique stack, frames separated
+ * by semicolons and followed by the sample count) that can be rendered using `flamegraph.pl` or
+ * speedscope. Frames that can't be symbolized are written as `module+offset` and can be resolved
+ * with `addr2line`.
+ *
+ * The events recorded via the `PARTICLE_TRACE_SCOPE()` markers are written to a file in the
+ * Chrome trace event format that can be opened in Perfetto or `chrome://tracing`.
+ *
+ * The output files are written when the process exits, resets, or is terminated with SIGINT or
+ * SIGTERM. The process image that replaces the current one when the device resets appends its data
+ * to the same files, and its trace events are shown as a separate process.
+ */
+class Profiler {
+public:
+    struct Config {
+        std::string profileFile; // Output file for the sampled stacks
+        std::string traceFile; // Output file for the trace events
+        unsigned sampleRate; // Sampling rate in Hz
+
+        Config() :
+                sampleRate(DEFAULT_SAMPLE_RATE) {
+        }
+    };
+
+    static const unsigned DEFAULT_SAMPLE_RATE = 997; // Avoid lockstep with periodic activity
+
+    /**
+     * Start profiling and/or tracing.
+     *
+     * Does nothing if neither output file is configured.
+     *
+     * @throws std::runtime_error if the profiler couldn't be started.
+     */
+    void start(const Config& conf);
+
+    /**
+     * Stop profiling and tracing and write the output files.
+     */
+    void stop();
+
+    bool isTracing() const;
+
+    void traceEvent(const char* name, char phase);
+
+    static Profiler* instance();
+
+private:
+    class Impl;
+
+    Impl* impl_;
+
+    Profiler();
+    ~Profiler();
+};
+
+} // namespace particle
@@ -314,8 +314,24 @@ sock_result_t socket_send(sock_handle_t sd, const void* buffer, socklen_t len)
 
 sock_result_t socket_send_ex(sock_handle_t sd, const void* buffer, socklen_t len, uint32_t flags, system_tick_t timeout, void* reserved)
 {
-    /* NOTE: non-blocking mode and timeouts are not supported */
-    return socket_send(sd, buffer, len);
+    if (!(flags & SOCKET_SEND_NO_WAIT)) {
+        /* NOTE: timeouts are not supported */
+        return socket_send(sd, buffer, len);
+    }
+    // Send only as much data as the socket accepts without blocking
+    auto& socket = tcp_from(sd);
+    if (!is_valid(socket))
+        return -1;
+    boost::system::error_code error;
+    socket.non_blocking(true, error);
+    if (error)
+        return -1;
+    std::size_t sent = socket.write_some(boost::asio::buffer(buffer, len), error);
+    boost::system::error_code ignored;
+    socket.non_blocking(false, ignored);
+    if (error == boost::asio::error::would_block || error == boost::asio::error::try_again)
+        return 0;
+    return error ? -1 : sent;
 }
 
 sock_result_t socket_create_nonblocking_server(sock_handle_t sock, uint16_t port)
@@ -1,6 +1,10 @@
 /* Includes ------------------------------------------------------------------*/
 #include "usart_hal.h"
 #include "socket_hal.h"
+#include "system_error.h"
+
+#include <algorithm>
+#include <cstring>
 
 struct UsartRingBuffer {
     uint8_t* buffer;
@@ -18,6 +22,8 @@ struct Usart {
     virtual int32_t read()=0;
     virtual int32_t peek()=0;
     virtual uint32_t write(uint8_t byte)=0;
+    virtual ssize_t read(uint8_t* data, size_t size, bool peek)=0;
+    virtual ssize_t write(const uint8_t* data, size_t size)=0;
     virtual void flush()=0;
 
     bool enabled() { return true; }
@@ -66,15 +72,23 @@ class SocketUsartBase : public Usart
         }
 
         void fillFromSocketIfNeeded() {
-            int space;
-            if (rx.head>rx.tail) {    // head after tail, so can fill up to end of buffer
-                space = rx.size-rx.tail;
+            if (socket==SOCKET_INVALID || rx.size==0) {
+                return;
+            }
+            // Contiguous free space after the head. One slot is kept unused so that a full buffer
+            // can be told apart from an empty one
+            size_t space;
+            if (rx.head>=rx.tail) {    // head after tail, so can fill up to end of buffer
+                space = rx.size-rx.head-(rx.tail==0 ? 1 : 0);
             }
             else {
-                space = rx.tail-rx.head;  // may be 0
+                space = rx.tail-rx.head-1;  // may be 0
             }
-            if (socket!=SOCKET_INVALID && space>0) {
-                socket_receive(socket, rx.buffer+rx.head, space, 0);
+            if (space>0) {
+                const sock_result_t r = socket_receive(socket, rx.buffer+rx.head, space, 0);
+                if (r>0) {
+                    rx.head = (rx.head + r) % rx.size;
+                }
             }
         }
 
@@ -99,7 +113,10 @@ class SocketUsartBase : public Usart
 
         virtual int32_t available() override {
             fillFromSocketIfNeeded();
-            return (rx.head-rx.tail) % rx.size;
+            if (rx.size==0) {
+                return 0;
+            }
+            return (rx.size + rx.head - rx.tail) % rx.size;
         }
         virtual int32_t availableForWrite() override {
             return (rx.size + tx.head - tx.tail) % rx.size;
@@ -117,6 +134,40 @@ class SocketUsartBase : public Usart
                 return 0;
             return socket_send(socket, &byte, 1);
         }
+        virtual ssize_t read(uint8_t* data, size_t size, bool peek) override {
+            size_t n = 0;
+            uint16_t tail = rx.tail;
+            while (n<size && rx.size>0) {
+                if (tail==rx.head) {
+                    // The socket data may not have fit before the end of the buffer
+                    fillFromSocketIfNeeded();
+                    if (tail==rx.head) {
+                        break;
+                    }
+                }
+                const size_t end = (rx.head>tail) ? rx.head : rx.size;
+                const size_t chunk = std::min(size-n, end-tail);
+                memcpy(data+n, rx.buffer+tail, chunk);
+                n += chunk;
+                tail = (tail + chunk) % rx.size;
+                if (!peek) {
+                    rx.tail = tail;
+                }
+            }
+            if (n==0) {
+                return SYSTEM_ERROR_NO_MEMORY;
+            }
+            return n;
+        }
+        virtual ssize_t write(const uint8_t* data, size_t size) override {
+            if (!initSocket())
+                return SYSTEM_ERROR_INVALID_STATE;
+            const sock_result_t r = socket_send(socket, data, size);
+            if (r<0) {
+                return SYSTEM_ERROR_IO;
+            }
+            return r;
+        }
 };
 
 
@@ -253,6 +304,30 @@ void hal_usart_flush(hal_usart_interface_t serial)
     usartMap(serial).flush();
 }
 
+ssize_t hal_usart_write_buffer(hal_usart_interface_t serial, const void* buffer, size_t size, size_t elementSize)
+{
+    if (elementSize!=sizeof(uint8_t)) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    return usartMap(serial).write((const uint8_t*)buffer, size);
+}
+
+ssize_t hal_usart_read_buffer(hal_usart_interface_t serial, void* buffer, size_t size, size_t elementSize)
+{
+    if (elementSize!=sizeof(uint8_t)) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    return usartMap(serial).read((uint8_t*)buffer, size, false /* peek */);
+}
+
+ssize_t hal_usart_peek_buffer(hal_usart_interface_t serial, void* buffer, size_t size, size_t elementSize)
+{
+    if (elementSize!=sizeof(uint8_t)) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    return usartMap(serial).read((uint8_t*)buffer, size, true /* peek */);
+}
+
 bool hal_usart_is_enabled(hal_usart_interface_t serial)
 {
     return usartMap(serial).enabled();
@@ -167,6 +167,29 @@ int32_t HAL_USB_USART_Send_Data(HAL_USB_USART_Serial serial, uint8_t data)
   return 1;
 }
 
+int32_t HAL_USB_USART_Receive_Data_Buffer(HAL_USB_USART_Serial serial, uint8_t* data, size_t size)
+{
+    size_t n = 0;
+    if (size > 0 && last >= 0) {
+        // Return the byte consumed by a previous peek first
+        data[n++] = last;
+        last = -1;
+    }
+    if (n < size && USB_USART_Available_Data()) {
+        const ssize_t r = read(0, data + n, size - n);
+        if (r > 0) {
+            n += r;
+        }
+    }
+    return n;
+}
+
+int32_t HAL_USB_USART_Send_Data_Buffer(HAL_USB_USART_Serial serial, const uint8_t* data, size_t size)
+{
+    std::cout.write((const char*)data, size);
+    return size;
+}
+
 void HAL_USB_USART_Flush_Data(HAL_USB_USART_Serial serial)
 {
   USB_USART_Flush_Data();
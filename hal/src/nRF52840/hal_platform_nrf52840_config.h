@@ -100,6 +100,9 @@
 
 #define HAL_PLATFORM_NEWLIB (1)
 
+// One full-sized message and a few acknowledgements
+#define HAL_PLATFORM_COAP_MESSAGE_POOL_SIZE (1280)
+
 #define HAL_PLATFORM_OTA_PROTOCOL_V3 (1)
 
 #define HAL_PLATFORM_RESUMABLE_OTA (1)
@@ -121,6 +124,7 @@
 #if MODULE_FUNCTION != 2 // MOD_FUNC_BOOTLOADER
 #define HAL_PLATFORM_INFLATE_USE_FILESYSTEM (1)
 #define HAL_PLATFORM_INCLUDE_LEGACY_MODULE_INFO (1)
+#define HAL_PLATFORM_MODULE_INTEGRITY_CACHE (1)
 #endif
 
 #if PLATFORM_ID == PLATFORM_ARGON
@@ -34,6 +34,7 @@ LOG_SOURCE_CATEGORY("hal.ota")
 #include "spark_macros.h"
 #include "bootloader.h"
 #include "ota_module.h"
+#include "module_integrity.h"
 #include "spark_protocol_functions.h"
 #include "hal_platform.h"
 #include "hal_event.h"
@@ -47,8 +48,10 @@ LOG_SOURCE_CATEGORY("hal.ota")
 #include "platform_ncp.h"
 #include "deviceid_hal.h"
 #include <memory>
+#include <atomic>
 #include "platform_radio_stack.h"
 #include "check.h"
+#include "scope_guard.h"
 #include "security_mode.h"
 
 extern volatile uint8_t SPARK_FLASH_UPDATE;
@@ -67,6 +70,9 @@ namespace {
 
 const uint16_t BOOTLOADER_MBR_UPDATE_MIN_VERSION = 1001; // 2.0.0-rc.1
 
+// Incremented every time the module storage is modified
+std::atomic<uint32_t> g_flashRevision(0);
+
 } // anonymous
 
 static int flash_bootloader(const hal_module_t* mod, uint32_t moduleLength);
@@ -376,6 +382,8 @@ uint16_t HAL_OTA_ChunkSize()
 
 bool HAL_FLASH_Begin(uint32_t address, uint32_t length, void* reserved)
 {
+    invalidate_module_crc32_cache();
+    ++g_flashRevision;
     const int r = FLASH_Begin(address, length);
     if (r != FLASH_ACCESS_RESULT_OK) {
         return false;
@@ -385,9 +393,16 @@ bool HAL_FLASH_Begin(uint32_t address, uint32_t length, void* reserved)
 
 int HAL_FLASH_Update(const uint8_t *pBuffer, uint32_t address, uint32_t length, void* reserved)
 {
+    invalidate_module_crc32_cache();
+    ++g_flashRevision;
     return FLASH_Update(pBuffer, address, length);
 }
 
+uint32_t HAL_FLASH_Revision(void* reserved)
+{
+    return g_flashRevision;
+}
+
 int HAL_OTA_Flash_Read(uintptr_t address, uint8_t* buffer, size_t size)
 {
 #ifdef USE_SERIAL_FLASH
@@ -596,6 +611,11 @@ int HAL_FLASH_OTA_Validate(bool userDepsOptional, module_validation_flags_t flag
 
 int HAL_FLASH_End(void* reserved)
 {
+    // The bootloader can be updated in place
+    SCOPE_GUARD({
+        invalidate_module_crc32_cache();
+        ++g_flashRevision;
+    });
     hal_module_t modules[MAX_COMBINED_MODULE_COUNT] = {};
     size_t moduleCount = CHECK(fetchModules(modules, MAX_COMBINED_MODULE_COUNT, true /* userDepsOptional */,
             MODULE_VALIDATION_INTEGRITY | MODULE_VALIDATION_DEPENDENCIES_FULL));
@@ -24,6 +24,7 @@
 #include "platform_radio_stack.h"
 #include "platform_ncp.h"
 #include "check.h"
+#include "module_integrity.h"
 
 namespace {
 
@@ -60,15 +61,6 @@ int get_module_crc_suffix(const module_bounds_t* bounds, const module_info_t* in
     }
 }
 
-bool verify_crc32(const module_bounds_t* bounds, const module_info_t* info) {
-    if (bounds->location == MODULE_BOUNDS_LOC_INTERNAL_FLASH) {
-        return FLASH_VerifyCRC32(FLASH_INTERNAL, bounds->start_address, module_length(info));
-    } else if (bounds->location == MODULE_BOUNDS_LOC_EXTERNAL_FLASH) {
-        return FLASH_VerifyCRC32(FLASH_SERIAL, bounds->start_address, module_length(info));
-    }
-    return false;
-}
-
 } // namespace
 
 /**
@@ -136,7 +128,7 @@ bool fetch_module(hal_module_t* target, const module_bounds_t* bounds, bool user
         if (validate_module_dependencies(bounds, userDepsOptional, target->validity_checked & MODULE_VALIDATION_DEPENDENCIES_FULL)) {
             target->validity_result |= MODULE_VALIDATION_DEPENDENCIES | (target->validity_checked & MODULE_VALIDATION_DEPENDENCIES_FULL);
         }
-        if ((target->validity_checked & MODULE_VALIDATION_INTEGRITY) && verify_crc32(bounds, info)) {
+        if ((target->validity_checked & MODULE_VALIDATION_INTEGRITY) && verify_module_crc32(bounds, info)) {
             target->validity_result |= MODULE_VALIDATION_INTEGRITY;
         }
     }
@@ -22,6 +22,7 @@
 #include "usb_hal_cdc.h"
 #include "usb_settings.h"
 #include <mutex>
+#include <algorithm>
 #include <nrf52840.h>
 #include <nrf_nvic.h>
 
@@ -132,6 +133,24 @@ int32_t HAL_USB_USART_Send_Data_protected(HAL_USB_USART_Serial serial, uint8_t d
     return HAL_USB_USART_Send_Data(serial, data);
 }
 
+int32_t HAL_USB_USART_Receive_Data_Buffer(HAL_USB_USART_Serial serial, uint8_t* data, size_t size) {
+    return usb_uart_get_rx_buffer(data, std::min(size, (size_t)UINT16_MAX));
+}
+
+int32_t HAL_USB_USART_Receive_Data_Buffer_protected(HAL_USB_USART_Serial serial, uint8_t* data, size_t size) {
+    CHECK_SECURITY_MODE_PROTECTED();
+    return HAL_USB_USART_Receive_Data_Buffer(serial, data, size);
+}
+
+int32_t HAL_USB_USART_Send_Data_Buffer(HAL_USB_USART_Serial serial, const uint8_t* data, size_t size) {
+    return usb_uart_send((uint8_t*)data, std::min(size, (size_t)UINT16_MAX));
+}
+
+int32_t HAL_USB_USART_Send_Data_Buffer_protected(HAL_USB_USART_Serial serial, const uint8_t* data, size_t size) {
+    CHECK_SECURITY_MODE_PROTECTED();
+    return HAL_USB_USART_Send_Data_Buffer(serial, data, size);
+}
+
 void HAL_USB_USART_Flush_Data(HAL_USB_USART_Serial serial) {
     usb_uart_flush_tx_data();
 }
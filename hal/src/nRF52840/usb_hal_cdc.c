@@ -515,18 +515,23 @@ int usb_uart_send(uint8_t data[], uint16_t size) {
         return -1;
     }
 
-    for (int i = 0; i < size; i++) {
+    uint16_t sent = 0;
+    while (sent < size) {
         // wait until tx fifo is available
         while (IS_FIFO_FULL(&m_usb_instance.tx_fifo)) {
             if (!usb_hal_is_connected() || !usb_will_preempt()) {
-                return -1;
+                // Report whatever has already been queued, fail only if nothing was
+                return sent > 0 ? sent : -1;
             }
         }
-        SPARK_ASSERT(app_fifo_put(&m_usb_instance.tx_fifo, data[i]) == NRF_SUCCESS);
+        // Copy as much as fits into the fifo in one go
+        uint32_t len = size - sent;
+        SPARK_ASSERT(app_fifo_write(&m_usb_instance.tx_fifo, data + sent, &len) == NRF_SUCCESS);
+        sent += len;
     }
 
     // NOTE: we only care and report about how many bytes were actually put into the transmit buffer
-    return size;
+    return sent;
 }
 
 void usb_uart_set_baudrate(uint32_t baudrate) {
@@ -608,6 +613,20 @@ uint8_t usb_uart_get_rx_data(void) {
     return data;
 }
 
+int usb_uart_get_rx_buffer(uint8_t* data, uint16_t size) {
+    if (usb_cdc_copy_from_rx_buffer()) {
+        m_usb_instance.rx_data_size = 0;
+        m_usb_instance.rx_done = false;
+    }
+
+    uint32_t len = size;
+    if (app_fifo_read(&m_usb_instance.rx_fifo, data, &len) != NRF_SUCCESS) {
+        // The fifo is empty
+        return 0;
+    }
+    return len;
+}
+
 uint8_t usb_uart_peek_rx_data(uint8_t index) {
     uint8_t data = 0;
     if (app_fifo_peek(&m_usb_instance.rx_fifo, index, &data)) {
@@ -22,6 +22,7 @@ void usb_hal_detach(void);
 
 int usb_uart_available_rx_data(void);
 uint8_t usb_uart_get_rx_data(void);
+int usb_uart_get_rx_buffer(uint8_t* data, uint16_t size);
 uint8_t usb_uart_peek_rx_data(uint8_t index);
 void usb_uart_flush_rx_data(void);
 void usb_uart_flush_tx_data(void);
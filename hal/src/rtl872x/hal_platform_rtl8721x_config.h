@@ -95,6 +95,9 @@
 
 #define HAL_PLATFORM_NEWLIB (1)
 
+// A couple of full-sized messages and the acknowledgements
+#define HAL_PLATFORM_COAP_MESSAGE_POOL_SIZE (2560)
+
 #define HAL_PLATFORM_OTA_PROTOCOL_V3 (1)
 
 #define HAL_PLATFORM_RESUMABLE_OTA (1)
@@ -111,6 +114,10 @@
 #define HAL_PLATFORM_USB_COMPOSITE (1)
 #endif // defined(MODULE_FUNCTION) && MODULE_FUNCTION == 2 // MOD_FUNC_BOOTLOADER
 
+#if !defined(MODULE_FUNCTION) || MODULE_FUNCTION != 2 // MOD_FUNC_BOOTLOADER
+#define HAL_PLATFORM_MODULE_INTEGRITY_CACHE (1)
+#endif // !defined(MODULE_FUNCTION) || MODULE_FUNCTION != 2 // MOD_FUNC_BOOTLOADER
+
 // FIXME: variable suffix size causes problems right now, some refatoring will have to be done
 // #if defined(MODULE_FUNCTION) && MODULE_FUNCTION == 5 // MOD_FUNC_USER_PART
 #define HAL_PLATFORM_MODULE_DYNAMIC_LOCATION (1)
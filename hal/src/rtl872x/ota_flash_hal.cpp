@@ -34,6 +34,7 @@ LOG_SOURCE_CATEGORY("hal.ota")
 #include "spark_macros.h"
 #include "bootloader.h"
 #include "ota_module.h"
+#include "module_integrity.h"
 #include "spark_protocol_functions.h"
 #include "hal_platform.h"
 #include "hal_event.h"
@@ -47,8 +48,10 @@ LOG_SOURCE_CATEGORY("hal.ota")
 #include "platform_ncp.h"
 #include "deviceid_hal.h"
 #include <memory>
+#include <atomic>
 #include "platform_radio_stack.h"
 #include "check.h"
+#include "scope_guard.h"
 #include "security_mode.h"
 
 extern volatile uint8_t SPARK_FLASH_UPDATE;
@@ -67,6 +70,9 @@ namespace {
 
 const uint16_t BOOTLOADER_MBR_UPDATE_MIN_VERSION = 1001; // 2.0.0-rc.1
 
+// Incremented every time the module storage is modified
+std::atomic<uint32_t> g_flashRevision(0);
+
 } // anonymous
 
 inline bool matches_mcu(uint8_t bounds_mcu, uint8_t actual_mcu) {
@@ -339,6 +345,8 @@ uint16_t HAL_OTA_ChunkSize()
 
 bool HAL_FLASH_Begin(uint32_t address, uint32_t length, void* reserved)
 {
+    invalidate_module_crc32_cache();
+    ++g_flashRevision;
     int r = 0;
     if (module_ota.location == MODULE_BOUNDS_LOC_INTERNAL_FLASH) {
         r = FLASH_Begin(FLASH_INTERNAL, address, length);
@@ -353,6 +361,8 @@ bool HAL_FLASH_Begin(uint32_t address, uint32_t length, void* reserved)
 
 int HAL_FLASH_Update(const uint8_t *pBuffer, uint32_t address, uint32_t length, void* reserved)
 {
+    invalidate_module_crc32_cache();
+    ++g_flashRevision;
     if (module_ota.location == MODULE_BOUNDS_LOC_INTERNAL_FLASH) {
         return FLASH_Update(FLASH_INTERNAL, pBuffer, address, length);
     } else {
@@ -360,6 +370,11 @@ int HAL_FLASH_Update(const uint8_t *pBuffer, uint32_t address, uint32_t length,
     }
 }
 
+uint32_t HAL_FLASH_Revision(void* reserved)
+{
+    return g_flashRevision;
+}
+
 int HAL_OTA_Flash_Read(uintptr_t address, uint8_t* buffer, size_t size)
 {
     return hal_flash_read(address, buffer, size);
@@ -523,6 +538,11 @@ int HAL_FLASH_OTA_Validate(bool userDepsOptional, module_validation_flags_t flag
 
 int HAL_FLASH_End(void* reserved)
 {
+    // Modules can be updated in place
+    SCOPE_GUARD({
+        invalidate_module_crc32_cache();
+        ++g_flashRevision;
+    });
     hal_module_t modules[MAX_COMBINED_MODULE_COUNT] = {};
     size_t moduleCount = CHECK(fetchModules(modules, MAX_COMBINED_MODULE_COUNT, true /* userDepsOptional */,
             MODULE_VALIDATION_INTEGRITY | MODULE_VALIDATION_DEPENDENCIES_FULL));
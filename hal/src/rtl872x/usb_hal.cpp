@@ -22,6 +22,7 @@
 #include "usbd_driver.h"
 #include "usbd_cdc.h"
 #include <mutex>
+#include <algorithm>
 #include "usb_settings.h"
 #include "usbd_hid.h"
 // FIXME: not ideal, directly using freertos task APIs
@@ -251,6 +252,55 @@ int32_t HAL_USB_USART_Send_Data_protected(HAL_USB_USART_Serial serial, uint8_t d
     return HAL_USB_USART_Send_Data(serial, data);
 }
 
+int32_t HAL_USB_USART_Receive_Data_Buffer(HAL_USB_USART_Serial serial, uint8_t* data, size_t size) {
+    if (serial != HAL_USB_USART_SERIAL) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const int r = getCdcClassDriver().read(data, size);
+    return std::max(r, 0);
+}
+
+int32_t HAL_USB_USART_Receive_Data_Buffer_protected(HAL_USB_USART_Serial serial, uint8_t* data, size_t size) {
+    CHECK_SECURITY_MODE_PROTECTED();
+    return HAL_USB_USART_Receive_Data_Buffer(serial, data, size);
+}
+
+int32_t HAL_USB_USART_Send_Data_Buffer(HAL_USB_USART_Serial serial, const uint8_t* data, size_t size) {
+    if (serial != HAL_USB_USART_SERIAL) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    // Just in case for now
+    if ((__get_PRIMASK() & 1) || (__get_BASEPRI() != 0)) {
+        return -1;
+    }
+    const bool needToYield = uxTaskPriorityGet(nullptr) >= rtl::RTL_USBD_ISR_PROCESSING_THREAD_PRIORITY;
+    size_t sent = 0;
+    while (sent < size) {
+        const int32_t available = HAL_USB_USART_Available_Data_For_Write(serial);
+        if (available < 0 || !HAL_USB_USART_Is_Connected(serial)) {
+            // Report whatever has already been queued, fail only if nothing was
+            return sent > 0 ? sent : -1;
+        }
+        if (available == 0) {
+            if (needToYield) {
+                HAL_Delay_Milliseconds(1);
+            }
+            continue;
+        }
+        const int r = getCdcClassDriver().write(data + sent, std::min(size - sent, (size_t)available));
+        if (r < 0) {
+            return sent > 0 ? sent : r;
+        }
+        sent += r;
+    }
+    return sent;
+}
+
+int32_t HAL_USB_USART_Send_Data_Buffer_protected(HAL_USB_USART_Serial serial, const uint8_t* data, size_t size) {
+    CHECK_SECURITY_MODE_PROTECTED();
+    return HAL_USB_USART_Send_Data_Buffer(serial, data, size);
+}
+
 void HAL_USB_USART_Flush_Data(HAL_USB_USART_Serial serial) {
     if (serial != HAL_USB_USART_SERIAL) {
         return;
@@ -70,6 +70,11 @@ int HAL_FLASH_End(void* reserved)
     return SYSTEM_ERROR_UNKNOWN;
 }
 
+uint32_t HAL_FLASH_Revision(void* reserved)
+{
+    return 0;
+}
+
 void HAL_FLASH_Read_ServerAddress(ServerAddress* server_addr)
 {
 }
@@ -25,6 +25,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "usart_hal.h"
+#include "system_error.h"
 
 int hal_usart_init_ex(hal_usart_interface_t serial, const hal_usart_buffer_config_t* config, void*)
 {
@@ -85,3 +86,18 @@ int hal_usart_sleep(hal_usart_interface_t serial, bool sleep, void* reserved)
 {
     return 0;
 }
+
+ssize_t hal_usart_write_buffer(hal_usart_interface_t serial, const void* buffer, size_t size, size_t elementSize)
+{
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+ssize_t hal_usart_read_buffer(hal_usart_interface_t serial, void* buffer, size_t size, size_t elementSize)
+{
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+ssize_t hal_usart_peek_buffer(hal_usart_interface_t serial, void* buffer, size_t size, size_t elementSize)
+{
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
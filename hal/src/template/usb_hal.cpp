@@ -144,6 +144,16 @@ int32_t HAL_USB_USART_Send_Data(HAL_USB_USART_Serial serial, uint8_t data)
   return -1;
 }
 
+int32_t HAL_USB_USART_Receive_Data_Buffer(HAL_USB_USART_Serial serial, uint8_t* data, size_t size)
+{
+  return -1;
+}
+
+int32_t HAL_USB_USART_Send_Data_Buffer(HAL_USB_USART_Serial serial, const uint8_t* data, size_t size)
+{
+  return -1;
+}
+
 void HAL_USB_USART_Flush_Data(HAL_USB_USART_Serial serial)
 {
 }
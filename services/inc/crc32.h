@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace particle {
+
+/**
+ * Compute the CRC-32 (ISO-HDLC) of a buffer.
+ *
+ * The result is the same as with `Compute_CRC32()` and `softCrc32()`, but the data is processed
+ * 8 bytes at a time using the slicing-by-8 algorithm, which is several times faster than the
+ * byte-wise table lookup. The lookup tables take 8KB of flash.
+ *
+ * @param data Data.
+ * @param size Data size.
+ * @param crc CRC of the preceding data, or 0.
+ * @return CRC of the data.
+ */
+uint32_t computeCrc32(const void* data, size_t size, uint32_t crc = 0);
+
+} // namespace particle
@@ -74,6 +74,31 @@
 #define DIAG_NAME_SYSTEM_PANIC_PC "sys:panic:pc"
 #define DIAG_NAME_SYSTEM_PANIC_LR "sys:panic:lr"
 #define DIAG_NAME_SYSTEM_PANIC_ASSERTION_STRING "sys:panic:assert"
+#define DIAG_NAME_CLOUD_COAP_ROUND_TRIP_HISTOGRAM "coap:roundtrip:hist"
+#define DIAG_NAME_CLOUD_DTLS_HANDSHAKE_TIME "cloud:hshake"
+#define DIAG_NAME_SYSTEM_FS_PROG_TIME "fs:prog"
+#define DIAG_NAME_SYSTEM_FS_ERASE_TIME "fs:erase"
+#define DIAG_NAME_CLOUD_DTLS_HANDSHAKES "cloud:hshakes"
+#define DIAG_NAME_CLOUD_DTLS_SESSION_RESUMPTIONS "cloud:resumed"
+#define DIAG_NAME_SYSTEM_LOOP_WAKEUPS "sys:loop:wakeups"
+#define DIAG_NAME_SYSTEM_LOOP_NETWORK_TIME "sys:loop:net"
+#define DIAG_NAME_SYSTEM_LOOP_CLOUD_TIME "sys:loop:cloud"
+#define DIAG_NAME_SYSTEM_LOOP_SETUP_TIME "sys:loop:setup"
+#define DIAG_NAME_SYSTEM_LOOP_OTHER_TIME "sys:loop:other"
+#define DIAG_NAME_APP_LOOP_TIME_HISTOGRAM "app:loop:hist"
+#define DIAG_NAME_APP_LOOP_STALL_HISTOGRAM "app:stall:hist"
+#define DIAG_NAME_SYSTEM_LOOP_MAX_STALL "sys:stall:max"
+#define DIAG_NAME_SYSTEM_LOOP_MAX_STALL_SOURCE "sys:stall:src"
+#define DIAG_NAME_NETWORK_ETHERNET_ROUND_TRIP "net:eth:rtt"
+#define DIAG_NAME_NETWORK_ETHERNET_LOSS "net:eth:loss"
+#define DIAG_NAME_NETWORK_WIFI_ROUND_TRIP "net:wifi:rtt"
+#define DIAG_NAME_NETWORK_WIFI_LOSS "net:wifi:loss"
+#define DIAG_NAME_NETWORK_CELLULAR_ROUND_TRIP "net:cell:rtt"
+#define DIAG_NAME_NETWORK_CELLULAR_LOSS "net:cell:loss"
+#define DIAG_NAME_CLOUD_CONNECTION_FAILOVERS "cloud:failover"
+#define DIAG_NAME_NETWORK_DNS_LATENCY_HISTOGRAM "net:dns:hist"
+#define DIAG_NAME_NETWORK_DNS_CACHE_HITS "net:dns:hits"
+#define DIAG_NAME_CLOUD_SESSION_MOVES "cloud:move"
 
 #ifdef __cplusplus
 extern "C" {
@@ -135,15 +160,46 @@ typedef enum diag_id {
     DIAG_ID_SYSTEM_PANIC_PC = 65, // sys:panic:pc
     DIAG_ID_SYSTEM_PANIC_LR = 66, // sys:panic:lr
     DIAG_ID_SYSTEM_PANIC_ASSERTION_STRING = 67, // sys:panic:assert
+    DIAG_ID_CLOUD_COAP_ROUND_TRIP_HISTOGRAM = 68, // coap:roundtrip:hist (milliseconds)
+    DIAG_ID_CLOUD_DTLS_HANDSHAKE_TIME = 69, // cloud:hshake (milliseconds)
+    DIAG_ID_SYSTEM_FS_PROG_TIME = 70, // fs:prog (microseconds)
+    DIAG_ID_SYSTEM_FS_ERASE_TIME = 71, // fs:erase (microseconds)
+    DIAG_ID_CLOUD_DTLS_HANDSHAKES = 72, // cloud:hshakes
+    DIAG_ID_CLOUD_DTLS_SESSION_RESUMPTIONS = 73, // cloud:resumed
+    DIAG_ID_SYSTEM_LOOP_WAKEUPS = 74, // sys:loop:wakeups
+    DIAG_ID_SYSTEM_LOOP_NETWORK_TIME = 75, // sys:loop:net (milliseconds)
+    DIAG_ID_SYSTEM_LOOP_CLOUD_TIME = 76, // sys:loop:cloud (milliseconds)
+    DIAG_ID_SYSTEM_LOOP_SETUP_TIME = 77, // sys:loop:setup (milliseconds)
+    DIAG_ID_SYSTEM_LOOP_OTHER_TIME = 78, // sys:loop:other (milliseconds)
+    DIAG_ID_APP_LOOP_TIME_HISTOGRAM = 79, // app:loop:hist (microseconds)
+    DIAG_ID_APP_LOOP_STALL_HISTOGRAM = 80, // app:stall:hist (microseconds)
+    DIAG_ID_SYSTEM_LOOP_MAX_STALL = 81, // sys:stall:max (microseconds)
+    DIAG_ID_SYSTEM_LOOP_MAX_STALL_SOURCE = 82, // sys:stall:src
+    DIAG_ID_NETWORK_ETHERNET_ROUND_TRIP = 83, // net:eth:rtt (milliseconds)
+    DIAG_ID_NETWORK_ETHERNET_LOSS = 84, // net:eth:loss (per mille)
+    DIAG_ID_NETWORK_WIFI_ROUND_TRIP = 85, // net:wifi:rtt (milliseconds)
+    DIAG_ID_NETWORK_WIFI_LOSS = 86, // net:wifi:loss (per mille)
+    DIAG_ID_NETWORK_CELLULAR_ROUND_TRIP = 87, // net:cell:rtt (milliseconds)
+    DIAG_ID_NETWORK_CELLULAR_LOSS = 88, // net:cell:loss (per mille)
+    DIAG_ID_CLOUD_CONNECTION_FAILOVERS = 89, // cloud:failover
+    DIAG_ID_NETWORK_DNS_LATENCY_HISTOGRAM = 90, // net:dns:hist (milliseconds)
+    DIAG_ID_NETWORK_DNS_CACHE_HITS = 91, // net:dns:hits
+    DIAG_ID_CLOUD_SESSION_MOVES = 92, // cloud:move
     DIAG_ID_USER = 32768 // Base value for application-specific source IDs
 } diag_id;
 
 // Data types
 typedef enum diag_type {
     DIAG_TYPE_INT = 1, // 32-bit signed integer
-    DIAG_TYPE_UINT = 2 // 32-bit unsigned integer
+    DIAG_TYPE_UINT = 2, // 32-bit unsigned integer
+    DIAG_TYPE_HISTOGRAM = 3 // Distribution of 32-bit unsigned samples (see `diag_histogram`)
 } diag_type;
 
+// Number of buckets in a histogram. Bucket 0 counts zero samples, bucket N counts samples in the
+// range [2^(N-1), 2^N), and the last bucket counts all samples greater than or equal to
+// 2^(DIAG_HISTOGRAM_BUCKET_COUNT-2)
+#define DIAG_HISTOGRAM_BUCKET_COUNT 20
+
 // Data source commands
 typedef enum diag_source_cmd {
     DIAG_SOURCE_CMD_GET = 1 // Get current data
@@ -170,6 +226,15 @@ struct diag_source {
     diag_source_cmd_callback callback; // Source callback
 };
 
+// Data of a DIAG_TYPE_HISTOGRAM source
+typedef struct diag_histogram {
+    uint32_t count; // Number of samples
+    uint32_t sum; // Sum of all samples (wraps around on overflow)
+    uint32_t min; // Smallest sample
+    uint32_t max; // Largest sample
+    uint32_t buckets[DIAG_HISTOGRAM_BUCKET_COUNT]; // Sample counts per bucket
+} diag_histogram;
+
 typedef struct diag_source_get_cmd_data {
     uint16_t size; // Size of this structure
     uint16_t reserved; // Reserved (should be set to 0)
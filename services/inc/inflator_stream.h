@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2023 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "hal_platform.h"
+
+#include "stream.h"
+#include "check.h"
+
+#if HAL_PLATFORM_COMPRESSED_OTA
+
+#include "inflate.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace particle {
+
+class InflatorStream: public InputStream {
+public:
+    InflatorStream(InputStream* compressedStream, size_t inflatedSize)
+            : compressedStream_(compressedStream),
+              inflatedSize_(inflatedSize),
+              inflate_(nullptr),
+              inflatedChunk_(nullptr),
+              inflatedChunkSize_(0),
+              posInChunk_(0),
+              offset_(0),
+              segmentOffsets_(nullptr),
+              segmentCount_(0),
+              segmentSize_(0) {
+    }
+
+    int init() {
+        // inflate_ will stay nullptr in case something goes wrong in inflate_create
+        return inflate_create(&inflate_, nullptr, [](const char* data, size_t size, void* ctx) -> int {
+            auto self = static_cast<InflatorStream*>(ctx);
+            return self->inflatedChunk(data, size);
+        }, this);
+    }
+
+    virtual ~InflatorStream() {
+        if (inflate_) {
+            inflate_destroy(inflate_);
+        }
+    }
+
+    /**
+     * Set the restart point index of the compressed data.
+     *
+     * With the index, seeking to any offset decompresses at most one segment of the data instead
+     * of starting over from the beginning of the stream. The array of offsets must remain valid for
+     * the lifetime of the stream.
+     *
+     * @param offsets Offsets of the segments in the compressed stream.
+     * @param count Number of segments.
+     * @param segmentSize Size of a decompressed segment.
+     */
+    int setRestartIndex(const uint32_t* offsets, size_t count, size_t segmentSize) {
+        CHECK_TRUE(offsets && count > 0 && segmentSize > 0 && offsets[0] == 0, SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK_TRUE((count - 1) * segmentSize < inflatedSize_ && count * segmentSize >= inflatedSize_, SYSTEM_ERROR_INVALID_ARGUMENT);
+        segmentOffsets_ = offsets;
+        segmentCount_ = count;
+        segmentSize_ = segmentSize;
+        return 0;
+    }
+
+    int read(char* data, size_t size) override {
+        size = CHECK(peek(data, size));
+        return skip(size);
+    }
+
+    int peek(char* data, size_t size) override {
+        CHECK_TRUE(data, SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(waitEvent(InputStream::READABLE, 0));
+        size = std::min<size_t>(size, availForRead());
+        memcpy(data, inflatedChunk_ + posInChunk_, size);
+        return size;
+    }
+
+    int skip(size_t size) override {
+        size = std::min(size, toInflate());
+        size_t skipped = 0;
+        while (size > 0) {
+            CHECK(waitEvent(InputStream::READABLE, 0));
+            size_t toSkip = std::min<size_t>(size, availForRead());
+            posInChunk_ += toSkip;
+            offset_ += toSkip;
+            size -= toSkip;
+            skipped += toSkip;
+        }
+        return skipped;
+    }
+
+    int seek(size_t offset) override {
+        if (segmentOffsets_ && offset <= inflatedSize_ && !(offset < offset_ && (offset_ - offset) <= posInChunk_)) {
+            const size_t segment = std::min(offset / segmentSize_, segmentCount_ - 1);
+            if (offset < offset_ || segment != offset_ / segmentSize_) {
+                CHECK(restart(segment));
+            }
+            CHECK(skip(offset - offset_));
+            return offset_;
+        }
+        CHECK_TRUE(offset == 0 || (offset >= offset_ && offset <= inflatedSize_) || (offset < offset_ && (offset_ - offset) <= posInChunk_), SYSTEM_ERROR_NOT_ALLOWED);
+        if (offset == 0) {
+            return rewind();
+        } else if (offset >= offset_) {
+            return skip(offset - offset_);
+        } else {
+            auto diff = offset_ - offset;
+            offset_ -= diff;
+            posInChunk_ -= diff;
+            return offset_;
+        }
+    }
+
+    int availForRead() override {
+        return inflatedChunkSize_ - posInChunk_;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        if (!flags) {
+            return 0;
+        }
+        if (!(flags & InputStream::READABLE)) {
+            return SYSTEM_ERROR_INVALID_ARGUMENT;
+        }
+        if (!toInflate()) {
+            return SYSTEM_ERROR_END_OF_STREAM;
+        }
+        if (CHECK(availForRead()) == 0) {
+            CHECK(inflateUntilNextChunk());   
+        }
+        return InputStream::READABLE;
+    }
+
+private:
+    size_t toInflate() {
+        return inflatedSize_ - offset_;
+    }
+
+    int rewind() {
+        return restart(0);
+    }
+
+    int restart(size_t segment) {
+        CHECK_TRUE(inflate_ && compressedStream_, SYSTEM_ERROR_INVALID_STATE);
+        CHECK(inflate_reset(inflate_));
+        CHECK(compressedStream_->seek(segment ? segmentOffsets_[segment] : 0));
+        offset_ = segment * segmentSize_;
+        posInChunk_ = 0;
+        inflatedChunkSize_ = 0;
+        inflatedChunk_ = nullptr;
+        return offset_;
+    }
+
+    int inflateUntilNextChunk() {
+        CHECK_TRUE(inflate_ && compressedStream_, SYSTEM_ERROR_INVALID_STATE);
+
+        char tmp[256];
+
+        while (true) {
+            size_t compressedChunk = 0;
+            if (compressedStream_->waitEvent(InputStream::READABLE) == InputStream::READABLE) {
+                compressedChunk = CHECK(compressedStream_->peek(tmp, sizeof(tmp)));
+            }
+            size_t compressedPos = 0;
+            int r = 0;
+            do {
+                size_t n = compressedChunk - compressedPos;
+                r = inflate_input(inflate_, tmp + compressedPos, &n, INFLATE_HAS_MORE_INPUT);
+                CHECK(r);
+                compressedPos += n;
+                compressedStream_->skip(n);
+                if (n == 0 && availForRead() <= 0) {
+                    break;
+                }
+            } while (compressedPos < compressedChunk && r != INFLATE_HAS_MORE_OUTPUT);
+            if (r == INFLATE_HAS_MORE_OUTPUT && availForRead() > 0) {
+                break;
+            }
+        }
+        return availForRead();
+    }
+
+    int inflatedChunk(const char* data, size_t size) {
+        if (availForRead() == 0 && inflatedChunk_ && posInChunk_ > 0 && posInChunk_ == size) {
+            // Acknowledge inflated chunk as consumed
+            inflatedChunk_ = nullptr;
+            posInChunk_ = 0;
+            inflatedChunkSize_ = 0;
+            return size;
+        }
+        inflatedChunkSize_ = size;
+        inflatedChunk_ = data;
+        posInChunk_ = 0;
+        return 0;
+    }
+
+private:
+    InputStream* compressedStream_;
+    size_t inflatedSize_;
+    inflate_ctx* inflate_;
+    const char* inflatedChunk_;
+    size_t inflatedChunkSize_;
+    size_t posInChunk_;
+    size_t offset_;
+    const uint32_t* segmentOffsets_;
+    size_t segmentCount_;
+    size_t segmentSize_;
+};
+
+} // particle
+
+#endif // HAL_PLATFORM_COMPRESSED_OTA
@@ -29,7 +29,7 @@
 #endif // HAL_PLATFORM_FILESYSTEM
 #include <memory>
 #if HAL_PLATFORM_COMPRESSED_OTA
-#include "inflate.h"
+#include "inflator_stream.h"
 #endif // HAL_PLATFORM_COMPRESSED_OTA
 
 namespace particle {
@@ -226,165 +226,6 @@ private:
 
 #endif // HAL_PLATFORM_FILESYSTEM
 
-#if HAL_PLATFORM_COMPRESSED_OTA
-class InflatorStream: public InputStream {
-public:
-    InflatorStream(InputStream* compressedStream, size_t inflatedSize)
-            : compressedStream_(compressedStream),
-              inflatedSize_(inflatedSize),
-              inflate_(nullptr),
-              inflatedChunk_(nullptr),
-              inflatedChunkSize_(0),
-              posInChunk_(0),
-              offset_(0) {
-    }
-
-    int init() {
-        // inflate_ will stay nullptr in case something goes wrong in inflate_create
-        return inflate_create(&inflate_, nullptr, [](const char* data, size_t size, void* ctx) -> int {
-            auto self = static_cast<InflatorStream*>(ctx);
-            return self->inflatedChunk(data, size);
-        }, this);
-    }
-
-    virtual ~InflatorStream() {
-        if (inflate_) {
-            inflate_destroy(inflate_);
-        }
-    }
-
-    int read(char* data, size_t size) override {
-        size = CHECK(peek(data, size));
-        return skip(size);
-    }
-
-    int peek(char* data, size_t size) override {
-        CHECK_TRUE(data, SYSTEM_ERROR_INVALID_ARGUMENT);
-        CHECK(waitEvent(InputStream::READABLE, 0));
-        size = std::min<size_t>(size, availForRead());
-        memcpy(data, inflatedChunk_ + posInChunk_, size);
-        return size;
-    }
-
-    int skip(size_t size) override {
-        size = std::min(size, toInflate());
-        size_t skipped = 0;
-        while (size > 0) {
-            CHECK(waitEvent(InputStream::READABLE, 0));
-            size_t toSkip = std::min<size_t>(size, availForRead());
-            posInChunk_ += toSkip;
-            offset_ += toSkip;
-            size -= toSkip;
-            skipped += toSkip;
-        }
-        return skipped;
-    }
-
-    int seek(size_t offset) override {
-        CHECK_TRUE(offset == 0 || (offset >= offset_ && offset <= inflatedSize_) || (offset < offset_ && (offset_ - offset) <= posInChunk_), SYSTEM_ERROR_NOT_ALLOWED);
-        if (offset == 0) {
-            return rewind();
-        } else if (offset >= offset_) {
-            return skip(offset - offset_);
-        } else {
-            auto diff = offset_ - offset;
-            offset_ -= diff;
-            posInChunk_ -= diff;
-            return offset_;
-        }
-    }
-
-    int availForRead() override {
-        return inflatedChunkSize_ - posInChunk_;
-    }
-
-    int waitEvent(unsigned flags, unsigned timeout) override {
-        if (!flags) {
-            return 0;
-        }
-        if (!(flags & InputStream::READABLE)) {
-            return SYSTEM_ERROR_INVALID_ARGUMENT;
-        }
-        if (!toInflate()) {
-            return SYSTEM_ERROR_END_OF_STREAM;
-        }
-        if (CHECK(availForRead()) == 0) {
-            CHECK(inflateUntilNextChunk());   
-        }
-        return InputStream::READABLE;
-    }
-
-private:
-    size_t toInflate() {
-        return inflatedSize_ - offset_;
-    }
-
-    int rewind() {
-        CHECK_TRUE(inflate_ && compressedStream_, SYSTEM_ERROR_INVALID_STATE);
-        CHECK(inflate_reset(inflate_));
-        CHECK(compressedStream_->seek(0));
-        offset_ = 0;
-        posInChunk_ = 0;
-        inflatedChunkSize_ = 0;
-        inflatedChunk_ = nullptr;
-        return 0;
-    }
-
-    int inflateUntilNextChunk() {
-        CHECK_TRUE(inflate_ && compressedStream_, SYSTEM_ERROR_INVALID_STATE);
-
-        char tmp[256];
-
-        while (true) {
-            size_t compressedChunk = 0;
-            if (compressedStream_->waitEvent(InputStream::READABLE) == InputStream::READABLE) {
-                compressedChunk = CHECK(compressedStream_->peek(tmp, sizeof(tmp)));
-            }
-            size_t compressedPos = 0;
-            int r = 0;
-            do {
-                size_t n = compressedChunk - compressedPos;
-                r = inflate_input(inflate_, tmp + compressedPos, &n, INFLATE_HAS_MORE_INPUT);
-                CHECK(r);
-                compressedPos += n;
-                compressedStream_->skip(n);
-                if (n == 0 && availForRead() <= 0) {
-                    break;
-                }
-            } while (compressedPos < compressedChunk && r != INFLATE_HAS_MORE_OUTPUT);
-            if (r == INFLATE_HAS_MORE_OUTPUT && availForRead() > 0) {
-                break;
-            }
-        }
-        return availForRead();
-    }
-
-    int inflatedChunk(const char* data, size_t size) {
-        if (availForRead() == 0 && inflatedChunk_ && posInChunk_ > 0 && posInChunk_ == size) {
-            // Acknowledge inflated chunk as consumed
-            inflatedChunk_ = nullptr;
-            posInChunk_ = 0;
-            inflatedChunkSize_ = 0;
-            return size;
-        }
-        inflatedChunkSize_ = size;
-        inflatedChunk_ = data;
-        posInChunk_ = 0;
-        return 0;
-    }
-
-private:
-    InputStream* compressedStream_;
-    size_t inflatedSize_;
-    inflate_ctx* inflate_;
-    const char* inflatedChunk_;
-    size_t inflatedChunkSize_;
-    size_t posInChunk_;
-    size_t offset_;
-};
-
-#endif // HAL_PLATFORM_COMPRESSED_OTA
-
 class ProxyInputStream : public InputStream {
 public:
     ProxyInputStream(InputStream* stream, size_t offset, size_t size)
@@ -28,6 +28,7 @@ enum class SystemCacheKey : uint16_t {
     WIZNET_CONFIG_DATA = 0x0003,
     CELLULAR_NCP_OPERATION_MODE = 0x0004,
     CELLULAR_DEVICE_INFO = 0x0005,
+    MODULE_INTEGRITY = 0x0006,
     ASSET_MANAGER_CONSUMER_STATE = 0x0010,
 };
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file trace_marker.h
+ *
+ * Scoped trace markers.
+ *
+ * A trace marker records the time spent in a block of code:
+ * ```
+ * int Protocol::handleMessage(Message& msg) {
+ *     PARTICLE_TRACE_SCOPE("protocol:handle");
+ *     ...
+ * }
+ * ```
+ * Markers are only compiled in if `PARTICLE_TRACE_MARKERS` is defined to 1, which is currently
+ * the case for the gcc platform only. There, the recorded events can be written to a file in the
+ * Chrome trace event format (see the `--trace` option of the virtual device). On all other
+ * platforms the macros expand to nothing.
+ *
+ * Marker names must be string literals or otherwise have static storage duration.
+ */
+
+#pragma once
+
+#include "preprocessor.h"
+
+#ifndef PARTICLE_TRACE_MARKERS
+#define PARTICLE_TRACE_MARKERS 0
+#endif
+
+#if PARTICLE_TRACE_MARKERS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// These functions are implemented by the platform
+void trace_marker_begin(const char* name, void* reserved);
+void trace_marker_end(const char* name, void* reserved);
+
+#ifdef __cplusplus
+} // extern "C"
+
+namespace particle {
+
+class TraceMarkerScope {
+public:
+    explicit TraceMarkerScope(const char* name) :
+            name_(name) {
+        trace_marker_begin(name_, nullptr);
+    }
+
+    ~TraceMarkerScope() {
+        trace_marker_end(name_, nullptr);
+    }
+
+    TraceMarkerScope(const TraceMarkerScope&) = delete;
+    TraceMarkerScope& operator=(const TraceMarkerScope&) = delete;
+
+private:
+    const char* name_;
+};
+
+} // namespace particle
+
+#define PARTICLE_TRACE_SCOPE(_name) \
+        ::particle::TraceMarkerScope PP_CAT(_particle_trace_scope_, __LINE__)(_name)
+
+#endif // defined(__cplusplus)
+
+#define PARTICLE_TRACE_BEGIN(_name) \
+        trace_marker_begin(_name, NULL)
+
+#define PARTICLE_TRACE_END(_name) \
+        trace_marker_end(_name, NULL)
+
+#else // !PARTICLE_TRACE_MARKERS
+
+#define PARTICLE_TRACE_SCOPE(_name) \
+        do { } while (false)
+
+#define PARTICLE_TRACE_BEGIN(_name) \
+        do { } while (0)
+
+#define PARTICLE_TRACE_END(_name) \
+        do { } while (0)
+
+#endif // !PARTICLE_TRACE_MARKERS
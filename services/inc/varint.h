@@ -85,8 +85,8 @@ inline int decodeUnsignedVarint(const char* buf, size_t size, T* val) {
         } else {
             b &= 0x7f;
         }
-        // Make sure the value fits into the destination variable
-        if (val && sizeof(unsigned) * 8 - __builtin_clz(b) > sizeof(T) * 8 - bits) {
+        // Make sure the value fits into the destination variable. __builtin_clz() is undefined for 0
+        if (val && b && sizeof(unsigned) * 8 - __builtin_clz(b) > sizeof(T) * 8 - bits) {
             return SYSTEM_ERROR_TOO_LARGE;
         }
         v |= (T)b << bits;
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "crc32.h"
+
+#include "endian_util.h"
+
+#include <cstring>
+
+namespace particle {
+
+namespace {
+
+static_assert(PARTICLE_LITTLE_ENDIAN, "This code is optimized for little-endian architectures");
+
+const uint32_t CRC32_POLYNOMIAL = 0xedb88320; // Reversed
+
+struct Crc32Tables {
+    // Table k contains the CRC of a byte followed by k zero bytes
+    uint32_t t[8][256];
+
+    constexpr Crc32Tables() :
+            t() {
+        for (unsigned i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (unsigned j = 0; j < 8; ++j) {
+                c = (c & 1) ? (c >> 1) ^ CRC32_POLYNOMIAL : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (unsigned i = 0; i < 256; ++i) {
+            for (unsigned k = 1; k < 8; ++k) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+            }
+        }
+    }
+};
+
+// Generated at compile time so that the tables are placed in flash
+constexpr Crc32Tables CRC32_TABLES;
+
+inline uint32_t updateCrc32(uint32_t crc, uint8_t b) {
+    return CRC32_TABLES.t[0][(crc ^ b) & 0xff] ^ (crc >> 8);
+}
+
+} // namespace
+
+uint32_t computeCrc32(const void* data, size_t size, uint32_t crc) {
+    const auto& t = CRC32_TABLES.t;
+    auto p = (const uint8_t*)data;
+    crc = ~crc;
+    // Process the leading bytes up to an aligned address
+    while (size > 0 && ((uintptr_t)p & 3)) {
+        crc = updateCrc32(crc, *p++);
+        --size;
+    }
+    while (size >= 8) {
+        uint32_t w1 = 0;
+        uint32_t w2 = 0;
+        memcpy(&w1, p, 4);
+        memcpy(&w2, p + 4, 4);
+        w1 ^= crc;
+        crc = t[7][w1 & 0xff] ^ t[6][(w1 >> 8) & 0xff] ^ t[5][(w1 >> 16) & 0xff] ^ t[4][w1 >> 24] ^
+                t[3][w2 & 0xff] ^ t[2][(w2 >> 8) & 0xff] ^ t[1][(w2 >> 16) & 0xff] ^ t[0][w2 >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size > 0) {
+        crc = updateCrc32(crc, *p++);
+        --size;
+    }
+    return ~crc;
+}
+
+} // namespace particle
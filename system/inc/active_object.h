@@ -264,6 +264,13 @@ public:
         return started;
     }
 
+    /**
+     * Set the time to wait for a message before running the background task.
+     */
+    void setTakeWait(unsigned timeout) {
+        configuration.take_wait = timeout;
+    }
+
     template<typename R> bool invoke_async(const std::function<R(void)>& work, bool dontBlock = false)
     {
         auto task = new AsyncTask<R>(work);
@@ -324,6 +331,21 @@ public:
     {
         createQueue();
     }
+
+    /**
+     * Wake up the message pump so that the background task runs without waiting for the take
+     * timeout to expire. This method can be called from an ISR.
+     *
+     * Each call posts an empty message to the queue, so the caller should avoid posting another
+     * one before the background task has run.
+     */
+    void wakeup()
+    {
+        if (queue) {
+            Item item = nullptr;
+            put(item, true /* dontBlock */);
+        }
+    }
 };
 
 
@@ -389,6 +411,15 @@ public:
             os_thread_notify(_thread, nullptr);
         }
     }
+
+    /**
+     * Wake up the message pump. Unlike `ActiveObjectQueue::wakeup()`, this method doesn't use
+     * a slot in the message queue.
+     */
+    void wakeup()
+    {
+        notify();
+    }
 #endif // HAL_PLATFORM_SOCKET_IOCTL_NOTIFY
 
     void start()
@@ -428,9 +459,16 @@ public:
         Task& operator=(const Task&) = delete;
     };
 
-    ISRTaskQueue() :
+    /**
+     * Function called when a task is added to the queue. It is called from the context of the
+     * enqueueing code, which may be an ISR.
+     */
+    typedef void(*NotifyFunc)();
+
+    explicit ISRTaskQueue(NotifyFunc notify = nullptr) :
             firstTask_(nullptr),
-            lastTask_(nullptr) {
+            lastTask_(nullptr),
+            notify_(notify) {
     }
 
     /**
@@ -454,7 +492,15 @@ public:
      */
     bool process();
 
+    /**
+     * Check if the queue has tasks pending.
+     */
+    bool hasTasks() const {
+        return firstTask_;
+    }
+
 private:
     Task* volatile firstTask_;
     Task* lastTask_;
+    NotifyFunc notify_;
 };
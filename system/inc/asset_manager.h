@@ -105,6 +105,7 @@ public:
 
 private:
     int calculateCrc(uint32_t* crc);
+    int readRestartIndex(const compressed_module_header& header);
 
 private:
     InputStream* stream_;
@@ -120,6 +121,10 @@ private:
 
     size_t dataOffset_;
     size_t dataSize_;
+
+    std::unique_ptr<uint32_t[]> segmentOffsets_;
+    size_t segmentCount_;
+    size_t segmentSize_;
 };
 
 class AssetManager {
@@ -55,6 +55,10 @@ DYNALIB_FN(19, system_net, network_get_configuration, int(network_handle_t, netw
 DYNALIB_FN(20, system_net, network_free_configuration, int(network_configuration_t*, size_t, void*))
 DYNALIB_FN(21, system_net, network_prefer, network_handle_t(network_handle_t, bool, void*))
 DYNALIB_FN(22, system_net, network_is_preferred, bool(network_handle_t, void*))
+DYNALIB_FN(23, system_net, network_redundant, network_handle_t(network_handle_t, bool, void*))
+DYNALIB_FN(24, system_net, network_is_redundant, bool(network_handle_t, void*))
+DYNALIB_FN(25, system_net, network_resolve, int(network_handle_t, const char*, HAL_IPAddress*, size_t, unsigned, void*))
+DYNALIB_FN(26, system_net, network_resolve_async, int(network_handle_t, const char*, unsigned, completion_callback, void*, void*))
 
 DYNALIB_END(system_net)
 
@@ -29,6 +29,7 @@
 #include "spark_macros.h"
 #include "system_defs.h"
 #include "system_network_configuration.h"
+#include "completion_handler.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +58,11 @@ typedef enum network_state_param {
     NETWORK_STATE_PARAM_UNBLOCK = 2,
 } network_state_param;
 
+typedef enum network_resolve_flag {
+    NETWORK_RESOLVE_FLAG_NONE = 0,
+    NETWORK_RESOLVE_FLAG_FLUSH_CACHE = 1 // Bypass the cached results
+} network_resolve_flag;
+
 /**
  * This is a bridge from the wiring layer to the system layer.
  * @return
@@ -76,6 +82,47 @@ bool network_is_off(network_handle_t network, void* reserved);
 int network_connect_cancel(network_handle_t network, uint32_t flags, uint32_t param1, void* reserved);
 network_handle_t network_prefer(network_handle_t network, bool prefer, void* reserved);
 bool network_is_preferred(network_handle_t network, void* reserved); 
+network_handle_t network_redundant(network_handle_t network, bool redundant, void* reserved);
+bool network_is_redundant(network_handle_t network, void* reserved);
+
+/**
+ * Resolve a host name.
+ *
+ * The results are cached and shared with the other users of the resolver. The resolver doesn't
+ * get the time-to-live of the DNS records, so a resolved name is cached for 60 seconds and a name
+ * that doesn't resolve for 10 seconds, both limited by SYSTEM_RESOLVER_CACHE_MAX_TTL (10 minutes
+ * by default, 0 disables the cache). Use NETWORK_RESOLVE_FLAG_FLUSH_CACHE to bypass the cache.
+ *
+ * Lookups that are not bound to an interface fail with SYSTEM_ERROR_TIMEOUT if they don't
+ * complete within 30 seconds.
+ *
+ * @param network   network interface or NETWORK_INTERFACE_ALL
+ * @param name      host name
+ * @param addrs     resolved addresses that are usable on the network
+ * @param count     maximum number of addresses to return
+ * @param flags     flags (see network_resolve_flag)
+ * @param reserved  reserved argument (should be set to NULL)
+ * @return          number of addresses or a negative error code
+ */
+int network_resolve(network_handle_t network, const char* name, HAL_IPAddress* addrs, size_t count, unsigned flags, void* reserved);
+
+/**
+ * Start resolving a host name without blocking the calling thread.
+ *
+ * On success, the `data` argument of the callback points to the first resolved address
+ * (HAL_IPAddress). The callback is invoked synchronously if the name is cached, and from the
+ * system thread otherwise.
+ *
+ * @param network       network interface or NETWORK_INTERFACE_ALL
+ * @param name          host name
+ * @param flags         flags (see network_resolve_flag)
+ * @param callback      completion callback
+ * @param callback_data user argument passed to the callback
+ * @param reserved      reserved argument (should be set to NULL)
+ * @return              0 if the callback will be invoked, or a negative error code otherwise
+ */
+int network_resolve_async(network_handle_t network, const char* name, unsigned flags, completion_callback callback,
+        void* callback_data, void* reserved);
 
 #define NETWORK_LISTEN_EXIT (1<<0)
 /**
@@ -101,6 +101,12 @@ uint8_t application_thread_invoke(void (*callback)(void* data), void* data, void
  */
 void cancel_connection();
 
+/**
+ * Wakes up the system loop so that pending events are processed without waiting for the next
+ * polling period. This function can be called from an ISR.
+ */
+void system_loop_wakeup();
+
 /**
  * Allocates memory from a pool designed for small and short-lived allocations. This function can
  * be called from an ISR.
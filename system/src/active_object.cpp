@@ -86,6 +86,9 @@ void ISRTaskQueue::enqueue(Task* task) {
         task->prev = lastTask_;
         lastTask_ = task;
     }
+    if (notify_) {
+        notify_();
+    }
 }
 
 void ISRTaskQueue::remove(Task* task) {
@@ -419,7 +419,9 @@ AssetReader::AssetReader()
           size_(0),
           originalSize_(0),
           dataOffset_(0),
-          dataSize_(0) {
+          dataSize_(0),
+          segmentCount_(0),
+          segmentSize_(0) {
 }
 
 int AssetReader::init(const char* filename) {
@@ -460,6 +462,7 @@ int AssetReader::validate(bool full) {
         CHECK_TRUE(compHeader.size >= sizeof(compHeader), SYSTEM_ERROR_BAD_DATA);
         CHECK_TRUE(compHeader.method == 0, SYSTEM_ERROR_BAD_DATA);
         origSize = compHeader.original_size;
+        CHECK(readRestartIndex(compHeader));
     }
     // Base suffix
     CHECK(stream_->seek(0));
@@ -489,12 +492,42 @@ int AssetReader::validate(bool full) {
         dataOffset_ = sizeof(module_info_t) + compHeader.size;
     }
     dataSize_ = moduleSize - suffix.size - sizeof(uint32_t) - dataOffset_;
+    for (size_t i = 0; i < segmentCount_; ++i) {
+        CHECK_TRUE(segmentOffsets_[i] < dataSize_ && (i == 0 || segmentOffsets_[i] > segmentOffsets_[i - 1]), SYSTEM_ERROR_BAD_DATA);
+    }
     size_ = moduleSize;
     originalSize_ = compressed ? origSize : (moduleSize - sizeof(module_info_t) - sizeof(uint32_t) - suffix.size);
     asset_ = Asset(asset.name(), asset.hash(), originalSize_, moduleSize);
     return 0;
 }
 
+int AssetReader::readRestartIndex(const compressed_module_header& header) {
+    segmentOffsets_.reset();
+    segmentCount_ = 0;
+    segmentSize_ = 0;
+    if (header.size < sizeof(header) + sizeof(compressed_module_index)) {
+        return 0;
+    }
+    compressed_module_index index = {};
+    CHECK(stream_->skipAll(sizeof(header)));
+    CHECK(stream_->readAll((char*)&index, sizeof(index)));
+    if (index.magic != COMPRESSED_MODULE_INDEX_MAGIC) {
+        return 0;
+    }
+    CHECK_TRUE(index.segment_count > 0 && index.segment_size > 0, SYSTEM_ERROR_BAD_DATA);
+    CHECK_TRUE(index.segment_count <= (header.size - sizeof(header) - sizeof(index)) / sizeof(uint32_t), SYSTEM_ERROR_BAD_DATA);
+    CHECK_TRUE((uint64_t)(index.segment_count - 1) * index.segment_size < header.original_size &&
+            (uint64_t)index.segment_count * index.segment_size >= header.original_size, SYSTEM_ERROR_BAD_DATA);
+    std::unique_ptr<uint32_t[]> offsets(new(std::nothrow) uint32_t[index.segment_count]);
+    CHECK_TRUE(offsets, SYSTEM_ERROR_NO_MEMORY);
+    CHECK(stream_->readAll((char*)offsets.get(), index.segment_count * sizeof(uint32_t)));
+    CHECK_TRUE(offsets[0] == 0, SYSTEM_ERROR_BAD_DATA);
+    segmentOffsets_ = std::move(offsets);
+    segmentCount_ = index.segment_count;
+    segmentSize_ = index.segment_size;
+    return 0;
+}
+
 int AssetReader::calculateCrc(uint32_t* crc) {
     size_t toRead = stream_->availForRead() - sizeof(uint32_t);
     char tmp[256];
@@ -546,6 +579,9 @@ int AssetReader::assetStream(InputStream*& stream) {
         auto stream = std::make_unique<InflatorStream>(proxyStream_.get(), originalSize_);
         CHECK_TRUE(stream, SYSTEM_ERROR_NO_MEMORY);
         CHECK(stream->init());
+        if (segmentOffsets_) {
+            CHECK(stream->setRestartIndex(segmentOffsets_.get(), segmentCount_, segmentSize_));
+        }
         decompressorStream_ = std::move(stream);
     }
 
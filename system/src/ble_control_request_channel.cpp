@@ -731,7 +731,7 @@ int BleControlRequestChannel::allocReplyData(ctrl_request* ctrlReq, size_t size)
 
 void BleControlRequestChannel::freeRequestData(ctrl_request* ctrlReq) {
     const auto req = static_cast<Request*>(ctrlReq);
-    delete[] req->reqBuf;
+    bufPool_.freeBuffer(req->reqBuf);
     req->reqBuf = nullptr;
     req->request_data = nullptr;
     req->request_size = 0;
@@ -1148,7 +1148,8 @@ int BleControlRequestChannel::allocRequest(size_t size, Request** req) {
     if (!r) {
         return SYSTEM_ERROR_NO_MEMORY;
     }
-    r->reqBuf = new(std::nothrow) char[size + MESSAGE_HEADER_SIZE + REQUEST_HEADER_SIZE + MESSAGE_FOOTER_SIZE];
+    // Request buffers are reused across requests
+    r->reqBuf = bufPool_.allocBuffer(size + MESSAGE_HEADER_SIZE + REQUEST_HEADER_SIZE + MESSAGE_FOOTER_SIZE);
     if (!r->reqBuf) {
         return SYSTEM_ERROR_NO_MEMORY;
     }
@@ -1173,7 +1174,7 @@ void BleControlRequestChannel::freeRequest(Request* req) {
     const auto handler = req->handler;
     const auto handlerData = req->handlerData;
     freeBuffer(req->repBuf);
-    delete[] req->reqBuf;
+    bufPool_.freeBuffer(req->reqBuf);
     delete req;
 #if BLE_CHANNEL_DEBUG_ENABLED
     const auto count = --allocReqCount_;
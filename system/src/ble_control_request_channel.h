@@ -22,6 +22,7 @@
 #if SYSTEM_CONTROL_ENABLED && HAL_PLATFORM_BLE_SETUP
 
 #include "control_request_handler.h"
+#include "control_buffer_pool.h"
 #include "simple_pool_allocator.h"
 
 #include "intrusive_queue.h"
@@ -118,6 +119,7 @@ private:
     std::unique_ptr<JpakeHandler> jpake_; // J-PAKE handshake handler
 #endif
     AtomicAllocedPool pool_; // Pool allocator
+    ControlBufferPool bufPool_; // Pool of request buffers
 
     hal_ble_conn_handle_t connHandle_; // Connection handle used by the processing thread
     volatile hal_ble_conn_handle_t curConnHandle_; // Current connection handle
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "diagnostics.h"
+
+#if SYSTEM_CONTROL_ENABLED
+
+#include "system_info.h"
+#include "system_error.h"
+#include "appender.h"
+
+#include <memory>
+#include <new>
+#include <cstring>
+
+namespace particle {
+
+namespace ctrl {
+
+namespace diagnostics {
+
+namespace {
+
+// Formatting flags of system_format_diag_data(). The binary format has no encoding for histograms
+const unsigned DIAG_FORMAT_JSON = 0;
+
+} // namespace
+
+int getDiagnosticInfo(ctrl_request* req) {
+    if (req->request_size % sizeof(uint16_t) != 0) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const size_t count = req->request_size / sizeof(uint16_t);
+    std::unique_ptr<uint16_t[]> ids;
+    if (count > 0) {
+        // The request data is not necessarily aligned
+        ids.reset(new(std::nothrow) uint16_t[count]);
+        if (!ids) {
+            return SYSTEM_ERROR_NO_MEMORY;
+        }
+        memcpy(ids.get(), req->request_data, count * sizeof(uint16_t));
+    }
+    size_t bufSize = 128; // Initial size of the reply buffer
+    for (;;) {
+        int ret = system_ctrl_alloc_reply_data(req, bufSize, nullptr);
+        if (ret != 0) {
+            system_ctrl_alloc_reply_data(req, 0, nullptr);
+            return ret;
+        }
+        BufferAppender appender(req->reply_data, bufSize);
+        ret = system_format_diag_data(ids.get(), count, DIAG_FORMAT_JSON, Appender::callback, &appender, nullptr);
+        if (ret != 0) {
+            system_ctrl_alloc_reply_data(req, 0, nullptr);
+            return ret;
+        }
+        const size_t size = appender.dataSize();
+        if (size > bufSize) {
+            // Increase the buffer size and format the data once again
+            bufSize = size + size / 16;
+            continue;
+        }
+        req->reply_size = size;
+        return 0;
+    }
+}
+
+} // particle::ctrl::diagnostics
+
+} // particle::ctrl
+
+} // particle
+
+#endif // SYSTEM_CONTROL_ENABLED
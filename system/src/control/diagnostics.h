@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "system_control.h"
+
+namespace particle {
+
+namespace ctrl {
+
+namespace diagnostics {
+
+/**
+ * Handle a `CTRL_REQUEST_DIAGNOSTIC_INFO` request.
+ *
+ * The request data is either empty or an array of 16-bit IDs of the data sources to query. The
+ * reply is a JSON document, which is the only format that includes the histogram data sources,
+ * such as the application loop timing histograms.
+ */
+int getDiagnosticInfo(ctrl_request* req);
+
+} // particle::ctrl::diagnostics
+
+} // particle::ctrl
+
+} // particle
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "control_buffer_pool.h"
+
+#include "atomic_section.h"
+#include "test_malloc.h"
+
+#include <cstring>
+
+namespace particle {
+
+namespace {
+
+// Buffer capacities of the size classes
+const size_t SIZE_CLASSES[CONTROL_BUFFER_POOL_SIZE_CLASS_COUNT] = { 64, 256, 1024, 4096 };
+
+} // namespace
+
+ControlBufferPool::ControlBufferPool(size_t maxCachedSize) :
+        free_(),
+        cachedSize_(0),
+        maxCachedSize_(maxCachedSize),
+        heapAllocCount_(0),
+        reuseCount_(0) {
+}
+
+ControlBufferPool::~ControlBufferPool() {
+    clear();
+}
+
+char* ControlBufferPool::allocBuffer(size_t size) {
+    const int cls = sizeClass(size);
+    Block* b = nullptr;
+    if (cls >= 0) {
+        ATOMIC_BLOCK() {
+            b = free_[cls];
+            if (b) {
+                free_[cls] = b->next;
+                cachedSize_ -= b->capacity;
+                ++reuseCount_;
+            }
+        }
+    }
+    if (!b) {
+        const size_t capacity = (cls >= 0) ? SIZE_CLASSES[cls] : size;
+        b = (Block*)t_malloc(sizeof(Block) + capacity);
+        if (!b) {
+            return nullptr;
+        }
+        b->capacity = capacity;
+        ATOMIC_BLOCK() {
+            ++heapAllocCount_;
+        }
+    }
+    b->next = nullptr;
+    return (char*)(b + 1);
+}
+
+char* ControlBufferPool::reallocBuffer(char* buf, size_t size) {
+    if (!buf) {
+        return (size > 0) ? allocBuffer(size) : nullptr;
+    }
+    if (size == 0) {
+        freeBuffer(buf);
+        return nullptr;
+    }
+    const size_t oldCapacity = capacity(buf);
+    if (oldCapacity >= size) {
+        return buf;
+    }
+    const auto newBuf = allocBuffer(size);
+    if (!newBuf) {
+        return nullptr;
+    }
+    memcpy(newBuf, buf, oldCapacity);
+    freeBuffer(buf);
+    return newBuf;
+}
+
+void ControlBufferPool::freeBuffer(char* buf) {
+    if (!buf) {
+        return;
+    }
+    auto b = (Block*)buf - 1;
+    const int cls = sizeClass(b->capacity);
+    if (cls >= 0 && SIZE_CLASSES[cls] == b->capacity) {
+        ATOMIC_BLOCK() {
+            if (cachedSize_ + b->capacity <= maxCachedSize_) {
+                b->next = free_[cls];
+                free_[cls] = b;
+                cachedSize_ += b->capacity;
+                b = nullptr;
+            }
+        }
+    }
+    t_free(b);
+}
+
+void ControlBufferPool::clear() {
+    for (size_t i = 0; i < CONTROL_BUFFER_POOL_SIZE_CLASS_COUNT; ++i) {
+        Block* b = nullptr;
+        ATOMIC_BLOCK() {
+            b = free_[i];
+            free_[i] = nullptr;
+            for (auto p = b; p; p = p->next) {
+                cachedSize_ -= p->capacity;
+            }
+        }
+        while (b) {
+            const auto next = b->next;
+            t_free(b);
+            b = next;
+        }
+    }
+}
+
+size_t ControlBufferPool::capacity(const char* buf) {
+    return ((const Block*)buf - 1)->capacity;
+}
+
+size_t ControlBufferPool::blockSize(size_t size) {
+    const int cls = sizeClass(size);
+    return sizeof(Block) + ((cls >= 0) ? SIZE_CLASSES[cls] : size);
+}
+
+int ControlBufferPool::sizeClass(size_t size) {
+    for (size_t i = 0; i < CONTROL_BUFFER_POOL_SIZE_CLASS_COUNT; ++i) {
+        if (size <= SIZE_CLASSES[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // namespace particle
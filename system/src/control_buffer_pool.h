@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace particle {
+
+// Number of buffer size classes
+const size_t CONTROL_BUFFER_POOL_SIZE_CLASS_COUNT = 4;
+
+// Maximum total size of the free buffers kept by a pool for reuse
+const size_t CONTROL_BUFFER_POOL_MAX_CACHED_SIZE = 4096;
+
+/**
+ * Allocator for the request and reply buffers of the control request channels.
+ *
+ * Buffers are allocated on the heap in a few size classes. When a buffer is freed, it is kept
+ * in a per-class free list as long as the total size of the free buffers doesn't exceed the
+ * limit, so that a stream of requests of similar sizes is served without touching the heap.
+ * Buffers larger than the largest size class are allocated and freed directly.
+ *
+ * The free lists are protected with an atomic section, so buffers can be freed from any thread.
+ * Heap allocations are never made from an atomic section.
+ */
+class ControlBufferPool {
+public:
+    explicit ControlBufferPool(size_t maxCachedSize = CONTROL_BUFFER_POOL_MAX_CACHED_SIZE);
+    ~ControlBufferPool();
+
+    /**
+     * Allocate a buffer.
+     *
+     * @param size Buffer size.
+     * @return Buffer or `nullptr` if the memory cannot be allocated.
+     */
+    char* allocBuffer(size_t size);
+
+    /**
+     * Resize a buffer.
+     *
+     * The buffer is returned as is if its capacity is sufficient. Otherwise, the contents of the
+     * buffer are moved to a larger one. If the memory cannot be allocated, the original buffer is
+     * left intact.
+     *
+     * @param buf Buffer or `nullptr`.
+     * @param size New size. If 0, the buffer is freed.
+     * @return Buffer or `nullptr`.
+     */
+    char* reallocBuffer(char* buf, size_t size);
+
+    /**
+     * Free a buffer.
+     *
+     * @param buf Buffer or `nullptr`.
+     */
+    void freeBuffer(char* buf);
+
+    /**
+     * Release all free buffers to the heap.
+     */
+    void clear();
+
+    /**
+     * Get the number of heap allocations made by the pool.
+     */
+    unsigned heapAllocCount() const {
+        return heapAllocCount_;
+    }
+
+    /**
+     * Get the number of allocations served from the free lists.
+     */
+    unsigned reuseCount() const {
+        return reuseCount_;
+    }
+
+    /**
+     * Get the total size of the free buffers.
+     */
+    size_t cachedSize() const {
+        return cachedSize_;
+    }
+
+    /**
+     * Get the capacity of a buffer.
+     */
+    static size_t capacity(const char* buf);
+
+    /**
+     * Get the size of the heap block allocated for a buffer of the given size.
+     */
+    static size_t blockSize(size_t size);
+
+    // This class is non-copyable
+    ControlBufferPool(const ControlBufferPool&) = delete;
+    ControlBufferPool& operator=(const ControlBufferPool&) = delete;
+
+private:
+    struct alignas(alignof(std::max_align_t)) Block {
+        Block* next; // Next free block
+        size_t capacity; // Buffer capacity
+    };
+
+    Block* free_[CONTROL_BUFFER_POOL_SIZE_CLASS_COUNT]; // Free lists
+    size_t cachedSize_; // Total size of the free buffers
+    size_t maxCachedSize_; // Maximum total size of the free buffers
+    unsigned heapAllocCount_; // Number of heap allocations
+    unsigned reuseCount_; // Number of reused buffers
+
+    static int sizeClass(size_t size);
+};
+
+} // namespace particle
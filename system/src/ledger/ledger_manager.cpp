@@ -49,6 +49,7 @@ LOG_SOURCE_CATEGORY("system.ledger");
 #include "str_compat.h"
 #include "scope_guard.h"
 #include "check.h"
+#include "trace_marker.h"
 
 #include "cloud/cloud.pb.h"
 #include "cloud/ledger.pb.h"
@@ -477,6 +478,7 @@ int LedgerManager::removeAllData() {
 }
 
 int LedgerManager::run() {
+    PARTICLE_TRACE_SCOPE("ledger:run");
     auto now = hal_timer_millis(nullptr);
     if (state_ == State::FAILED) {
         if (now >= retryTime_) {
@@ -325,6 +325,7 @@ void reset_button_click()
         // Certain numbers of clicks can be processed directly in ISR
         system_handle_button_clicks(hal_interrupt_is_isr());
 #endif
+        system_loop_wakeup();
     }
 }
 
@@ -472,6 +473,41 @@ void applicationSetupDone() {
     }
 }
 
+// Measures the time spent in the application's loop() function and the time the application
+// waits for the system between two consecutive calls to loop()
+class AppLoopTiming {
+public:
+    AppLoopTiming() :
+            loopTime_(DIAG_ID_APP_LOOP_TIME_HISTOGRAM, DIAG_NAME_APP_LOOP_TIME_HISTOGRAM),
+            stallTime_(DIAG_ID_APP_LOOP_STALL_HISTOGRAM, DIAG_NAME_APP_LOOP_STALL_HISTOGRAM),
+            start_(0),
+            end_(0),
+            running_(false) {
+    }
+
+    void loopStarted() {
+        start_ = HAL_Timer_Get_Micro_Seconds();
+        if (running_) {
+            stallTime_.record(start_ - end_);
+        }
+    }
+
+    void loopFinished() {
+        end_ = HAL_Timer_Get_Micro_Seconds();
+        loopTime_.record(end_ - start_);
+        running_ = true;
+    }
+
+private:
+    HistogramDiagnosticData loopTime_;
+    HistogramDiagnosticData stallTime_;
+    system_tick_t start_;
+    system_tick_t end_;
+    bool running_;
+};
+
+AppLoopTiming g_appLoopTiming;
+
 } // namespace
 
 void app_loop(bool threaded)
@@ -527,7 +563,9 @@ void app_loop(bool threaded)
             //Execute user application loop
             DECLARE_SYS_HEALTH(ENTERED_Loop);
             if (system_mode()!=SAFE_MODE) {
+                g_appLoopTiming.loopStarted();
                 loop();
+                g_appLoopTiming.loopFinished();
                 DECLARE_SYS_HEALTH(RAN_Loop);
 #if !(defined(MODULAR_FIRMWARE) && MODULAR_FIRMWARE)
                 _post_loop();
@@ -243,6 +243,18 @@ int Spark_Send_UDP(const unsigned char* buf, uint32_t buflen, void* reserved)
     return system_cloud_send(buf, buflen, 0);
 }
 
+int Spark_Send_UDP_Redundant(const unsigned char* buf, uint32_t buflen, void* reserved)
+{
+    if (SPARK_WLAN_RESET || SPARK_WLAN_SLEEP || spark_cloud_socket_closed() || cloud_socket_aborted)
+    {
+        LOG(TRACE, "SPARK_WLAN_RESET || SPARK_WLAN_SLEEP || spark_cloud_socket_closed() || cloud_socket_aborted");
+        //break from any blocking loop
+        return -1;
+    }
+
+    return system_cloud_send(buf, buflen, SYSTEM_CLOUD_SEND_REDUNDANT);
+}
+
 int Spark_Receive_UDP(unsigned char *buf, uint32_t buflen, void* reserved)
 {
     if (SPARK_WLAN_RESET || SPARK_WLAN_SLEEP || spark_cloud_socket_closed() || cloud_socket_aborted)
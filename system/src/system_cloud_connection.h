@@ -37,6 +37,10 @@ typedef enum {
     SYSTEM_CLOUD_DISCONNECT_GRACEFULLY = 1
 } system_cloud_connection_flags_t;
 
+typedef enum {
+    SYSTEM_CLOUD_SEND_REDUNDANT = 1 ///< Also send the data over the redundant path, if there's one.
+} system_cloud_send_flags_t;
+
 typedef enum CloudServerAddressType {
     CLOUD_SERVER_ADDRESS_TYPE_NONE            = 0,
     CLOUD_SERVER_ADDRESS_TYPE_CACHED          = 1,
@@ -55,6 +59,37 @@ int system_cloud_set_inet_family_keepalive(int af, unsigned int value, int flags
 int system_cloud_get_inet_family_keepalive(int af, unsigned int* value);
 sock_handle_t system_cloud_get_socket_handle();
 
+/**
+ * Move the cloud connection to another network interface.
+ *
+ * The connection's socket is replaced with a socket bound to the given interface and connected to
+ * the same server address. The protocol session is not affected.
+ *
+ * @param iface Network interface.
+ * @param reserved Reserved argument. Must be set to `NULL`.
+ * @return 0 on success, otherwise an error code defined by `system_error_t`.
+ */
+int system_cloud_move(network_handle_t iface, void* reserved);
+
+/**
+ * Set the network interface of the redundant path of the cloud connection.
+ *
+ * Data sent with the `SYSTEM_CLOUD_SEND_REDUNDANT` flag is duplicated over the redundant path, and
+ * data received over it is passed to the protocol layer.
+ *
+ * @param iface Network interface or `NETWORK_INTERFACE_ALL` to close the redundant path.
+ * @param reserved Reserved argument. Must be set to `NULL`.
+ * @return 0 on success, otherwise an error code defined by `system_error_t`.
+ */
+int system_cloud_set_redundant_interface(network_handle_t iface, void* reserved);
+
+/**
+ * Get the network interface of the redundant path of the cloud connection.
+ *
+ * @return Network interface or `NETWORK_INTERFACE_ALL` if there's no redundant path.
+ */
+network_handle_t system_cloud_get_redundant_interface(void* reserved);
+
 #if HAL_PLATFORM_IFAPI
 int system_cloud_resolv_address(int protocol, const ServerAddress* address, sockaddr* saddrCache, addrinfo** info, CloudServerAddressType* type, bool useCachedAddrInfo, network_handle_t interface = NETWORK_INTERFACE_ALL, bool flushDnsCache = false);
 #endif // HAL_PLATFORM_IFAPI
@@ -78,6 +113,7 @@ int Spark_Receive(unsigned char *buf, uint32_t buflen, void* reserved);
 #if HAL_PLATFORM_CLOUD_UDP
 int Spark_Send_UDP(const unsigned char* buf, uint32_t buflen, void* reserved);
 int Spark_Receive_UDP(unsigned char *buf, uint32_t buflen, void* reserved);
+int Spark_Send_UDP_Redundant(const unsigned char* buf, uint32_t buflen, void* reserved);
 #endif /* HAL_PLATFORM_CLOUD_UDP */
 
 /**
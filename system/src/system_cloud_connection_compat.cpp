@@ -328,5 +328,21 @@ sock_handle_t system_cloud_get_socket_handle()
     return s_state.socket;
 }
 
+int system_cloud_move(network_handle_t iface, void* reserved)
+{
+    // Sockets can't be bound to a specific interface
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+int system_cloud_set_redundant_interface(network_handle_t iface, void* reserved)
+{
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+network_handle_t system_cloud_get_redundant_interface(void* reserved)
+{
+    return NETWORK_INTERFACE_ALL;
+}
+
 
 #endif /* !HAL_USE_SOCKET_HAL_POSIX && HAL_USE_SOCKET_HAL_COMPAT */
@@ -20,6 +20,7 @@
 #include "system_cloud_connection.h"
 #include "system_cloud_internal.h"
 #include "system_connection_manager.h"
+#include "system_resolver.h"
 #include "system_error.h"
 #include "inet_hal.h"
 #include "ifapi.h"
@@ -32,6 +33,7 @@
 #include "system_mode.h"
 #endif // HAL_PLATFORM_SOCKET_IOCTL_NOTIFY
 #include "simple_ntp_client.h"
+#include "scope_guard.h"
 
 namespace {
 
@@ -39,12 +41,135 @@ struct SystemCloudState {
     int socket = -1;
     struct addrinfo* addr = nullptr;
     struct addrinfo* next = nullptr;
+    // Socket of the redundant path
+    int redundantSocket = -1;
+    network_handle_t redundantInterface = NETWORK_INTERFACE_ALL;
 };
 
 SystemCloudState s_state;
 
 const unsigned CLOUD_SOCKET_HALF_CLOSED_WAIT_TIMEOUT = 5000;
 
+int getCloudPeerAddress(sockaddr_storage* addr) {
+    if (s_state.socket < 0) {
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+    int type = 0;
+    socklen_t len = sizeof(type);
+    if (sock_getsockopt(s_state.socket, SOL_SOCKET, SO_TYPE, &type, &len) || type != SOCK_DGRAM) {
+        // Only a datagram session can continue over another socket
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+    len = sizeof(*addr);
+    if (sock_getpeername(s_state.socket, (sockaddr*)addr, &len)) {
+        return SYSTEM_ERROR_NETWORK;
+    }
+    return 0;
+}
+
+/**
+ * Opens a UDP socket that is bound to the given interface and connected to the given address.
+ */
+int openCloudPathSocket(const sockaddr_storage& peer, network_handle_t iface) {
+    if (!network_ready(iface, (peer.ss_family == AF_INET6) ? NETWORK_READY_TYPE_IPV6 : NETWORK_READY_TYPE_IPV4, nullptr)) {
+        return SYSTEM_ERROR_NETWORK;
+    }
+    const int s = sock_socket(peer.ss_family, SOCK_DGRAM, IPPROTO_UDP);
+    if (s < 0) {
+        LOG(ERROR, "Cloud path socket failed, family=%d, errno=%d", peer.ss_family, errno);
+        return SYSTEM_ERROR_NETWORK;
+    }
+    NAMED_SCOPE_GUARD(guard, {
+        sock_close(s);
+    });
+    // Same as in system_cloud_connect()
+    if (peer.ss_family == AF_INET6) {
+        struct sockaddr_storage saddr = {};
+        saddr.s2_len = sizeof(saddr);
+        saddr.ss_family = AF_INET6;
+        ((sockaddr_in6*)&saddr)->sin6_port = htons(PORT_COAPS);
+        const int one = 1;
+        if (sock_setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) ||
+                sock_bind(s, (const struct sockaddr*)&saddr, sizeof(saddr))) {
+            LOG(ERROR, "Cloud path socket=%d, failed to bind, errno=%d", s, errno);
+            return SYSTEM_ERROR_NETWORK;
+        }
+    }
+    struct ifreq ifr = {};
+    if_index_to_name(iface, ifr.ifr_name);
+    if (sock_setsockopt(s, SOL_SOCKET, SO_BINDTODEVICE, &ifr, sizeof(ifr))) {
+        LOG(ERROR, "Failed to bind cloud path socket to interface %u, errno=%d", iface, errno);
+        return SYSTEM_ERROR_NETWORK;
+    }
+    if (sock_connect(s, (const sockaddr*)&peer, peer.s2_len)) {
+        LOG(ERROR, "Cloud path socket=%d, failed to connect, errno=%d", s, errno);
+        return SYSTEM_ERROR_NETWORK;
+    }
+#if HAL_PLATFORM_SOCKET_IOCTL_NOTIFY
+    if (system_thread_get_state(nullptr) == spark::feature::ENABLED) {
+        auto thread = os_thread_current(nullptr);
+        sock_ioctl(s, SIOCSPGRP, (void*)&thread);
+    }
+#endif // HAL_PLATFORM_SOCKET_IOCTL_NOTIFY
+    guard.dismiss();
+    return s;
+}
+
+void closeRedundantPath() {
+    if (s_state.redundantSocket >= 0) {
+        LOG(TRACE, "Closing redundant cloud path, socket=%d", s_state.redundantSocket);
+        sock_close(s_state.redundantSocket);
+    }
+    s_state.redundantSocket = -1;
+    s_state.redundantInterface = NETWORK_INTERFACE_ALL;
+}
+
+int recvCloudSocket(int s, uint8_t* buf, size_t buflen) {
+    int recvd = sock_recv(s, buf, buflen, MSG_DONTWAIT);
+    if (recvd < 0) {
+        if (errno == EWOULDBLOCK || errno == EAGAIN || errno == ENOMEM) {
+            /* Not an error */
+            if (errno == ENOMEM) {
+                LOG_DEBUG(WARN, "sock_recv ENOMEM");
+            }
+            recvd = 0;
+        } else {
+            LOG(ERROR, "sock_recv returned %d %d", recvd, errno);
+        }
+    }
+
+    if (recvd) {
+        LOG_DEBUG(TRACE, "RX socket %d buflen %d recvd %d", s, buflen, recvd);
+    }
+
+    return recvd;
+}
+
+/**
+ * Converts a resolved address to the same addrinfo that getaddrinfo() would have returned for it.
+ */
+int ipAddressToAddrInfo(const HAL_IPAddress& addr, const char* serv, const struct addrinfo& hints, struct addrinfo** info) {
+    char host[INET6_ADDRSTRLEN] = {};
+    struct addrinfo h = hints;
+    h.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+#if HAL_IPv6
+    if (addr.v == 6) {
+        h.ai_family = AF_INET6;
+        if (!inet_inet_ntop(AF_INET6, addr.ipv6, host, sizeof(host))) {
+            return SYSTEM_ERROR_INVALID_ARGUMENT;
+        }
+        return netdb_getaddrinfo(host, serv, &h, info);
+    }
+#endif // HAL_IPv6
+    h.ai_family = AF_INET;
+    struct in_addr in = {};
+    in.s_addr = htonl(addr.ipv4);
+    if (!inet_inet_ntop(AF_INET, &in, host, sizeof(host))) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    return netdb_getaddrinfo(host, serv, &h, info);
+}
+
 } /* anonymous */
 
 int system_cloud_resolv_address(int protocol, const ServerAddress* address, sockaddr* saddrCache, addrinfo** info, CloudServerAddressType* type, bool useCachedAddrInfo, network_handle_t interface, bool flushDnsCache) {
@@ -117,15 +242,18 @@ int system_cloud_resolv_address(int protocol, const ServerAddress* address, sock
                 /* FIXME: this should probably be moved into system_cloud_internal */
                 system_string_interpolate(address->domain, tmphost, sizeof(tmphost), system_interpolate_cloud_server_hostname);
                 snprintf(tmpserv, sizeof(tmpserv), "%u", address->port);
-                if (flushDnsCache) {
-                    hints.ai_flags |= AI_FLUSHCACHE;
-                }
-                if_t iface = nullptr;
-                if (interface != NETWORK_INTERFACE_ALL) {
-                    if_get_by_index(interface, &iface);
-                }
                 LOG(TRACE, "Resolving %s#%s cache=%d iface=%d", tmphost, tmpserv, !flushDnsCache, interface);
-                netdb_getaddrinfo_ex(tmphost, tmpserv, &hints, info, iface);
+                // Reconnects are answered from the resolver's cache, which is shared with the application
+                using particle::system::Resolver;
+                HAL_IPAddress addrs[Resolver::MAX_ADDRESSES] = {};
+                const unsigned flags = flushDnsCache ? NETWORK_RESOLVE_FLAG_FLUSH_CACHE : NETWORK_RESOLVE_FLAG_NONE;
+                const int count = Resolver::instance()->resolve(tmphost, interface, flags, addrs, Resolver::MAX_ADDRESSES);
+                struct addrinfo** next = info;
+                for (int i = 0; i < count; ++i) {
+                    if (!ipAddressToAddrInfo(addrs[i], tmpserv, hints, next) && *next) {
+                        next = &(*next)->ai_next;
+                    }
+                }
                 *type = CLOUD_SERVER_ADDRESS_TYPE_NEW_ADDRINFO;
                 break;
             }
@@ -333,6 +461,8 @@ int system_cloud_disconnect(int flags)
         }
     }
 
+    closeRedundantPath();
+
     LOG_DEBUG(TRACE, "Close Attempt");
     ret = sock_close(s_state.socket);
     LOG_DEBUG(TRACE, "sock_close()=%s", (ret ? "fail":"success"));
@@ -344,7 +474,6 @@ int system_cloud_disconnect(int flags)
 
 int system_cloud_send(const uint8_t* buf, size_t buflen, int flags)
 {
-    (void)flags;
     LOG_DEBUG(TRACE, "TX s_state.socket %d buflen %d", s_state.socket, buflen);
     int r = sock_send(s_state.socket, buf, buflen, 0);
     if (r < 0) {
@@ -357,30 +486,83 @@ int system_cloud_send(const uint8_t* buf, size_t buflen, int flags)
         }
     }
 
+    if ((flags & SYSTEM_CLOUD_SEND_REDUNDANT) && s_state.redundantSocket >= 0) {
+        LOG_DEBUG(TRACE, "TX s_state.redundantSocket %d buflen %d", s_state.redundantSocket, buflen);
+        const int r2 = sock_send(s_state.redundantSocket, buf, buflen, 0);
+        if (r2 < 0) {
+            LOG_DEBUG(WARN, "sock_send on redundant path returned %d %d", r2, errno);
+        } else if (r <= 0) {
+            // The data got out over the redundant path
+            r = r2;
+        }
+    }
+
     return r;
 }
 
 int system_cloud_recv(uint8_t* buf, size_t buflen, int flags)
 {
     (void)flags;
-    int recvd = sock_recv(s_state.socket, buf, buflen, MSG_DONTWAIT);
-    if (recvd < 0) {
-        if (errno == EWOULDBLOCK || errno == EAGAIN || errno == ENOMEM) {
-            /* Not an error */
-            if (errno == ENOMEM) {
-                LOG_DEBUG(WARN, "sock_recv ENOMEM");
-            }
+    int recvd = recvCloudSocket(s_state.socket, buf, buflen);
+    if (recvd == 0 && s_state.redundantSocket >= 0) {
+        // The protocol layer discards the records it has already received over the other path
+        recvd = recvCloudSocket(s_state.redundantSocket, buf, buflen);
+        if (recvd < 0) {
+            // Errors on the redundant path don't affect the connection
             recvd = 0;
-        } else {
-            LOG(ERROR, "sock_recv returned %d %d", recvd, errno);
         }
     }
+    return recvd;
+}
 
-    if (recvd) {
-        LOG_DEBUG(TRACE, "RX s_state.socket %d buflen %d recvd %d", s_state.socket, buflen, recvd);
+int system_cloud_move(network_handle_t iface, void* reserved)
+{
+    if (iface == NETWORK_INTERFACE_ALL) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    sockaddr_storage peer = {};
+    CHECK(getCloudPeerAddress(&peer));
+    int s = -1;
+    if (s_state.redundantSocket >= 0 && s_state.redundantInterface == iface) {
+        // Promote the redundant path
+        s = s_state.redundantSocket;
+        s_state.redundantSocket = -1;
+        s_state.redundantInterface = NETWORK_INTERFACE_ALL;
+    } else {
+        s = CHECK(openCloudPathSocket(peer, iface));
     }
+    LOG(INFO, "Moving cloud connection to if %d, socket=%d -> %d", iface, s_state.socket, s);
+    sock_close(s_state.socket);
+    s_state.socket = s;
 
-    return recvd;
+#if HAL_PLATFORM_AUTOMATIC_CONNECTION_MANAGEMENT
+    const unsigned int keepalive = (iface == NETWORK_INTERFACE_CELLULAR ? HAL_PLATFORM_CELLULAR_CLOUD_KEEPALIVE_INTERVAL : HAL_PLATFORM_DEFAULT_CLOUD_KEEPALIVE_INTERVAL);
+    system_cloud_set_inet_family_keepalive(peer.ss_family, keepalive, 1);
+#endif
+    return 0;
+}
+
+int system_cloud_set_redundant_interface(network_handle_t iface, void* reserved)
+{
+    if (iface == s_state.redundantInterface && (iface == NETWORK_INTERFACE_ALL || s_state.redundantSocket >= 0)) {
+        return 0;
+    }
+    closeRedundantPath();
+    if (iface == NETWORK_INTERFACE_ALL) {
+        return 0;
+    }
+    sockaddr_storage peer = {};
+    CHECK(getCloudPeerAddress(&peer));
+    const int s = CHECK(openCloudPathSocket(peer, iface));
+    LOG(INFO, "Redundant cloud path over if %d, socket=%d", iface, s);
+    s_state.redundantSocket = s;
+    s_state.redundantInterface = iface;
+    return 0;
+}
+
+network_handle_t system_cloud_get_redundant_interface(void* reserved)
+{
+    return s_state.redundantInterface;
 }
 
 int system_internet_test(void* reserved)
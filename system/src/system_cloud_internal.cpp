@@ -50,6 +50,7 @@
 #include "bytes2hexbuf.h"
 #include "system_event.h"
 #include "system_cloud_connection.h"
+#include "system_diagnostics_snapshot.h"
 #include "system_network_internal.h"
 #include "str_util.h"
 #include "scope_guard.h"
@@ -422,6 +423,15 @@ uint32_t compute_describe_app_checksum()
 
 uint32_t compute_describe_system_checksum()
 {
+    // The checksum is computed on every handshake but the modules can only change when the flash
+    // is modified
+    static uint32_t cachedChecksum = 0;
+    static uint32_t cachedFlashRevision = 0;
+    static bool cached = false;
+    const auto flashRevision = HAL_FLASH_Revision(nullptr);
+    if (cached && flashRevision == cachedFlashRevision) {
+        return cachedChecksum;
+    }
     hal_system_info_t info;
     memset(&info, 0, sizeof(info));
     info.size = sizeof(info);
@@ -432,6 +442,10 @@ uint32_t compute_describe_system_checksum()
 		checksum += crc(info.modules[i].suffix.sha);
 	}
 	HAL_System_Info(&info, false, NULL);
+    cachedChecksum = checksum;
+    cachedFlashRevision = flashRevision;
+    // Don't reuse the checksum if the flash was modified while the modules were being walked
+    cached = (HAL_FLASH_Revision(nullptr) == flashRevision);
     return checksum;
 }
 
@@ -603,6 +617,10 @@ uint32_t compute_cloud_state_checksum(SparkAppStateSelector::Enum stateSelector,
 			});
 			break;
 		}
+		case SparkAppStateSelector::DESCRIBE_METRICS: {
+			particle::system::vitalsDiagnosticsSnapshot()->acknowledge(value);
+			break;
+		}
 		default:
 			break;
 		}
@@ -624,6 +642,14 @@ uint32_t compute_cloud_state_checksum(SparkAppStateSelector::Enum stateSelector,
 			data.app_state_flags = 0;
 		});
 	}
+	else if (stateSelector == SparkAppStateSelector::DESCRIBE_METRICS)
+	{
+		if (operation == SparkAppStateUpdate::SENT) {
+			particle::system::vitalsDiagnosticsSnapshot()->frameSent(value);
+		} else if (operation == SparkAppStateUpdate::RESET) {
+			particle::system::vitalsDiagnosticsSnapshot()->frameLost(value);
+		}
+	}
 	return 0;
 }
 #endif /* HAL_PLATFORM_CLOUD_UDP */
@@ -1113,6 +1139,7 @@ void Spark_Protocol_Init(void)
         if (udp)
         {
             callbacks.send = Spark_Send_UDP;
+            callbacks.send_redundant = Spark_Send_UDP_Redundant;
             callbacks.receive = Spark_Receive_UDP;
             callbacks.transport_context = &g_system_cloud_session_data;
             callbacks.save = Spark_Save;
@@ -1252,6 +1279,8 @@ int Spark_Handshake(bool presence_announce)
     LOG(INFO,"Starting handshake: presense_announce=%d", presence_announce);
     bool session_resumed = false;
     // TODO: Perform the DTLS handshake and receive a response for the Hello message asynchronously
+    // The server may not have the vitals sent in the previous session
+    particle::system::vitalsDiagnosticsSnapshot()->reset();
     SPARK_CLOUD_PROTOCOL_HANDSHAKE_IN_PROGRESS = 1;
     int err = spark_protocol_handshake(sp);
     SPARK_CLOUD_PROTOCOL_HANDSHAKE_IN_PROGRESS = 0;
@@ -1346,6 +1375,20 @@ bool Spark_Communication_Loop(void)
     return spark_protocol_event_loop(sp);
 }
 
+/**
+ * Returns true if the protocol is in the middle of an exchange with the server and its event
+ * loop needs to be run frequently.
+ */
+bool Spark_Communication_Busy(void)
+{
+    protocol_status status = {};
+    status.size = sizeof(status);
+    if (spark_protocol_get_status(sp, &status, nullptr) != 0) {
+        return true;
+    }
+    return status.flags & PROTOCOL_STATUS_BUSY;
+}
+
 /**
  * This is the internal function called by the background loop to pump cloud events.
  */
@@ -35,6 +35,7 @@ int Spark_Restore(void* buffer, size_t max_length, uint8_t type, void* reserved)
 void Spark_Protocol_Init(void);
 int Spark_Handshake(bool presence_announce);
 bool Spark_Communication_Loop(void);
+bool Spark_Communication_Busy(void);
 void Spark_Process_Events();
 
 void system_set_time(uint32_t time, unsigned param, void* reserved);
@@ -28,6 +28,7 @@ LOG_SOURCE_CATEGORY("system.cm")
 #include "system_cloud_internal.h"
 #include "system_string_interpolate.h"
 #include "system_network_diagnostics.h"
+#include "spark_wiring_diagnostics.h"
 #include "spark_wiring_network.h"
 #include "spark_wiring_vector.h"
 #include "spark_wiring_random.h"
@@ -113,6 +114,24 @@ network_handle_t ConnectionManager::getPreferredNetwork() {
     return preferredNetwork_;
 }
 
+void ConnectionManager::setRedundantNetwork(network_handle_t network, bool redundant) {
+    if (redundant) {
+        if (network != NETWORK_INTERFACE_ALL) {
+            redundantNetwork_ = network;
+        }
+    } else {
+        if (network == redundantNetwork_ || network == NETWORK_INTERFACE_ALL) {
+            redundantNetwork_ = NETWORK_INTERFACE_ALL;
+        }
+    }
+    // The path is opened or closed on the next sample
+    lastLinkQualitySample_ = 0;
+}
+
+network_handle_t ConnectionManager::getRedundantNetwork() {
+    return redundantNetwork_;
+}
+
 network_handle_t ConnectionManager::getCloudConnectionNetwork() {
     uint8_t socketNetIfIndex = 0;
 
@@ -181,6 +200,7 @@ int ConnectionManager::testConnections(bool background) {
         }
         backgroundTestInProgress_ = false;
         backgroundTester_.reset();
+        probeTester_.reset();
         testResultsActual_ = false;
 
         LOG_DEBUG(INFO, "Full reachability test started");
@@ -195,6 +215,7 @@ int ConnectionManager::testConnections(bool background) {
         testResultsActual_ = false;
         if (!backgroundTestInProgress_) {
             LOG_DEBUG(INFO, "Background reachability test started");
+            probeTester_.reset();
             backgroundTester_ = std::make_unique<ConnectionTester>();
             CHECK_TRUE(backgroundTester_, SYSTEM_ERROR_NO_MEMORY);
             CHECK(backgroundTester_->prepare(false /* full test*/));
@@ -209,6 +230,7 @@ int ConnectionManager::testConnections(bool background) {
         }
     }
     if (r == 0) {
+        updateLinkQuality(metrics, HAL_Timer_Get_Milli_Seconds());
         bestNetworks_.clear();
         bool hasValidScore = false;
         for (auto& i: metrics) {
@@ -255,7 +277,175 @@ bool ConnectionManager::testIsAllowed() const {
     return spark_cloud_flag_connected() && !resetPending && !SPARK_FLASH_UPDATE;
 }
 
+void ConnectionManager::handleLinkQuality() {
+    const auto now = HAL_Timer_Get_Milli_Seconds();
+    handleLinkProbe(now);
+    if (lastLinkQualitySample_ != 0 && now - lastLinkQualitySample_ < LINK_QUALITY_SAMPLE_PERIOD_MS) {
+        return;
+    }
+    lastLinkQualitySample_ = now;
+    sampleCloudLinkQuality(now);
+    handleFailover(now);
+    handleRedundantPath();
+}
+
+void ConnectionManager::handleRedundantPath() {
+    auto network = redundantNetwork_;
+    // The redundant path needs a ready interface other than the one carrying the connection
+    if (network != NETWORK_INTERFACE_ALL && (!spark_cloud_flag_connected() || !network_ready(network, 0, nullptr) ||
+            network == getCloudConnectionNetwork())) {
+        network = NETWORK_INTERFACE_ALL;
+    }
+    if (network == system_cloud_get_redundant_interface(nullptr)) {
+        return;
+    }
+    const int r = system_cloud_set_redundant_interface(network, nullptr);
+    if (r < 0) {
+        LOG(WARN, "Failed to set up the redundant cloud path over %s: %d", netifToName(network), r);
+    }
+}
+
+int ConnectionManager::moveCloudSession(network_handle_t network) {
+    // The DTLS session is bound to its connection ID rather than the device's address, so it
+    // survives a change of the socket. The server learns about the new address from the next
+    // record the device sends
+    CHECK(system_cloud_move(network, nullptr));
+    const int r = spark_protocol_command(system_cloud_protocol_instance(), ProtocolCommands::MOVE_SESSION, 0, nullptr);
+    if (r != 0) {
+        LOG(ERROR, "Failed to move the cloud session: %d", r);
+        return SYSTEM_ERROR_PROTOCOL;
+    }
+    ++sessionMoves_;
+    LOG(INFO, "Cloud session moved to %s", netifToName(network));
+    return 0;
+}
+
+void ConnectionManager::sampleCloudLinkQuality(system_tick_t now) {
+    diag_histogram roundTrip = {};
+    AbstractUnsignedIntegerDiagnosticData::IntType retransmits = 0;
+    if (AbstractHistogramDiagnosticData::get(DIAG_ID_CLOUD_COAP_ROUND_TRIP_HISTOGRAM, roundTrip) != 0 ||
+            AbstractUnsignedIntegerDiagnosticData::get(DIAG_ID_CLOUD_RETRANSMITTED_MESSAGES, retransmits) != 0) {
+        return;
+    }
+    // Attribute the acknowledgements and retransmissions that the protocol layer observed since
+    // the last sample to the interface the cloud connection is bound to
+    const auto network = getCloudConnectionNetwork();
+    if (network != NETWORK_INTERFACE_ALL && network == linkQualityNetwork_ &&
+            roundTrip.count >= lastAckCount_ && retransmits >= lastRetransmitCount_) {
+        const unsigned acks = roundTrip.count - lastAckCount_;
+        const unsigned lost = retransmits - lastRetransmitCount_;
+        const auto link = linkQuality_.link(network);
+        if (link && (acks || lost)) {
+            link->update(now, acks, lost, acks ? (roundTrip.sum - lastRoundTripSum_) / acks : 0);
+        }
+    }
+    linkQualityNetwork_ = network;
+    lastAckCount_ = roundTrip.count;
+    lastRoundTripSum_ = roundTrip.sum;
+    lastRetransmitCount_ = retransmits;
+}
+
+void ConnectionManager::updateLinkQuality(const Vector<ConnectionMetrics>& metrics, system_tick_t now) {
+    for (const auto& i: metrics) {
+        const auto link = linkQuality_.link(i.interface);
+        if (link && i.txPacketCount > 0) {
+            link->update(now, i.rxPacketCount, i.txPacketCount - i.rxPacketCount, i.avgPacketRoundTripTime);
+        }
+    }
+}
+
+int ConnectionManager::handleLinkProbe(system_tick_t now) {
+    if (!probeTester_) {
+        if ((lastLinkProbe_ != 0 && now - lastLinkProbe_ < LINK_PROBE_PERIOD_MS) || !testIsAllowed()) {
+            return 0;
+        }
+        lastLinkProbe_ = now;
+        unsigned countReady = 0;
+        for (const auto& i: bestNetworks_) {
+            if (network_ready(i.first, 0, nullptr)) {
+                countReady++;
+            }
+        }
+        if (countReady < 2) {
+            return 0;
+        }
+        // The interface that carries the cloud connection is scored passively
+        probeTester_ = std::make_unique<ConnectionTester>(LINK_PROBE_PACKET_COUNT, LINK_PROBE_DURATION_MS,
+                LINK_PROBE_PAYLOAD_SIZE, getCloudConnectionNetwork());
+        CHECK_TRUE(probeTester_, SYSTEM_ERROR_NO_MEMORY);
+        const int r = probeTester_->prepare(false /* fullTest */);
+        if (r < 0) {
+            LOG_DEBUG(WARN, "Link probe failed to start (%d)", r);
+            probeTester_.reset();
+            return r;
+        }
+    }
+    const int r = probeTester_->runTest(0 /* non blocking */);
+    if (r == SYSTEM_ERROR_BUSY) {
+        return 0;
+    }
+    if (r == 0) {
+        updateLinkQuality(probeTester_->getConnectionMetrics(), now);
+    }
+    probeTester_.reset();
+    return r;
+}
+
+bool ConnectionManager::handleFailover(system_tick_t now) {
+    if (lastFailover_ != 0 && now - lastFailover_ < FAILOVER_HOLDOFF_MS) {
+        return false;
+    }
+    if (!testIsAllowed()) {
+        return false;
+    }
+    const auto current = getCloudConnectionNetwork();
+    const auto link = linkQuality_.link(current);
+    if (current == NETWORK_INTERFACE_ALL || !link) {
+        return false;
+    }
+    // Stay on the preferred network for as long as it's usable
+    if (current == preferredNetwork_ && !link->degraded()) {
+        return false;
+    }
+    uint32_t ready = 0;
+    for (const auto& i: bestNetworks_) {
+        if (i.first < LinkQualityMonitor::MAX_INTERFACES && network_ready(i.first, 0, nullptr)) {
+            ready |= (1u << i.first);
+        }
+    }
+    const int target = linkQuality_.failoverTarget(current, ready, now);
+    if (target < 0) {
+        return false;
+    }
+    LOG(WARN, "%s link quality is poor (rtt: %lu, loss: %u, score: %lu) - moving the cloud session to %s (score: %lu)",
+            netifToName(current), link->roundTrip(), link->loss(), link->score(), netifToName(target),
+            linkQuality_.score(target, now));
+    // Rank the interfaces by link quality so that the reconnection picks the target without
+    // running a full reachability test
+    for (auto& i: bestNetworks_) {
+        i.second = (i.first == current) ? LinkQuality::INVALID_SCORE : linkQuality_.score(i.first, now);
+    }
+    std::stable_sort(bestNetworks_.begin(), bestNetworks_.end(), [](const std::pair<network_handle_t, uint32_t>& n1,
+            const std::pair<network_handle_t, uint32_t>& n2) {
+        return n1.second < n2.second;
+    });
+    lastFailover_ = now ? now : 1;
+    ++failovers_;
+    if (moveCloudSession(target) == 0) {
+        return true;
+    }
+    testResultsActual_ = true;
+    auto options = CloudDisconnectOptions().reconnect(true);
+    auto systemOptions = options.toSystemOptions();
+    spark_cloud_disconnect(&systemOptions, nullptr);
+    return true;
+}
+
 int ConnectionManager::checkCloudConnectionNetwork() {
+    if (!backgroundTestInProgress_ && !checkScheduled_) {
+        handleLinkQuality();
+    }
+
     bool finishedBackgroundTest = false;
     if (backgroundTestInProgress_) {
         int r = testConnections(true /* background */);
@@ -327,15 +517,27 @@ int ConnectionManager::checkCloudConnectionNetwork() {
             }
         }
     }
-    // If best candidate doesn't match current network interface - reconnect
+    // If best candidate doesn't match current network interface - move the session or reconnect
     LOG(TRACE, "Best network interface for cloud connection changed (to %s) - move the cloud session", netifToName(best));
+    if (best != NETWORK_INTERFACE_ALL && moveCloudSession(best) == 0) {
+        return 0;
+    }
     auto options = CloudDisconnectOptions().reconnect(true);
     auto systemOptions = options.toSystemOptions();
     spark_cloud_disconnect(&systemOptions, nullptr);
     return 0;
 }
 
-ConnectionTester::ConnectionTester() {
+ConnectionTester::ConnectionTester()
+        : ConnectionTester(REACHABILITY_TEST_MAX_TX_PACKET_COUNT, REACHABILITY_TEST_DURATION_MS, REACHABILITY_MAX_PAYLOAD_SIZE) {
+}
+
+ConnectionTester::ConnectionTester(unsigned maxTxPacketCount, system_tick_t duration, size_t maxPayloadSize,
+        network_handle_t skipNetwork)
+        : maxTxPacketCount_(std::min<unsigned>(maxTxPacketCount, REACHABILITY_TEST_MAX_TX_PACKET_COUNT)),
+          duration_(duration),
+          maxPayloadSize_(std::min<size_t>(maxPayloadSize, REACHABILITY_MAX_PAYLOAD_SIZE)),
+          skipNetwork_(skipNetwork) {
     for (const auto& i: getSupportedInterfaces()) {
         struct ConnectionMetrics interfaceDiagnostics = {};
         interfaceDiagnostics.interface = i.first;
@@ -368,7 +570,11 @@ ConnectionMetrics* ConnectionTester::metricsFromSocketDescriptor(int socketDescr
 
 bool ConnectionTester::testPacketsOutstanding() {
     for (auto& i : metrics_) {
-        if (i.txPacketCount != REACHABILITY_TEST_MAX_TX_PACKET_COUNT) {
+        if (i.socketDescriptor < 0) {
+            // Not tested
+            continue;
+        }
+        if (i.txPacketCount != maxTxPacketCount_) {
             return true;
         } else {
             if (i.txPacketCount != i.rxPacketCount) {
@@ -380,7 +586,7 @@ bool ConnectionTester::testPacketsOutstanding() {
 }
 
 int ConnectionTester::allocateTestPacketBuffers(ConnectionMetrics* metrics) {
-    int maxMessageLength = REACHABILITY_MAX_PAYLOAD_SIZE + sizeof(DTLSPlaintext_t);
+    int maxMessageLength = maxPayloadSize_ + sizeof(DTLSPlaintext_t);
     uint8_t* txBuffer = (uint8_t*)malloc(maxMessageLength);
     uint8_t* rxBuffer = (uint8_t*)malloc(maxMessageLength);
 
@@ -403,7 +609,7 @@ int ConnectionTester::allocateTestPacketBuffers(ConnectionMetrics* metrics) {
 int ConnectionTester::sendTestPacket(ConnectionMetrics* metrics) {
     int r = 0;
     // Only send a new packet every REACHABILITY_TEST_PACKET_TX_TIMEOUT_MS milliseconds
-    if (HAL_Timer_Get_Milli_Seconds() >= (metrics->txPacketStartMillis + REACHABILITY_TEST_PACKET_TX_TIMEOUT_MS) && metrics->txPacketCount < REACHABILITY_TEST_MAX_TX_PACKET_COUNT) {
+    if (HAL_Timer_Get_Milli_Seconds() >= (metrics->txPacketStartMillis + REACHABILITY_TEST_PACKET_TX_TIMEOUT_MS) && metrics->txPacketCount < maxTxPacketCount_) {
         size_t testPacketSize = CHECK(generateTestPacket(metrics));
 
         int r = sock_send(metrics->socketDescriptor, metrics->txBuffer, testPacketSize, 0);
@@ -430,7 +636,7 @@ int ConnectionTester::receiveTestPacket(ConnectionMetrics* metrics) {
     msg.msg_iov = &iov;
     msg.msg_iovlen = 1;
     iov.iov_base = metrics->rxBuffer;
-    iov.iov_len = REACHABILITY_MAX_PAYLOAD_SIZE + sizeof(DTLSPlaintext_t);
+    iov.iov_len = maxPayloadSize_ + sizeof(DTLSPlaintext_t);
     char controlBuf[CMSG_SPACE(sizeof(timespec))] = {};
     msg.msg_control = controlBuf;
     msg.msg_controllen = sizeof(controlBuf);
@@ -486,7 +692,7 @@ int ConnectionTester::receiveTestPacket(ConnectionMetrics* metrics) {
 }
 
 int ConnectionTester::generateTestPacket(ConnectionMetrics* metrics) {
-    unsigned packetDataLength = random(1, REACHABILITY_MAX_PAYLOAD_SIZE);
+    unsigned packetDataLength = random(1, maxPayloadSize_);
 
     DTLSPlaintext_t msg = {
         REACHABILITY_TEST_MSG, // DTLS Message Type
@@ -609,6 +815,9 @@ int ConnectionTester::prepare(bool fullTest, bool lastTestFailed) {
                 LOG_DEBUG(TRACE,"%s not ready, skipping test", netifToName(connectionMetrics.interface));
                 continue;
             }
+            if (connectionMetrics.interface == skipNetwork_) {
+                continue;
+            }
 
             int s = sock_socket(a->ai_family, a->ai_socktype, a->ai_protocol);
             NAMED_SCOPE_GUARD(guard, {
@@ -682,7 +891,7 @@ int ConnectionTester::prepare(bool fullTest, bool lastTestFailed) {
         pfds_ = std::move(pfds);
     }
 
-    endTime_ = HAL_Timer_Get_Milli_Seconds() + REACHABILITY_TEST_DURATION_MS;
+    endTime_ = HAL_Timer_Get_Milli_Seconds() + duration_;
 
     return r;
 }
@@ -768,6 +977,73 @@ const Vector<std::pair<network_interface_t, uint32_t>> ConnectionTester::getSupp
     return interfaceList;
 }
 
+namespace {
+
+class LinkQualityDiagnosticData: public AbstractUnsignedIntegerDiagnosticData {
+public:
+    LinkQualityDiagnosticData(uint16_t id, const char* name, network_interface_t iface, bool loss) :
+            AbstractUnsignedIntegerDiagnosticData(id, name),
+            iface_(iface),
+            loss_(loss) {
+    }
+
+    virtual int get(IntType& val) override {
+        const auto link = ConnectionManager::instance()->linkQuality().link(iface_);
+        if (!link || !link->windows()) {
+            return SYSTEM_ERROR_NOT_FOUND;
+        }
+        val = loss_ ? link->loss() : link->roundTrip();
+        return 0; // OK
+    }
+
+private:
+    network_interface_t iface_;
+    bool loss_;
+};
+
+class ConnectionCounterDiagnosticData: public AbstractUnsignedIntegerDiagnosticData {
+public:
+    typedef unsigned (ConnectionManager::*Counter)() const;
+
+    ConnectionCounterDiagnosticData(uint16_t id, const char* name, Counter counter) :
+            AbstractUnsignedIntegerDiagnosticData(id, name),
+            counter_(counter) {
+    }
+
+    virtual int get(IntType& val) override {
+        val = (ConnectionManager::instance()->*counter_)();
+        return 0; // OK
+    }
+
+private:
+    Counter counter_;
+};
+
+#if HAL_PLATFORM_ETHERNET
+LinkQualityDiagnosticData g_ethernetRoundTripDiag(DIAG_ID_NETWORK_ETHERNET_ROUND_TRIP, DIAG_NAME_NETWORK_ETHERNET_ROUND_TRIP,
+        NETWORK_INTERFACE_ETHERNET, false /* loss */);
+LinkQualityDiagnosticData g_ethernetLossDiag(DIAG_ID_NETWORK_ETHERNET_LOSS, DIAG_NAME_NETWORK_ETHERNET_LOSS,
+        NETWORK_INTERFACE_ETHERNET, true /* loss */);
+#endif
+#if HAL_PLATFORM_WIFI
+LinkQualityDiagnosticData g_wifiRoundTripDiag(DIAG_ID_NETWORK_WIFI_ROUND_TRIP, DIAG_NAME_NETWORK_WIFI_ROUND_TRIP,
+        NETWORK_INTERFACE_WIFI_STA, false /* loss */);
+LinkQualityDiagnosticData g_wifiLossDiag(DIAG_ID_NETWORK_WIFI_LOSS, DIAG_NAME_NETWORK_WIFI_LOSS,
+        NETWORK_INTERFACE_WIFI_STA, true /* loss */);
+#endif
+#if HAL_PLATFORM_CELLULAR
+LinkQualityDiagnosticData g_cellularRoundTripDiag(DIAG_ID_NETWORK_CELLULAR_ROUND_TRIP, DIAG_NAME_NETWORK_CELLULAR_ROUND_TRIP,
+        NETWORK_INTERFACE_CELLULAR, false /* loss */);
+LinkQualityDiagnosticData g_cellularLossDiag(DIAG_ID_NETWORK_CELLULAR_LOSS, DIAG_NAME_NETWORK_CELLULAR_LOSS,
+        NETWORK_INTERFACE_CELLULAR, true /* loss */);
+#endif
+ConnectionCounterDiagnosticData g_failoverCountDiag(DIAG_ID_CLOUD_CONNECTION_FAILOVERS, DIAG_NAME_CLOUD_CONNECTION_FAILOVERS,
+        &ConnectionManager::failoverCount);
+ConnectionCounterDiagnosticData g_sessionMoveCountDiag(DIAG_ID_CLOUD_SESSION_MOVES, DIAG_NAME_CLOUD_SESSION_MOVES,
+        &ConnectionManager::sessionMoveCount);
+
+} // namespace
+
 }} /* namespace particle::system */
 
 #endif /* HAL_PLATFORM_IFAPI */
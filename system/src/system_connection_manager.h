@@ -23,6 +23,7 @@
 #if HAL_PLATFORM_IFAPI
 
 #include "system_network.h"
+#include "system_link_quality.h"
 #include "spark_wiring_vector.h"
 #include <memory>
 
@@ -62,6 +63,9 @@ public:
     void setPreferredNetwork(network_handle_t network, bool preferred);
     network_handle_t getPreferredNetwork();
 
+    void setRedundantNetwork(network_handle_t network, bool redundant);
+    network_handle_t getRedundantNetwork();
+
     network_handle_t getCloudConnectionNetwork();
     network_handle_t selectCloudConnectionNetwork();
 
@@ -69,9 +73,28 @@ public:
     int scheduleCloudConnectionNetworkCheck();
     int checkCloudConnectionNetwork();
 
+    const LinkQualityMonitor& linkQuality() const {
+        return linkQuality_;
+    }
+
+    unsigned failoverCount() const {
+        return failovers_;
+    }
+
+    unsigned sessionMoveCount() const {
+        return sessionMoves_;
+    }
+
 private:
     void handlePeriodicCheck();
     bool testIsAllowed() const;
+    void handleLinkQuality();
+    void sampleCloudLinkQuality(system_tick_t now);
+    void updateLinkQuality(const Vector<ConnectionMetrics>& metrics, system_tick_t now);
+    int handleLinkProbe(system_tick_t now);
+    bool handleFailover(system_tick_t now);
+    void handleRedundantPath();
+    int moveCloudSession(network_handle_t network);
 
 private:
     network_handle_t preferredNetwork_;
@@ -83,11 +106,38 @@ private:
     static constexpr system_tick_t PERIODIC_CHECK_PERIOD_MS = 5 * 60 * 1000;
     system_tick_t nextPeriodicCheck_ = 0;
     bool lastTestFailed_ = false;
+
+    // Passive link quality is sampled from the CoAP round-trip and retransmission counters
+    static constexpr system_tick_t LINK_QUALITY_SAMPLE_PERIOD_MS = 2000;
+    // Interfaces that don't carry the cloud connection are probed with a few small packets
+    static constexpr system_tick_t LINK_PROBE_PERIOD_MS = 60 * 1000;
+    static constexpr unsigned LINK_PROBE_PACKET_COUNT = 3;
+    static constexpr system_tick_t LINK_PROBE_DURATION_MS = 1500;
+    static constexpr size_t LINK_PROBE_PAYLOAD_SIZE = 16;
+    // Minimum time between two moves of the cloud connection based on link quality
+    static constexpr system_tick_t FAILOVER_HOLDOFF_MS = 60 * 1000;
+    LinkQualityMonitor linkQuality_;
+    std::unique_ptr<ConnectionTester> probeTester_;
+    network_handle_t linkQualityNetwork_ = NETWORK_INTERFACE_ALL;
+    uint32_t lastAckCount_ = 0;
+    uint32_t lastRoundTripSum_ = 0;
+    uint32_t lastRetransmitCount_ = 0;
+    // Times of the last link quality sample and the last probe of the standby interfaces (0 if none)
+    system_tick_t lastLinkQualitySample_ = 0;
+    system_tick_t lastLinkProbe_ = 0;
+    system_tick_t lastFailover_ = 0;
+    unsigned failovers_ = 0;
+
+    // Interface that duplicates the retransmitted cloud messages
+    network_handle_t redundantNetwork_ = NETWORK_INTERFACE_ALL;
+    unsigned sessionMoves_ = 0;
 };
 
 class ConnectionTester {
 public:
     ConnectionTester();
+    ConnectionTester(unsigned maxTxPacketCount, system_tick_t duration, size_t maxPayloadSize,
+            network_handle_t skipNetwork = NETWORK_INTERFACE_ALL);
     ~ConnectionTester();
 
     int prepare(bool fullTest = true, bool lastTestFailed = false);
@@ -105,11 +155,16 @@ private:
     ConnectionMetrics* metricsFromSocketDescriptor(int socketDescriptor);
     bool testPacketsOutstanding();
 
-    const uint8_t REACHABILITY_TEST_MSG = 252;
-    const system_tick_t REACHABILITY_MAX_PAYLOAD_SIZE = 512; // FIXME: get some constant from cloud layer
-    const system_tick_t REACHABILITY_TEST_DURATION_MS = 5000;
-    const system_tick_t REACHABILITY_TEST_PACKET_TX_TIMEOUT_MS = 250;
-    const unsigned REACHABILITY_TEST_MAX_TX_PACKET_COUNT = 10;
+    static constexpr uint8_t REACHABILITY_TEST_MSG = 252;
+    static constexpr system_tick_t REACHABILITY_MAX_PAYLOAD_SIZE = 512; // FIXME: get some constant from cloud layer
+    static constexpr system_tick_t REACHABILITY_TEST_DURATION_MS = 5000;
+    static constexpr system_tick_t REACHABILITY_TEST_PACKET_TX_TIMEOUT_MS = 250;
+    static constexpr unsigned REACHABILITY_TEST_MAX_TX_PACKET_COUNT = 10;
+
+    const unsigned maxTxPacketCount_;
+    const system_tick_t duration_;
+    const size_t maxPayloadSize_;
+    const network_handle_t skipNetwork_;
 
     Vector<ConnectionMetrics> metrics_;
     std::unique_ptr<pollfd[]> pfds_;
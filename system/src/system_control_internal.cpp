@@ -36,6 +36,7 @@
 #include "control/config.h"
 #include "control/storage.h"
 #include "control/cloud.h"
+#include "control/diagnostics.h"
 
 namespace particle {
 
@@ -43,38 +44,6 @@ namespace system {
 
 namespace {
 
-typedef int(*ReplyFormatterCallback)(Appender*, void* data);
-
-int formatReplyData(ctrl_request* req, ReplyFormatterCallback callback, void* data = nullptr,
-        size_t maxSize = std::numeric_limits<size_t>::max()) {
-    size_t bufSize = std::min((size_t)128, maxSize); // Initial size of the reply buffer
-    for (;;) {
-        int ret = system_ctrl_alloc_reply_data(req, bufSize, nullptr);
-        if (ret != 0) {
-            system_ctrl_alloc_reply_data(req, 0, nullptr);
-            return ret;
-        }
-        BufferAppender appender(req->reply_data, bufSize);
-        ret = callback(&appender, data);
-        if (ret != 0) {
-            system_ctrl_alloc_reply_data(req, 0, nullptr);
-            return ret;
-        }
-        const size_t size = appender.dataSize();
-        if (size > maxSize) {
-            system_ctrl_alloc_reply_data(req, 0, nullptr);
-            return SYSTEM_ERROR_TOO_LARGE;
-        }
-        if (size > bufSize) {
-            // Increase the buffer size and format the data once again
-            bufSize = std::min(size + size / 16, maxSize);
-            continue;
-        }
-        req->reply_size = size;
-        return 0; // OK
-    }
-}
-
 SystemControl g_systemControl;
 
 } // particle::system::
@@ -247,18 +216,7 @@ void SystemControl::processRequest(ctrl_request* req, ControlRequestChannel* cha
     }
 #endif // HAL_PLATFORM_ASSETS
     case CTRL_REQUEST_DIAGNOSTIC_INFO: {
-        if (req->request_size > 0) {
-            // TODO: Querying a part of the diagnostic data is not supported
-            setResult(req, SYSTEM_ERROR_NOT_SUPPORTED);
-        } else {
-            struct Formatter {
-                static int callback(Appender* appender, void* data) {
-                    return system_format_diag_data(nullptr, 0, 0, Appender::callback, appender, nullptr);
-                }
-            };
-            const int ret = formatReplyData(req, Formatter::callback);
-            setResult(req, ret);
-        }
+        setResult(req, ctrl::diagnostics::getDiagnosticInfo(req));
         break;
     }
     /* config requests */
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_diagnostics_snapshot.h"
+
+#include "spark_wiring_diagnostics.h"
+#include "varint.h"
+#include "check.h"
+
+namespace particle {
+
+namespace system {
+
+namespace {
+
+// Buffers encoded entries so that the appender is not called for every varint
+class FrameWriter {
+public:
+    FrameWriter(appender_fn append, void* appendData) :
+            append_(append),
+            appendData_(appendData),
+            size_(0),
+            ok_(true) {
+    }
+
+    void writeByte(uint8_t b) {
+        flushIfNeeded(1);
+        buf_[size_++] = b;
+    }
+
+    void writeVarint(uint32_t val) {
+        flushIfNeeded(maxUnsignedVarintSize<uint32_t>());
+        size_ += encodeUnsignedVarint((char*)buf_ + size_, sizeof(buf_) - size_, val);
+    }
+
+    bool flush() {
+        if (size_ > 0 && ok_) {
+            ok_ = append_(appendData_, buf_, size_);
+        }
+        size_ = 0;
+        return ok_;
+    }
+
+private:
+    uint8_t buf_[64];
+    appender_fn append_;
+    void* appendData_;
+    size_t size_;
+    bool ok_;
+
+    void flushIfNeeded(size_t n) {
+        if (sizeof(buf_) - size_ < n) {
+            flush();
+        }
+    }
+};
+
+inline uint32_t zigzag(int32_t val) {
+    return ((uint32_t)val << 1) ^ (uint32_t)(val >> 31);
+}
+
+} // namespace
+
+DiagnosticsSnapshot::DiagnosticsSnapshot(unsigned keyframeInterval, bool enabled) :
+        keyframeInterval_(keyframeInterval),
+        framesSinceKeyframe_(0),
+        sentMsgId_(0),
+        sentState_(FRAME_NONE),
+        valid_(false),
+        keyframeRequested_(false),
+        enabled_(enabled) {
+}
+
+int DiagnosticsSnapshot::encode(appender_fn append, void* appendData, bool keyframe) {
+    pending_.clear();
+    CHECK(diag_enum_sources(collectSource, nullptr, this, nullptr));
+    // If the previous frame is still pending, the other side may or may not have its values
+    if (!valid_ || keyframeRequested_ || sentState_ != FRAME_NONE ||
+            framesSinceKeyframe_ + 1 >= keyframeInterval_ || entries_.size() != pending_.size()) {
+        keyframe = true;
+    } else {
+        for (int i = 0; i < pending_.size(); ++i) {
+            if (pending_.at(i).id != entries_.at(i).id) {
+                keyframe = true;
+                break;
+            }
+        }
+    }
+    FrameWriter w(append, appendData);
+    w.writeByte(0);
+    w.writeByte(0);
+    w.writeByte(keyframe ? FRAME_KEY : FRAME_DELTA);
+    uint16_t prevId = 0;
+    for (int i = 0; i < pending_.size(); ++i) {
+        const auto& e = pending_.at(i);
+        if (!keyframe) {
+            const auto& prev = entries_.at(i);
+            if (e.error == prev.error && e.value == prev.value) {
+                continue;
+            }
+        }
+        w.writeVarint(((uint32_t)(e.id - prevId) << 1) | (e.error ? 1 : 0));
+        w.writeVarint(zigzag(e.value));
+        prevId = e.id;
+    }
+    if (!w.flush()) {
+        return SYSTEM_ERROR_TOO_LARGE;
+    }
+    swap(sent_, pending_);
+    sentState_ = FRAME_ENCODED;
+    keyframeRequested_ = false;
+    framesSinceKeyframe_ = keyframe ? 0 : framesSinceKeyframe_ + 1;
+    return 0;
+}
+
+void DiagnosticsSnapshot::frameSent(unsigned msgId) {
+    if (sentState_ == FRAME_ENCODED) {
+        sentMsgId_ = msgId;
+        sentState_ = FRAME_SENT;
+    }
+}
+
+void DiagnosticsSnapshot::acknowledge(unsigned msgId) {
+    if (sentState_ != FRAME_SENT || sentMsgId_ != msgId) {
+        return;
+    }
+    // The other side has received the values of the pending frame
+    swap(entries_, sent_);
+    sent_.clear();
+    sentState_ = FRAME_NONE;
+    valid_ = true;
+}
+
+void DiagnosticsSnapshot::frameLost(unsigned msgId) {
+    if (sentState_ != FRAME_SENT || sentMsgId_ != msgId) {
+        return;
+    }
+    sent_.clear();
+    sentState_ = FRAME_NONE;
+    keyframeRequested_ = true;
+}
+
+void DiagnosticsSnapshot::reset() {
+    entries_.clear();
+    sent_.clear();
+    sentState_ = FRAME_NONE;
+    valid_ = false;
+    keyframeRequested_ = false;
+}
+
+int DiagnosticsSnapshot::collectSource(const diag_source* src, void* data) {
+    const auto self = static_cast<DiagnosticsSnapshot*>(data);
+    Entry e = {};
+    e.id = src->id;
+    int ret = 0;
+    switch (src->type) {
+    case DIAG_TYPE_INT: {
+        AbstractIntegerDiagnosticData::IntType val = 0;
+        ret = AbstractIntegerDiagnosticData::get(src, val);
+        e.value = val;
+        break;
+    }
+    case DIAG_TYPE_UINT: {
+        AbstractUnsignedIntegerDiagnosticData::IntType val = 0;
+        ret = AbstractUnsignedIntegerDiagnosticData::get(src, val);
+        e.value = (int32_t)val;
+        break;
+    }
+    case DIAG_TYPE_HISTOGRAM:
+        // Histograms are only available in the JSON format
+        return 0;
+    default:
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+    if (ret < 0) {
+        e.error = true;
+        e.value = ret;
+    }
+    if (!self->pending_.append(e)) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    return 0;
+}
+
+DiagnosticsSnapshot* vitalsDiagnosticsSnapshot() {
+    static DiagnosticsSnapshot snapshot(DiagnosticsSnapshot::DEFAULT_KEYFRAME_INTERVAL,
+            SYSTEM_VITALS_DELTA_ENCODING);
+    return &snapshot;
+}
+
+} // namespace system
+
+} // namespace particle
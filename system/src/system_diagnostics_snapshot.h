@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "appender.h"
+#include "diagnostics.h"
+#include "spark_wiring_vector.h"
+
+#include <cstdint>
+
+// The compact encoding needs to be supported by the receiving side
+#ifndef SYSTEM_VITALS_DELTA_ENCODING
+#define SYSTEM_VITALS_DELTA_ENCODING 0
+#endif
+
+namespace particle {
+
+namespace system {
+
+/**
+ * Incremental encoder for diagnostic data.
+ *
+ * The snapshot keeps the values of all registered data sources that were last acknowledged by the
+ * receiving side. A keyframe contains all sources; a delta frame contains only the sources whose
+ * value or error state differs from the acknowledged values. A keyframe is produced for the first
+ * frame, after `reset()` or `requestKeyframe()`, if the set of registered sources changes, and
+ * every `keyframeInterval()` frames so that a consumer that missed a frame resynchronizes within a
+ * bounded number of frames.
+ *
+ * Values are always encoded as absolute values, so a duplicated frame doesn't affect how the
+ * following frames are decoded. Only one frame is tracked at a time: the values of a frame become
+ * the reference for delta frames once the acknowledgement for the message that carried it is
+ * received. A frame encoded while the previous one is still unacknowledged is a keyframe, since
+ * it is unknown which values the other side has.
+ *
+ * Frame format (all integers are varints, see `varint.h`):
+ *
+ * - 2 bytes: `0x00 0x00`. The legacy binary format starts with the ID size (2), so a zero value
+ *   identifies the compact format.
+ * - 1 byte: frame type, `FRAME_KEY` or `FRAME_DELTA`.
+ * - For each encoded source, in ascending order of IDs:
+ *   - `(id - previous_id) << 1 | error`, where `previous_id` is 0 for the first source.
+ *   - Zigzag-encoded value. If `error` is set, the value is the error code.
+ */
+class DiagnosticsSnapshot {
+public:
+    enum FrameType {
+        FRAME_KEY = 1,
+        FRAME_DELTA = 2
+    };
+
+    static const unsigned DEFAULT_KEYFRAME_INTERVAL = 12;
+
+    explicit DiagnosticsSnapshot(unsigned keyframeInterval = DEFAULT_KEYFRAME_INTERVAL,
+            bool enabled = false);
+
+    /**
+     * Encode the current values of all registered data sources.
+     *
+     * The encoded values become the reference for the following delta frames once the frame is
+     * acknowledged (see `frameSent()` and `acknowledge()`).
+     *
+     * @param append Appender function.
+     * @param appendData Opaque data passed to the appender function.
+     * @param keyframe Produce a keyframe regardless of the snapshot state.
+     * @return 0 on success, or a negative result code in case of an error.
+     */
+    int encode(appender_fn append, void* appendData, bool keyframe = false);
+
+    /**
+     * Notify the snapshot that the most recently encoded frame has been sent.
+     *
+     * @param msgId ID of the message that carried the frame.
+     */
+    void frameSent(unsigned msgId);
+
+    /**
+     * Notify the snapshot that a message has been acknowledged by the other side.
+     *
+     * If the message carried the pending frame, its values are used as the reference for delta
+     * frames. Acknowledgements for other messages are ignored.
+     *
+     * @param msgId Message ID.
+     */
+    void acknowledge(unsigned msgId);
+
+    /**
+     * Notify the snapshot that a message has been rejected by the other side or couldn't be
+     * delivered.
+     *
+     * If the message carried the pending frame, the frame is discarded and the next frame will be
+     * a keyframe.
+     *
+     * @param msgId Message ID.
+     */
+    void frameLost(unsigned msgId);
+
+    /**
+     * Discard the stored values. The next frame will be a keyframe.
+     *
+     * This method should be called when a new session with the other side is established.
+     */
+    void reset();
+
+    /**
+     * Make the next frame a keyframe without discarding the stored values.
+     */
+    void requestKeyframe() {
+        keyframeRequested_ = true;
+    }
+
+    void keyframeInterval(unsigned interval) {
+        keyframeInterval_ = interval;
+    }
+
+    unsigned keyframeInterval() const {
+        return keyframeInterval_;
+    }
+
+    /**
+     * Enable or disable the compact incremental encoding for the vitals published to the cloud.
+     */
+    void enabled(bool enabled) {
+        enabled_ = enabled;
+    }
+
+    bool enabled() const {
+        return enabled_;
+    }
+
+private:
+    struct Entry {
+        uint16_t id;
+        bool error;
+        int32_t value;
+    };
+
+    enum FrameState {
+        FRAME_NONE, // No frame is pending
+        FRAME_ENCODED, // The frame has been encoded but not sent yet
+        FRAME_SENT // The frame has been sent and is awaiting an acknowledgement
+    };
+
+    spark::Vector<Entry> entries_; // Acknowledged values
+    spark::Vector<Entry> sent_; // Values of the pending frame
+    spark::Vector<Entry> pending_;
+    unsigned keyframeInterval_;
+    unsigned framesSinceKeyframe_;
+    unsigned sentMsgId_; // ID of the message that carried the pending frame
+    FrameState sentState_;
+    bool valid_;
+    bool keyframeRequested_;
+    bool enabled_;
+
+    static int collectSource(const diag_source* src, void* data);
+};
+
+/**
+ * Get the snapshot used for the vitals published to the cloud.
+ *
+ * The compact encoding is enabled for it by default if `SYSTEM_VITALS_DELTA_ENCODING` is set to 1.
+ */
+DiagnosticsSnapshot* vitalsDiagnosticsSnapshot();
+
+} // namespace system
+
+} // namespace particle
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_idle_events.h"
+#include "system_idle_scheduler.h"
+#include "system_task.h"
+#include "system_cloud.h"
+#include "system_cloud_internal.h"
+#include "system_mode.h"
+#include "system_network.h"
+#include "system_network_internal.h"
+#include "system_update.h"
+#include "system_threading.h"
+#include "firmware_update.h"
+#include "timer_hal.h"
+#include "wlan_hal.h"
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_BLE_SETUP
+#include "ble_hal.h"
+#include "system_control_internal.h"
+#endif /* HAL_PLATFORM_BLE_SETUP */
+
+#include "backup_ram_hal.h"
+#include "spark_wiring_diagnostics.h"
+#include "trace_marker.h"
+
+using namespace particle;
+using namespace particle::system;
+
+// Defined in system_task.cpp
+void manage_cloud_connection(bool force_events);
+void manage_listening_mode_flag();
+void manage_ble_prov_mode();
+
+void system_loop_wakeup()
+{
+    // Wake up the system thread only once per pass of the loop so that the wakeups of
+    // repeated events don't pile up in the message queue
+    if (IdleScheduler::instance()->notify()) {
+#if PLATFORM_THREADING
+        SystemThread.wakeup();
+#endif
+    }
+}
+
+namespace {
+
+// Trace marker names of the subsystems
+const char* const IDLE_TRACE_MARKERS[IdleScheduler::SUBSYSTEM_COUNT] = {
+    "system:idle:network",
+    "system:idle:cloud",
+    "system:idle:setup",
+    "system:idle:other"
+};
+
+// Accounts the time spent in consecutive sections of the system loop to their subsystems. Each
+// section is also recorded as a trace marker so that long stalls can be inspected in a trace
+class IdleTimeAccounting {
+public:
+    explicit IdleTimeAccounting(IdleScheduler::Subsystem subsystem) :
+            subsystem_(subsystem),
+            start_(HAL_Timer_Get_Micro_Seconds()) {
+        PARTICLE_TRACE_BEGIN(IDLE_TRACE_MARKERS[subsystem_]);
+    }
+
+    ~IdleTimeAccounting() {
+        IdleScheduler::instance()->addTime(subsystem_, HAL_Timer_Get_Micro_Seconds() - start_);
+        PARTICLE_TRACE_END(IDLE_TRACE_MARKERS[subsystem_]);
+    }
+
+    void next(IdleScheduler::Subsystem subsystem) {
+        const auto now = HAL_Timer_Get_Micro_Seconds();
+        IdleScheduler::instance()->addTime(subsystem_, now - start_);
+        PARTICLE_TRACE_END(IDLE_TRACE_MARKERS[subsystem_]);
+        subsystem_ = subsystem;
+        start_ = now;
+        PARTICLE_TRACE_BEGIN(IDLE_TRACE_MARKERS[subsystem_]);
+    }
+
+private:
+    IdleScheduler::Subsystem subsystem_;
+    system_tick_t start_;
+};
+
+class IdleTimeDiagnosticData: public AbstractUnsignedIntegerDiagnosticData {
+public:
+    IdleTimeDiagnosticData(uint16_t id, const char* name, IdleScheduler::Subsystem subsystem) :
+            AbstractUnsignedIntegerDiagnosticData(id, name),
+            subsystem_(subsystem) {
+    }
+
+    virtual int get(IntType& val) override {
+        val = IdleScheduler::instance()->time(subsystem_) / 1000;
+        return 0; // OK
+    }
+
+private:
+    IdleScheduler::Subsystem subsystem_;
+};
+
+class IdleWakeupsDiagnosticData: public AbstractUnsignedIntegerDiagnosticData {
+public:
+    IdleWakeupsDiagnosticData() :
+            AbstractUnsignedIntegerDiagnosticData(DIAG_ID_SYSTEM_LOOP_WAKEUPS, DIAG_NAME_SYSTEM_LOOP_WAKEUPS) {
+    }
+
+    virtual int get(IntType& val) override {
+        val = IdleScheduler::instance()->wakeups();
+        return 0; // OK
+    }
+};
+
+class IdleMaxStallDiagnosticData: public AbstractUnsignedIntegerDiagnosticData {
+public:
+    IdleMaxStallDiagnosticData(uint16_t id, const char* name, bool source) :
+            AbstractUnsignedIntegerDiagnosticData(id, name),
+            source_(source) {
+    }
+
+    virtual int get(IntType& val) override {
+        const auto scheduler = IdleScheduler::instance();
+        val = source_ ? (IntType)scheduler->maxTimeSubsystem() : scheduler->maxTime();
+        return 0; // OK
+    }
+
+private:
+    bool source_;
+};
+
+IdleWakeupsDiagnosticData g_idleWakeupsDiag;
+IdleMaxStallDiagnosticData g_idleMaxStallDiag(DIAG_ID_SYSTEM_LOOP_MAX_STALL, DIAG_NAME_SYSTEM_LOOP_MAX_STALL,
+        false /* source */);
+IdleMaxStallDiagnosticData g_idleMaxStallSourceDiag(DIAG_ID_SYSTEM_LOOP_MAX_STALL_SOURCE,
+        DIAG_NAME_SYSTEM_LOOP_MAX_STALL_SOURCE, true /* source */);
+IdleTimeDiagnosticData g_idleNetworkTimeDiag(DIAG_ID_SYSTEM_LOOP_NETWORK_TIME, DIAG_NAME_SYSTEM_LOOP_NETWORK_TIME,
+        IdleScheduler::NETWORK);
+IdleTimeDiagnosticData g_idleCloudTimeDiag(DIAG_ID_SYSTEM_LOOP_CLOUD_TIME, DIAG_NAME_SYSTEM_LOOP_CLOUD_TIME,
+        IdleScheduler::CLOUD);
+IdleTimeDiagnosticData g_idleSetupTimeDiag(DIAG_ID_SYSTEM_LOOP_SETUP_TIME, DIAG_NAME_SYSTEM_LOOP_SETUP_TIME,
+        IdleScheduler::SETUP);
+IdleTimeDiagnosticData g_idleOtherTimeDiag(DIAG_ID_SYSTEM_LOOP_OTHER_TIME, DIAG_NAME_SYSTEM_LOOP_OTHER_TIME,
+        IdleScheduler::OTHER);
+
+/**
+ * Requests periodic polling from the subsystems that are in the middle of an operation. Idle
+ * subsystems don't need to be polled: anything that changes their state either posts a message
+ * to the system thread or calls system_loop_wakeup().
+ *
+ * Where incoming data on the cloud socket wakes up the system thread, a connected cloud is polled
+ * frequently only while the protocol is in the middle of an exchange with the server. The timers
+ * of an idle protocol, such as the keepalive ping, are handled within the maximum timeout of
+ * the scheduler.
+ */
+void schedule_idle_events(IdleScheduler* scheduler)
+{
+    if (SystemISRTaskQueue.hasTasks()) {
+        scheduler->schedule(0);
+        return;
+    }
+#if HAL_PLATFORM_IFAPI
+    bool active = SYSTEM_POWEROFF || SPARK_WLAN_RESET || network_connecting(0, 0, 0) || network_listening(0, 0, 0);
+    if (spark_cloud_flag_auto_connect() || SPARK_CLOUD_SOCKETED) {
+#if HAL_PLATFORM_SOCKET_IOCTL_NOTIFY
+        // The cloud socket notifies the system thread about incoming data
+        const bool cloudSocketNotify = system_thread_get_state(nullptr) == spark::feature::ENABLED;
+#else
+        const bool cloudSocketNotify = false;
+#endif
+        // Connecting, handshaking or disconnecting, or connected and exchanging messages
+        active = active || !SPARK_CLOUD_CONNECTED || !spark_cloud_flag_auto_connect() || !cloudSocketNotify ||
+                Spark_Communication_Busy();
+    }
+    active = active || SPARK_FLASH_UPDATE || system::FirmwareUpdate::instance()->isRunning();
+#if HAL_PLATFORM_BLE_SETUP
+    active = active || hal_ble_gap_is_connected(nullptr, nullptr);
+#endif
+#else
+    // The legacy network management code relies on being polled
+    const bool active = true;
+#endif // HAL_PLATFORM_IFAPI
+    if (active) {
+        scheduler->schedule(IdleScheduler::ACTIVE_POLL_PERIOD);
+    }
+}
+
+} // namespace
+
+#if HAL_PLATFORM_SETUP_BUTTON_UX
+extern void system_handle_button_clicks(bool isIsr);
+#endif
+
+void Spark_Idle_Events(bool force_events/*=false*/)
+{
+    PARTICLE_TRACE_SCOPE("system:idle_events");
+    ON_EVENT_DELTA();
+    spark_loop_total_millis = 0;
+
+    const auto scheduler = IdleScheduler::instance();
+    scheduler->begin(HAL_Timer_Get_Milli_Seconds());
+    IdleTimeAccounting timeAccounting(IdleScheduler::OTHER);
+
+    SystemISRTaskQueue.process();
+
+    if (!SYSTEM_POWEROFF) {
+
+#if HAL_PLATFORM_SETUP_BUTTON_UX
+        system_handle_button_clicks(false /* isIsr */);
+#endif
+
+        timeAccounting.next(IdleScheduler::NETWORK);
+
+        manage_network_connection();
+
+        manage_smart_config();
+
+        manage_ip_config();
+
+        timeAccounting.next(IdleScheduler::CLOUD);
+
+        manage_cloud_connection(force_events);
+
+        system::FirmwareUpdate::instance()->process();
+
+        timeAccounting.next(IdleScheduler::SETUP);
+
+        if (system_mode() != SAFE_MODE) {
+            manage_listening_mode_flag();
+        }
+
+#if HAL_PLATFORM_BACKUP_RAM_NEED_SYNC
+        hal_backup_ram_routine();
+#endif
+    }
+    else
+    {
+        system_pending_shutdown(RESET_REASON_USER);
+    }
+#if HAL_PLATFORM_BLE_SETUP
+    timeAccounting.next(IdleScheduler::SETUP);
+    // TODO: Process BLE channel events in a separate thread
+    system::SystemControl::instance()->run();
+    if (system_mode() != SAFE_MODE) {
+        manage_ble_prov_mode();
+    }
+#endif
+    timeAccounting.next(IdleScheduler::OTHER);
+    system_shutdown_if_needed();
+    schedule_idle_events(scheduler);
+}
+
+namespace particle {
+
+namespace system {
+
+system_tick_t runIdleEvents()
+{
+    Spark_Idle_Events(true);
+    // Block until the earliest deadline requested by the subsystems, or until a message is
+    // posted to the system thread or system_loop_wakeup() is called
+    return IdleScheduler::instance()->timeout(HAL_Timer_Get_Milli_Seconds());
+}
+
+} // namespace system
+
+} // namespace particle
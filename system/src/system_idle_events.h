@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "system_tick_hal.h"
+
+namespace particle {
+
+namespace system {
+
+/**
+ * Run a pass of the system loop on behalf of the idle system thread.
+ *
+ * @return Time the system thread can block for until the next pass, in milliseconds.
+ */
+system_tick_t runIdleEvents();
+
+} // namespace system
+
+} // namespace particle
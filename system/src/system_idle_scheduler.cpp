@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_idle_scheduler.h"
+
+namespace particle {
+
+namespace system {
+
+namespace {
+
+IdleScheduler g_scheduler;
+
+} // namespace
+
+const system_tick_t IdleScheduler::ACTIVE_POLL_PERIOD;
+const system_tick_t IdleScheduler::DEFAULT_MAX_TIMEOUT;
+
+void IdleScheduler::begin(system_tick_t now) {
+    // Events that occur while the loop is running are handled in the next pass
+    pending_ = false;
+    start_ = now;
+    period_ = maxTimeout_;
+    ++wakeups_;
+}
+
+void IdleScheduler::schedule(system_tick_t period) {
+    if (period < period_) {
+        period_ = period;
+    }
+}
+
+system_tick_t IdleScheduler::timeout(system_tick_t now) const {
+    if (pending_) {
+        return 0;
+    }
+    const system_tick_t elapsed = now - start_;
+    if (elapsed >= period_) {
+        return 0;
+    }
+    return period_ - elapsed;
+}
+
+IdleScheduler* IdleScheduler::instance() {
+    return &g_scheduler;
+}
+
+} // namespace system
+
+} // namespace particle
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "system_tick_hal.h"
+
+#include <cstdint>
+
+namespace particle {
+
+namespace system {
+
+/**
+ * Decides how long the system loop can block between two passes.
+ *
+ * At the beginning of each pass the loop calls `begin()`. Subsystems that need to be polled
+ * call `schedule()` with the longest period they can tolerate, and events that occur
+ * asynchronously (ISR tasks, button clicks, cloud connection requests) call `notify()`. When
+ * the pass is over, `timeout()` returns the time until the earliest deadline, or zero if an
+ * event is pending.
+ *
+ * The scheduler doesn't read the clock itself so that it can be driven by a fake one in tests.
+ */
+class IdleScheduler {
+public:
+    /**
+     * Subsystems that the time spent in the system loop is accounted to.
+     */
+    enum Subsystem {
+        NETWORK, ///< Network connection management.
+        CLOUD, ///< Cloud connection, protocol events and firmware updates.
+        SETUP, ///< Listening mode, BLE provisioning and control requests.
+        OTHER, ///< ISR tasks, button clicks and shutdown handling.
+        SUBSYSTEM_COUNT
+    };
+
+    /**
+     * Polling period of a subsystem that is actively doing something, in milliseconds.
+     */
+    static const system_tick_t ACTIVE_POLL_PERIOD = 100;
+
+    /**
+     * Maximum time the system loop can block when no subsystem requested a shorter period,
+     * in milliseconds.
+     */
+    static const system_tick_t DEFAULT_MAX_TIMEOUT = 1000;
+
+    // The constructor is constexpr so that the global instance is usable from ISRs before
+    // static initialization
+    explicit constexpr IdleScheduler(system_tick_t maxTimeout = DEFAULT_MAX_TIMEOUT) :
+            time_(),
+            maxTimeout_(maxTimeout),
+            start_(0),
+            period_(maxTimeout),
+            maxTime_(0),
+            maxTimeSubsystem_(OTHER),
+            wakeups_(0),
+            pending_(false) {
+    }
+
+    /**
+     * Start a pass of the system loop.
+     *
+     * @param now Current time in milliseconds.
+     */
+    void begin(system_tick_t now);
+
+    /**
+     * Request the system loop to run again after at most `period` milliseconds.
+     */
+    void schedule(system_tick_t period);
+
+    /**
+     * Request the system loop to run again as soon as possible.
+     *
+     * This method can be called from an ISR.
+     *
+     * @return `true` if no event was pending yet and the system loop needs to be woken up,
+     *         otherwise `false`.
+     */
+    bool notify() {
+        if (pending_) {
+            return false;
+        }
+        pending_ = true;
+        return true;
+    }
+
+    /**
+     * Get the time the system loop can block for.
+     *
+     * @param now Current time in milliseconds.
+     * @return Timeout in milliseconds.
+     */
+    system_tick_t timeout(system_tick_t now) const;
+
+    /**
+     * Account time spent in the system loop to a subsystem.
+     *
+     * @param subsystem Subsystem.
+     * @param micros Time in microseconds.
+     */
+    void addTime(Subsystem subsystem, uint32_t micros) {
+        time_[subsystem] += micros;
+        if (micros > maxTime_) {
+            maxTime_ = micros;
+            maxTimeSubsystem_ = subsystem;
+        }
+    }
+
+    /**
+     * Get the total time spent in a subsystem, in microseconds.
+     */
+    uint64_t time(Subsystem subsystem) const {
+        return time_[subsystem];
+    }
+
+    /**
+     * Get the longest time spent in a subsystem in one pass of the system loop, in microseconds.
+     */
+    uint32_t maxTime() const {
+        return maxTime_;
+    }
+
+    /**
+     * Get the subsystem that `maxTime()` was spent in.
+     */
+    Subsystem maxTimeSubsystem() const {
+        return maxTimeSubsystem_;
+    }
+
+    /**
+     * Get the number of passes of the system loop.
+     */
+    unsigned wakeups() const {
+        return wakeups_;
+    }
+
+    void maxTimeout(system_tick_t timeout) {
+        maxTimeout_ = timeout;
+    }
+
+    system_tick_t maxTimeout() const {
+        return maxTimeout_;
+    }
+
+    static IdleScheduler* instance();
+
+private:
+    uint64_t time_[SUBSYSTEM_COUNT];
+    system_tick_t maxTimeout_;
+    system_tick_t start_;
+    system_tick_t period_;
+    uint32_t maxTime_;
+    Subsystem maxTimeSubsystem_;
+    unsigned wakeups_;
+    volatile bool pending_;
+};
+
+} // namespace system
+
+} // namespace particle
@@ -18,6 +18,7 @@
 #include "system_info.h"
 #include "system_cloud_internal.h"
 #include "system_info_encoding.h"
+#include "system_diagnostics_snapshot.h"
 #include "check.h"
 #include "scope_guard.h"
 #include "bytes2hexbuf.h"
@@ -30,7 +31,10 @@
 #include "control/common.h"
 #if HAL_PLATFORM_PROTOBUF
 #include "security_mode.h"
+#include "static_recursive_mutex.h"
+#include "spark_wiring_vector.h"
 #include "cloud/describe.pb.h"
+#include <mutex>
 using particle::control::common::EncodedString;
 #endif // HAL_PLATFORM_PROTOBUF
 
@@ -168,6 +172,14 @@ protected:
 			}
 			break;
 		}
+		case DIAG_TYPE_HISTOGRAM: {
+			diag_histogram val = {};
+			const int ret = AbstractHistogramDiagnosticData::get(src, val);
+			if ((ret == 0 && !fmt.formatSourceHistogram(src, val)) || (ret != 0 && !fmt.formatSourceError(src, ret))) {
+				return SYSTEM_ERROR_TOO_LARGE;
+			}
+			break;
+		}
 		default:
 			return SYSTEM_ERROR_NOT_SUPPORTED;
 		}
@@ -250,6 +262,27 @@ public:
 		json.name(src->name).value(val);
 		return json.isOk();
 	}
+
+	bool formatSourceHistogram(const diag_source* src, const diag_histogram& val) {
+		// Trailing empty buckets are omitted
+		unsigned bucketCount = DIAG_HISTOGRAM_BUCKET_COUNT;
+		while (bucketCount > 0 && !val.buckets[bucketCount - 1]) {
+			--bucketCount;
+		}
+		json.name(src->name);
+		json.beginObject();
+		json.name("n").value(val.count);
+		json.name("sum").value(val.sum);
+		json.name("min").value(val.min);
+		json.name("max").value(val.max);
+		json.name("b").beginArray();
+		for (unsigned i = 0; i < bucketCount; ++i) {
+			json.value(val.buckets[i]);
+		}
+		json.endArray();
+		json.endObject();
+		return json.isOk();
+	}
 };
 
 
@@ -282,7 +315,8 @@ public:
 	}
 
 	inline bool isSourceOk(const diag_source* src) {
-	    return true;
+	    // Histograms don't fit the fixed-size entries of this format
+	    return src->type != DIAG_TYPE_HISTOGRAM;
 	}
 
 	inline bool formatSourceInt(const diag_source* src, AbstractIntegerDiagnosticData::IntType val) {
@@ -293,6 +327,10 @@ public:
 		return data.write(src->id) && data.write(val);
 	}
 
+	inline bool formatSourceHistogram(const diag_source* src, const diag_histogram& val) {
+		return true;
+	}
+
 };
 
 #if HAL_PLATFORM_PROTOBUF
@@ -438,6 +476,12 @@ int system_format_diag_data(const uint16_t* id, size_t count, unsigned flags, ap
 }
 
 bool system_metrics(appender_fn appender, void* append_data, uint32_t flags, uint32_t page, void* reserved) {
+    const auto snapshot = particle::system::vitalsDiagnosticsSnapshot();
+    if ((flags & 1) && snapshot->enabled()) {
+        // Compact encoding of the data sources that changed since the last acknowledged publish.
+        // A server request gets all the data sources
+        return snapshot->encode(appender, append_data, flags & 2) == 0;
+    }
     const int ret = system_format_diag_data(nullptr, 0, flags, appender, append_data, nullptr);
     return ret == 0;
 }
@@ -469,22 +513,26 @@ bool system_app_info(appender_fn appender, void* append_data, void* reserved) {
 }
 
 #if HAL_PLATFORM_PROTOBUF
-bool system_module_info_pb(appender_fn appender, void* append_data, void* reserved) {
-    PB(SystemDescribe) pbDesc = {};
-    // Firmware modules
-    EncodeFirmwareModules modules(&pbDesc.firmware_modules, EncodeFirmwareModules::Flag::SYSTEM_INFO_CLOUD);
 
+namespace {
+
+using spark::Vector;
+
+bool isDeviceProtected() {
     // Report the actual status of device protection, even if it's temporarily disabled
-    if (security_mode_get(nullptr) == MODULE_INFO_SECURITY_MODE_PROTECTED || security_mode_is_overridden()) {
-        pbDesc.protected_state = true;
-    }
+    return security_mode_get(nullptr) == MODULE_INFO_SECURITY_MODE_PROTECTED || security_mode_is_overridden();
+}
+
+bool encodeSystemDescribe(PB(SystemDescribe)* pbDesc, const hal_system_info_t& sysInfo, appender_fn appender,
+        void* appendData) {
+    pbDesc->protected_state = isDeviceProtected();
 
     // IMEI, ICCID, modem firmware version
-    EncodedString pbImei(&pbDesc.imei);
-    EncodedString pbIccid(&pbDesc.iccid);
-    EncodedString pbModemFwVer(&pbDesc.modem_firmware_version);
-    for (unsigned i = 0; i < modules.sysInfo()->key_value_count; ++i) {
-        const auto& keyVal = modules.sysInfo()->key_values[i];
+    EncodedString pbImei(&pbDesc->imei);
+    EncodedString pbIccid(&pbDesc->iccid);
+    EncodedString pbModemFwVer(&pbDesc->modem_firmware_version);
+    for (unsigned i = 0; i < sysInfo.key_value_count; ++i) {
+        const auto& keyVal = sysInfo.key_values[i];
         if (strcmp(keyVal.key, "imei") == 0) {
             pbImei.data = keyVal.value;
             pbImei.size = strlen(keyVal.value);
@@ -497,10 +545,167 @@ bool system_module_info_pb(appender_fn appender, void* append_data, void* reserv
         }
     }
 #if HAL_PLATFORM_ASSETS
-    EncodeAssets assets(&pbDesc.assets, AssetManager::instance().availableAssets());
+    EncodeAssets assets(&pbDesc->assets, AssetManager::instance().availableAssets());
+#endif // HAL_PLATFORM_ASSETS
+    PbAppenderStream strm(appender, appendData);
+    return pb_encode(&strm, &PB(SystemDescribe_msg), pbDesc);
+}
+
+/**
+ * Cache of the encoded system describe.
+ *
+ * HAL_System_Info() checks the integrity of every module in flash, and the describe is encoded
+ * for every Describe message, so a burst of reconnects would walk and encode the same modules over
+ * and over again. The encoded describe is reused as long as the module storage is not modified
+ * (see HAL_FLASH_Revision()) and the system properties, available assets and protection state
+ * reported along with the modules stay the same. After the storage has been modified, the modules
+ * are walked again, but the describe is only encoded again if the bounds or CRCs of the modules
+ * have changed.
+ */
+class SystemDescribeCache {
+public:
+    SystemDescribeCache() :
+            flashRevision_(0),
+            protected_(false),
+            valid_(false) {
+    }
+
+    bool append(appender_fn appender, void* appendData);
+
+    static SystemDescribeCache* instance() {
+        static SystemDescribeCache cache;
+        return &cache;
+    }
+
+private:
+    // Module info the encoded describe depends on
+    struct ModuleKey {
+        uint32_t startAddress;
+        uint32_t endAddress;
+        uint32_t crc;
+        uint16_t validityChecked;
+        uint16_t validityResult;
+    };
+
+    Vector<char> data_; // Encoded describe
+    Vector<ModuleKey> modules_;
+    Vector<key_value> props_;
+#if HAL_PLATFORM_ASSETS
+    Vector<Asset> assets_;
+#endif // HAL_PLATFORM_ASSETS
+    uint32_t flashRevision_;
+    bool protected_;
+    bool valid_;
+    StaticRecursiveMutex mutex_;
+
+    bool modulesChanged(const hal_system_info_t& sysInfo) const;
+    bool stateChanged(const hal_system_info_t& sysInfo) const;
+    bool saveState(const hal_system_info_t& sysInfo);
+
+    static ModuleKey moduleKey(const hal_module_t& module);
+};
+
+bool SystemDescribeCache::append(appender_fn appender, void* appendData) {
+    const std::lock_guard<StaticRecursiveMutex> lock(mutex_);
+    const auto flashRevision = HAL_FLASH_Revision(nullptr);
+    if (valid_ && flashRevision == flashRevision_) {
+        // The modules haven't changed but the system properties still need to be checked
+        hal_system_info_t props = {};
+        props.size = sizeof(props);
+        props.flags = HAL_SYSTEM_INFO_FLAGS_CLOUD;
+        HAL_OTA_Add_System_Info(&props, true /* create */, nullptr /* reserved */);
+        const bool changed = stateChanged(props);
+        HAL_OTA_Add_System_Info(&props, false /* create */, nullptr /* reserved */);
+        if (!changed) {
+            return appender(appendData, (const uint8_t*)data_.data(), data_.size());
+        }
+    }
+    PB(SystemDescribe) pbDesc = {};
+    // Firmware modules
+    EncodeFirmwareModules modules(&pbDesc.firmware_modules, EncodeFirmwareModules::Flag::SYSTEM_INFO_CLOUD);
+    const auto& sysInfo = *modules.sysInfo();
+    if (!valid_ || modulesChanged(sysInfo) || stateChanged(sysInfo)) {
+        valid_ = false;
+        data_.clear();
+        const auto appendToCache = [](void* data, const uint8_t* buf, size_t size) {
+            return ((Vector<char>*)data)->append((const char*)buf, size);
+        };
+        if (!encodeSystemDescribe(&pbDesc, sysInfo, appendToCache, &data_) || !saveState(sysInfo)) {
+            // Not enough memory to cache the describe
+            data_ = Vector<char>();
+            return encodeSystemDescribe(&pbDesc, sysInfo, appender, appendData);
+        }
+    }
+    flashRevision_ = flashRevision;
+    // Don't reuse the describe if the storage was modified while the modules were being walked
+    valid_ = (HAL_FLASH_Revision(nullptr) == flashRevision);
+    return appender(appendData, (const uint8_t*)data_.data(), data_.size());
+}
+
+bool SystemDescribeCache::modulesChanged(const hal_system_info_t& sysInfo) const {
+    if (modules_.size() != sysInfo.module_count) {
+        return true;
+    }
+    for (unsigned i = 0; i < sysInfo.module_count; ++i) {
+        const auto key = moduleKey(sysInfo.modules[i]);
+        if (memcmp(&key, &modules_[i], sizeof(key)) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SystemDescribeCache::stateChanged(const hal_system_info_t& sysInfo) const {
+    if (props_.size() != sysInfo.key_value_count) {
+        return true;
+    }
+    for (unsigned i = 0; i < sysInfo.key_value_count; ++i) {
+        const auto& prop = sysInfo.key_values[i];
+        if (strcmp(prop.key, props_[i].key) != 0 || strcmp(prop.value, props_[i].value) != 0) {
+            return true;
+        }
+    }
+#if HAL_PLATFORM_ASSETS
+    if (AssetManager::instance().availableAssets() != assets_) {
+        return true;
+    }
 #endif // HAL_PLATFORM_ASSETS
-    PbAppenderStream strm(appender, append_data);
-    return pb_encode(&strm, &PB(SystemDescribe_msg), &pbDesc);
+    return isDeviceProtected() != protected_;
+}
+
+bool SystemDescribeCache::saveState(const hal_system_info_t& sysInfo) {
+    modules_.clear();
+    if (!modules_.reserve(sysInfo.module_count)) {
+        return false;
+    }
+    for (unsigned i = 0; i < sysInfo.module_count; ++i) {
+        modules_.append(moduleKey(sysInfo.modules[i]));
+    }
+    props_.clear();
+    if (!props_.append(sysInfo.key_values, sysInfo.key_value_count)) {
+        return false;
+    }
+#if HAL_PLATFORM_ASSETS
+    assets_ = AssetManager::instance().availableAssets();
+#endif // HAL_PLATFORM_ASSETS
+    protected_ = isDeviceProtected();
+    return true;
+}
+
+SystemDescribeCache::ModuleKey SystemDescribeCache::moduleKey(const hal_module_t& module) {
+    ModuleKey key = {};
+    key.startAddress = module.bounds.start_address;
+    key.endAddress = module.bounds.end_address;
+    key.crc = module.crc.crc32;
+    key.validityChecked = module.validity_checked;
+    key.validityResult = module.validity_result;
+    return key;
+}
+
+} // anonymous
+
+bool system_module_info_pb(appender_fn appender, void* append_data, void* reserved) {
+    return SystemDescribeCache::instance()->append(appender, append_data);
 }
 
 #endif // HAL_PLATFORM_PROTOBUF
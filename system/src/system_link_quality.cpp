@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_link_quality.h"
+
+namespace particle {
+
+namespace system {
+
+const unsigned LinkQuality::LOSS_SCALE;
+const unsigned LinkQuality::DEGRADED_LOSS;
+const system_tick_t LinkQuality::LOSS_PENALTY;
+const uint32_t LinkQuality::INVALID_SCORE;
+
+const size_t LinkQualityMonitor::MAX_INTERFACES;
+const unsigned LinkQualityMonitor::MIN_WINDOWS;
+const system_tick_t LinkQualityMonitor::MAX_AGE;
+const unsigned LinkQualityMonitor::FAILOVER_MARGIN;
+
+void LinkQuality::update(system_tick_t now, unsigned delivered, unsigned lost, system_tick_t roundTrip) {
+    const unsigned total = delivered + lost;
+    if (!total) {
+        return;
+    }
+    // The averages are kept scaled up so that they converge to the samples exactly, the same way
+    // the TCP stacks do it
+    const unsigned loss = (uint64_t)lost * LOSS_SCALE / total;
+    if (!windows_) {
+        loss8_ = loss << 3;
+    } else {
+        // loss = 7/8 * loss + 1/8 * sample
+        loss8_ = loss8_ - (loss8_ >> 3) + loss;
+    }
+    if (delivered) {
+        if (!hasRoundTrip_) {
+            srtt8_ = roundTrip << 3;
+            rttvar4_ = roundTrip << 1;
+            hasRoundTrip_ = true;
+        } else {
+            // rttvar = 3/4 * rttvar + 1/4 * |srtt - sample|, srtt = 7/8 * srtt + 1/8 * sample
+            const system_tick_t srtt = srtt8_ >> 3;
+            const system_tick_t delta = (srtt > roundTrip) ? srtt - roundTrip : roundTrip - srtt;
+            rttvar4_ = rttvar4_ - (rttvar4_ >> 2) + delta;
+            srtt8_ = srtt8_ - (srtt8_ >> 3) + roundTrip;
+        }
+    }
+    ++windows_;
+    lastUpdate_ = now;
+}
+
+void LinkQuality::reset() {
+    srtt8_ = 0;
+    rttvar4_ = 0;
+    lastUpdate_ = 0;
+    loss8_ = 0;
+    windows_ = 0;
+    hasRoundTrip_ = false;
+}
+
+uint32_t LinkQuality::score() const {
+    const unsigned l = loss();
+    if (!hasRoundTrip_ || l >= LOSS_SCALE) {
+        return INVALID_SCORE;
+    }
+    // Every delivered message takes on average l / (1 - l) losses before it gets through
+    const uint64_t s = (uint64_t)roundTrip() + roundTripVar() + (uint64_t)LOSS_PENALTY * l / (LOSS_SCALE - l);
+    return (s < INVALID_SCORE) ? s : INVALID_SCORE - 1;
+}
+
+uint32_t LinkQualityMonitor::score(unsigned iface, system_tick_t now) const {
+    const auto l = link(iface);
+    if (!l || !l->windows() || now - l->lastUpdate() > MAX_AGE) {
+        return LinkQuality::INVALID_SCORE;
+    }
+    return l->score();
+}
+
+int LinkQualityMonitor::failoverTarget(unsigned current, uint32_t ready, system_tick_t now) const {
+    const auto cur = link(current);
+    if (!cur || cur->windows() < MIN_WINDOWS) {
+        return -1;
+    }
+    const uint64_t curScore = cur->score();
+    int target = -1;
+    uint32_t targetScore = LinkQuality::INVALID_SCORE;
+    for (unsigned i = 0; i < MAX_INTERFACES; ++i) {
+        if (i == current || !(ready & (1u << i))) {
+            continue;
+        }
+        const auto s = score(i, now);
+        if (s < targetScore) {
+            target = i;
+            targetScore = s;
+        }
+    }
+    if (target < 0 || (uint64_t)targetScore * FAILOVER_MARGIN / 100 >= curScore) {
+        return -1;
+    }
+    return target;
+}
+
+void LinkQualityMonitor::reset() {
+    for (auto& l: links_) {
+        l.reset();
+    }
+}
+
+} // namespace system
+
+} // namespace particle
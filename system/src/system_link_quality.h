@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "system_tick_hal.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace particle {
+
+namespace system {
+
+/**
+ * Smoothed round-trip time and loss rate of a network link.
+ *
+ * The estimate is updated with observation windows: the number of messages that were delivered
+ * and lost during the window, and their average round-trip time. The round-trip time is smoothed
+ * the same way TCP does it (RFC 6298), and the loss rate is an exponentially weighted moving
+ * average of the per-window loss ratios.
+ */
+class LinkQuality {
+public:
+    /**
+     * Scale of the loss rate (the loss rate is in per mille).
+     */
+    static const unsigned LOSS_SCALE = 1000;
+
+    /**
+     * Loss rate at which a link is considered degraded, in per mille.
+     */
+    static const unsigned DEGRADED_LOSS = 200;
+
+    /**
+     * Time it takes to detect a lost message and send it again, in milliseconds (the CoAP
+     * acknowledgement timeout).
+     */
+    static const system_tick_t LOSS_PENALTY = 4000;
+
+    /**
+     * Score of a link with no usable estimate.
+     */
+    static const uint32_t INVALID_SCORE = UINT32_MAX;
+
+    LinkQuality() {
+        reset();
+    }
+
+    /**
+     * Add an observation window.
+     *
+     * @param now Current time in milliseconds.
+     * @param delivered Number of messages that were acknowledged.
+     * @param lost Number of messages that were not acknowledged in time.
+     * @param roundTrip Average round-trip time of the acknowledged messages, in milliseconds.
+     */
+    void update(system_tick_t now, unsigned delivered, unsigned lost, system_tick_t roundTrip);
+
+    /**
+     * Discard the estimate.
+     */
+    void reset();
+
+    /**
+     * Check if a round-trip time has been observed.
+     */
+    bool valid() const {
+        return hasRoundTrip_;
+    }
+
+    /**
+     * Check if the loss rate is at or above `DEGRADED_LOSS`.
+     */
+    bool degraded() const {
+        return windows_ > 0 && loss() >= DEGRADED_LOSS;
+    }
+
+    /**
+     * Get the smoothed round-trip time, in milliseconds.
+     */
+    system_tick_t roundTrip() const {
+        return srtt8_ >> 3;
+    }
+
+    /**
+     * Get the round-trip time variation, in milliseconds.
+     */
+    system_tick_t roundTripVar() const {
+        return rttvar4_ >> 2;
+    }
+
+    /**
+     * Get the loss rate, in per mille.
+     */
+    unsigned loss() const {
+        return loss8_ >> 3;
+    }
+
+    /**
+     * Get the link score.
+     *
+     * The score is the expected time it takes to get a message acknowledged over the link, in
+     * milliseconds: the round-trip time and its variation, plus `LOSS_PENALTY` for every loss
+     * that a delivered message takes on average. A lower score is better.
+     *
+     * @return Score or `INVALID_SCORE` if there's no usable estimate.
+     */
+    uint32_t score() const;
+
+    /**
+     * Get the number of observation windows.
+     */
+    unsigned windows() const {
+        return windows_;
+    }
+
+    /**
+     * Get the time of the last update, in milliseconds.
+     */
+    system_tick_t lastUpdate() const {
+        return lastUpdate_;
+    }
+
+private:
+    system_tick_t srtt8_; // Smoothed round-trip time scaled by 8
+    system_tick_t rttvar4_; // Round-trip time variation scaled by 4
+    system_tick_t lastUpdate_;
+    unsigned loss8_; // Loss rate scaled by 8
+    unsigned windows_;
+    bool hasRoundTrip_;
+};
+
+/**
+ * Per-interface link quality estimates and the failover policy that is based on them.
+ */
+class LinkQualityMonitor {
+public:
+    /**
+     * Maximum number of interfaces (interface indices are in the range [0, MAX_INTERFACES)).
+     */
+    static const size_t MAX_INTERFACES = 8;
+
+    /**
+     * Number of observation windows a link needs before it can be failed over from.
+     */
+    static const unsigned MIN_WINDOWS = 3;
+
+    /**
+     * Maximum age of an estimate that can be failed over to, in milliseconds.
+     */
+    static const system_tick_t MAX_AGE = 5 * 60 * 1000;
+
+    /**
+     * A link needs to score better than the current one by this factor, in percent, for the
+     * connection to be moved to it.
+     */
+    static const unsigned FAILOVER_MARGIN = 150;
+
+    /**
+     * Get the estimate of an interface.
+     *
+     * @param iface Interface index.
+     * @return Estimate or `nullptr` if the index is out of range.
+     */
+    LinkQuality* link(unsigned iface) {
+        return (iface < MAX_INTERFACES) ? &links_[iface] : nullptr;
+    }
+
+    const LinkQuality* link(unsigned iface) const {
+        return (iface < MAX_INTERFACES) ? &links_[iface] : nullptr;
+    }
+
+    /**
+     * Get the score of an interface, taking the age of its estimate into account.
+     *
+     * @param iface Interface index.
+     * @param now Current time in milliseconds.
+     * @return Score or `LinkQuality::INVALID_SCORE`.
+     */
+    uint32_t score(unsigned iface, system_tick_t now) const;
+
+    /**
+     * Choose an interface to move the connection to.
+     *
+     * A connection is moved only when its current link has enough observations to tell and
+     * another ready interface scores better by at least `FAILOVER_MARGIN`.
+     *
+     * @param current Interface currently carrying the connection.
+     * @param ready Mask of the interfaces that are ready (bit N is set for interface N).
+     * @param now Current time in milliseconds.
+     * @return Interface index or a negative value if the connection should stay where it is.
+     */
+    int failoverTarget(unsigned current, uint32_t ready, system_tick_t now) const;
+
+    /**
+     * Discard all estimates.
+     */
+    void reset();
+
+private:
+    LinkQuality links_[MAX_INTERFACES];
+};
+
+} // namespace system
+
+} // namespace particle
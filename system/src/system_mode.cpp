@@ -63,11 +63,13 @@ void spark_cloud_flag_connect(void)
     SPARK_WLAN_SLEEP = 0;
     // Reset disconnection options
     CloudConnectionSettings::instance()->takePendingDisconnectOptions();
+    system_loop_wakeup();
 }
 
 void spark_cloud_flag_disconnect(void)
 {
     SPARK_CLOUD_AUTO_CONNECT = 0;
+    system_loop_wakeup();
 }
 
 bool spark_cloud_flag_auto_connect()
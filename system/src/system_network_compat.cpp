@@ -257,6 +257,23 @@ bool network_is_preferred(network_handle_t network, void* reserved) {
     return false;
 }
 
+network_handle_t network_redundant(network_handle_t network, bool redundant, void* reserved) {
+    return NETWORK_INTERFACE_ALL;
+}
+
+bool network_is_redundant(network_handle_t network, void* reserved) {
+    return false;
+}
+
+int network_resolve(network_handle_t network, const char* name, HAL_IPAddress* addrs, size_t count, unsigned flags, void* reserved) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+int network_resolve_async(network_handle_t network, const char* name, unsigned flags, completion_callback callback,
+        void* callback_data, void* reserved) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
 /* FIXME: */
 extern int cfod_count;
 
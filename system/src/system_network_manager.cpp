@@ -52,6 +52,7 @@ LOG_SOURCE_CATEGORY("system.nm")
 #include "control/network.h"
 #include <unistd.h>
 #include "system_connection_manager.h"
+#include "system_resolver.h"
 #include "spark_wiring_cloud.h"
 
 #define CHECKV(_expr) \
@@ -842,6 +843,8 @@ void NetworkManager::resolvEventHandlerCb(void* arg, const void* data) {
 }
 
 void NetworkManager::resolvEventHandler(const void* data) {
+    // The cached results may have come from a DNS server that is no longer configured
+    Resolver::instance()->flush();
     refreshIpState();
     // NOTE: we could potentially force a cloud ping on DNS change, but
     // this seems excessive, and it's better to rely on IP state only instead
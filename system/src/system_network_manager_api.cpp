@@ -20,6 +20,7 @@
 #if HAL_PLATFORM_IFAPI
 
 #include "system_connection_manager.h"
+#include "system_resolver.h"
 #include "system_network.h"
 #include "system_network_internal.h"
 #include "system_update.h"
@@ -33,6 +34,8 @@
 
 #include <atomic>
 #include <algorithm>
+#include <memory>
+#include <new>
 
 #if HAL_PLATFORM_WIFI
 #include "wlan_hal.h"
@@ -88,6 +91,16 @@ void networkDisconnectImpl(network_handle_t network, network_disconnect_reason r
     }
 }
 
+struct ResolveCompletion {
+    completion_callback callback;
+    void* data;
+};
+
+void resolveCompletionCallback(int error, const HAL_IPAddress* addrs, size_t count, void* arg) {
+    const std::unique_ptr<ResolveCompletion> c(static_cast<ResolveCompletion*>(arg));
+    c->callback(error, (error < 0) ? nullptr : addrs, c->data, nullptr);
+}
+
 bool testAndClearListeningModeFlag() {
     static bool check = true;
     if (check) {
@@ -424,6 +437,29 @@ bool network_is_preferred(network_handle_t network, void* reserved) {
     return network == ConnectionManager::instance()->getPreferredNetwork();
 }
 
+network_handle_t network_redundant(network_handle_t network, bool redundant, void* reserved) {
+    ConnectionManager::instance()->setRedundantNetwork(network, redundant);
+    return ConnectionManager::instance()->getRedundantNetwork();
+}
+
+bool network_is_redundant(network_handle_t network, void* reserved) {
+    return network == ConnectionManager::instance()->getRedundantNetwork();
+}
+
+int network_resolve(network_handle_t network, const char* name, HAL_IPAddress* addrs, size_t count, unsigned flags, void* reserved) {
+    return Resolver::instance()->resolve(name, network, flags, addrs, count);
+}
+
+int network_resolve_async(network_handle_t network, const char* name, unsigned flags, completion_callback callback,
+        void* callback_data, void* reserved) {
+    CHECK_TRUE(callback, SYSTEM_ERROR_INVALID_ARGUMENT);
+    std::unique_ptr<ResolveCompletion> c(new(std::nothrow) ResolveCompletion{ callback, callback_data });
+    CHECK_TRUE(c, SYSTEM_ERROR_NO_MEMORY);
+    CHECK(Resolver::instance()->resolveAsync(name, network, flags, resolveCompletionCallback, c.get()));
+    c.release(); // Deleted by resolveCompletionCallback()
+    return 0;
+}
+
 
 int network_set_credentials(network_handle_t network, uint32_t, NetworkCredentials* credentials, void*) {
     switch (network) {
@@ -50,11 +50,12 @@ inline int postDescription()
 namespace particle { namespace system {
 
 template <class Timer>
-VitalsPublisher<Timer>::VitalsPublisher(Timer* timer_)
+VitalsPublisher<Timer>::VitalsPublisher(Timer* timer_, DiagnosticsSnapshot* snapshot_)
     : _period_s(std::numeric_limits<system_tick_t>::max()),
       _timer(timer_ ? timer_
                     : new Timer(_period_s, &VitalsPublisher::publishFromTimer, *this, false)),
-      _timer_owner(!timer_)
+      _timer_owner(!timer_),
+      _snapshot(snapshot_ ? snapshot_ : vitalsDiagnosticsSnapshot())
 {
 }
 
@@ -112,9 +113,24 @@ void VitalsPublisher<Timer>::period(system_tick_t period_s_)
     }
 }
 
+template <class Timer>
+bool VitalsPublisher<Timer>::deltaEncoding(void) const
+{
+    return _snapshot->enabled();
+}
+
+template <class Timer>
+void VitalsPublisher<Timer>::deltaEncoding(bool enabled_)
+{
+    _snapshot->enabled(enabled_);
+    _snapshot->reset();
+}
+
 template <class Timer>
 int VitalsPublisher<Timer>::publish(void)
 {
+    // Immediate publishes always carry a full keyframe
+    _snapshot->requestKeyframe();
     return postDescription();
 }
 
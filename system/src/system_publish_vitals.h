@@ -6,6 +6,7 @@
 #include <functional>
 
 #include "spark_protocol_functions.h"
+#include "system_diagnostics_snapshot.h"
 #include "system_tick_hal.h"
 
 namespace particle
@@ -21,6 +22,10 @@ namespace system
  * publish vitals information to the cloud. This information is then consumed
  * by the fleet health metrics dashboard in the console.
  *
+ * When delta encoding is enabled, periodic publishes only carry the data
+ * sources that changed since the previous publish, while an immediate
+ * publish always carries a full keyframe.
+ *
  * @tparam Timer An API compatible timer class with \p spark_wiring_timer.h:Timer
  *
  * @sa Timer
@@ -35,8 +40,10 @@ public:
      * The constructor initializes all member variables to known values.
      *
      * @param[in] timer The timer used to schedule the period
+     * @param[in] snapshot The diagnostics snapshot used for delta encoding
+     *                     (defaults to the system vitals snapshot)
      */
-    VitalsPublisher(Timer* timer = nullptr);
+    VitalsPublisher(Timer* timer = nullptr, DiagnosticsSnapshot* snapshot = nullptr);
 
     /**
      * @brief Destructor
@@ -70,6 +77,20 @@ public:
      */
     void period(system_tick_t period_s);
 
+    /**
+     * @brief Check whether delta encoding is enabled
+     *
+     * @return \p true if only changed data sources are published periodically
+     */
+    bool deltaEncoding(void) const;
+
+    /**
+     * @brief Enable or disable delta encoding
+     *
+     * @param[in] enabled \p true to publish only changed data sources
+     */
+    void deltaEncoding(bool enabled);
+
     /**
      * @brief Publish vitals information to the cloud (immediately)
      *
@@ -84,6 +105,7 @@ private:
     system_tick_t _period_s;
     Timer* const _timer;
     const bool _timer_owner;
+    DiagnosticsSnapshot* const _snapshot;
 
     /**
      * @brief Publish vitals from Timer callback
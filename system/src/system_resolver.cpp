@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_resolver.h"
+
+#if HAL_USE_SOCKET_HAL_POSIX
+
+#include "netdb_hal.h"
+#include "ifapi.h"
+#include "concurrent_hal.h"
+#include "timer_hal.h"
+#include "system_threading.h"
+#include "system_error.h"
+#include "check.h"
+#include "scope_guard.h"
+#include "spark_wiring_diagnostics.h"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstring>
+
+namespace particle {
+
+namespace system {
+
+namespace {
+
+// Maximum time a synchronous lookup waits for lwIP to complete it: the time it takes a query to
+// go through all its retransmissions to the DNS servers of an interface, plus a margin
+const system_tick_t LOOKUP_TIMEOUT = 30000;
+
+HistogramDiagnosticData g_latencyDiag(DIAG_ID_NETWORK_DNS_LATENCY_HISTOGRAM, DIAG_NAME_NETWORK_DNS_LATENCY_HISTOGRAM);
+
+class CacheHitsDiagnosticData: public AbstractUnsignedIntegerDiagnosticData {
+public:
+    CacheHitsDiagnosticData() :
+            AbstractUnsignedIntegerDiagnosticData(DIAG_ID_NETWORK_DNS_CACHE_HITS, DIAG_NAME_NETWORK_DNS_CACHE_HITS) {
+    }
+
+    virtual int get(IntType& val) override {
+        val = Resolver::instance()->cacheHits();
+        return 0; // OK
+    }
+} g_cacheHitsDiag;
+
+inline bool isIpv6(const HAL_IPAddress& addr) {
+#if HAL_IPv6
+    return addr.v == 6;
+#else
+    return false;
+#endif
+}
+
+bool sockaddrToIpAddress(const struct sockaddr* saddr, HAL_IPAddress* addr) {
+    *addr = {};
+    if (saddr->sa_family == AF_INET) {
+        // NOTE: HAL_IPAddress.ipv4 is host-order
+        addr->ipv4 = ntohl(((const struct sockaddr_in*)saddr)->sin_addr.s_addr);
+#if HAL_IPv6
+        addr->v = 4;
+#endif
+        return true;
+    }
+#if HAL_IPv6
+    if (saddr->sa_family == AF_INET6) {
+        memcpy(addr->ipv6, ((const struct sockaddr_in6*)saddr)->sin6_addr.s6_addr, sizeof(addr->ipv6));
+        addr->v = 6;
+        return true;
+    }
+#endif
+    return false;
+}
+
+// Returns the address family to query on a network, based on the IP protocols that are configured on it
+int readyFamily(network_handle_t network) {
+    const bool ipv4 = network_ready(network, NETWORK_READY_TYPE_IPV4, nullptr);
+    const bool ipv6 = network_ready(network, NETWORK_READY_TYPE_IPV6, nullptr);
+    if (ipv4 && ipv6) {
+        return AF_UNSPEC;
+    }
+    if (ipv4) {
+        return AF_INET;
+    }
+    if (ipv6) {
+        return AF_INET6;
+    }
+    return SYSTEM_ERROR_NETWORK;
+}
+
+// Moves the addresses that are usable on a network to the front of the array
+size_t filterReady(network_handle_t network, HAL_IPAddress* addrs, size_t count) {
+    const bool ipv4 = network_ready(network, NETWORK_READY_TYPE_IPV4, nullptr);
+    const bool ipv6 = network_ready(network, NETWORK_READY_TYPE_IPV6, nullptr);
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (isIpv6(addrs[i]) ? ipv6 : ipv4) {
+            addrs[n++] = addrs[i];
+        }
+    }
+    return n;
+}
+
+// Maps a getaddrinfo() error to a system error code
+int getaddrinfoError(int error) {
+    switch (error) {
+    case EAI_FAIL:
+    case EAI_NONAME:
+        return SYSTEM_ERROR_NOT_FOUND;
+    case EAI_AGAIN:
+        return SYSTEM_ERROR_TIMEOUT;
+    default:
+        return SYSTEM_ERROR_NETWORK;
+    }
+}
+
+} // namespace
+
+struct Resolver::Request: ISRTaskQueue::Task {
+    char name[ResolverCache::MAX_NAME_LENGTH + 1] = {}; // Empty if the name is too long to be cached
+    network_handle_t network = NETWORK_INTERFACE_ALL;
+    Callback callback = nullptr; // Not set if the caller waits for the semaphore
+    void* arg = nullptr;
+    os_semaphore_t sem = nullptr;
+    system_tick_t startTime = 0;
+    system_tick_t duration = 0;
+    HAL_IPAddress addrs[MAX_ADDRESSES] = {};
+    size_t count = 0;
+    int error = 0;
+    // Set by whichever of the waiting thread and the completion callback gives up the request first;
+    // the other one deletes it
+    std::atomic_bool detached{false};
+
+    ~Request() {
+        if (sem) {
+            os_semaphore_destroy(sem);
+        }
+    }
+};
+
+int Resolver::resolve(const char* name, network_handle_t network, unsigned flags, HAL_IPAddress* addrs, size_t maxCount) {
+    CHECK_TRUE(name && addrs && maxCount, SYSTEM_ERROR_INVALID_ARGUMENT);
+    if (flags & NETWORK_RESOLVE_FLAG_FLUSH_CACHE) {
+        flush(name);
+    } else {
+        const int r = getCached(name, network, addrs, maxCount);
+        if (r != 0) {
+            return r;
+        }
+        if (network == NETWORK_INTERFACE_ALL) {
+            // Wait for the A and AAAA queries made in parallel. LwIP completes every query, with or
+            // without an answer, but the wait is bounded in case a query gets stuck
+            std::unique_ptr<Request> req(new(std::nothrow) Request());
+            CHECK_TRUE(req, SYSTEM_ERROR_NO_MEMORY);
+            CHECK_TRUE(os_semaphore_create(&req->sem, 1, 0) == 0, SYSTEM_ERROR_NO_MEMORY);
+            CHECK(startLookup(req.get(), name, network));
+            if (os_semaphore_take(req->sem, LOOKUP_TIMEOUT, false) != 0) {
+                if (!req->detached.exchange(true)) {
+                    req.release(); // Deleted by resolveCallback()
+                    return SYSTEM_ERROR_TIMEOUT;
+                }
+                // The lookup has completed in the meantime
+                os_semaphore_take(req->sem, CONCURRENT_WAIT_FOREVER, false);
+            }
+            const size_t count = std::min<size_t>(CHECK(completeLookup(req.get())), maxCount);
+            memcpy(addrs, req->addrs, count * sizeof(HAL_IPAddress));
+            return count;
+        }
+    }
+    // LwIP's asynchronous API can neither bind a query to an interface nor flush its own cache,
+    // so the remaining lookups go through getaddrinfo()
+    if_t iface = nullptr;
+    if (network != NETWORK_INTERFACE_ALL) {
+        CHECK_TRUE(if_get_by_index(network, &iface) == 0, SYSTEM_ERROR_NOT_FOUND);
+    }
+    struct addrinfo hints = {};
+    hints.ai_flags = AI_ADDRCONFIG;
+    if (flags & NETWORK_RESOLVE_FLAG_FLUSH_CACHE) {
+        hints.ai_flags |= AI_FLUSHCACHE;
+    }
+    hints.ai_family = AF_UNSPEC;
+    struct addrinfo* ai = nullptr;
+    const auto t = HAL_Timer_Get_Milli_Seconds();
+    const int r = netdb_getaddrinfo_ex(name, nullptr, &hints, &ai, iface);
+    g_latencyDiag.record(HAL_Timer_Get_Milli_Seconds() - t);
+    SCOPE_GUARD({
+        netdb_freeaddrinfo(ai);
+    });
+    HAL_IPAddress resolved[MAX_ADDRESSES] = {};
+    size_t count = 0;
+    for (auto cur = ai; cur && count < MAX_ADDRESSES; cur = cur->ai_next) {
+        if (cur->ai_addr && sockaddrToIpAddress(cur->ai_addr, &resolved[count])) {
+            ++count;
+        }
+    }
+    putCached(name, resolved, count, getaddrinfoError(r));
+    count = filterReady(network, resolved, count);
+    if (!count) {
+        return (r == 0) ? SYSTEM_ERROR_NOT_FOUND : getaddrinfoError(r);
+    }
+    count = std::min(count, maxCount);
+    memcpy(addrs, resolved, count * sizeof(HAL_IPAddress));
+    return count;
+}
+
+int Resolver::resolveAsync(const char* name, network_handle_t network, unsigned flags, Callback callback, void* arg) {
+    CHECK_TRUE(name && callback, SYSTEM_ERROR_INVALID_ARGUMENT);
+    if (flags & NETWORK_RESOLVE_FLAG_FLUSH_CACHE) {
+        flush(name);
+    } else {
+        HAL_IPAddress addrs[MAX_ADDRESSES] = {};
+        const int r = getCached(name, network, addrs, MAX_ADDRESSES);
+        if (r != 0) {
+            callback((r < 0) ? r : 0, addrs, (r < 0) ? 0 : r, arg);
+            return 0;
+        }
+    }
+    std::unique_ptr<Request> req(new(std::nothrow) Request());
+    CHECK_TRUE(req, SYSTEM_ERROR_NO_MEMORY);
+    req->callback = callback;
+    req->arg = arg;
+    CHECK(startLookup(req.get(), name, network));
+    req.release(); // Deleted by completeCallback()
+    return 0;
+}
+
+void Resolver::flush(const char* name) {
+    const std::lock_guard<StaticRecursiveMutex> lock(mutex_);
+    if (name) {
+        cache_.remove(name);
+    } else {
+        cache_.clear();
+    }
+}
+
+Resolver* Resolver::instance() {
+    static Resolver resolver;
+    return &resolver;
+}
+
+int Resolver::startLookup(Request* req, const char* name, network_handle_t network) {
+    const int family = CHECK(readyFamily(network));
+    if (strlen(name) <= ResolverCache::MAX_NAME_LENGTH) {
+        strcpy(req->name, name);
+    }
+    req->network = network;
+    req->startTime = HAL_Timer_Get_Milli_Seconds();
+    return netdb_resolve_async(name, family, resolveCallback, req, nullptr);
+}
+
+int Resolver::completeLookup(Request* req) {
+    g_latencyDiag.record(req->duration);
+    if (req->name[0]) {
+        putCached(req->name, req->addrs, req->count, req->error);
+    }
+    req->count = filterReady(req->network, req->addrs, req->count);
+    if (req->error < 0) {
+        return req->error;
+    }
+    if (!req->count) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    return req->count;
+}
+
+int Resolver::getCached(const char* name, network_handle_t network, HAL_IPAddress* addrs, size_t maxCount) {
+    HAL_IPAddress cached[MAX_ADDRESSES] = {};
+    int r = 0;
+    {
+        const std::lock_guard<StaticRecursiveMutex> lock(mutex_);
+        r = cache_.get(name, HAL_Timer_Get_Milli_Seconds(), cached, MAX_ADDRESSES);
+    }
+    if (r <= 0) {
+        return r;
+    }
+    size_t count = filterReady(network, cached, r);
+    if (!count) {
+        return 0; // Resolve the name again for the IP protocols that are configured now
+    }
+    count = std::min(count, maxCount);
+    memcpy(addrs, cached, count * sizeof(HAL_IPAddress));
+    return count;
+}
+
+void Resolver::putCached(const char* name, const HAL_IPAddress* addrs, size_t count, int error) {
+    if (!count && error != SYSTEM_ERROR_NOT_FOUND) {
+        return; // Only cache the names that are known not to resolve
+    }
+    const std::lock_guard<StaticRecursiveMutex> lock(mutex_);
+    // LwIP doesn't report the time-to-live of the records, so the default one clamped to the
+    // configured limit is used
+    cache_.put(name, addrs, count, 0 /* ttl */, HAL_Timer_Get_Milli_Seconds());
+}
+
+void Resolver::resolveCallback(int error, const struct sockaddr_storage* saddrs, size_t count, void* arg) {
+    // Invoked by the networking thread with the core lock held, so only the results are stored here
+    // and the cache is updated by the thread that completes the lookup
+    const auto req = static_cast<Request*>(arg);
+    req->duration = HAL_Timer_Get_Milli_Seconds() - req->startTime;
+    req->error = error;
+    for (size_t i = 0; i < count && req->count < MAX_ADDRESSES; ++i) {
+        if (sockaddrToIpAddress((const struct sockaddr*)&saddrs[i], &req->addrs[req->count])) {
+            ++req->count;
+        }
+    }
+    if (req->callback) {
+        req->func = completeCallback;
+        SystemISRTaskQueue.enqueue(req);
+    } else if (req->detached.exchange(true)) {
+        delete req; // The waiting thread has timed out
+    } else {
+        os_semaphore_give(req->sem, false);
+    }
+}
+
+void Resolver::completeCallback(ISRTaskQueue::Task* task) {
+    std::unique_ptr<Request> req(static_cast<Request*>(task));
+    const int r = instance()->completeLookup(req.get());
+    req->callback((r < 0) ? r : 0, req->addrs, (r < 0) ? 0 : r, req->arg);
+}
+
+} // namespace system
+
+} // namespace particle
+
+#endif // HAL_USE_SOCKET_HAL_POSIX
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "hal_platform.h"
+
+#if HAL_USE_SOCKET_HAL_POSIX
+
+#include "system_resolver_cache.h"
+#include "system_network.h"
+#include "static_recursive_mutex.h"
+#include "concurrent_hal.h"
+
+#include <mutex>
+
+#include "active_object.h"
+
+namespace particle {
+
+namespace system {
+
+/**
+ * Host name resolver shared by the application, the socket wrappers and the cloud connection.
+ *
+ * Results are kept in a `ResolverCache`, so that reconnecting to a known host doesn't take a DNS
+ * round trip. Lookups that are not bound to an interface query the A and AAAA records at the
+ * same time.
+ */
+class Resolver {
+public:
+    /**
+     * Maximum number of addresses per host name.
+     */
+    static const size_t MAX_ADDRESSES = ResolverCache::MAX_ADDRESSES;
+
+    /**
+     * Completion callback of an asynchronous lookup.
+     *
+     * @param error 0 on success or a negative error code.
+     * @param addrs Resolved addresses that are usable on the network the lookup was made for.
+     * @param count Number of addresses.
+     * @param arg User argument.
+     */
+    typedef void (*Callback)(int error, const HAL_IPAddress* addrs, size_t count, void* arg);
+
+    /**
+     * Resolve a host name.
+     *
+     * @param name Host name.
+     * @param network Network interface or `NETWORK_INTERFACE_ALL`.
+     * @param flags Flags (see `network_resolve_flag`).
+     * @param[out] addrs Resolved addresses.
+     * @param maxCount Maximum number of addresses to return.
+     * @return Number of addresses or a negative error code.
+     */
+    int resolve(const char* name, network_handle_t network, unsigned flags, HAL_IPAddress* addrs, size_t maxCount);
+
+    /**
+     * Start resolving a host name without blocking the calling thread.
+     *
+     * The callback is invoked synchronously if the name is cached, and from the system thread
+     * otherwise. It should not block.
+     *
+     * @param name Host name.
+     * @param network Network interface or `NETWORK_INTERFACE_ALL`.
+     * @param flags Flags (see `network_resolve_flag`).
+     * @param callback Completion callback.
+     * @param arg User argument.
+     * @return 0 if the callback will be invoked, or a negative error code otherwise.
+     */
+    int resolveAsync(const char* name, network_handle_t network, unsigned flags, Callback callback, void* arg);
+
+    /**
+     * Discard the cached results.
+     *
+     * @param name Host name or `nullptr` to discard all the results.
+     */
+    void flush(const char* name = nullptr);
+
+    /**
+     * Get the number of lookups that were answered from the cache.
+     */
+    unsigned cacheHits() const {
+        return cache_.hits();
+    }
+
+    static Resolver* instance();
+
+private:
+    struct Request;
+
+    ResolverCache cache_;
+    StaticRecursiveMutex mutex_;
+
+    Resolver() = default;
+
+    int startLookup(Request* req, const char* name, network_handle_t network);
+    int completeLookup(Request* req);
+    int getCached(const char* name, network_handle_t network, HAL_IPAddress* addrs, size_t maxCount);
+    void putCached(const char* name, const HAL_IPAddress* addrs, size_t count, int error);
+
+    static void resolveCallback(int error, const struct sockaddr_storage* saddrs, size_t count, void* arg);
+    static void completeCallback(ISRTaskQueue::Task* task);
+};
+
+} // namespace system
+
+} // namespace particle
+
+#endif // HAL_USE_SOCKET_HAL_POSIX
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_resolver_cache.h"
+
+#include "system_error.h"
+
+#include <algorithm>
+#include <cstring>
+#include <strings.h>
+
+namespace particle {
+
+namespace system {
+
+const size_t ResolverCache::MAX_ENTRIES;
+const size_t ResolverCache::MAX_ADDRESSES;
+const size_t ResolverCache::MAX_NAME_LENGTH;
+const system_tick_t ResolverCache::DEFAULT_TTL;
+const system_tick_t ResolverCache::MAX_TTL;
+const system_tick_t ResolverCache::NEGATIVE_TTL;
+
+int ResolverCache::get(const char* name, system_tick_t now, HAL_IPAddress* addrs, size_t maxCount) {
+    const auto e = find(name, now);
+    if (!e) {
+        ++misses_;
+        return 0;
+    }
+    ++hits_;
+    e->lastUsed = now;
+    if (!e->count) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    const size_t n = std::min<size_t>(e->count, maxCount);
+    memcpy(addrs, e->addrs, n * sizeof(HAL_IPAddress));
+    return n;
+}
+
+void ResolverCache::put(const char* name, const HAL_IPAddress* addrs, size_t count, system_tick_t ttl, system_tick_t now) {
+    if (strlen(name) > MAX_NAME_LENGTH || !maxTtl_) {
+        return;
+    }
+    Entry* e = find(name, now);
+    if (!e) {
+        // Replace an expired entry or the least recently used one
+        e = &entries_[0];
+        for (auto& entry: entries_) {
+            if (!entry.valid) {
+                e = &entry;
+                break;
+            }
+            if (now - entry.lastUsed > now - e->lastUsed) {
+                e = &entry;
+            }
+        }
+        strcpy(e->name, name);
+    }
+    count = std::min(count, MAX_ADDRESSES);
+    memcpy(e->addrs, addrs, count * sizeof(HAL_IPAddress));
+    e->count = count;
+    if (!count) {
+        ttl = NEGATIVE_TTL;
+    } else if (!ttl) {
+        ttl = DEFAULT_TTL;
+    }
+    e->ttl = std::min(ttl, maxTtl_);
+    e->time = now;
+    e->lastUsed = now;
+    e->valid = true;
+}
+
+void ResolverCache::remove(const char* name) {
+    for (auto& e: entries_) {
+        if (e.valid && strcasecmp(e.name, name) == 0) {
+            e.valid = false;
+        }
+    }
+}
+
+void ResolverCache::clear() {
+    for (auto& e: entries_) {
+        e.valid = false;
+    }
+}
+
+ResolverCache::Entry* ResolverCache::find(const char* name, system_tick_t now) {
+    for (auto& e: entries_) {
+        if (!e.valid) {
+            continue;
+        }
+        if (now - e.time >= e.ttl) {
+            e.valid = false; // Expired
+            continue;
+        }
+        // Host names are case-insensitive
+        if (strcasecmp(e.name, name) == 0) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace system
+
+} // namespace particle
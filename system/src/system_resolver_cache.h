@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "inet_hal.h"
+#include "system_tick_hal.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Limit for the time-to-live of the cached host names, in milliseconds
+#ifndef SYSTEM_RESOLVER_CACHE_MAX_TTL
+#define SYSTEM_RESOLVER_CACHE_MAX_TTL (10 * 60 * 1000)
+#endif
+
+namespace particle {
+
+namespace system {
+
+/**
+ * Cache of resolved host names shared by all the users of the resolver.
+ *
+ * An entry expires after the time-to-live of its records, or `DEFAULT_TTL` if it is unknown, capped
+ * by `maxTtl()`. A failed lookup is cached for `NEGATIVE_TTL` so that a name that doesn't resolve
+ * isn't queried in a loop. When the cache is full, an expired entry or otherwise the least recently
+ * used one is replaced.
+ *
+ * The cache is not thread-safe.
+ */
+class ResolverCache {
+public:
+    /**
+     * Maximum number of cached host names.
+     */
+    static const size_t MAX_ENTRIES = 8;
+
+    /**
+     * Maximum number of addresses per host name (the resolver returns one address per family).
+     */
+    static const size_t MAX_ADDRESSES = 2;
+
+    /**
+     * Maximum length of a cached host name. Longer names are not cached.
+     */
+    static const size_t MAX_NAME_LENGTH = 63;
+
+    /**
+     * Time-to-live of an entry whose records have an unknown time-to-live, in milliseconds.
+     */
+    static const system_tick_t DEFAULT_TTL = 60 * 1000;
+
+    /**
+     * Default limit for the time-to-live of an entry, in milliseconds.
+     */
+    static const system_tick_t MAX_TTL = SYSTEM_RESOLVER_CACHE_MAX_TTL;
+
+    /**
+     * Time-to-live of a failed lookup, in milliseconds.
+     */
+    static const system_tick_t NEGATIVE_TTL = 10 * 1000;
+
+    ResolverCache() :
+            maxTtl_(MAX_TTL),
+            hits_(0),
+            misses_(0) {
+        clear();
+    }
+
+    /**
+     * Look up a host name.
+     *
+     * @param name Host name.
+     * @param now Current time in milliseconds.
+     * @param[out] addrs Resolved addresses.
+     * @param maxCount Maximum number of addresses to return.
+     * @return Number of addresses, 0 if the name is not cached, or `SYSTEM_ERROR_NOT_FOUND` if the
+     *         last lookup of the name failed.
+     */
+    int get(const char* name, system_tick_t now, HAL_IPAddress* addrs, size_t maxCount);
+
+    /**
+     * Store the result of a lookup.
+     *
+     * @param name Host name.
+     * @param addrs Resolved addresses.
+     * @param count Number of addresses. If 0, the lookup is cached as failed.
+     * @param ttl Time-to-live of the records in milliseconds, or 0 if unknown.
+     * @param now Current time in milliseconds.
+     */
+    void put(const char* name, const HAL_IPAddress* addrs, size_t count, system_tick_t ttl, system_tick_t now);
+
+    /**
+     * Remove a host name from the cache.
+     */
+    void remove(const char* name);
+
+    /**
+     * Remove all host names from the cache.
+     */
+    void clear();
+
+    /**
+     * Set the limit for the time-to-live of the entries stored from now on.
+     *
+     * A failed lookup is cached for the shorter of `NEGATIVE_TTL` and the limit. If the limit is 0,
+     * nothing is cached.
+     *
+     * @param ttl Time-to-live in milliseconds.
+     */
+    void maxTtl(system_tick_t ttl) {
+        maxTtl_ = ttl;
+    }
+
+    /**
+     * Get the limit for the time-to-live of the entries.
+     */
+    system_tick_t maxTtl() const {
+        return maxTtl_;
+    }
+
+    /**
+     * Get the number of lookups that were answered from the cache.
+     */
+    unsigned hits() const {
+        return hits_;
+    }
+
+    /**
+     * Get the number of lookups that were not answered from the cache.
+     */
+    unsigned misses() const {
+        return misses_;
+    }
+
+private:
+    struct Entry {
+        char name[MAX_NAME_LENGTH + 1];
+        HAL_IPAddress addrs[MAX_ADDRESSES];
+        system_tick_t time; // Time the entry was stored
+        system_tick_t ttl;
+        system_tick_t lastUsed;
+        uint8_t count; // Number of addresses (0 if the lookup failed)
+        bool valid;
+    };
+
+    Entry entries_[MAX_ENTRIES];
+    system_tick_t maxTtl_;
+    unsigned hits_;
+    unsigned misses_;
+
+    Entry* find(const char* name, system_tick_t now);
+};
+
+} // namespace system
+
+} // namespace particle
@@ -103,7 +103,7 @@ system_tick_t g_lastAppLoopProcessTime = 0;
 
 } // system
 
-ISRTaskQueue SystemISRTaskQueue;
+ISRTaskQueue SystemISRTaskQueue(system_loop_wakeup);
 
 } // particle
 
@@ -500,55 +500,6 @@ static bool process_isr_task_queue()
     return SystemISRTaskQueue.process();
 }
 
-#if HAL_PLATFORM_SETUP_BUTTON_UX
-extern void system_handle_button_clicks(bool isIsr);
-#endif
-
-void Spark_Idle_Events(bool force_events/*=false*/)
-{
-    ON_EVENT_DELTA();
-    spark_loop_total_millis = 0;
-
-    process_isr_task_queue();
-
-    if (!SYSTEM_POWEROFF) {
-
-#if HAL_PLATFORM_SETUP_BUTTON_UX
-        system_handle_button_clicks(false /* isIsr */);
-#endif
-
-        manage_network_connection();
-
-        manage_smart_config();
-
-        manage_ip_config();
-
-        manage_cloud_connection(force_events);
-
-        system::FirmwareUpdate::instance()->process();
-
-        if (system_mode() != SAFE_MODE) {
-            manage_listening_mode_flag();
-        }
-
-#if HAL_PLATFORM_BACKUP_RAM_NEED_SYNC
-        hal_backup_ram_routine();
-#endif
-    }
-    else
-    {
-        system_pending_shutdown(RESET_REASON_USER);
-    }
-#if HAL_PLATFORM_BLE_SETUP
-    // TODO: Process BLE channel events in a separate thread
-    system::SystemControl::instance()->run();
-    if (system_mode() != SAFE_MODE) {
-        manage_ble_prov_mode();
-    }
-#endif
-    system_shutdown_if_needed();
-}
-
 namespace {
 
 #if PLATFORM_THREADING
@@ -647,7 +598,17 @@ void delayNonThreadedImpl(unsigned long ms, system_tick_t start_millis, system_t
         }
         else
         {
-            HAL_Delay_Milliseconds(1);
+            // Sleep until the last millisecond or until the background loop is due, whichever
+            // comes first, instead of waking up every millisecond
+            system_tick_t step = ms - 1 - elapsed_millis;
+            if (!force_no_background_loop) {
+                system_tick_t untilLoop = 1;
+                if (spark_loop_total_millis < SPARK_LOOP_DELAY_MILLIS && spark_loop_elapsed_millis > elapsed_millis) {
+                    untilLoop = spark_loop_elapsed_millis - elapsed_millis;
+                }
+                step = std::min(step, untilLoop);
+            }
+            HAL_Delay_Milliseconds(step);
         }
 
         if (force_no_background_loop)
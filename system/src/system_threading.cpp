@@ -1,5 +1,6 @@
 #include "system_threading.h"
 #include "system_task.h"
+#include "system_idle_events.h"
 #include <time.h>
 #include <string.h>
 #include "hal_platform.h"
@@ -14,7 +15,7 @@ os_mutex_recursive_t usb_serial_mutex;
 
 void system_thread_idle()
 {
-    Spark_Idle_Events(true);
+    SystemThread.setTakeWait(system::runIdleEvents());
 }
 
 } // namespace
@@ -29,7 +29,6 @@
 
 #include "spark_wiring_interrupts.h"
 
-#include "test_malloc.h"
 #include "bytes2hexbuf.h"
 #include "debug.h"
 #include "security_mode.h"
@@ -229,13 +228,14 @@ particle::UsbControlRequestChannel::~UsbControlRequestChannel() {
 int particle::UsbControlRequestChannel::allocReplyData(ctrl_request* ctrlReq, size_t size) {
     const auto req = static_cast<Request*>(ctrlReq);
     if (size > 0) {
-        const auto data = (char*)t_realloc(req->reply_data, size);
+        // The buffer is reused if the reply grows within its capacity
+        const auto data = bufPool_.reallocBuffer(req->reply_data, size);
         if (!data) {
             return SYSTEM_ERROR_NO_MEMORY;
         }
         req->reply_data = data;
     } else {
-        t_free(req->reply_data);
+        bufPool_.freeBuffer(req->reply_data);
         req->reply_data = nullptr;
     }
     req->reply_size = size;
@@ -249,8 +249,8 @@ void particle::UsbControlRequestChannel::freeRequestData(ctrl_request* ctrlReq)
         system_pool_free(req->request_data, nullptr);
         req->flags &= ~RequestFlag::POOLED_REQ_DATA;
     } else {
-        // Free a dynamically allocated buffer
-        t_free(req->request_data);
+        // Return a dynamically allocated buffer to the buffer pool
+        bufPool_.freeBuffer(req->request_data);
     }
     req->request_data = nullptr;
     req->request_size = 0;
@@ -611,7 +611,8 @@ void particle::UsbControlRequestChannel::invokeRequestHandler(ISRTaskQueue::Task
 void particle::UsbControlRequestChannel::allocRequestData(ISRTaskQueue::Task* isrTask) {
     const auto task = static_cast<RequestTask*>(isrTask);
     auto req = task->req;
-    req->request_data = (char*)t_malloc(req->request_size); // FIXME: volatile?
+    const auto channel = static_cast<UsbControlRequestChannel*>(req->channel);
+    req->request_data = channel->bufPool_.allocBuffer(req->request_size); // FIXME: volatile?
     ATOMIC_BLOCK() {
         if (req->state == RequestState::ALLOC_PENDING) {
             if (req->request_data) {
@@ -623,7 +624,7 @@ void particle::UsbControlRequestChannel::allocRequestData(ISRTaskQueue::Task* is
         }
     }
     if (req) { // Request has been cancelled
-        t_free(req->request_data);
+        channel->bufPool_.freeBuffer(req->request_data);
         systemPoolDelete(req);
     }
 }
@@ -23,6 +23,7 @@
 
 #include "system_control.h"
 #include "control_request_handler.h"
+#include "control_buffer_pool.h"
 #include "active_object.h"
 
 namespace particle {
@@ -50,6 +51,14 @@ public:
     virtual void freeRequestData(ctrl_request* ctrlReq) override;
     virtual void setResult(ctrl_request* req, int result, ctrl_completion_handler_fn handler, void* data) override;
 
+    ControlBufferPool& bufferPool() {
+        return bufPool_;
+    }
+
+    const ControlBufferPool& bufferPool() const {
+        return bufPool_;
+    }
+
 private:
     // Request state
     enum RequestState {
@@ -86,6 +95,7 @@ private:
         uint8_t flags; // Request flags
     };
 
+    ControlBufferPool bufPool_; // Pool of request and reply buffers
     Request* activeReqs_; // List of active requests
     Request* curReq_; // A request currently being processed by the USB subsystem
     uint16_t activeReqCount_; // Number of active requests
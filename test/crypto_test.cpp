@@ -1,10 +1,100 @@
 #include "crypto/crypto.h"
+#include "crypto/aes.h"
+#include "system_error.h"
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> fromHex(const std::string& hex) {
+    std::vector<uint8_t> data;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        data.push_back((uint8_t)std::stoul(hex.substr(i, 2), nullptr, 16));
+    }
+    return data;
+}
+
+std::string toHex(const uint8_t* data, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t i = 0; i < size; ++i) {
+        hex += digits[data[i] >> 4];
+        hex += digits[data[i] & 0x0f];
+    }
+    return hex;
+}
+
+// Runs a test body with the portable implementation and, if available, with AES-NI
+template<typename F>
+void forEachImpl(F fn) {
+    crypto_aes_set_hw_accel(0);
+    fn();
+    crypto_aes_set_hw_accel(1);
+    if (crypto_aes_hw_accel_enabled()) {
+        fn();
+    }
+}
+
+struct GcmVector {
+    const char* key;
+    const char* iv;
+    const char* aad;
+    const char* plaintext;
+    const char* ciphertext;
+    const char* tag;
+};
+
+// Test cases 1-4 and 13-16 from "The Galois/Counter Mode of Operation (GCM)", McGrew & Viega
+const GcmVector GCM_VECTORS[] = {
+    { "00000000000000000000000000000000", "000000000000000000000000", "", "", "",
+            "58e2fccefa7e3061367f1d57a4e7455a" },
+    { "00000000000000000000000000000000", "000000000000000000000000", "",
+            "00000000000000000000000000000000", "0388dace60b6a392f328c2b971b2fe78",
+            "ab6e47d42cec13bdf53a67b21257bddf" },
+    { "feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "",
+            "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+            "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+            "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+            "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985",
+            "4d5c2af327cd64a62cf35abd2ba6fab4" },
+    { "feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888",
+            "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+            "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+            "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+            "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+            "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+            "5bc94fbc3221a5db94fae95ae7121a47" },
+    { "0000000000000000000000000000000000000000000000000000000000000000",
+            "000000000000000000000000", "", "", "", "530f8afbc74536b9a963b4f1c4cb738b" },
+    { "0000000000000000000000000000000000000000000000000000000000000000",
+            "000000000000000000000000", "", "00000000000000000000000000000000",
+            "cea7403d4d606b6e074ec5d3baf39d18", "d0d1c8a799996bf0265b98b5d48ab919" },
+    { "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+            "cafebabefacedbaddecaf888", "",
+            "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+            "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+            "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+            "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662898015ad",
+            "b094dac5d93471bdec1a502270e3cc6c" },
+    { "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+            "cafebabefacedbaddecaf888", "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+            "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+            "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+            "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+            "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+            "76fc6ece0f4e1768cddf8853bb2d551b" }
+};
+
+} // namespace
+
 // Example test case for crypto library
 TEST(CryptoLibraryTest, EncryptFunction) {
     std::string plaintext = "Hello, World!";
-    std::string key = "secretkey";
+    std::string key = "0123456789abcdef";
     std::string ciphertext = encrypt(plaintext, key);
 
     ASSERT_FALSE(ciphertext.empty());
@@ -13,14 +103,203 @@ TEST(CryptoLibraryTest, EncryptFunction) {
 
 TEST(CryptoLibraryTest, DecryptFunction) {
     std::string plaintext = "Hello, World!";
-    std::string key = "secretkey";
+    std::string key = "0123456789abcdef";
     std::string ciphertext = encrypt(plaintext, key);
     std::string decrypted = decrypt(ciphertext, key);
 
     ASSERT_EQ(plaintext, decrypted);
 }
 
+TEST(CryptoLibraryTest, DecryptRejectsTamperedData) {
+    std::string ciphertext = encrypt("Hello, World!", "0123456789abcdef");
+    ciphertext[ciphertext.size() / 2] ^= 0x01;
+
+    int error = 0;
+    ASSERT_TRUE(decrypt(ciphertext, "0123456789abcdef", &error).empty());
+    ASSERT_EQ(error, SYSTEM_ERROR_BAD_DATA);
+}
+
+TEST(CryptoLibraryTest, RejectsUnsupportedKeySizes) {
+    for (size_t size : { 0, 9, 15, 17, 31, 33, 64 }) {
+        const std::string key(size, 'k');
+        int error = 0;
+        ASSERT_TRUE(encrypt("Hello, World!", key, &error).empty());
+        ASSERT_EQ(error, SYSTEM_ERROR_INVALID_ARGUMENT);
+        error = 0;
+        ASSERT_TRUE(decrypt(std::string(64, '\0'), key, &error).empty());
+        ASSERT_EQ(error, SYSTEM_ERROR_INVALID_ARGUMENT);
+    }
+    for (size_t size : { 16, 24, 32 }) {
+        const std::string key(size, 'k');
+        int error = -1;
+        const auto ciphertext = encrypt("Hello, World!", key, &error);
+        ASSERT_EQ(error, 0);
+        ASSERT_EQ(decrypt(ciphertext, key, &error), "Hello, World!");
+        ASSERT_EQ(error, 0);
+    }
+}
+
+TEST(AesTest, BlockCipherFips197) {
+    forEachImpl([]() {
+        const auto pt = fromHex("00112233445566778899aabbccddeeff");
+        uint8_t out[16];
+        crypto_aes_key key;
+        ASSERT_EQ(crypto_aes_set_key(&key, fromHex("000102030405060708090a0b0c0d0e0f").data(), 16), 0);
+        crypto_aes_encrypt_block(&key, pt.data(), out);
+        ASSERT_EQ(toHex(out, 16), "69c4e0d86a7b0430d8cdb78070b4c55a");
+        ASSERT_EQ(crypto_aes_set_key(&key, fromHex("000102030405060708090a0b0c0d0e0f"
+                "1011121314151617").data(), 24), 0);
+        crypto_aes_encrypt_block(&key, pt.data(), out);
+        ASSERT_EQ(toHex(out, 16), "dda97ca4864cdfe06eaf70a0ec0d7191");
+        ASSERT_EQ(crypto_aes_set_key(&key, fromHex("000102030405060708090a0b0c0d0e0f"
+                "101112131415161718191a1b1c1d1e1f").data(), 32), 0);
+        crypto_aes_encrypt_block(&key, pt.data(), out);
+        ASSERT_EQ(toHex(out, 16), "8ea2b7ca516745bfeafc49904b496089");
+    });
+}
+
+TEST(AesTest, InvalidKeySize) {
+    crypto_aes_key key;
+    uint8_t data[20] = {};
+    ASSERT_EQ(crypto_aes_set_key(&key, data, sizeof(data)), SYSTEM_ERROR_INVALID_ARGUMENT);
+}
+
+TEST(AesTest, CtrSp80038a) {
+    forEachImpl([]() {
+        // NIST SP 800-38A, F.5.1 and F.5.5
+        const auto iv = fromHex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+        const auto pt = fromHex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+        struct {
+            const char* key;
+            const char* ct;
+        } vectors[] = {
+            { "2b7e151628aed2a6abf7158809cf4f3c",
+                    "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                    "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee" },
+            { "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4",
+                    "601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c5"
+                    "2b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6" }
+        };
+        for (const auto& v : vectors) {
+            const auto key = fromHex(v.key);
+            // Process the data in uneven chunks to exercise the keystream carry-over
+            for (size_t chunk : { 1, 7, 16, 33, 64 }) {
+                crypto_aes_ctr_ctx ctx;
+                ASSERT_EQ(crypto_aes_ctr_init(&ctx, key.data(), key.size(), iv.data()), 0);
+                std::vector<uint8_t> out(pt.size());
+                for (size_t offs = 0; offs < pt.size(); offs += chunk) {
+                    const size_t n = std::min(chunk, pt.size() - offs);
+                    crypto_aes_ctr_update(&ctx, pt.data() + offs, out.data() + offs, n);
+                }
+                ASSERT_EQ(toHex(out.data(), out.size()), v.ct);
+            }
+        }
+    });
+}
+
+TEST(AesTest, Gcm) {
+    forEachImpl([]() {
+        for (const auto& v : GCM_VECTORS) {
+            const auto key = fromHex(v.key);
+            const auto iv = fromHex(v.iv);
+            const auto aad = fromHex(v.aad);
+            const auto pt = fromHex(v.plaintext);
+            const auto expectedTag = fromHex(v.tag);
+            for (size_t chunk : { 1, 5, 16, 64 }) {
+                crypto_aes_gcm_ctx ctx;
+                ASSERT_EQ(crypto_aes_gcm_init(&ctx, key.data(), key.size(), iv.data(), iv.size()), 0);
+                for (size_t offs = 0; offs < aad.size(); offs += chunk) {
+                    const size_t n = std::min(chunk, aad.size() - offs);
+                    ASSERT_EQ(crypto_aes_gcm_update_aad(&ctx, aad.data() + offs, n), 0);
+                }
+                std::vector<uint8_t> ct(pt);
+                for (size_t offs = 0; offs < ct.size(); offs += chunk) {
+                    const size_t n = std::min(chunk, ct.size() - offs);
+                    // In-place encryption
+                    ASSERT_EQ(crypto_aes_gcm_encrypt_update(&ctx, ct.data() + offs, ct.data() + offs, n), 0);
+                }
+                uint8_t tag[16];
+                ASSERT_EQ(crypto_aes_gcm_finish(&ctx, tag, sizeof(tag)), 0);
+                ASSERT_EQ(toHex(ct.data(), ct.size()), v.ciphertext);
+                ASSERT_EQ(toHex(tag, sizeof(tag)), v.tag);
+
+                ASSERT_EQ(crypto_aes_gcm_init(&ctx, key.data(), key.size(), iv.data(), iv.size()), 0);
+                ASSERT_EQ(crypto_aes_gcm_update_aad(&ctx, aad.data(), aad.size()), 0);
+                std::vector<uint8_t> dec(ct.size());
+                ASSERT_EQ(crypto_aes_gcm_decrypt_update(&ctx, ct.data(), dec.data(), ct.size()), 0);
+                ASSERT_EQ(crypto_aes_gcm_verify(&ctx, expectedTag.data(), expectedTag.size()), 0);
+                ASSERT_EQ(dec, pt);
+            }
+        }
+    });
+}
+
+TEST(AesTest, GcmRejectsBadTag) {
+    const uint8_t key[16] = {};
+    const uint8_t iv[12] = {};
+    uint8_t data[32] = {};
+    uint8_t tag[16];
+    crypto_aes_gcm_ctx ctx;
+    ASSERT_EQ(crypto_aes_gcm_init(&ctx, key, sizeof(key), iv, sizeof(iv)), 0);
+    ASSERT_EQ(crypto_aes_gcm_encrypt_update(&ctx, data, data, sizeof(data)), 0);
+    ASSERT_EQ(crypto_aes_gcm_finish(&ctx, tag, sizeof(tag)), 0);
+    tag[0] ^= 0x80;
+    ASSERT_EQ(crypto_aes_gcm_init(&ctx, key, sizeof(key), iv, sizeof(iv)), 0);
+    ASSERT_EQ(crypto_aes_gcm_decrypt_update(&ctx, data, data, sizeof(data)), 0);
+    ASSERT_EQ(crypto_aes_gcm_verify(&ctx, tag, sizeof(tag)), SYSTEM_ERROR_BAD_DATA);
+}
+
+TEST(AesTest, GcmAadAfterDataIsRejected) {
+    const uint8_t key[16] = {};
+    const uint8_t iv[12] = {};
+    uint8_t data[4] = {};
+    crypto_aes_gcm_ctx ctx;
+    ASSERT_EQ(crypto_aes_gcm_init(&ctx, key, sizeof(key), iv, sizeof(iv)), 0);
+    ASSERT_EQ(crypto_aes_gcm_encrypt_update(&ctx, data, data, sizeof(data)), 0);
+    ASSERT_EQ(crypto_aes_gcm_update_aad(&ctx, data, sizeof(data)), SYSTEM_ERROR_INVALID_STATE);
+}
+
+// Disabled by default, run with --gtest_also_run_disabled_tests
+TEST(AesTest, DISABLED_Benchmark) {
+    const size_t sizes[] = { 64, 1024, 16 * 1024, 256 * 1024, 1024 * 1024 };
+    const size_t totalBytes = 8 * 1024 * 1024;
+    std::vector<uint8_t> buf(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+    const uint8_t key[32] = {};
+    const uint8_t iv[16] = {};
+    forEachImpl([&]() {
+        const char* impl = crypto_aes_hw_accel_enabled() ? "aes-ni" : "portable";
+        for (size_t keySize : { 16, 24, 32 }) {
+            for (size_t size : sizes) {
+                // Keep the portable runs short
+                const size_t total = crypto_aes_hw_accel_enabled() ? totalBytes : totalBytes / 8;
+                const size_t iterations = std::max<size_t>(1, total / size);
+                auto t1 = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < iterations; ++i) {
+                    crypto_aes_ctr_ctx ctx;
+                    crypto_aes_ctr_init(&ctx, key, keySize, iv);
+                    crypto_aes_ctr_update(&ctx, buf.data(), buf.data(), size);
+                }
+                auto t2 = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < iterations; ++i) {
+                    crypto_aes_gcm_ctx ctx;
+                    uint8_t tag[16];
+                    crypto_aes_gcm_init(&ctx, key, keySize, iv, CRYPTO_AES_GCM_IV_SIZE);
+                    crypto_aes_gcm_encrypt_update(&ctx, buf.data(), buf.data(), size);
+                    crypto_aes_gcm_finish(&ctx, tag, sizeof(tag));
+                }
+                auto t3 = std::chrono::steady_clock::now();
+                const double mb = (double)(iterations * size) / (1024 * 1024);
+                const double ctrSec = std::chrono::duration<double>(t2 - t1).count();
+                const double gcmSec = std::chrono::duration<double>(t3 - t2).count();
+                std::printf("[ BENCH    ] %-8s AES-%zu %8zu B: CTR %9.1f MB/s, GCM %9.1f MB/s\n",
+                        impl, keySize * 8, size, mb / ctrSec, mb / gcmSec);
+            }
+        }
+    });
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
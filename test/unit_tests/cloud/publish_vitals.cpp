@@ -16,6 +16,10 @@
  */
 
 #include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "active_object.h"
 #include "protocol_selector.h"
@@ -26,6 +30,9 @@
 
 #include "mock/mock_types.h"
 #include "system_publish_vitals.h"
+#include "system_diagnostics_snapshot.h"
+#include "spark_wiring_diagnostics.h"
+#include "varint.h"
 
 bool spark_cloud_flag_connected_called;
 int spark_cloud_flag_connected_result;
@@ -382,3 +389,321 @@ TEST_CASE("Publishing vitals", "[VitalsPublisher::publish]")
         }
     }
 }
+
+namespace {
+
+using particle::system::DiagnosticsSnapshot;
+
+struct DecodedValue {
+    bool error;
+    int32_t value;
+};
+
+typedef std::map<uint16_t, DecodedValue> DecodedState;
+
+bool appendToString(void* data, const uint8_t* buf, size_t size)
+{
+    static_cast<std::string*>(data)->append((const char*)buf, size);
+    return true;
+}
+
+bool appendFail(void*, const uint8_t*, size_t)
+{
+    return false;
+}
+
+// Simulates the delivery of the last encoded frame in a message with the given ID
+void deliverFrame(DiagnosticsSnapshot& snapshot, unsigned msgId)
+{
+    snapshot.frameSent(msgId);
+    snapshot.acknowledge(msgId);
+}
+
+// Applies a compact diagnostics frame to the consumer-side state
+int decodeFrame(const std::string& frame, DecodedState& state)
+{
+    if (frame.size() < 3 || frame[0] != 0 || frame[1] != 0)
+    {
+        return -1;
+    }
+    const int type = frame[2];
+    if (type == DiagnosticsSnapshot::FRAME_KEY)
+    {
+        state.clear();
+    }
+    size_t offs = 3;
+    uint16_t id = 0;
+    while (offs < frame.size())
+    {
+        uint32_t key = 0;
+        uint32_t zz = 0;
+        int n = particle::decodeUnsignedVarint(frame.data() + offs, frame.size() - offs, &key);
+        REQUIRE(n > 0);
+        offs += n;
+        n = particle::decodeUnsignedVarint(frame.data() + offs, frame.size() - offs, &zz);
+        REQUIRE(n > 0);
+        offs += n;
+        id += key >> 1;
+        const bool error = key & 1;
+        const int32_t value = (int32_t)((zz >> 1) ^ -(zz & 1));
+        state[id] = DecodedValue{ error, value };
+    }
+    return type;
+}
+
+// Size of the same data in the fixed-width binary format produced by `system_format_diag_data()`
+size_t legacyFrameSize(size_t sourceCount)
+{
+    return 2 * sizeof(uint16_t) + sourceCount * (sizeof(uint16_t) + sizeof(int32_t));
+}
+
+class DiagService
+{
+public:
+    DiagService()
+    {
+        REQUIRE(diag_command(DIAG_SERVICE_CMD_RESET, nullptr, nullptr) == 0);
+    }
+
+    ~DiagService()
+    {
+        diag_command(DIAG_SERVICE_CMD_RESET, nullptr, nullptr);
+    }
+
+    void start()
+    {
+        REQUIRE(diag_command(DIAG_SERVICE_CMD_START, nullptr, nullptr) == 0);
+    }
+};
+
+} // namespace
+
+TEST_CASE("Incremental encoding", "[DiagnosticsSnapshot]")
+{
+    DiagService diag;
+    std::vector<std::unique_ptr<particle::SimpleIntegerDiagnosticData>> srcs;
+    for (uint16_t id = 1; id <= 8; ++id)
+    {
+        srcs.emplace_back(new particle::SimpleIntegerDiagnosticData(id, (int32_t)id * 1000));
+    }
+    diag.start();
+    DiagnosticsSnapshot snapshot(4 /* keyframeInterval */, true /* enabled */);
+
+    SECTION("First frame is a keyframe with all sources")
+    {
+        std::string frame;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        DecodedState state;
+        CHECK(decodeFrame(frame, state) == DiagnosticsSnapshot::FRAME_KEY);
+        REQUIRE(state.size() == srcs.size());
+        CHECK(state[3].value == 3000);
+    }
+
+    SECTION("Unchanged sources are omitted from delta frames")
+    {
+        std::string frame;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        deliverFrame(snapshot, 1);
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        CHECK(frame.size() == 3);
+        DecodedState state;
+        CHECK(decodeFrame(frame, state) == DiagnosticsSnapshot::FRAME_DELTA);
+        CHECK(state.empty());
+    }
+
+    SECTION("Delta frames carry the values of the changed sources")
+    {
+        DecodedState state;
+        std::string frame;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        deliverFrame(snapshot, 1);
+        decodeFrame(frame, state);
+        *srcs[5] = -123456;
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        CHECK(decodeFrame(frame, state) == DiagnosticsSnapshot::FRAME_DELTA);
+        CHECK(state[6].value == -123456);
+        CHECK(state[1].value == 1000);
+    }
+
+    SECTION("Frames are keyframes until a frame is acknowledged")
+    {
+        std::string frame;
+        DecodedState state;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        CHECK(decodeFrame(frame, state) == DiagnosticsSnapshot::FRAME_KEY);
+        CHECK(state.size() == srcs.size());
+    }
+
+    SECTION("Only the acknowledgement for the message that carried the frame commits it")
+    {
+        snapshot.keyframeInterval(100);
+        DecodedState state;
+        std::string frame;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        deliverFrame(snapshot, 1);
+        decodeFrame(frame, state);
+        *srcs[2] = 7;
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        snapshot.frameSent(2);
+        snapshot.acknowledge(3);
+        CHECK(decodeFrame(frame, state) == DiagnosticsSnapshot::FRAME_DELTA);
+        snapshot.acknowledge(2);
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        CHECK(frame.size() == 3);
+    }
+
+    SECTION("A frame encoded while the previous one is unacknowledged is a keyframe")
+    {
+        snapshot.keyframeInterval(100);
+        DecodedState state;
+        std::string frame;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        deliverFrame(snapshot, 1);
+        decodeFrame(frame, state);
+        // The acknowledgement for this frame is lost
+        *srcs[2] = 7;
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        snapshot.frameSent(2);
+        decodeFrame(frame, state);
+        *srcs[2] = 3000;
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        CHECK(decodeFrame(frame, state) == DiagnosticsSnapshot::FRAME_KEY);
+        CHECK(state[3].value == 3000);
+        deliverFrame(snapshot, 3);
+        // A late acknowledgement for the superseded frame is ignored
+        snapshot.acknowledge(2);
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        CHECK(decodeFrame(frame, state) == DiagnosticsSnapshot::FRAME_DELTA);
+        CHECK(frame.size() == 3);
+    }
+
+    SECTION("A rejected frame is discarded and the next frame is a keyframe")
+    {
+        snapshot.keyframeInterval(100);
+        std::string frame;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        deliverFrame(snapshot, 1);
+        *srcs[2] = 7;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        snapshot.frameSent(2);
+        snapshot.frameLost(2);
+        snapshot.acknowledge(2);
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        DecodedState state;
+        CHECK(decodeFrame(frame, state) == DiagnosticsSnapshot::FRAME_KEY);
+        CHECK(state.size() == srcs.size());
+    }
+
+    SECTION("A keyframe is produced periodically, on request and after a reset")
+    {
+        std::vector<int> types;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (i == 5)
+            {
+                snapshot.reset();
+            }
+            std::string frame;
+            DecodedState state;
+            REQUIRE(snapshot.encode(appendToString, &frame, i == 7 /* keyframe */) == 0);
+            deliverFrame(snapshot, i);
+            types.push_back(decodeFrame(frame, state));
+        }
+        const int K = DiagnosticsSnapshot::FRAME_KEY;
+        const int D = DiagnosticsSnapshot::FRAME_DELTA;
+        CHECK(types == std::vector<int>{ K, D, D, D, K, K, D, K });
+        std::string frame;
+        DecodedState state;
+        snapshot.requestKeyframe();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        CHECK(decodeFrame(frame, state) == K);
+    }
+
+    SECTION("Snapshot is not updated if the data could not be appended")
+    {
+        DecodedState state;
+        std::string frame;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        deliverFrame(snapshot, 1);
+        decodeFrame(frame, state);
+        *srcs[0] = 42;
+        CHECK(snapshot.encode(appendFail, nullptr) == SYSTEM_ERROR_TOO_LARGE);
+        frame.clear();
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        decodeFrame(frame, state);
+        CHECK(state[1].value == 42);
+    }
+}
+
+TEST_CASE("Incremental encoding payload size", "[DiagnosticsSnapshot]")
+{
+    // Synthetic device with a typical mix of vitals: a few sources that change every period
+    // (uptime, free memory, loop counters), a few that change occasionally (signal strength,
+    // CoAP counters) and many that rarely change (connection status, error codes, IDs)
+    const unsigned SOURCE_COUNT = 48;
+    const unsigned PUBLISH_COUNT = 120;
+    DiagService diag;
+    std::vector<std::unique_ptr<particle::SimpleIntegerDiagnosticData>> srcs;
+    for (unsigned i = 0; i < SOURCE_COUNT; ++i)
+    {
+        srcs.emplace_back(new particle::SimpleIntegerDiagnosticData(i + 1, (int32_t)(i * 7919)));
+    }
+    diag.start();
+    DiagnosticsSnapshot snapshot(DiagnosticsSnapshot::DEFAULT_KEYFRAME_INTERVAL, true);
+
+    uint32_t seed = 12345;
+    const auto nextRand = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7fff;
+    };
+    size_t compactBytes = 0;
+    size_t legacyBytes = 0;
+    DecodedState state;
+    for (unsigned n = 0; n < PUBLISH_COUNT; ++n)
+    {
+        *srcs[0] = (int32_t)(n * 3600); // Uptime
+        *srcs[1] = (int32_t)(80000 + nextRand() % 2000); // Free memory
+        *srcs[2] = (int32_t)(n * 36000 + nextRand() % 100); // Loop counter
+        for (unsigned i = 3; i < 8; ++i)
+        {
+            if (nextRand() % 4 == 0)
+            {
+                *srcs[i] = (int32_t)(-60 - nextRand() % 40);
+            }
+        }
+        for (unsigned i = 8; i < SOURCE_COUNT; ++i)
+        {
+            if (nextRand() % 64 == 0)
+            {
+                ++(*srcs[i]);
+            }
+        }
+        std::string frame;
+        REQUIRE(snapshot.encode(appendToString, &frame) == 0);
+        deliverFrame(snapshot, n);
+        decodeFrame(frame, state);
+        // The consumer-side state always matches the sources
+        REQUIRE(state.size() == SOURCE_COUNT);
+        for (unsigned i = 0; i < SOURCE_COUNT; ++i)
+        {
+            int32_t val = 0;
+            REQUIRE(particle::AbstractIntegerDiagnosticData::get(i + 1, val) == 0);
+            REQUIRE(state[i + 1].value == val);
+        }
+        compactBytes += frame.size();
+        legacyBytes += legacyFrameSize(SOURCE_COUNT);
+    }
+    INFO("Legacy: " << legacyBytes << " bytes, compact: " << compactBytes << " bytes over "
+            << PUBLISH_COUNT << " publishes");
+    CHECK(compactBytes * 5 < legacyBytes);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "v2/coap_channel.h"
+
+#include "util/coap_message_channel.h"
+#include "util/protocol_stub.h"
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+using namespace particle;
+using namespace particle::protocol;
+using namespace particle::protocol::test;
+
+} // namespace
+
+TEST_CASE("CoapChannel") {
+    auto coap = v2::CoapChannel::instance();
+    // See spark_protocol_instance() in hal_stubs.cpp
+    auto& channel = static_cast<CoapMessageChannel&>(spark_protocol_instance()->get_channel());
+
+    SECTION("discards the session on a protocol error") {
+        coap->open();
+        RefCountPtr<v2::CoapMessage> msg;
+        REQUIRE(coap->beginRequest(msg, "test", COAP_METHOD_POST, 0 /* timeout */, 0 /* flags */) > 0);
+        channel.sendError(ProtocolError::IO_ERROR_GENERIC_SEND);
+        const auto cmdCount = channel.commands().size();
+        CHECK(coap->endRequest(msg, nullptr, nullptr, nullptr, nullptr) < 0);
+        channel.sendError(ProtocolError::NO_ERROR);
+        REQUIRE(channel.commands().size() == cmdCount + 1);
+        CHECK(channel.commands().back() == Channel::CLOSE);
+        coap->close();
+    }
+}
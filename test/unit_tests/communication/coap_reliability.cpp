@@ -18,6 +18,7 @@
  */
 
 #include <climits>
+#include <vector>
 
 #include "coap_channel.h"
 #include "forward_message_channel.h"
@@ -201,10 +202,10 @@ SCENARIO("a message can be added to a message store with the same id more than o
 
 }
 
-SCENARIO("multiple messages are stored in a list in the order they are added, most recent first")
+SCENARIO("multiple messages in the same bucket are stored in a list in the order they are added, most recent first")
 {
 	const message_id_t id1 = 456;
-	const message_id_t id2 = 345;
+	const message_id_t id2 = id1 + CoAPMessageStore::BUCKET_COUNT;
 	REQUIRE(CoAPMessage::messages()==0);
 	GIVEN("an empty message store")
 	{
@@ -346,6 +347,12 @@ SCENARIO("an unacknowledged message is resent up to MAX_TRANSMIT times, with exp
 								Verify(Method(mock,send)).Exactly(MAX_RETRANSMIT);
 								REQUIRE(store.from_id(id)==nullptr);
 							}
+
+							AND_THEN("the channel is closed but the session is kept")
+							{
+								Verify(Method(mock,command).Using(Channel::CLOSE_KEEP_SESSION, nullptr)).Once();
+								Verify(Method(mock,command).Using(Channel::CLOSE, nullptr)).Never();
+							}
 						}
 					}
 				}
@@ -393,6 +400,43 @@ SCENARIO("an unacknowledged message is resent up to MAX_TRANSMIT times, with exp
 
 }
 
+SCENARIO("retransmissions of a confirmable message are flagged to take the redundant path")
+{
+	REQUIRE(CoAPMessage::messages()==0);
+	GIVEN("a channel and a confirmable message in the store")
+	{
+		Mock<MessageChannel> mock;
+		MessageChannel& channel = mock.get();
+		build_message_channel_mock(mock);
+		std::vector<bool> redundant;
+		When(Method(mock,send)).AlwaysDo([&redundant](Message& msg)->ProtocolError {
+			redundant.push_back(msg.redundant());
+			return NO_ERROR;
+		});
+
+		uint8_t buf[] = { 0x40, 0, 0x12, 0x34 };
+		Message m(buf, sizeof(buf), sizeof(buf));
+		m.decode_id();
+		CoAPMessageStore store;
+		REQUIRE(store.send(m, 0)==NO_ERROR);
+		CoAPMessage* cm = store.from_id(0x1234);
+		REQUIRE(cm!=nullptr);
+
+		WHEN("the message is sent and then times out twice")
+		{
+			REQUIRE(store.send_message(cm, channel)==NO_ERROR);
+			store.process(cm->get_timeout(), channel);
+			store.process(cm->get_timeout(), channel);
+			THEN("only the retransmissions are redundant")
+			{
+				REQUIRE(redundant==std::vector<bool>({ false, true, true }));
+			}
+		}
+		store.clear();
+	}
+	REQUIRE(CoAPMessage::messages()==0);
+}
+
 SCENARIO("a CoAPMessage can be created with the message buffer part of the allocation")
 {
 	// todo - factor out the message tests to their own test suite
@@ -950,6 +994,110 @@ SCENARIO("sending a reliable message first passes it to the store, and then on t
 }
 
 
+SCENARIO("the transmission window limits confirmable requests but not separate responses")
+{
+	GIVEN("a CoAPReliableChannel")
+	{
+		Mock<MessageChannel> mock;
+		MessageChannel& delegate = mock.get();
+		auto time = []() { return system_tick_t(0); };	// time not needed here
+		ForwardCoAPReliableChannel<decltype(time)> channel(delegate, time);
+		When(Method(mock,send)).AlwaysReturn(NO_ERROR);
+
+		auto send = [&channel](uint8_t code, message_id_t id) {
+			uint8_t buf[] = { 0x40, code, uint8_t(id >> 8), uint8_t(id), 0xFF, 1 };
+			Message m(buf, sizeof(buf), sizeof(buf));
+			m.decode_id();
+			return channel.send(m);
+		};
+
+		WHEN("the window size is not set")
+		{
+			for (message_id_t id = 1; id <= NSTART + 1; ++id) {
+				REQUIRE(send(0x02 /* POST */, id)==NO_ERROR);
+			}
+			THEN("the default window applies")
+			{
+				REQUIRE(NSTART>0);
+				REQUIRE(channel.window_size()==NSTART);
+				Verify(Method(mock,send)).Exactly(NSTART);
+				REQUIRE(channel.queued_request_count()==1);
+				REQUIRE(channel.client_messages().confirmable_request_count()==NSTART);
+			}
+		}
+
+		WHEN("the window is disabled")
+		{
+			channel.set_window_size(0);
+			for (message_id_t id = 1; id <= 32; ++id) {
+				REQUIRE(send(0x02 /* POST */, id)==NO_ERROR);
+			}
+			THEN("all requests are sent immediately")
+			{
+				Verify(Method(mock,send)).Exactly(32);
+				REQUIRE(channel.queued_request_count()==0);
+			}
+		}
+
+		WHEN("the window size is set")
+		{
+			channel.set_window_size(2);
+			for (message_id_t id = 1; id <= 2 + MAX_QUEUED_REQUESTS; ++id) {
+				REQUIRE(send(0x02 /* POST */, id)==NO_ERROR);
+			}
+			THEN("the requests beyond the window are queued up to a limit")
+			{
+				Verify(Method(mock,send)).Exactly(2);
+				REQUIRE(channel.queued_request_count()==MAX_QUEUED_REQUESTS);
+				REQUIRE(send(0x02 /* POST */, 100)==NO_MEMORY);
+			}
+			AND_WHEN("a separate response is sent")
+			{
+				REQUIRE(send(0x45 /* 2.05 Content */, 200)==NO_ERROR);
+				THEN("it is not limited by the window")
+				{
+					Verify(Method(mock,send)).Exactly(3);
+					REQUIRE(channel.client_messages().from_id(200)!=nullptr);
+				}
+			}
+			AND_WHEN("the window is disabled")
+			{
+				channel.set_window_size(0);
+				THEN("the queued requests are sent")
+				{
+					Verify(Method(mock,send)).Exactly(2 + MAX_QUEUED_REQUESTS);
+					REQUIRE(channel.queued_request_count()==0);
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("the message store counts the confirmable requests as they are added and removed")
+{
+	CoAPMessageStore store;
+	auto send = [&store](uint8_t type, uint8_t code, message_id_t id) {
+		uint8_t buf[] = { type, code, uint8_t(id >> 8), uint8_t(id), 0xFF, 1 };
+		Message m(buf, sizeof(buf), sizeof(buf));
+		m.decode_id();
+		return store.send(m, 0);
+	};
+	REQUIRE(send(0x40 /* CON */, 0x02 /* POST */, 1)==NO_ERROR);
+	REQUIRE(send(0x40 /* CON */, 0x01 /* GET */, 2)==NO_ERROR);
+	REQUIRE(send(0x40 /* CON */, 0x45 /* 2.05 Content */, 3)==NO_ERROR);
+	REQUIRE(send(0x50 /* NON */, 0x02 /* POST */, 4)==NO_ERROR);
+	REQUIRE(store.confirmable_request_count()==2);
+	// Replacing a request with the same ID doesn't count it twice
+	REQUIRE(send(0x40 /* CON */, 0x02 /* POST */, 1)==NO_ERROR);
+	REQUIRE(store.confirmable_request_count()==2);
+	REQUIRE(store.clear_message(1));
+	REQUIRE(store.confirmable_request_count()==1);
+	REQUIRE(store.clear_message(3));
+	REQUIRE(store.confirmable_request_count()==1);
+	store.clear();
+	REQUIRE(store.confirmable_request_count()==0);
+}
+
 SCENARIO("receiving a message first retrieves from the channel and then passes the message to the store")
 {
 	GIVEN("a CoAPReliableChannel")
@@ -1253,3 +1401,60 @@ SCENARIO("notify_client_messages_processed() is invoked when all client messages
 		}
 	}
 }
+
+/**
+ * Sends `count` confirmable messages through the store.
+ */
+void send_confirmable_messages(CoAPMessageStore& store, unsigned round, unsigned count)
+{
+	uint8_t buf[64] = { 0x40 };	// confirmable message
+	for (unsigned i = 0; i < count; ++i)
+	{
+		const message_id_t id = round * count + i + 1;
+		buf[2] = id >> 8;
+		buf[3] = id & 0xFF;
+		Message m(buf, sizeof(buf), sizeof(buf));
+		m.decode_id();
+		REQUIRE(store.send(m, 0)==NO_ERROR);
+	}
+}
+
+/**
+ * Acknowledges the messages sent by `send_confirmable_messages()` in the order they were sent,
+ * the oldest message first. Returns the number of acknowledgements that were not matched.
+ */
+unsigned acknowledge_messages(CoAPMessageStore& store, MessageChannel& channel, unsigned round, unsigned count)
+{
+	unsigned errors = 0;
+	for (unsigned i = 0; i < count; ++i)
+	{
+		const message_id_t id = round * count + i + 1;
+		uint8_t ack[4];
+		Message m(ack, sizeof(ack), Messages::empty_ack(ack, id >> 8, id & 0xFF));
+		if (store.receive(m, channel, 1)!=NO_ERROR || m.passthrough())
+			++errors;
+	}
+	return errors;
+}
+
+SCENARIO("acknowledgements are matched regardless of the number of messages in flight", "[reliability]")
+{
+	Mock<MessageChannel> mock;
+	build_message_channel_mock(mock);
+	MessageChannel& channel = mock.get();
+	for (unsigned count: { 8u, 64u, 256u })
+	{
+		CoAPMessageStore store;
+		for (unsigned r = 0; r < 4; ++r)
+		{
+			send_confirmable_messages(store, r, count);
+			// Matching an ACK only looks at the messages in one bucket of the index
+			const size_t max_bucket_size = (count + CoAPMessageStore::BUCKET_COUNT - 1) / CoAPMessageStore::BUCKET_COUNT;
+			for (unsigned i = 0; i < count; ++i)
+				CHECK(store.bucket_size(r * count + i + 1)==max_bucket_size);
+			CHECK(acknowledge_messages(store, channel, r, count)==0);
+			REQUIRE(!store.has_messages());
+		}
+	}
+	REQUIRE(CoAPMessage::messages()==0);
+}
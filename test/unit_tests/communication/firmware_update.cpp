@@ -18,13 +18,20 @@
 #include "firmware_update.h"
 #include "messages.h"
 #include "sha256.h"
+#include "varint.h"
 
 #include "util/coap_message_channel.h"
 #include "util/protocol_callbacks.h"
 
+#include "mbedtls_mock.h"
+
 #include <catch2/catch.hpp>
 #include <fakeit.hpp>
 
+#include <zlib.h>
+
+#include <algorithm>
+#include <functional>
 #include <random>
 #include <regex>
 
@@ -35,6 +42,7 @@ namespace {
 using namespace particle;
 using namespace particle::protocol;
 using namespace particle::protocol::test;
+using particle::test::MbedtlsMock;
 
 using namespace fakeit;
 
@@ -47,9 +55,15 @@ enum OtaCoapOption {
     CHUNK_SIZE = 2065,
     DISCARD_DATA = 2069,
     CANCEL_UPDATE = 2073,
-    MODULE_FUNCTION_OPT = 2077
+    MODULE_FUNCTION_OPT = 2077,
+    TRANSFER_ENCODING = 2081,
+    TRANSFER_SIZE = 2085,
+    ACK_FORMAT = 2089
 };
 
+const unsigned TRANSFER_ENCODING_DEFLATE = 1;
+const unsigned ACK_FORMAT_RANGES = 1;
+
 class FirmwareUpdateWrapper: public FirmwareUpdate {
 public:
     FirmwareUpdateWrapper() :
@@ -82,6 +96,34 @@ public:
         return sendMessage(std::move(m));
     }
 
+    // Sends an UpdateStart message for a file transferred as a raw Deflate stream
+    int sendCompressedStart(size_t fileSize, const std::string& fileHash, size_t chunkSize, size_t transferSize) {
+        CoapMessage m;
+        m.type(CoapType::CON);
+        m.code(CoapCode::POST);
+        m.option(CoapOption::URI_PATH, "S");
+        if (!fileHash.empty()) {
+            m.option(OtaCoapOption::FILE_SHA256, fileHash);
+        }
+        m.option(OtaCoapOption::FILE_SIZE, fileSize);
+        m.option(OtaCoapOption::CHUNK_SIZE, chunkSize);
+        m.option(OtaCoapOption::TRANSFER_ENCODING, TRANSFER_ENCODING_DEFLATE);
+        m.option(OtaCoapOption::TRANSFER_SIZE, transferSize);
+        return sendMessage(std::move(m));
+    }
+
+    // Sends an UpdateStart message that requests the chunks to be acknowledged with ranges
+    int sendStartWithAckFormat(size_t fileSize, size_t chunkSize, unsigned ackFormat) {
+        CoapMessage m;
+        m.type(CoapType::CON);
+        m.code(CoapCode::POST);
+        m.option(CoapOption::URI_PATH, "S");
+        m.option(OtaCoapOption::FILE_SIZE, fileSize);
+        m.option(OtaCoapOption::CHUNK_SIZE, chunkSize);
+        m.option(OtaCoapOption::ACK_FORMAT, ackFormat);
+        return sendMessage(std::move(m));
+    }
+
     // Sends an UpdateFinish message to the device
     int sendFinish(bool cancelUpdate, bool discardData) {
         CoapMessage m;
@@ -236,6 +278,63 @@ std::vector<unsigned> parseChunkAckPayload(const CoapMessage& msg) {
     return sackIndices;
 }
 
+// Parses the payload of an UpdateAck message sent with the ranges format
+std::vector<unsigned> parseChunkAckRanges(const CoapMessage& msg) {
+    std::vector<unsigned> ranges;
+    const auto payload = msg.hasPayload() ? msg.payload() : std::string();
+    size_t offs = 0;
+    while (offs < payload.size()) {
+        unsigned v = 0;
+        const int r = decodeUnsignedVarint(payload.data() + offs, payload.size() - offs, &v);
+        if (r <= 0) {
+            throw std::runtime_error("Invalid payload data");
+        }
+        ranges.push_back(v);
+        offs += r;
+    }
+    return ranges;
+}
+
+// Generates data that compresses about as well as a firmware binary
+std::string genModuleData(size_t size) {
+    std::uniform_int_distribution<unsigned> dist(0, 255);
+    std::string s;
+    s.reserve(size + 16);
+    while (s.size() < size) {
+        const unsigned v = dist(randomGen());
+        if (v < 64) {
+            s += genString(1 + v % 8); // Random bytes
+        } else {
+            s += "\x10\xb5\x04\x46" + std::to_string(v % 32); // Repeated code
+        }
+    }
+    s.resize(size);
+    return s;
+}
+
+// Compresses the data into a raw Deflate stream
+std::string deflateRaw(const std::string& data) {
+    z_stream strm = {};
+    REQUIRE(deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, -15 /* Raw Deflate */, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    std::string out(deflateBound(&strm, data.size()), '\0');
+    strm.next_in = (Bytef*)data.data();
+    strm.avail_in = data.size();
+    strm.next_out = (Bytef*)&out[0];
+    strm.avail_out = out.size();
+    REQUIRE(deflate(&strm, Z_FINISH) == Z_STREAM_END);
+    out.resize(out.size() - strm.avail_out);
+    deflateEnd(&strm);
+    return out;
+}
+
+// The SHA-256 implementation is stubbed in the unit tests. This function produces a digest that
+// is good enough to tell whether the device has hashed the same data
+std::string fakeSha256(const std::string& data) {
+    std::string h = std::to_string(std::hash<std::string>()(data));
+    h.resize(Sha256::HASH_SIZE, '#');
+    return h;
+}
+
 bool hasDiagnosticPayload(const CoapMessage& msg) {
     static const std::regex rx("^\\{\"code\":-\\d+,\"message\":\".+\"\\}$");
     return msg.hasPayload() && std::regex_match(msg.payload(), rx);
@@ -914,3 +1013,175 @@ TEST_CASE("FirmwareUpdate") {
         CHECK(!w.isRunning());
     }
 }
+
+TEST_CASE("FirmwareUpdate (compressed transfer)") {
+    FirmwareUpdateWrapper w;
+    MbedtlsMock mbedtls;
+    std::string hashedData;
+    When(Method(mbedtls, mdStarts)).AlwaysDo([&](mbedtls_md_context_t* ctx) {
+        hashedData.clear();
+        return 0;
+    });
+    When(Method(mbedtls, mdUpdate)).AlwaysDo([&](mbedtls_md_context_t* ctx, std::string data) {
+        hashedData += data;
+        return 0;
+    });
+    When(Method(mbedtls, mdFinish)).AlwaysDo([&](mbedtls_md_context_t* ctx, unsigned char* out) {
+        const auto h = fakeSha256(hashedData);
+        memcpy(out, h.data(), h.size());
+        return 0;
+    });
+    auto cb = w.callbacksMock();
+    std::string savedData;
+    When(Method(cb, saveFirmwareChunk)).AlwaysDo([&](const char* chunkData, size_t chunkSize, size_t chunkOffset,
+            size_t partialSize) {
+        REQUIRE(chunkOffset == savedData.size()); // Decompressed data is saved in order
+        REQUIRE(partialSize == chunkOffset + chunkSize);
+        savedData.append(chunkData, chunkSize);
+        return 0;
+    });
+    Spy(Method(cb, startFirmwareUpdate));
+    Spy(Method(cb, finishFirmwareUpdate));
+
+    const size_t chunkSize = 512;
+    const auto module = genModuleData(96 * 1024);
+    const auto compressed = deflateRaw(module);
+    REQUIRE(compressed.size() < module.size() * 2 / 3);
+    const size_t chunkCount = (compressed.size() + chunkSize - 1) / chunkSize;
+
+    auto chunk = [&](unsigned index) { // 1-based
+        return compressed.substr((index - 1) * chunkSize, chunkSize);
+    };
+
+    SECTION("decompresses the file data and saves it in the OTA region") {
+        w.sendCompressedStart(module.size(), fakeSha256(module), chunkSize, compressed.size());
+        Verify(Method(cb, startFirmwareUpdate).Matching([&](size_t fileSize, const char* fileHash, size_t* partialSize,
+                unsigned flags, int moduleFunction) {
+            return fileSize == module.size() && FirmwareUpdateFlags::fromUnderlying(flags) == FirmwareUpdateFlag::NON_RESUMABLE;
+        })).Once();
+        w.skipMessages(1); // Skip the ACK
+        auto m = w.receiveMessage();
+        CHECK(m.code() == CoapCode::CREATED);
+        const unsigned windowSize = m.option(OtaCoapOption::WINDOW_SIZE).toUInt();
+        CHECK(windowSize == OTA_COMPRESSED_RECEIVE_WINDOW_SIZE / chunkSize);
+        // Send the chunks of each window in a random order
+        std::vector<unsigned> indices;
+        for (unsigned i = 1; i <= chunkCount; ++i) {
+            indices.push_back(i);
+        }
+        for (size_t i = 0; i < indices.size(); i += windowSize) {
+            std::shuffle(indices.begin() + i, indices.begin() + std::min<size_t>(i + windowSize, indices.size()), randomGen());
+        }
+        for (auto i: indices) {
+            CHECK(w.sendChunk(i, chunk(i)) == ProtocolError::NO_ERROR);
+            if (i == 5) {
+                w.sendChunk(i, chunk(i)); // Duplicate
+            }
+        }
+        CHECK(w.stats().duplicateChunks == 1);
+        CHECK(w.isRunning());
+        CHECK(savedData == module);
+        CHECK(hashedData == module);
+        w.sendFinish(false /* cancelUpdate */, false /* discardData */);
+        Verify(Method(cb, finishFirmwareUpdate).Matching([=](unsigned flags) {
+            return FirmwareUpdateFlags::fromUnderlying(flags) == FirmwareUpdateFlag::VALIDATE_ONLY;
+        })).Once();
+        // Acknowledge the UpdateFinish response
+        while (w.hasMessages()) {
+            m = w.receiveMessage();
+        }
+        CHECK((isCoapResponseCode(m.code()) && isCoapSuccessCode(m.code())));
+        w.sendMessage(CoapMessage().type(CoapType::ACK).code(CoapCode::EMPTY).id(m.id()));
+        Verify(Method(cb, finishFirmwareUpdate).Matching([=](unsigned flags) {
+            return flags == 0;
+        })).Once();
+        CHECK(!w.isRunning());
+    }
+
+    SECTION("fails the update if the checksum of the decompressed data doesn't match") {
+        w.sendCompressedStart(module.size(), fakeSha256(module + "x"), chunkSize, compressed.size());
+        w.skipMessages(2); // Skip the ACK and response
+        for (unsigned i = 1; i < chunkCount; ++i) {
+            w.sendChunk(i, chunk(i));
+        }
+        CHECK(w.isRunning());
+        w.sendChunk(chunkCount, chunk(chunkCount));
+        CHECK(!w.isRunning());
+        Verify(Method(cb, finishFirmwareUpdate).Matching([=](unsigned flags) {
+            return FirmwareUpdateFlags::fromUnderlying(flags) == FirmwareUpdateFlag::CANCEL;
+        })).Once();
+    }
+
+    SECTION("fails the update if the compressed data is corrupted") {
+        auto bad = chunk(1);
+        bad[0] |= 0x06; // Reserved block type
+        w.sendCompressedStart(module.size(), fakeSha256(module), chunkSize, compressed.size());
+        w.skipMessages(2); // Skip the ACK and response
+        for (unsigned i = 1; i <= chunkCount && w.isRunning(); ++i) {
+            w.sendChunk(i, (i == 1) ? bad : chunk(i));
+        }
+        CHECK(!w.isRunning());
+        CHECK(savedData != module);
+    }
+
+    SECTION("rejects an update with an unsupported transfer encoding") {
+        CoapMessage req;
+        req.type(CoapType::CON);
+        req.code(CoapCode::POST);
+        req.option(CoapOption::URI_PATH, "S");
+        req.option(OtaCoapOption::FILE_SIZE, 1000);
+        req.option(OtaCoapOption::CHUNK_SIZE, 512);
+        req.option(OtaCoapOption::TRANSFER_ENCODING, 2);
+        req.option(OtaCoapOption::TRANSFER_SIZE, 500);
+        w.sendMessage(req);
+        auto resp = w.receiveMessage();
+        CHECK(resp.type() == CoapType::ACK);
+        CHECK((isCoapResponseCode(resp.code()) && !isCoapSuccessCode(resp.code())));
+        CHECK(hasDiagnosticPayload(resp));
+        CHECK(!w.isRunning());
+    }
+}
+
+TEST_CASE("FirmwareUpdate (acknowledgement ranges)") {
+    FirmwareUpdateWrapper w;
+
+    SECTION("reports the window size and encodes the received chunks as ranges") {
+        w.sendStartWithAckFormat(8192 /* fileSize */, 512 /* chunkSize */, ACK_FORMAT_RANGES);
+        w.skipMessages(2); // Skip the ACK and response
+        const unsigned windowSize = OTA_RECEIVE_WINDOW_SIZE / 512;
+        // Chunk 2
+        w.sendChunk(2 /* index */, genString(512) /* data */);
+        auto m = w.receiveMessage();
+        CHECK(m.option(OtaCoapOption::CHUNK_INDEX).toUInt() == 0);
+        CHECK(m.option(OtaCoapOption::WINDOW_SIZE).toUInt() == windowSize);
+        CHECK(parseChunkAckRanges(m) == std::vector<unsigned>{ 1, 1 }); // 1 missing, 1 received
+        // Chunk 4
+        w.sendChunk(4 /* index */, genString(512) /* data */);
+        m = w.receiveMessage();
+        CHECK(m.option(OtaCoapOption::CHUNK_INDEX).toUInt() == 0);
+        CHECK(parseChunkAckRanges(m) == std::vector<unsigned>{ 1, 1, 1, 1 });
+        // Chunk 5 neither creates nor fills a gap
+        w.sendChunk(5 /* index */, genString(512) /* data */);
+        CHECK(!w.hasMessages()); // ACK delayed
+        // Chunk 3
+        w.sendChunk(3 /* index */, genString(512) /* data */);
+        m = w.receiveMessage();
+        CHECK(m.option(OtaCoapOption::CHUNK_INDEX).toUInt() == 0);
+        CHECK(parseChunkAckRanges(m) == std::vector<unsigned>{ 1, 4 });
+        // Chunk 1
+        w.sendChunk(1 /* index */, genString(512) /* data */);
+        m = w.receiveMessage();
+        CHECK(m.option(OtaCoapOption::CHUNK_INDEX).toUInt() == 5);
+        CHECK(m.option(OtaCoapOption::WINDOW_SIZE).toUInt() == windowSize);
+        CHECK(!m.hasPayload()); // No gaps
+    }
+
+    SECTION("rejects an update with an unsupported acknowledgement format") {
+        w.sendStartWithAckFormat(1000 /* fileSize */, 512 /* chunkSize */, 2 /* ackFormat */);
+        auto resp = w.receiveMessage();
+        CHECK(resp.type() == CoapType::ACK);
+        CHECK((isCoapResponseCode(resp.code()) && !isCoapSuccessCode(resp.code())));
+        CHECK(hasDiagnosticPayload(resp));
+        CHECK(!w.isRunning());
+    }
+}
@@ -0,0 +1,463 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Throughput benchmark of the OTA update protocol.
+ *
+ * The device runs the real FirmwareUpdate implementation on top of a simulated datagram link with
+ * injected latency, a limited rate and packet loss. The server side is a minimal in-process
+ * stand-in for the sender side of the protocol: it keeps the receiver window full and retransmits
+ * the chunks that are reported missing or not acknowledged in time. All timing is virtual, so the
+ * results do not depend on the host.
+ */
+
+#include "firmware_update.h"
+#include "coap_channel.h"
+#include "messages.h"
+#include "varint.h"
+
+#include "util/simulated_link.h"
+#include "util/coap_message.h"
+#include "util/protocol_callbacks.h"
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+#include <deque>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+using namespace particle;
+using namespace particle::protocol;
+using namespace particle::protocol::test;
+
+// Protocol-specific CoAP options
+enum OtaCoapOption {
+    CHUNK_INDEX = 2049,
+    WINDOW_SIZE = 2053,
+    FILE_SIZE = 2057,
+    CHUNK_SIZE = 2065,
+    ACK_FORMAT = 2089
+};
+
+const unsigned ACK_FORMAT_RANGES = 1;
+
+const system_tick_t START_TIME = 1000000;
+// Maximum time to wait for an update to complete
+const system_tick_t UPDATE_TIMEOUT = 10 * 60 * 1000;
+
+const size_t TEST_FILE_SIZE = 2 * 1024 * 1024;
+const size_t TEST_CHUNK_SIZE = 1024;
+const size_t TEST_CHUNK_COUNT = (TEST_FILE_SIZE + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE;
+
+// Retransmission timeout used by the server before the round trip time is known
+const system_tick_t INITIAL_RETRANSMIT_TIMEOUT = 1000;
+const system_tick_t MIN_RETRANSMIT_TIMEOUT = 200;
+
+struct LinkProfile {
+    const char* name;
+    system_tick_t latency; // One-way delay
+    system_tick_t jitter;
+    unsigned loss; // Percent
+    unsigned bandwidth; // Bytes per second
+};
+
+const LinkProfile LINK_PROFILES[] = {
+    { "LTE Cat-M1", 100, 20, 1, 40 * 1024 },
+    // Jitter reorders packets in the simulated link, which is rare on faster links
+    { "LTE Cat-1", 75, 0, 0, 1250 * 1024 },
+    { "Wi-Fi", 20, 0, 0, 5 * 1024 * 1024 },
+    { "Wi-Fi lossy", 20, 0, 2, 5 * 1024 * 1024 }
+};
+
+struct BenchmarkResult {
+    system_tick_t transferTime;
+    size_t chunks; // Number of chunks sent by the server, including the retransmitted ones
+    size_t acks; // Number of acknowledgements received by the server
+    size_t ackBytes; // Size of the acknowledgements received by the server
+    unsigned maxWindowSize; // Maximum receiver window size reported by the device
+    system_tick_t roundTripTime; // Round trip time measured by the device
+    bool completed;
+
+    double throughput() const {
+        return transferTime ? TEST_FILE_SIZE * 1000.0 / 1024 / transferTime : 0.0;
+    }
+};
+
+// Device side of the benchmark
+class Device {
+public:
+    explicit Device(SimulatedLink* link) {
+        channel_.link(link);
+        REQUIRE(ota_.init(&channel_, callbacks_.get()) == ProtocolError::NO_ERROR);
+    }
+
+    ~Device() {
+        ota_.destroy();
+    }
+
+    void run(system_tick_t now) {
+        callbacks_.setMillis(now);
+        for (;;) {
+            Message m;
+            REQUIRE(channel_.receive(m) == ProtocolError::NO_ERROR);
+            if (!m.length()) {
+                break;
+            }
+            ProtocolError r = ProtocolError::NO_ERROR;
+            switch (Messages::decodeType(m.buf(), m.length())) {
+            case CoAPMessageType::UPDATE_START_V3: {
+                r = ota_.startRequest(&m);
+                break;
+            }
+            case CoAPMessageType::UPDATE_FINISH_V3: {
+                r = ota_.finishRequest(&m);
+                break;
+            }
+            case CoAPMessageType::UPDATE_CHUNK_V3: {
+                r = ota_.chunkRequest(&m);
+                break;
+            }
+            case CoAPMessageType::EMPTY_ACK: {
+                bool handled = false;
+                r = ota_.responseAck(&m, &handled);
+                break;
+            }
+            default:
+                break;
+            }
+            REQUIRE(r == ProtocolError::NO_ERROR);
+        }
+        REQUIRE(ota_.process() == ProtocolError::NO_ERROR);
+    }
+
+    const FirmwareUpdateStats& stats() const {
+        return ota_.stats();
+    }
+
+private:
+    CoAPChannel<SimulatedLinkChannel> channel_;
+    ProtocolCallbacks callbacks_;
+    FirmwareUpdate ota_;
+};
+
+// Minimal stand-in for the sender side of the protocol
+class OtaServer {
+public:
+    enum State {
+        IDLE,
+        START,
+        TRANSFER,
+        FINISH,
+        DONE
+    };
+
+    OtaServer(SimulatedLink* link, bool ackRanges) :
+            link_(link),
+            chunkCount_(TEST_CHUNK_COUNT),
+            acked_(chunkCount_ + 1),
+            sentSeq_(chunkCount_ + 1),
+            sentTime_(chunkCount_ + 1),
+            sentCount_(chunkCount_ + 1),
+            queued_(chunkCount_ + 1),
+            retransmitTimeout_(INITIAL_RETRANSMIT_TIMEOUT),
+            roundTripTime_(0),
+            state_(IDLE),
+            lastId_(0),
+            window_(0),
+            cumAck_(0),
+            next_(1),
+            seq_(0),
+            ackedSeq_(0),
+            lastProgressTime_(0),
+            transferStartTime_(0),
+            transferFinishTime_(0),
+            chunks_(0),
+            acks_(0),
+            ackBytes_(0),
+            maxWindow_(0),
+            ackRanges_(ackRanges) {
+    }
+
+    void start() {
+        CoapMessage m;
+        m.type(CoapType::CON);
+        m.code(CoapCode::POST);
+        m.id(++lastId_);
+        m.token(std::string(1, 'a'));
+        m.option(CoapOption::URI_PATH, "S");
+        m.option(OtaCoapOption::FILE_SIZE, TEST_FILE_SIZE);
+        m.option(OtaCoapOption::CHUNK_SIZE, TEST_CHUNK_SIZE);
+        if (ackRanges_) {
+            m.option(OtaCoapOption::ACK_FORMAT, ACK_FORMAT_RANGES);
+        }
+        send(m.encode());
+        state_ = START;
+    }
+
+    void run() {
+        std::string data;
+        while (link_->receive(SimulatedLink::TO_SERVER, &data)) {
+            handleMessage(CoapMessage::decode(data), data.size());
+        }
+        if (state_ == TRANSFER) {
+            sendChunks();
+        }
+    }
+
+    State state() const {
+        return state_;
+    }
+
+    void fillResult(BenchmarkResult* r) const {
+        r->transferTime = transferFinishTime_ - transferStartTime_;
+        r->chunks = chunks_;
+        r->acks = acks_;
+        r->ackBytes = ackBytes_;
+        r->maxWindowSize = maxWindow_;
+    }
+
+private:
+    SimulatedLink* link_;
+    size_t chunkCount_;
+    std::vector<bool> acked_; // Chunks acknowledged selectively or cumulatively
+    std::vector<unsigned> sentSeq_; // Transmission sequence number of every chunk
+    std::vector<system_tick_t> sentTime_;
+    std::vector<unsigned> sentCount_;
+    std::vector<bool> queued_; // Chunks queued for retransmission
+    std::deque<unsigned> retransmit_;
+    system_tick_t retransmitTimeout_;
+    system_tick_t roundTripTime_; // Smoothed round trip time
+    State state_;
+    CoapMessageId lastId_;
+    unsigned window_;
+    unsigned cumAck_;
+    unsigned next_; // Next chunk to send for the first time
+    unsigned seq_;
+    unsigned ackedSeq_; // Highest transmission sequence number among the acknowledged chunks
+    system_tick_t lastProgressTime_;
+    system_tick_t transferStartTime_;
+    system_tick_t transferFinishTime_;
+    size_t chunks_;
+    size_t acks_;
+    size_t ackBytes_;
+    unsigned maxWindow_;
+    bool ackRanges_;
+
+    void handleMessage(const CoapMessage& msg, size_t size) {
+        if (msg.type() == CoapType::CON) {
+            CoapMessage ack;
+            ack.type(CoapType::ACK);
+            ack.code(CoapCode::EMPTY);
+            ack.id(msg.id());
+            send(ack.encode());
+        }
+        if (state_ == START && msg.code() == (unsigned)CoapCode::CREATED) {
+            window_ = msg.option(OtaCoapOption::WINDOW_SIZE).toUInt();
+            maxWindow_ = window_;
+            state_ = TRANSFER;
+            transferStartTime_ = link_->time();
+            lastProgressTime_ = link_->time();
+        } else if (state_ == FINISH && msg.code() == (unsigned)CoapCode::CHANGED) {
+            state_ = DONE;
+        } else if (state_ == TRANSFER && msg.type() == CoapType::NON && msg.code() == (unsigned)CoapCode::POST) {
+            ++acks_;
+            ackBytes_ += size;
+            handleAck(msg);
+        }
+    }
+
+    void handleAck(const CoapMessage& msg) {
+        const unsigned index = msg.option(OtaCoapOption::CHUNK_INDEX).toUInt();
+        for (unsigned i = cumAck_ + 1; i <= index; ++i) {
+            setAcked(i);
+        }
+        if (index > cumAck_) {
+            if (sentCount_.at(index) == 1) {
+                // Chunks that were retransmitted are not sampled, as it's unknown which copy is acknowledged
+                const system_tick_t t = link_->time() - sentTime_.at(index);
+                roundTripTime_ = roundTripTime_ ? (roundTripTime_ * 7 + t) / 8 : t;
+                retransmitTimeout_ = std::max(roundTripTime_ * 2, MIN_RETRANSMIT_TIMEOUT);
+            }
+            cumAck_ = index;
+            lastProgressTime_ = link_->time();
+        }
+        const auto p = msg.hasPayload() ? msg.payload() : std::string();
+        if (ackRanges_) {
+            window_ = msg.option(OtaCoapOption::WINDOW_SIZE).toUInt();
+            maxWindow_ = std::max(maxWindow_, window_);
+            unsigned pos = index + 1;
+            size_t offs = 0;
+            while (offs < p.size()) {
+                unsigned missing = 0;
+                unsigned received = 0;
+                int n = decodeUnsignedVarint(p.data() + offs, p.size() - offs, &missing);
+                REQUIRE(n > 0);
+                offs += n;
+                n = decodeUnsignedVarint(p.data() + offs, p.size() - offs, &received);
+                REQUIRE(n > 0);
+                offs += n;
+                pos += missing;
+                for (unsigned i = 0; i < received; ++i) {
+                    setAcked(pos++);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < p.size() * 8; ++i) {
+                if (p.at(i / 8) & (1 << (i % 8))) {
+                    setAcked(index + 1 + i);
+                }
+            }
+        }
+        // A chunk is considered lost if a chunk sent after it has been acknowledged
+        for (unsigned i = cumAck_ + 1; i < next_; ++i) {
+            if (!acked_.at(i) && !queued_.at(i) && sentSeq_.at(i) < ackedSeq_) {
+                retransmit_.push_back(i);
+                queued_.at(i) = true;
+            }
+        }
+        if (cumAck_ == chunkCount_) {
+            transferFinishTime_ = link_->time();
+            sendFinish();
+        }
+    }
+
+    void setAcked(unsigned index) {
+        if (index > chunkCount_ || acked_.at(index)) {
+            return;
+        }
+        acked_.at(index) = true;
+        ackedSeq_ = std::max(ackedSeq_, sentSeq_.at(index));
+    }
+
+    void sendChunks() {
+        const auto now = link_->time();
+        if (now - lastProgressTime_ >= retransmitTimeout_ && !queued_.at(cumAck_ + 1)) {
+            // Retransmit the first unacknowledged chunk
+            retransmit_.push_front(cumAck_ + 1);
+            queued_.at(cumAck_ + 1) = true;
+            lastProgressTime_ = now;
+        }
+        while (!retransmit_.empty()) {
+            const unsigned i = retransmit_.front();
+            retransmit_.pop_front();
+            queued_.at(i) = false;
+            if (!acked_.at(i)) {
+                sendChunk(i);
+            }
+        }
+        while (next_ <= chunkCount_ && next_ <= cumAck_ + window_) {
+            sendChunk(next_++);
+        }
+    }
+
+    void sendChunk(unsigned index) {
+        const size_t size = std::min(TEST_CHUNK_SIZE, TEST_FILE_SIZE - (index - 1) * TEST_CHUNK_SIZE);
+        CoapMessage m;
+        m.type(CoapType::NON);
+        m.code(CoapCode::POST);
+        m.id(++lastId_);
+        m.option(CoapOption::URI_PATH, "C");
+        m.option(OtaCoapOption::CHUNK_INDEX, index);
+        m.payload(std::string(size, (char)index));
+        send(m.encode());
+        sentSeq_.at(index) = ++seq_;
+        sentTime_.at(index) = link_->time();
+        ++sentCount_.at(index);
+        ++chunks_;
+    }
+
+    void sendFinish() {
+        CoapMessage m;
+        m.type(CoapType::CON);
+        m.code(CoapCode::POST);
+        m.id(++lastId_);
+        m.token(std::string(1, 'b'));
+        m.option(CoapOption::URI_PATH, "F");
+        send(m.encode());
+        state_ = FINISH;
+    }
+
+    void send(const std::string& data) {
+        link_->send(SimulatedLink::TO_DEVICE, (const uint8_t*)data.data(), data.size());
+    }
+};
+
+BenchmarkResult runUpdate(const LinkProfile& profile, bool ackRanges) {
+    SimulatedLink link(12345);
+    link.latency(profile.latency).jitter(profile.jitter).bandwidth(profile.bandwidth);
+    Device device(&link);
+    OtaServer server(&link, ackRanges);
+    system_tick_t now = START_TIME;
+    link.time(now);
+    server.start();
+    while (server.state() != OtaServer::DONE && now - START_TIME < UPDATE_TIMEOUT) {
+        ++now;
+        link.time(now);
+        // Only the chunks and their acknowledgements are subject to packet loss
+        link.loss((server.state() == OtaServer::TRANSFER) ? profile.loss : 0);
+        device.run(now);
+        server.run();
+    }
+    BenchmarkResult r = {};
+    server.fillResult(&r);
+    r.roundTripTime = device.stats().roundTripTime;
+    r.completed = (server.state() == OtaServer::DONE);
+    return r;
+}
+
+void report(const LinkProfile& profile, const char* mode, const BenchmarkResult& r) {
+    std::printf("[ BENCH ] OTA %-12s %-7s link=%ums+%ums/%u%%/%uKB/s rate=%.1f KB/s chunks=%u acks=%u ack_bytes=%u "
+            "max_window=%u rtt=%ums\n", profile.name, mode, (unsigned)profile.latency, (unsigned)profile.jitter,
+            profile.loss, profile.bandwidth / 1024, r.throughput(), (unsigned)r.chunks, (unsigned)r.acks,
+            (unsigned)r.ackBytes, r.maxWindowSize, (unsigned)r.roundTripTime);
+}
+
+} // namespace
+
+TEST_CASE("FirmwareUpdate throughput") {
+    for (const auto& profile: LINK_PROFILES) {
+        const auto fixed = runUpdate(profile, false /* ackRanges */);
+        const auto adaptive = runUpdate(profile, true /* ackRanges */);
+        CHECK(fixed.completed);
+        CHECK(adaptive.completed);
+        // The window doesn't grow if the link can't carry it, so the adaptive policy is never slower
+        CHECK(adaptive.throughput() >= fixed.throughput() * 0.95);
+        CHECK(adaptive.acks <= fixed.acks);
+        CHECK(adaptive.ackBytes <= fixed.ackBytes);
+        CHECK(adaptive.roundTripTime >= 2 * profile.latency);
+        if (profile.loss == 0) {
+            // No chunk is retransmitted
+            CHECK(fixed.chunks == TEST_CHUNK_COUNT);
+            CHECK(adaptive.chunks == TEST_CHUNK_COUNT);
+        }
+        if (profile.loss == 0 && profile.bandwidth / 1000 * (2 * profile.latency) > OTA_RECEIVE_WINDOW_SIZE) {
+            // The bandwidth-delay product exceeds the initial window
+            CHECK(adaptive.maxWindowSize > OTA_RECEIVE_WINDOW_SIZE / TEST_CHUNK_SIZE);
+            CHECK(adaptive.throughput() >= fixed.throughput() * 1.2);
+        }
+    }
+}
+
+TEST_CASE("FirmwareUpdate throughput report", "[.benchmark]") {
+    for (const auto& profile: LINK_PROFILES) {
+        report(profile, "fixed", runUpdate(profile, false /* ackRanges */));
+        report(profile, "adaptive", runUpdate(profile, true /* ackRanges */));
+    }
+}
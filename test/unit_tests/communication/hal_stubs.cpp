@@ -10,11 +10,7 @@
 #include "logging.h"
 #include "diagnostics.h"
 
-namespace particle::protocol {
-
-class Protocol;
-
-} // namespace particle::protocol
+#include "util/protocol_stub.h"
 
 extern "C" uint32_t HAL_RNG_GetRandomNumber()
 {
@@ -51,6 +47,9 @@ extern "C" int diag_register_source(const diag_source* src, void* reserved) {
 	return 0;
 }
 
+// Used by the CoAP channel (v2) which can't be given a protocol instance explicitly
 extern "C" particle::protocol::Protocol* spark_protocol_instance(void) {
-	return nullptr;
+	static particle::protocol::test::CoapMessageChannel channel;
+	static particle::protocol::test::ProtocolStub protocol(&channel);
+	return &protocol;
 }
@@ -0,0 +1,801 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * End-to-end benchmark of the cloud protocol stack.
+ *
+ * The device runs the real Protocol implementation on top of the same CoAP reliability layers as
+ * DTLSProtocol. The DTLS layer is replaced with a simulated datagram link that delays, reorders and
+ * drops packets deterministically; its per-packet overhead is accounted for in the wire byte counts.
+ * The server side is a minimal in-process stand-in for the Device Service. All timing is virtual,
+ * so the results do not depend on the host and can be used as a regression gate.
+ */
+
+#include "protocol.h"
+#include "coap_channel.h"
+
+#include "util/simulated_link.h"
+#include "util/coap_message.h"
+#include "util/protocol_callbacks.h"
+#include "util/descriptor_callbacks.h"
+
+#include <catch2/catch.hpp>
+
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <map>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using namespace particle;
+using namespace particle::protocol;
+using namespace particle::protocol::test;
+
+// Keeps the virtual time far from the timestamps used by the rate limiter tests
+const system_tick_t START_TIME = 1000000;
+// Interval between application events that stays below the rate limit of 4 events per second
+const system_tick_t PUBLISH_INTERVAL = 260;
+// Maximum time to wait for an operation to complete
+const system_tick_t OPERATION_TIMEOUT = MAX_TRANSMIT_SPAN + 15000;
+
+const char* const FUNCTION_NAME = "bench_fn";
+const char* const VARIABLE_NAME = "bench_var";
+const char* const EVENT_PREFIX = "bench/";
+const std::string EVENT_DATA = "0123456789abcdef";
+
+class LatencyStats {
+public:
+    void add(system_tick_t ms) {
+        samples_.push_back(ms);
+    }
+
+    // Nearest-rank percentile
+    system_tick_t percentile(unsigned p) const {
+        if (samples_.empty()) {
+            return 0;
+        }
+        auto s = samples_;
+        std::sort(s.begin(), s.end());
+        size_t rank = (s.size() * p + 99) / 100;
+        if (rank > 0) {
+            --rank;
+        }
+        return s.at(rank);
+    }
+
+    size_t count() const {
+        return samples_.size();
+    }
+
+private:
+    std::vector<system_tick_t> samples_;
+};
+
+struct BenchmarkResult {
+    LatencyStats latency;
+    SimulatedLink::Stats up;
+    SimulatedLink::Stats down;
+    system_tick_t elapsed;
+    size_t completed;
+    size_t failed;
+
+    BenchmarkResult() :
+            up(),
+            down(),
+            elapsed(0),
+            completed(0),
+            failed(0) {
+    }
+
+    double throughput() const {
+        return elapsed ? completed * 1000.0 / elapsed : 0.0;
+    }
+
+    double packetsPerOp() const {
+        return completed ? (double)(up.packets + down.packets) / completed : 0.0;
+    }
+
+    double bytesPerOp() const {
+        return completed ? (double)(up.bytes + down.bytes) / completed : 0.0;
+    }
+
+    double wireBytesPerOp() const {
+        return completed ? (double)(up.wireBytes() + down.wireBytes()) / completed : 0.0;
+    }
+};
+
+// Minimal stand-in for the server side of the protocol
+class CloudStandIn {
+public:
+    typedef std::function<void(const CoapMessage&)> ResponseHandler;
+
+    explicit CloudStandIn(SimulatedLink* link) :
+            link_(link),
+            events_(0),
+            subscriptions_(0),
+            lastId_(0),
+            lastToken_(0) {
+    }
+
+    void callFunction(const std::string& name, const std::string& arg, ResponseHandler handler) {
+        CoapMessage m;
+        m.type(CoapType::CON);
+        m.code(CoapCode::POST);
+        m.token(nextToken(std::move(handler)));
+        m.option(CoapOption::URI_PATH, "f");
+        m.option(CoapOption::URI_PATH, name);
+        m.option(CoapOption::URI_QUERY, arg);
+        sendRequest(std::move(m));
+    }
+
+    void getVariable(const std::string& name, ResponseHandler handler) {
+        CoapMessage m;
+        m.type(CoapType::CON);
+        m.code(CoapCode::GET);
+        m.token(nextToken(std::move(handler)));
+        m.option(CoapOption::URI_PATH, "v");
+        m.option(CoapOption::URI_PATH, name);
+        sendRequest(std::move(m));
+    }
+
+    void sendEvent(const std::string& name, const std::string& data) {
+        CoapMessage m;
+        m.type(CoapType::CON);
+        m.code(CoapCode::POST);
+        m.option(CoapOption::URI_PATH, "e");
+        m.option(CoapOption::URI_PATH, name);
+        m.payload(data);
+        sendRequest(std::move(m));
+    }
+
+    // Processes the packets received from the device and retransmits unacknowledged requests
+    void run() {
+        std::string data;
+        while (link_->receive(SimulatedLink::TO_SERVER, &data)) {
+            handleMessage(CoapMessage::decode(data));
+        }
+        const auto now = link_->time();
+        for (auto it = unacked_.begin(); it != unacked_.end();) {
+            auto& req = it->second;
+            if ((int32_t)(req.timeout - now) > 0) {
+                ++it;
+                continue;
+            }
+            if (req.count > MAX_RETRANSMIT) {
+                it = unacked_.erase(it); // Give up
+                continue;
+            }
+            send(req.data);
+            req.timeout = now + (ACK_TIMEOUT << req.count);
+            ++req.count;
+            ++it;
+        }
+    }
+
+    // Discards the handlers of the requests that are still awaiting a response
+    void cancelRequests() {
+        handlers_.clear();
+        unacked_.clear();
+    }
+
+    size_t events() const {
+        return events_;
+    }
+
+    size_t subscriptions() const {
+        return subscriptions_;
+    }
+
+private:
+    struct UnackedRequest {
+        std::string data;
+        system_tick_t timeout;
+        unsigned count;
+    };
+
+    static const size_t MAX_RECENT_IDS = 64;
+
+    std::map<CoapMessageId, UnackedRequest> unacked_;
+    std::map<std::string, ResponseHandler> handlers_; // Response handlers by token
+    std::deque<CoapMessageId> recentIds_; // IDs of the recently received confirmable messages
+    SimulatedLink* link_;
+    size_t events_;
+    size_t subscriptions_;
+    CoapMessageId lastId_;
+    uint8_t lastToken_;
+
+    void handleMessage(const CoapMessage& msg) {
+        if (msg.type() == CoapType::ACK || msg.type() == CoapType::RST) {
+            unacked_.erase(msg.id());
+            if (msg.code() != (unsigned)CoapCode::EMPTY) {
+                handleResponse(msg); // Piggybacked response
+            }
+            return;
+        }
+        if (msg.type() == CoapType::CON) {
+            CoapMessage ack;
+            ack.type(CoapType::ACK);
+            ack.code(CoapCode::EMPTY);
+            ack.id(msg.id());
+            send(ack.encode());
+            if (std::find(recentIds_.begin(), recentIds_.end(), msg.id()) != recentIds_.end()) {
+                return; // Duplicate
+            }
+            recentIds_.push_back(msg.id());
+            if (recentIds_.size() > MAX_RECENT_IDS) {
+                recentIds_.pop_front();
+            }
+        }
+        if (isCoapResponseCode(msg.code())) {
+            handleResponse(msg);
+            return;
+        }
+        const auto path = msg.options(CoapOption::URI_PATH);
+        if (path.empty()) {
+            return; // Ping
+        }
+        const auto& prefix = path.front().toString();
+        if (msg.code() == (unsigned)CoapCode::POST && (prefix == "e" || prefix == "E")) {
+            ++events_;
+        } else if (msg.code() == (unsigned)CoapCode::GET && prefix == "e") {
+            ++subscriptions_;
+        }
+    }
+
+    void handleResponse(const CoapMessage& msg) {
+        const auto it = handlers_.find(msg.token());
+        if (it == handlers_.end()) {
+            return;
+        }
+        const auto handler = std::move(it->second);
+        handlers_.erase(it);
+        handler(msg);
+    }
+
+    void sendRequest(CoapMessage msg) {
+        msg.id(++lastId_);
+        UnackedRequest req = {};
+        req.data = msg.encode();
+        req.timeout = link_->time() + ACK_TIMEOUT;
+        req.count = 1;
+        send(req.data);
+        unacked_[msg.id()] = std::move(req);
+    }
+
+    std::string nextToken(ResponseHandler handler) {
+        // The device only supports 1-byte tokens
+        const std::string token(1, (char)++lastToken_);
+        handlers_[token] = std::move(handler);
+        return token;
+    }
+
+    void send(const std::string& data) {
+        link_->send(SimulatedLink::TO_DEVICE, (const uint8_t*)data.data(), data.size());
+    }
+};
+
+// Application callbacks of the device
+class DeviceApp: public DescriptorCallbacks {
+public:
+    DeviceApp() :
+            events_(0),
+            variable_(0x12345678) {
+    }
+
+    int callFunction(const char* name, const char* arg, SparkDescriptor::FunctionResultCallback callback, void* reserved) override {
+        if (strcmp(name, FUNCTION_NAME) != 0) {
+            return -1;
+        }
+        callback((const void*)(intptr_t)strlen(arg), SparkReturnType::INT);
+        return 0;
+    }
+
+    const void* getVariable(const char* name) override {
+        if (strcmp(name, VARIABLE_NAME) != 0) {
+            return nullptr;
+        }
+        return &variable_;
+    }
+
+    SparkReturnType::Enum variableType(const char* name) override {
+        return SparkReturnType::INT;
+    }
+
+    void callEventHandler(uint16_t size, FilteringEventHandler* handler, const char* name, const char* data,
+            size_t dataSize, int contentType) override {
+        ++events_;
+    }
+
+    size_t events() const {
+        return events_;
+    }
+
+private:
+    size_t events_;
+    int32_t variable_;
+};
+
+typedef CoAPChannel<CoAPReliableChannel<SimulatedLinkChannel, decltype(SparkCallbacks::millis)>> DeviceChannel;
+
+// Protocol instance of the device. Mirrors the channel layering of DTLSProtocol
+class DeviceProtocol: public Protocol {
+public:
+    DeviceProtocol(SimulatedLink* link, const ProtocolCallbacks& callbacks, const DescriptorCallbacks& descriptor) :
+            Protocol(channel_) {
+        channel_.link(link);
+        channel_.set_millis(callbacks.get().millis);
+        Protocol::init(callbacks.get(), descriptor.get());
+    }
+
+    // Reimplemented from Protocol
+    void init(const char* id, const SparkKeys& keys, const SparkCallbacks& cb, const SparkDescriptor& desc) override {
+    }
+
+    int command(ProtocolCommands::Enum cmd, uint32_t val, const void* data) override {
+        return 0;
+    }
+
+    size_t build_hello(Message& msg, uint16_t flags) override {
+        return 0;
+    }
+
+    int get_status(protocol_status* status) const override {
+        status->flags = 0;
+        return 0;
+    }
+
+    DeviceChannel& channel() {
+        return channel_;
+    }
+
+private:
+    DeviceChannel channel_;
+};
+
+void dummyEventHandler(const char* name, const char* data) {
+}
+
+class Benchmark {
+public:
+    explicit Benchmark(uint32_t seed) :
+            link_(seed),
+            server_(&link_),
+            device_(&link_, callbacks_, app_),
+            now_(START_TIME),
+            start_(START_TIME),
+            error_(ProtocolError::NO_ERROR) {
+        srand(seed); // Used for the retransmission timeouts on the device
+        callbacks_.setMillis(now_);
+        link_.time(now_);
+        // Let the event loop initialize its timers
+        tick();
+    }
+
+    ~Benchmark() {
+        device_.reset();
+    }
+
+    SimulatedLink& link() {
+        return link_;
+    }
+
+    const CloudStandIn& server() const {
+        return server_;
+    }
+
+    // Advances the virtual time by 1 ms and runs both ends of the link
+    void tick() {
+        ++now_;
+        callbacks_.setMillis(now_);
+        link_.time(now_);
+        server_.run();
+        CoAPMessageType::Enum type;
+        const auto err = device_.event_loop(type);
+        if (err && !error_) {
+            error_ = err;
+        }
+    }
+
+    bool runUntil(const std::function<bool()>& cond, system_tick_t timeout = OPERATION_TIMEOUT) {
+        const auto start = now_;
+        while (!cond()) {
+            if (now_ - start >= timeout) {
+                return false;
+            }
+            tick();
+        }
+        return true;
+    }
+
+    void runFor(system_tick_t duration) {
+        const auto end = now_ + duration;
+        while ((int32_t)(end - now_) > 0) {
+            tick();
+        }
+    }
+
+    BenchmarkResult publish(unsigned count) {
+        BenchmarkResult r;
+        begin();
+        size_t pending = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            // The completion handler takes the ownership over the context and is invoked even if
+            // the event couldn't be sent
+            const auto ctx = new PublishContext{ this, &r, &pending, now_ };
+            ++pending;
+            const auto name = std::string(EVENT_PREFIX) + "pub";
+            device_.send_event(name.c_str(), EVENT_DATA.data(), EVENT_DATA.size(), 0 /* content_type */, 60 /* ttl */,
+                    EventType::PUBLIC | EventType::WITH_ACK, CompletionHandler(publishDone, ctx));
+            runFor(PUBLISH_INTERVAL);
+        }
+        runUntil([&pending]() {
+            return pending == 0;
+        });
+        end(&r);
+        return r;
+    }
+
+    BenchmarkResult callFunction(unsigned count) {
+        BenchmarkResult r;
+        begin();
+        for (unsigned i = 0; i < count; ++i) {
+            bool done = false;
+            const auto start = now_;
+            server_.callFunction(FUNCTION_NAME, "arg" + std::to_string(i), [&](const CoapMessage& resp) {
+                if (resp.code() == (unsigned)CoapCode::CHANGED) {
+                    r.latency.add(now_ - start);
+                    ++r.completed;
+                } else {
+                    ++r.failed;
+                }
+                done = true;
+            });
+            completeRequest(&r, &done);
+        }
+        end(&r);
+        return r;
+    }
+
+    BenchmarkResult getVariable(unsigned count) {
+        BenchmarkResult r;
+        begin();
+        for (unsigned i = 0; i < count; ++i) {
+            bool done = false;
+            const auto start = now_;
+            server_.getVariable(VARIABLE_NAME, [&](const CoapMessage& resp) {
+                if (isCoapSuccessCode(resp.code())) {
+                    r.latency.add(now_ - start);
+                    ++r.completed;
+                } else {
+                    ++r.failed;
+                }
+                done = true;
+            });
+            completeRequest(&r, &done);
+        }
+        end(&r);
+        return r;
+    }
+
+    BenchmarkResult receiveEvents(unsigned count) {
+        BenchmarkResult r;
+        // Subscribe to the events first
+        if (!device_.add_event_handler(EVENT_PREFIX, dummyEventHandler, nullptr /* handler_data */, 0 /* flags */) ||
+                device_.send_subscription(EVENT_PREFIX, 0 /* flags */) != ProtocolError::NO_ERROR ||
+                !runUntil([this]() { return server_.subscriptions() > 0; })) {
+            r.failed = count;
+            return r;
+        }
+        waitIdle();
+        begin();
+        for (unsigned i = 0; i < count; ++i) {
+            const auto start = now_;
+            const auto received = app_.events();
+            server_.sendEvent(std::string(EVENT_PREFIX) + "sub", EVENT_DATA);
+            if (runUntil([&]() { return app_.events() != received; })) {
+                r.latency.add(now_ - start);
+                ++r.completed;
+            } else {
+                ++r.failed;
+            }
+        }
+        waitIdle(); // Wait for the acknowledgements
+        end(&r);
+        return r;
+    }
+
+    // Sends a burst of confirmable events through the device's channel directly, bypassing the
+    // publisher's rate limiting
+    BenchmarkResult sendRequests(unsigned count) {
+        BenchmarkResult r;
+        begin();
+        const auto events = server_.events();
+        auto& channel = device_.channel();
+        for (unsigned i = 0; i < count; ++i) {
+            CoapMessage m;
+            m.type(CoapType::CON);
+            m.code(CoapCode::POST);
+            m.id(0); // Will be assigned by the channel
+            m.option(CoapOption::URI_PATH, "E");
+            m.option(CoapOption::URI_PATH, std::string(EVENT_PREFIX) + "burst");
+            m.payload(EVENT_DATA);
+            const auto data = m.encode();
+            Message msg;
+            if (channel.create(msg) != ProtocolError::NO_ERROR || data.size() > msg.capacity()) {
+                ++r.failed;
+                continue;
+            }
+            memcpy(msg.buf(), data.data(), data.size());
+            msg.set_length(data.size());
+            // The number of requests waiting for a free slot in the window is limited
+            runUntil([&]() {
+                return channel.queued_request_count() < MAX_QUEUED_REQUESTS;
+            });
+            if (channel.send(msg) != ProtocolError::NO_ERROR) {
+                ++r.failed;
+            }
+        }
+        runUntil([&]() {
+            return !channel.has_unacknowledged_client_requests() && !link_.hasPending(SimulatedLink::TO_SERVER);
+        }, count * OPERATION_TIMEOUT);
+        r.completed = server_.events() - events;
+        end(&r);
+        return r;
+    }
+
+    void setWindowSize(uint8_t size) {
+        device_.channel().set_window_size(size);
+    }
+
+    ProtocolError error() const {
+        return error_;
+    }
+
+private:
+    struct PublishContext {
+        Benchmark* self;
+        BenchmarkResult* result;
+        size_t* pending;
+        system_tick_t time;
+    };
+
+    SimulatedLink link_;
+    CloudStandIn server_;
+    ProtocolCallbacks callbacks_;
+    DeviceApp app_;
+    DeviceProtocol device_;
+    system_tick_t now_;
+    system_tick_t start_;
+    ProtocolError error_;
+
+    void begin() {
+        link_.resetStats();
+        start_ = now_;
+    }
+
+    void end(BenchmarkResult* r) {
+        r->elapsed = now_ - start_;
+        r->up = link_.stats(SimulatedLink::TO_SERVER);
+        r->down = link_.stats(SimulatedLink::TO_DEVICE);
+    }
+
+    void completeRequest(BenchmarkResult* r, bool* done) {
+        if (!runUntil([done]() { return *done; })) {
+            server_.cancelRequests();
+            ++r->failed;
+            return;
+        }
+        // Make sure the device's separate response is acknowledged before the next request
+        waitIdle();
+    }
+
+    void waitIdle() {
+        runUntil([this]() {
+            return !link_.hasPending(SimulatedLink::TO_DEVICE) && !link_.hasPending(SimulatedLink::TO_SERVER);
+        });
+    }
+
+    static void publishDone(int error, const void* data, void* callbackData, void* reserved) {
+        std::unique_ptr<PublishContext> ctx(static_cast<PublishContext*>(callbackData));
+        if (error == 0) {
+            ctx->result->latency.add(ctx->self->now_ - ctx->time);
+            ++ctx->result->completed;
+        } else {
+            ++ctx->result->failed;
+        }
+        --*ctx->pending;
+    }
+};
+
+void report(const char* op, system_tick_t latency, system_tick_t jitter, unsigned loss,
+        const BenchmarkResult& r) {
+    std::printf("[ BENCH ] %-9s link=%ums+%ums/%u%% ops=%u failed=%u rate=%.2f op/s p50=%ums p99=%ums "
+            "pkt/op=%.2f bytes/op=%.1f wire/op=%.1f\n", op, (unsigned)latency, (unsigned)jitter, loss,
+            (unsigned)r.completed, (unsigned)r.failed, r.throughput(), (unsigned)r.latency.percentile(50),
+            (unsigned)r.latency.percentile(99), r.packetsPerOp(), r.bytesPerOp(), r.wireBytesPerOp());
+}
+
+} // namespace
+
+TEST_CASE("Protocol benchmark") {
+    const unsigned OPS = 50;
+
+    SECTION("ideal link") {
+        const system_tick_t LATENCY = 40;
+        Benchmark b(1);
+        b.link().latency(LATENCY);
+        // A round trip can't take much longer than the link delay. One extra tick is allowed for
+        // every hop that is processed by the event loop
+        const system_tick_t rtt = 2 * LATENCY + 4;
+
+        SECTION("publish") {
+            const auto r = b.publish(OPS);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.completed == OPS);
+            CHECK(b.server().events() == OPS);
+            CHECK(r.latency.percentile(99) <= rtt);
+            // Request and ACK
+            CHECK(r.packetsPerOp() == Approx(2.0));
+            CHECK(r.bytesPerOp() <= 48);
+            CHECK(r.wireBytesPerOp() == Approx(r.bytesPerOp() + 2 * SimulatedLink::PACKET_OVERHEAD));
+        }
+        SECTION("subscribe") {
+            const auto r = b.receiveEvents(OPS);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.completed == OPS);
+            CHECK(r.latency.percentile(99) <= rtt / 2);
+            // Event and ACK
+            CHECK(r.packetsPerOp() == Approx(2.0));
+            CHECK(r.bytesPerOp() <= 48);
+        }
+        SECTION("function call") {
+            const auto r = b.callFunction(OPS);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.completed == OPS);
+            CHECK(r.latency.percentile(99) <= rtt);
+            // Request, ACK, separate response and ACK
+            CHECK(r.packetsPerOp() == Approx(4.0));
+            CHECK(r.bytesPerOp() <= 48);
+        }
+        SECTION("variable read") {
+            const auto r = b.getVariable(OPS);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.completed == OPS);
+            CHECK(r.latency.percentile(99) <= rtt);
+            // Request, ACK, separate response and ACK
+            CHECK(r.packetsPerOp() == Approx(4.0));
+            CHECK(r.bytesPerOp() <= 48);
+        }
+    }
+
+    SECTION("lossy link") {
+        const system_tick_t LATENCY = 60;
+        const system_tick_t JITTER = 20;
+        const unsigned LOSS = 5;
+        Benchmark b(12345);
+        b.link().latency(LATENCY).jitter(JITTER).loss(LOSS);
+        const system_tick_t rtt = 2 * (LATENCY + JITTER) + 4;
+        // Operations that time out on the device or the server side are reported as failed
+        const unsigned maxFailed = OPS / 25;
+
+        SECTION("publish") {
+            const auto r = b.publish(OPS);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.failed <= maxFailed);
+            CHECK(r.latency.percentile(50) <= rtt);
+            CHECK(r.latency.percentile(99) <= MAX_TRANSMIT_SPAN);
+            CHECK(r.packetsPerOp() <= 2.0 * 1.5);
+        }
+        SECTION("subscribe") {
+            const auto r = b.receiveEvents(OPS);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.failed <= maxFailed);
+            CHECK(r.latency.percentile(50) <= rtt / 2);
+            CHECK(r.latency.percentile(99) <= MAX_TRANSMIT_SPAN);
+            CHECK(r.packetsPerOp() <= 2.0 * 1.5);
+        }
+        SECTION("function call") {
+            const auto r = b.callFunction(OPS);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.failed <= maxFailed);
+            CHECK(r.latency.percentile(50) <= rtt);
+            CHECK(r.latency.percentile(99) <= MAX_TRANSMIT_SPAN);
+            CHECK(r.packetsPerOp() <= 4.0 * 1.5);
+        }
+        SECTION("variable read") {
+            const auto r = b.getVariable(OPS);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.failed <= maxFailed);
+            CHECK(r.latency.percentile(50) <= rtt);
+            CHECK(r.latency.percentile(99) <= MAX_TRANSMIT_SPAN);
+            CHECK(r.packetsPerOp() <= 4.0 * 1.5);
+        }
+    }
+}
+
+TEST_CASE("Protocol benchmark report", "[.benchmark]") {
+    const unsigned OPS = 50;
+    const struct {
+        const char* name;
+        BenchmarkResult (Benchmark::*run)(unsigned);
+    } ops[] = {
+        { "publish", &Benchmark::publish },
+        { "subscribe", &Benchmark::receiveEvents },
+        { "function", &Benchmark::callFunction },
+        { "variable", &Benchmark::getVariable }
+    };
+    const struct {
+        system_tick_t latency;
+        system_tick_t jitter;
+        unsigned loss;
+        unsigned seed;
+    } links[] = {
+        { 40, 0, 0, 1 }, // Ideal link
+        { 60, 20, 5, 12345 } // Lossy link
+    };
+    for (const auto& link: links) {
+        for (const auto& op: ops) {
+            Benchmark b(link.seed);
+            b.link().latency(link.latency).jitter(link.jitter).loss(link.loss);
+            const auto r = (b.*op.run)(OPS);
+            report(op.name, link.latency, link.jitter, link.loss, r);
+        }
+    }
+}
+
+TEST_CASE("Confirmable request window") {
+    const unsigned COUNT = 64;
+    // Typical one-way delay of a cellular link
+    const system_tick_t LATENCY = 150;
+
+    SECTION("ideal link") {
+        double baseRate = 0;
+        for (unsigned window = 1; window <= 8; ++window) {
+            Benchmark b(1);
+            b.link().latency(LATENCY);
+            b.setWindowSize(window);
+            const auto r = b.sendRequests(COUNT);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.completed == COUNT);
+            if (window == 1) {
+                baseRate = r.throughput();
+                // One request per round trip
+                CHECK(baseRate <= 1000.0 / (2 * LATENCY));
+            } else {
+                CHECK(r.throughput() >= baseRate * window * 0.8);
+            }
+        }
+    }
+
+    SECTION("lossy link") {
+        const system_tick_t JITTER = 50;
+        const unsigned LOSS = 5;
+        for (unsigned window: { 1, 4, 8 }) {
+            Benchmark b(12345);
+            b.link().latency(LATENCY).jitter(JITTER).loss(LOSS);
+            b.setWindowSize(window);
+            const auto r = b.sendRequests(COUNT);
+            CHECK(b.error() == ProtocolError::NO_ERROR);
+            CHECK(r.completed >= COUNT - COUNT / 16);
+        }
+    }
+}
@@ -24,6 +24,9 @@ namespace protocol {
 namespace test {
 
 ProtocolError CoapMessageChannel::send(Message& msg) {
+    if (sendError_ != ProtocolError::NO_ERROR) {
+        return sendError_;
+    }
     if (msg.length() >= MIN_COAP_MESSAGE_SIZE) {
         const CoapMessageId id = msg.has_id() ? msg.get_id() : ++lastMsgId_;
         const auto buf = msg.buf();
@@ -24,6 +24,7 @@
 
 #include <memory>
 #include <queue>
+#include <vector>
 
 namespace particle {
 
@@ -43,6 +44,10 @@ public:
     CoapMessageChannel& skipMessages(unsigned count);
     // Returns true if there's a message received from the device
     bool hasMessages() const;
+    // Makes send() fail with the specified error
+    CoapMessageChannel& sendError(ProtocolError error);
+    // Returns the commands issued by the device
+    const std::vector<Command>& commands() const;
 
     // Reimplemented from AbstractMessageChannel
     ProtocolError send(Message& msg) override;
@@ -58,11 +63,14 @@ public:
 private:
     std::queue<CoapMessage> send_;
     std::queue<CoapMessage> recv_;
+    std::vector<Command> cmds_;
     CoapMessageId lastMsgId_;
+    ProtocolError sendError_;
 };
 
 inline CoapMessageChannel::CoapMessageChannel() :
-        lastMsgId_(0) {
+        lastMsgId_(0),
+        sendError_(ProtocolError::NO_ERROR) {
 }
 
 inline CoapMessageChannel& CoapMessageChannel::sendMessage(CoapMessage msg) {
@@ -93,11 +101,21 @@ inline bool CoapMessageChannel::hasMessages() const {
     return !recv_.empty();
 }
 
+inline CoapMessageChannel& CoapMessageChannel::sendError(ProtocolError error) {
+    sendError_ = error;
+    return *this;
+}
+
+inline const std::vector<CoapMessageChannel::Command>& CoapMessageChannel::commands() const {
+    return cmds_;
+}
+
 inline ProtocolError CoapMessageChannel::establish() {
     return ProtocolError::NO_ERROR;
 }
 
 inline ProtocolError CoapMessageChannel::command(Command cmd, void* arg) {
+    cmds_.push_back(cmd);
     return ProtocolError::NO_ERROR;
 }
 
@@ -19,6 +19,8 @@
 
 #include "protocol_callbacks.h"
 
+#include <utility>
+
 namespace particle {
 
 namespace protocol {
@@ -50,6 +52,34 @@ bool appendMetricsCallback(appender_fn append, void* arg, uint32_t flags, uint32
     return false;
 }
 
+int callFunctionCallback(const char* name, const char* arg, SparkDescriptor::FunctionResultCallback callback, void* reserved) {
+    if (g_callbacks) {
+        return g_callbacks->callFunction(name, arg, std::move(callback), reserved);
+    }
+    return -1;
+}
+
+const void* getVariableCallback(const char* name) {
+    if (g_callbacks) {
+        return g_callbacks->getVariable(name);
+    }
+    return nullptr;
+}
+
+SparkReturnType::Enum variableTypeCallback(const char* name) {
+    if (g_callbacks) {
+        return g_callbacks->variableType(name);
+    }
+    return SparkReturnType::INT;
+}
+
+void callEventHandlerCallback(uint16_t size, FilteringEventHandler* handler, const char* name, const char* data,
+        size_t dataSize, int contentType) {
+    if (g_callbacks) {
+        g_callbacks->callEventHandler(size, handler, name, data, dataSize, contentType);
+    }
+}
+
 } // namespace
 
 DescriptorCallbacks::DescriptorCallbacks() :
@@ -58,6 +88,10 @@ DescriptorCallbacks::DescriptorCallbacks() :
     desc_.append_system_info = appendSystemInfoCallback;
     desc_.append_app_info = appendAppInfoCallback;
     desc_.append_metrics = appendMetricsCallback;
+    desc_.call_function = callFunctionCallback;
+    desc_.get_variable = getVariableCallback;
+    desc_.variable_type = variableTypeCallback;
+    desc_.call_event_handler = callEventHandlerCallback;
     g_callbacks = this;
 }
 
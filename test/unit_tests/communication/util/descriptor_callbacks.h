@@ -36,6 +36,11 @@ public:
     virtual bool appendSystemInfo(appender_fn append, void* arg, void* reserved);
     virtual bool appendAppInfo(appender_fn append, void* arg, void* reserved);
     virtual bool appendMetrics(appender_fn append, void* arg, uint32_t flags, uint32_t page, void* reserved);
+    virtual int callFunction(const char* name, const char* arg, SparkDescriptor::FunctionResultCallback callback, void* reserved);
+    virtual const void* getVariable(const char* name);
+    virtual SparkReturnType::Enum variableType(const char* name);
+    virtual void callEventHandler(uint16_t size, FilteringEventHandler* handler, const char* name, const char* data,
+            size_t dataSize, int contentType);
 
 private:
     SparkDescriptor desc_;
@@ -57,6 +62,23 @@ inline bool DescriptorCallbacks::appendMetrics(appender_fn append, void* arg, ui
     return false;
 }
 
+inline int DescriptorCallbacks::callFunction(const char* name, const char* arg, SparkDescriptor::FunctionResultCallback callback,
+        void* reserved) {
+    return -1;
+}
+
+inline const void* DescriptorCallbacks::getVariable(const char* name) {
+    return nullptr;
+}
+
+inline SparkReturnType::Enum DescriptorCallbacks::variableType(const char* name) {
+    return SparkReturnType::INT;
+}
+
+inline void DescriptorCallbacks::callEventHandler(uint16_t size, FilteringEventHandler* handler, const char* name,
+        const char* data, size_t dataSize, int contentType) {
+}
+
 } // namespace test
 
 } // namespace protocol
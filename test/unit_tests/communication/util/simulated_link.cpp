@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simulated_link.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace particle {
+
+namespace protocol {
+
+namespace test {
+
+SimulatedLink::SimulatedLink(uint32_t seed) :
+        stats_(),
+        busyUntil_(),
+        latency_(0),
+        jitter_(0),
+        loss_(0),
+        bandwidth_(0),
+        time_(0),
+        rand_(seed ? seed : 1) {
+}
+
+void SimulatedLink::send(Direction dir, const uint8_t* data, size_t size) {
+    auto& stats = stats_[dir];
+    ++stats.packets;
+    stats.bytes += size;
+    system_tick_t sendTime = time_;
+    if (bandwidth_ > 0) {
+        // Dropped packets take the link time too
+        auto& busyUntil = busyUntil_[dir];
+        busyUntil = std::max(busyUntil, (uint64_t)time_ * 1000) + (uint64_t)(size + PACKET_OVERHEAD) * 1000000 / bandwidth_;
+        sendTime = (busyUntil + 999) / 1000;
+    }
+    if (loss_ > 0 && nextRandom() % 100 < loss_) {
+        ++stats.dropped;
+        return;
+    }
+    system_tick_t delay = sendTime - time_ + latency_;
+    if (jitter_ > 0) {
+        delay += nextRandom() % (jitter_ + 1);
+    }
+    queue_[dir].emplace(time_ + delay, std::string((const char*)data, size));
+}
+
+bool SimulatedLink::receive(Direction dir, std::string* data) {
+    auto& queue = queue_[dir];
+    const auto it = queue.begin();
+    if (it == queue.end() || (int32_t)(it->first - time_) > 0) {
+        return false;
+    }
+    *data = std::move(it->second);
+    queue.erase(it);
+    return true;
+}
+
+uint32_t SimulatedLink::nextRandom() {
+    // xorshift32
+    rand_ ^= rand_ << 13;
+    rand_ ^= rand_ >> 17;
+    rand_ ^= rand_ << 5;
+    return rand_;
+}
+
+ProtocolError SimulatedLinkChannel::send(Message& msg) {
+    link_->send(SimulatedLink::TO_SERVER, msg.buf(), msg.length());
+    return ProtocolError::NO_ERROR;
+}
+
+ProtocolError SimulatedLinkChannel::receive(Message& msg) {
+    std::string data;
+    if (link_->receive(SimulatedLink::TO_DEVICE, &data)) {
+        if (data.size() > sizeof(queue)) {
+            return ProtocolError::INSUFFICIENT_STORAGE;
+        }
+        memcpy(queue, data.data(), data.size());
+        msg = Message(queue, sizeof(queue), data.size());
+    } else {
+        msg = Message();
+    }
+    return ProtocolError::NO_ERROR;
+}
+
+} // namespace test
+
+} // namespace protocol
+
+} // namespace particle
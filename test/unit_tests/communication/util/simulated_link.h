@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "buffer_message_channel.h"
+#include "protocol_defs.h"
+#include "system_tick_hal.h"
+
+#include <string>
+#include <map>
+#include <cstdint>
+
+namespace particle {
+
+namespace protocol {
+
+namespace test {
+
+// Deterministic model of a datagram link between the device and the server
+class SimulatedLink {
+public:
+    enum Direction {
+        TO_SERVER = 0,
+        TO_DEVICE = 1
+    };
+
+    struct Stats {
+        size_t packets; // Number of packets sent, including the dropped ones
+        size_t bytes; // Number of payload bytes sent, including the dropped packets
+        size_t dropped; // Number of dropped packets
+
+        // Number of bytes on the wire, including the per-packet overhead
+        size_t wireBytes() const {
+            return bytes + packets * PACKET_OVERHEAD;
+        }
+    };
+
+    // DTLS 1.2 record header with AES-128-CCM-8 (13 + 8 + 8 bytes), UDP and IPv4 headers (28 bytes)
+    static const size_t PACKET_OVERHEAD = 57;
+
+    explicit SimulatedLink(uint32_t seed = 1);
+
+    // One-way delay
+    SimulatedLink& latency(system_tick_t ms);
+    // Maximum random delay added to the one-way delay. Packets may get reordered
+    SimulatedLink& jitter(system_tick_t ms);
+    // Packet loss rate in percent, applied independently in both directions
+    SimulatedLink& loss(unsigned percent);
+    // Link rate in bytes per second, applied independently in both directions (0 if unlimited).
+    // Packets are queued until the link is available, the per-packet overhead is accounted for
+    SimulatedLink& bandwidth(unsigned bytesPerSec);
+
+    SimulatedLink& time(system_tick_t ms);
+    system_tick_t time() const;
+
+    void send(Direction dir, const uint8_t* data, size_t size);
+    // Returns false if no packet is due for delivery at the current time
+    bool receive(Direction dir, std::string* data);
+    bool hasPending(Direction dir) const;
+
+    const Stats& stats(Direction dir) const;
+    void resetStats();
+
+private:
+    std::multimap<system_tick_t, std::string> queue_[2]; // Packets in flight ordered by the delivery time
+    Stats stats_[2];
+    uint64_t busyUntil_[2]; // Time in microseconds when the last queued packet leaves the sender
+    system_tick_t latency_;
+    system_tick_t jitter_;
+    unsigned loss_;
+    unsigned bandwidth_;
+    system_tick_t time_;
+    uint32_t rand_;
+
+    uint32_t nextRandom();
+};
+
+// Device side of a simulated link
+class SimulatedLinkChannel: public BufferMessageChannel<PROTOCOL_BUFFER_SIZE> {
+public:
+    SimulatedLinkChannel();
+
+    void link(SimulatedLink* link);
+
+    // Reimplemented from AbstractMessageChannel
+    ProtocolError send(Message& msg) override;
+    ProtocolError receive(Message& msg) override;
+    ProtocolError command(Command cmd, void* arg) override;
+    bool is_unreliable() override;
+    ProtocolError establish() override;
+    ProtocolError notify_established() override;
+    void notify_client_messages_processed() override;
+    AppStateDescriptor cached_app_state_descriptor() const override;
+    void reset() override;
+
+private:
+    SimulatedLink* link_;
+};
+
+inline SimulatedLink& SimulatedLink::latency(system_tick_t ms) {
+    latency_ = ms;
+    return *this;
+}
+
+inline SimulatedLink& SimulatedLink::jitter(system_tick_t ms) {
+    jitter_ = ms;
+    return *this;
+}
+
+inline SimulatedLink& SimulatedLink::loss(unsigned percent) {
+    loss_ = percent;
+    return *this;
+}
+
+inline SimulatedLink& SimulatedLink::bandwidth(unsigned bytesPerSec) {
+    bandwidth_ = bytesPerSec;
+    return *this;
+}
+
+inline SimulatedLink& SimulatedLink::time(system_tick_t ms) {
+    time_ = ms;
+    return *this;
+}
+
+inline system_tick_t SimulatedLink::time() const {
+    return time_;
+}
+
+inline bool SimulatedLink::hasPending(Direction dir) const {
+    return !queue_[dir].empty();
+}
+
+inline const SimulatedLink::Stats& SimulatedLink::stats(Direction dir) const {
+    return stats_[dir];
+}
+
+inline void SimulatedLink::resetStats() {
+    stats_[TO_SERVER] = Stats();
+    stats_[TO_DEVICE] = Stats();
+}
+
+inline SimulatedLinkChannel::SimulatedLinkChannel() :
+        link_(nullptr) {
+}
+
+inline void SimulatedLinkChannel::link(SimulatedLink* link) {
+    link_ = link;
+}
+
+inline ProtocolError SimulatedLinkChannel::command(Command cmd, void* arg) {
+    return ProtocolError::NO_ERROR;
+}
+
+inline bool SimulatedLinkChannel::is_unreliable() {
+    return true;
+}
+
+inline ProtocolError SimulatedLinkChannel::establish() {
+    return ProtocolError::NO_ERROR;
+}
+
+inline ProtocolError SimulatedLinkChannel::notify_established() {
+    return ProtocolError::NO_ERROR;
+}
+
+inline void SimulatedLinkChannel::notify_client_messages_processed() {
+}
+
+inline AppStateDescriptor SimulatedLinkChannel::cached_app_state_descriptor() const {
+    return AppStateDescriptor();
+}
+
+inline void SimulatedLinkChannel::reset() {
+}
+
+} // namespace test
+
+} // namespace protocol
+
+} // namespace particle
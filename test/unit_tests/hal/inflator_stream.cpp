@@ -0,0 +1,262 @@
+#include "inflator_stream.h"
+
+#include <zlib.h>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace particle;
+
+// Compressed stream backed by a string
+class MemoryInputStream: public InputStream {
+public:
+    explicit MemoryInputStream(std::string data) :
+            data_(std::move(data)),
+            offset_(0),
+            bytesRead_(0) {
+    }
+
+    int read(char* data, size_t size) override {
+        const int r = peek(data, size);
+        if (r < 0) {
+            return r;
+        }
+        return skip(r);
+    }
+
+    int peek(char* data, size_t size) override {
+        if (offset_ == data_.size()) {
+            return SYSTEM_ERROR_END_OF_STREAM;
+        }
+        size = std::min(size, data_.size() - offset_);
+        memcpy(data, data_.data() + offset_, size);
+        return size;
+    }
+
+    int skip(size_t size) override {
+        if (offset_ == data_.size()) {
+            return SYSTEM_ERROR_END_OF_STREAM;
+        }
+        size = std::min(size, data_.size() - offset_);
+        offset_ += size;
+        bytesRead_ += size;
+        return size;
+    }
+
+    int seek(size_t offset) override {
+        if (offset > data_.size()) {
+            return SYSTEM_ERROR_NOT_ENOUGH_DATA;
+        }
+        offset_ = offset;
+        return offset_;
+    }
+
+    int availForRead() override {
+        return data_.size() - offset_;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        if (!flags) {
+            return 0;
+        }
+        if (offset_ == data_.size()) {
+            return SYSTEM_ERROR_END_OF_STREAM;
+        }
+        return InputStream::READABLE;
+    }
+
+    // Number of compressed bytes fed to the decompressor
+    size_t bytesRead() const {
+        return bytesRead_;
+    }
+
+private:
+    std::string data_;
+    size_t offset_;
+    size_t bytesRead_;
+};
+
+// Compresses the data into a raw Deflate stream made of independently decompressible segments
+std::string deflateSegments(const std::string& data, size_t segmentSize, std::vector<uint32_t>* offsets) {
+    z_stream strm = {};
+    REQUIRE(deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, -15 /* Raw Deflate */, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    std::string out;
+    char buf[4096];
+    size_t pos = 0;
+    do {
+        offsets->push_back(out.size());
+        const size_t n = std::min(segmentSize, data.size() - pos);
+        strm.next_in = (Bytef*)data.data() + pos;
+        strm.avail_in = n;
+        pos += n;
+        const int flush = (pos == data.size()) ? Z_FINISH : Z_FULL_FLUSH;
+        do {
+            strm.next_out = (Bytef*)buf;
+            strm.avail_out = sizeof(buf);
+            const int r = deflate(&strm, flush);
+            REQUIRE((r == Z_OK || r == Z_STREAM_END || r == Z_BUF_ERROR));
+            out.append(buf, sizeof(buf) - strm.avail_out);
+        } while (strm.avail_out == 0);
+    } while (pos < data.size());
+    deflateEnd(&strm);
+    return out;
+}
+
+std::string genCompressibleData(size_t size) {
+    static thread_local std::default_random_engine gen(12345);
+    std::uniform_int_distribution<unsigned> word(0, 63);
+    std::string d;
+    d.reserve(size + 16);
+    while (d.size() < size) {
+        d += "token" + std::to_string(word(gen)) + ' ';
+    }
+    d.resize(size);
+    return d;
+}
+
+class CompressedAsset {
+public:
+    CompressedAsset(std::string data, size_t segmentSize) :
+            data_(std::move(data)),
+            offsets_(),
+            compressed_(deflateSegments(data_, segmentSize, &offsets_)),
+            segmentSize_(segmentSize) {
+    }
+
+    const std::string& data() const {
+        return data_;
+    }
+
+    const std::string& compressed() const {
+        return compressed_;
+    }
+
+    const std::vector<uint32_t>& offsets() const {
+        return offsets_;
+    }
+
+    size_t segmentSize() const {
+        return segmentSize_;
+    }
+
+private:
+    std::string data_;
+    std::vector<uint32_t> offsets_;
+    std::string compressed_;
+    size_t segmentSize_;
+};
+
+// Reads `size` bytes at `offset` the way a consumer without the index has to: streams can only be
+// decompressed forward, so a backward seek starts over from the beginning
+std::string readAt(InflatorStream& strm, size_t offset, size_t size, bool indexed) {
+    if (strm.seek(offset) < 0) {
+        REQUIRE_FALSE(indexed);
+        REQUIRE(strm.seek(0) == 0);
+        REQUIRE(strm.seek(offset) >= 0);
+    }
+    std::string s(size, '\0');
+    REQUIRE(strm.readAll(&s[0], size) == (int)size);
+    return s;
+}
+
+// Statistics of a series of random reads from a compressed asset
+struct RandomReadStats {
+    size_t bytesRead; // Number of compressed bytes read
+    double usPerRead; // Average time of a read in microseconds
+};
+
+RandomReadStats readRandomly(const CompressedAsset& asset, size_t readCount, size_t readSize, bool indexed) {
+    std::default_random_engine gen(1);
+    std::uniform_int_distribution<size_t> dist(0, asset.data().size() - readSize);
+    MemoryInputStream src(asset.compressed());
+    InflatorStream strm(&src, asset.data().size());
+    REQUIRE(strm.init() == 0);
+    if (indexed) {
+        REQUIRE(strm.setRestartIndex(asset.offsets().data(), asset.offsets().size(), asset.segmentSize()) == 0);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < readCount; ++i) {
+        const size_t offs = dist(gen);
+        REQUIRE(readAt(strm, offs, readSize, indexed) == asset.data().substr(offs, readSize));
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+    return { src.bytesRead(), std::chrono::duration<double, std::micro>(t2 - t1).count() / readCount };
+}
+
+} // namespace
+
+TEST_CASE("InflatorStream") {
+    const size_t SEGMENT_SIZE = 4096;
+    CompressedAsset asset(genCompressibleData(100000), SEGMENT_SIZE);
+    MemoryInputStream src(asset.compressed());
+    InflatorStream strm(&src, asset.data().size());
+    REQUIRE(strm.init() == 0);
+
+    SECTION("decompresses a segmented stream without the index") {
+        std::string out(asset.data().size(), '\0');
+        CHECK(strm.readAll(&out[0], out.size()) == (int)out.size());
+        CHECK(out == asset.data());
+    }
+
+    SECTION("validates the restart point index") {
+        const auto& offs = asset.offsets();
+        CHECK(strm.setRestartIndex(offs.data(), offs.size(), SEGMENT_SIZE / 2) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(strm.setRestartIndex(offs.data(), offs.size() - 1, SEGMENT_SIZE) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(strm.setRestartIndex(offs.data() + 1, offs.size() - 1, SEGMENT_SIZE) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(strm.setRestartIndex(offs.data(), offs.size(), SEGMENT_SIZE) == 0);
+    }
+
+    SECTION("seeks backward and forward across segments with the index") {
+        REQUIRE(strm.setRestartIndex(asset.offsets().data(), asset.offsets().size(), SEGMENT_SIZE) == 0);
+        const size_t offsets[] = { 90000, 10, 50000, 49990, 4095, 4096, 99990, 0, 8191 };
+        for (auto offs: offsets) {
+            CHECK(readAt(strm, offs, 10, true) == asset.data().substr(offs, 10));
+        }
+        // Seeking to the end of the data
+        CHECK(strm.seek(asset.data().size()) == (int)asset.data().size());
+        char c = 0;
+        CHECK(strm.read(&c, 1) == SYSTEM_ERROR_END_OF_STREAM);
+    }
+
+    SECTION("decompresses at most one segment per seek with the index") {
+        REQUIRE(strm.setRestartIndex(asset.offsets().data(), asset.offsets().size(), SEGMENT_SIZE) == 0);
+        readAt(strm, 90000, 10, true);
+        const size_t n = src.bytesRead();
+        readAt(strm, 10, 10, true);
+        // Restarting at the first segment doesn't read past its end
+        CHECK(src.bytesRead() - n <= asset.offsets()[1]);
+    }
+}
+
+TEST_CASE("InflatorStream random reads") {
+    const size_t READ_COUNT = 50;
+    const size_t READ_SIZE = 64;
+    for (size_t size: { 64 * 1024, 256 * 1024 }) {
+        CompressedAsset asset(genCompressibleData(size), 4096 /* segmentSize */);
+        const auto sequential = readRandomly(asset, READ_COUNT, READ_SIZE, false /* indexed */);
+        const auto indexed = readRandomly(asset, READ_COUNT, READ_SIZE, true /* indexed */);
+        // Each read decompresses at most one segment
+        CHECK(indexed.bytesRead <= READ_COUNT * asset.compressed().size() / asset.offsets().size() * 2);
+        CHECK(indexed.bytesRead < sequential.bytesRead);
+    }
+}
+
+TEST_CASE("InflatorStream random read benchmark", "[.benchmark]") {
+    const size_t READ_COUNT = 200;
+    const size_t READ_SIZE = 64;
+    for (size_t size: { 64 * 1024, 256 * 1024, 1024 * 1024 }) {
+        CompressedAsset asset(genCompressibleData(size), 4096 /* segmentSize */);
+        const auto sequential = readRandomly(asset, READ_COUNT, READ_SIZE, false /* indexed */);
+        const auto indexed = readRandomly(asset, READ_COUNT, READ_SIZE, true /* indexed */);
+        std::cout << "[ BENCH ] InflatorStream, " << READ_COUNT << " random reads from a " << size << " byte asset: " <<
+                "sequential " << sequential.bytesRead / READ_COUNT << " compressed bytes and " << (uint64_t)sequential.usPerRead << " us per read; " <<
+                "indexed " << indexed.bytesRead / READ_COUNT << " compressed bytes and " << (uint64_t)indexed.usPerRead << " us per read" << std::endl;
+    }
+}
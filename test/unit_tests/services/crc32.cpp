@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "crc32.h"
+
+#include <cstdint>
+#include "softcrc32.h"
+
+#include "mbedtls/sha256.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace particle;
+
+namespace {
+
+std::vector<uint8_t> genRandomData(size_t size) {
+    std::mt19937 gen(size);
+    std::uniform_int_distribution<unsigned> dist(0, 255);
+    std::vector<uint8_t> data(size);
+    for (auto& b: data) {
+        b = dist(gen);
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("computeCrc32()") {
+    SECTION("computes the CRC of known test vectors") {
+        CHECK(computeCrc32("", 0) == 0);
+        CHECK(computeCrc32("123456789", 9) == 0xcbf43926);
+        CHECK(computeCrc32("The quick brown fox jumps over the lazy dog", 43) == 0x414fa339);
+    }
+
+    SECTION("produces the same result as softCrc32() for any size and alignment") {
+        const auto data = genRandomData(1024 + 16);
+        for (size_t offs = 0; offs < 8; ++offs) {
+            const auto p = data.data() + offs;
+            for (size_t size = 0; size <= 1024; ++size) {
+                const auto crc = computeCrc32(p, size);
+                if (crc != softCrc32(p, size, nullptr)) {
+                    CAPTURE(offs);
+                    CAPTURE(size);
+                    FAIL("CRC mismatch");
+                }
+            }
+        }
+    }
+
+    SECTION("can be computed incrementally") {
+        const auto data = genRandomData(4096);
+        const uint32_t expected = computeCrc32(data.data(), data.size());
+        for (size_t chunkSize: { 1, 5, 8, 100, 1024 }) {
+            uint32_t crc = 0;
+            for (size_t offs = 0; offs < data.size(); offs += chunkSize) {
+                crc = computeCrc32(data.data() + offs, std::min(chunkSize, data.size() - offs), crc);
+            }
+            CHECK(crc == expected);
+        }
+    }
+}
+
+TEST_CASE("computeCrc32() throughput", "[.benchmark]") {
+    // Roughly the size of a system part
+    const size_t size = 1024 * 1024;
+    const unsigned rounds = 8;
+    const auto data = genRandomData(size);
+    double mbPerSec[2] = {};
+    volatile uint32_t crc = 0;
+    for (int sliced = 0; sliced < 2; ++sliced) {
+        const auto t1 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < rounds; ++i) {
+            crc = sliced ? computeCrc32(data.data(), size) : softCrc32(data.data(), size, nullptr);
+        }
+        const auto t2 = std::chrono::steady_clock::now();
+        mbPerSec[sliced] = (double)size * rounds / (1024 * 1024) / std::chrono::duration<double>(t2 - t1).count();
+    }
+    std::cout << "[ BENCH ] CRC-32 of a " << size << " byte buffer: " << (uint64_t)mbPerSec[0] << " MB/s byte-wise, " <<
+            (uint64_t)mbPerSec[1] << " MB/s slicing-by-8" << std::endl;
+}
+
+TEST_CASE("SHA-256 throughput", "[.benchmark]") {
+    const size_t size = 1024 * 1024;
+    const unsigned rounds = 8;
+    const auto data = genRandomData(size);
+    unsigned char hash[32] = {};
+    const auto t1 = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rounds; ++i) {
+        REQUIRE(mbedtls_sha256_ret(data.data(), size, hash, 0 /* is224 */) == 0);
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+    const double mbPerSec = (double)size * rounds / (1024 * 1024) / std::chrono::duration<double>(t2 - t1).count();
+    std::cout << "[ BENCH ] SHA-256 of a " << size << " byte buffer: " << (uint64_t)mbPerSec << " MB/s" << std::endl;
+}
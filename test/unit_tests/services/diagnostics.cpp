@@ -3,6 +3,8 @@
 #include "util/catch.h"
 
 #include <functional>
+#include <thread>
+#include <vector>
 #include <unordered_set>
 #include <cassert>
 
@@ -666,4 +668,80 @@ TEST_CASE("Wiring API") {
         testPersistentEnumDiagnosticData<PersistentEnumDiagnosticData, NoConcurrency>(diag);
         // testPersistentEnumDiagnosticData<PersistentEnumDiagnosticData, AtomicConcurrency>(diag);
     }
+
+    SECTION("HistogramDiagnosticData") {
+        HistogramDiagnosticData d(1, "hist");
+        diag.start();
+
+        SECTION("is empty after construction") {
+            diag_histogram h = {};
+            REQUIRE(AbstractHistogramDiagnosticData::get(1, h) == 0);
+            CHECK(h.count == 0);
+            CHECK(h.sum == 0);
+            CHECK(h.min == 0);
+            CHECK(h.max == 0);
+            for (auto b: h.buckets) {
+                CHECK(b == 0);
+            }
+        }
+
+        SECTION("uses logarithmic buckets") {
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(0) == 0);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(1) == 1);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(2) == 2);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(3) == 2);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(4) == 3);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(1023) == 10);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(1024) == 11);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(UINT32_MAX) == DIAG_HISTOGRAM_BUCKET_COUNT - 1);
+        }
+
+        SECTION("records samples") {
+            d.record(5);
+            d.record(0);
+            d.record(100);
+            d.record(6);
+            diag_histogram h = {};
+            REQUIRE(AbstractHistogramDiagnosticData::get(1, h) == 0);
+            CHECK(h.count == 4);
+            CHECK(h.sum == 111);
+            CHECK(h.min == 0);
+            CHECK(h.max == 100);
+            CHECK(h.buckets[0] == 1);
+            CHECK(h.buckets[3] == 2);
+            CHECK(h.buckets[7] == 1);
+        }
+
+        SECTION("reset() discards all samples") {
+            d.record(10);
+            d.reset();
+            d.record(20);
+            diag_histogram h = {};
+            REQUIRE(AbstractHistogramDiagnosticData::get(1, h) == 0);
+            CHECK(h.count == 1);
+            CHECK(h.min == 20);
+            CHECK(h.max == 20);
+        }
+
+        SECTION("can be updated concurrently") {
+            const unsigned threadCount = 4;
+            const unsigned sampleCount = 10000;
+            std::vector<std::thread> threads;
+            for (unsigned i = 0; i < threadCount; ++i) {
+                threads.emplace_back([&d, i]() {
+                    for (unsigned j = 1; j <= sampleCount; ++j) {
+                        d.record(j * (i + 1));
+                    }
+                });
+            }
+            for (auto& t: threads) {
+                t.join();
+            }
+            diag_histogram h = {};
+            REQUIRE(AbstractHistogramDiagnosticData::get(1, h) == 0);
+            CHECK(h.count == threadCount * sampleCount);
+            CHECK(h.min == 1);
+            CHECK(h.max == threadCount * sampleCount);
+        }
+    }
 }
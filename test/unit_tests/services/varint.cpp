@@ -164,6 +164,13 @@ TEST_CASE("decodeUnsignedVarint()") {
             CHECK(r == 2);
             CHECK(v == 255);
         }
+        {
+            uint16_t v = 0;
+            char buf[] = "\x80\x02"; // 256
+            auto r = decodeUnsignedVarint(buf, sizeof(buf), &v);
+            CHECK(r == 2);
+            CHECK(v == 256);
+        }
         {
             uint16_t v = 0;
             char buf[] = "\xac\x02"; // 300
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "control/diagnostics.h"
+
+#include "spark_wiring_diagnostics.h"
+#include "spark_wiring_json.h"
+
+#include "mock/control.h"
+
+#include <hippomocks.h>
+
+#include "util/catch.h"
+
+#include <string>
+
+using namespace particle;
+using spark::JSONValue;
+
+namespace {
+
+class DiagService {
+public:
+    DiagService() {
+        REQUIRE(diag_command(DIAG_SERVICE_CMD_RESET, nullptr, nullptr) == 0);
+    }
+
+    ~DiagService() {
+        diag_command(DIAG_SERVICE_CMD_RESET, nullptr, nullptr);
+    }
+
+    void start() {
+        REQUIRE(diag_command(DIAG_SERVICE_CMD_START, nullptr, nullptr) == 0);
+    }
+};
+
+std::string sourceIds(std::initializer_list<uint16_t> ids) {
+    std::string s;
+    for (auto id: ids) {
+        s.append((const char*)&id, sizeof(id));
+    }
+    return s;
+}
+
+JSONValue getSource(const JSONValue& doc, const char* name) {
+    spark::JSONObjectIterator it(doc);
+    while (it.next()) {
+        if (it.name() == name) {
+            return it.value();
+        }
+    }
+    return JSONValue();
+}
+
+} // namespace
+
+TEST_CASE("CTRL_REQUEST_DIAGNOSTIC_INFO") {
+    DiagService diag;
+    HistogramDiagnosticData loopTime(DIAG_ID_APP_LOOP_TIME_HISTOGRAM, DIAG_NAME_APP_LOOP_TIME_HISTOGRAM);
+    SimpleUnsignedIntegerDiagnosticData stallMax(DIAG_ID_SYSTEM_LOOP_MAX_STALL, DIAG_NAME_SYSTEM_LOOP_MAX_STALL);
+    diag.start();
+    loopTime.record(3);
+    loopTime.record(100);
+    stallMax = 42;
+
+    MockRepository mocks;
+    test::SystemControl ctrl(&mocks);
+
+    SECTION("reads a histogram by its ID") {
+        auto req = ctrl.makeRequest(CTRL_REQUEST_DIAGNOSTIC_INFO, sourceIds({ DIAG_ID_APP_LOOP_TIME_HISTOGRAM }));
+        REQUIRE(ctrl::diagnostics::getDiagnosticInfo(req.get()) == 0);
+        const auto doc = JSONValue::parseCopy(req->replyData().data(), req->replyData().size());
+        REQUIRE(doc.isObject());
+        CHECK_FALSE(getSource(doc, DIAG_NAME_SYSTEM_LOOP_MAX_STALL).isValid());
+        const auto hist = getSource(doc, DIAG_NAME_APP_LOOP_TIME_HISTOGRAM);
+        REQUIRE(hist.isObject());
+        CHECK(getSource(hist, "n").toInt() == 2);
+        CHECK(getSource(hist, "sum").toInt() == 103);
+        CHECK(getSource(hist, "min").toInt() == 3);
+        CHECK(getSource(hist, "max").toInt() == 100);
+        const auto buckets = getSource(hist, "b");
+        REQUIRE(buckets.isArray());
+        spark::JSONArrayIterator it(buckets);
+        unsigned count = 0;
+        for (unsigned i = 0; it.next(); ++i) {
+            const unsigned n = it.value().toInt();
+            if (i == AbstractHistogramDiagnosticData::bucketIndex(3) || i == AbstractHistogramDiagnosticData::bucketIndex(100)) {
+                CHECK(n == 1);
+            } else {
+                CHECK(n == 0);
+            }
+            count += n;
+        }
+        CHECK(count == 2);
+    }
+
+    SECTION("reads all the data sources including the histograms") {
+        auto req = ctrl.makeRequest(CTRL_REQUEST_DIAGNOSTIC_INFO);
+        REQUIRE(ctrl::diagnostics::getDiagnosticInfo(req.get()) == 0);
+        const auto doc = JSONValue::parseCopy(req->replyData().data(), req->replyData().size());
+        CHECK(getSource(doc, DIAG_NAME_SYSTEM_LOOP_MAX_STALL).toInt() == 42);
+        CHECK(getSource(getSource(doc, DIAG_NAME_APP_LOOP_TIME_HISTOGRAM), "n").toInt() == 2);
+    }
+
+    SECTION("rejects request data that is not an array of 16-bit IDs") {
+        auto req = ctrl.makeRequest(CTRL_REQUEST_DIAGNOSTIC_INFO, std::string(3, '\0'));
+        CHECK(ctrl::diagnostics::getDiagnosticInfo(req.get()) == SYSTEM_ERROR_INVALID_ARGUMENT);
+    }
+
+    SECTION("fails if a data source doesn't exist") {
+        auto req = ctrl.makeRequest(CTRL_REQUEST_DIAGNOSTIC_INFO, sourceIds({ DIAG_ID_APP_LOOP_STALL_HISTOGRAM }));
+        CHECK(ctrl::diagnostics::getDiagnosticInfo(req.get()) != 0);
+        CHECK_FALSE(req->hasReplyData());
+    }
+}
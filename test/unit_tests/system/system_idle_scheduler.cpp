@@ -0,0 +1,76 @@
+#include "system_idle_scheduler.h"
+
+#include "util/catch.h"
+
+using namespace particle;
+using namespace particle::system;
+
+TEST_CASE("IdleScheduler") {
+    IdleScheduler sched;
+    system_tick_t now = 0;
+
+    SECTION("blocks for the maximum timeout when no subsystem needs polling") {
+        sched.begin(now);
+        CHECK(sched.timeout(now) == IdleScheduler::DEFAULT_MAX_TIMEOUT);
+        CHECK(sched.timeout(now + 300) == IdleScheduler::DEFAULT_MAX_TIMEOUT - 300);
+        CHECK(sched.timeout(now + 5000) == 0);
+    }
+
+    SECTION("blocks until the earliest deadline") {
+        sched.begin(now);
+        sched.schedule(500);
+        sched.schedule(20);
+        sched.schedule(200);
+        CHECK(sched.timeout(now) == 20);
+        // Deadlines are reset on every pass
+        sched.begin(now);
+        CHECK(sched.timeout(now) == IdleScheduler::DEFAULT_MAX_TIMEOUT);
+    }
+
+    SECTION("handles the clock wrapping around") {
+        now = (system_tick_t)-50;
+        sched.begin(now);
+        sched.schedule(200);
+        CHECK(sched.timeout(now + 100) == 100);
+        CHECK(sched.timeout(now + 250) == 0);
+    }
+
+    SECTION("doesn't block while an event is pending") {
+        sched.begin(now);
+        CHECK(sched.notify());
+        CHECK(sched.timeout(now) == 0);
+        // The event is handled by the next pass
+        sched.begin(now);
+        CHECK(sched.timeout(now) == IdleScheduler::DEFAULT_MAX_TIMEOUT);
+    }
+
+    SECTION("requests a wakeup only for the first of the pending events") {
+        sched.begin(now);
+        CHECK(sched.notify());
+        CHECK_FALSE(sched.notify());
+        CHECK_FALSE(sched.notify());
+        sched.begin(now);
+        CHECK(sched.notify());
+    }
+
+    SECTION("accounts the time spent in each subsystem") {
+        sched.addTime(IdleScheduler::NETWORK, 1500);
+        sched.addTime(IdleScheduler::CLOUD, 4000000000u);
+        sched.addTime(IdleScheduler::CLOUD, 4000000000u);
+        sched.addTime(IdleScheduler::NETWORK, 500);
+        CHECK(sched.time(IdleScheduler::NETWORK) == 2000);
+        CHECK(sched.time(IdleScheduler::CLOUD) == 8000000000ull);
+        CHECK(sched.time(IdleScheduler::SETUP) == 0);
+        CHECK(sched.time(IdleScheduler::OTHER) == 0);
+    }
+
+    SECTION("tracks the subsystem that caused the longest stall") {
+        CHECK(sched.maxTime() == 0);
+        sched.addTime(IdleScheduler::NETWORK, 1500);
+        sched.addTime(IdleScheduler::SETUP, 20000);
+        sched.addTime(IdleScheduler::CLOUD, 8000);
+        sched.addTime(IdleScheduler::SETUP, 100);
+        CHECK(sched.maxTime() == 20000);
+        CHECK(sched.maxTimeSubsystem() == IdleScheduler::SETUP);
+    }
+}
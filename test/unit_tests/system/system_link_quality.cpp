@@ -0,0 +1,160 @@
+#include "system_link_quality.h"
+
+#include "util/catch.h"
+
+namespace {
+
+using namespace particle::system;
+
+const unsigned WIFI = 5;
+const unsigned CELLULAR = 4;
+
+// Sampling period of the passive estimate and the probing period of the standby interfaces
+const system_tick_t SAMPLE_PERIOD = 2000;
+const system_tick_t PROBE_PERIOD = 60000;
+
+// Period of the reachability test before the passive estimate was introduced
+const system_tick_t LEGACY_CHECK_PERIOD = 5 * 60 * 1000;
+
+// Models a link that delivers a given fraction of the messages with a fixed round-trip time
+struct Link {
+    system_tick_t roundTrip;
+    unsigned loss; // Per mille
+
+    void exchange(LinkQuality* q, system_tick_t now, unsigned count) const {
+        const unsigned lost = count * loss / LinkQuality::LOSS_SCALE;
+        q->update(now, count - lost, lost, roundTrip);
+    }
+};
+
+// Runs the cloud connection over a good Wi-Fi link for 10 minutes, then makes Wi-Fi drop half of
+// the messages and returns the time it takes the monitor to suggest moving to cellular
+system_tick_t timeToFailover(LinkQualityMonitor& mon) {
+    // The cloud connection runs over Wi-Fi and exchanges a CoAP message per second. Cellular is
+    // on standby and probed with a few packets every minute
+    const uint32_t ready = (1 << WIFI) | (1 << CELLULAR);
+    const Link wifi = { 50, 0 };
+    const Link cellular = { 300, 0 };
+    system_tick_t now = 0;
+    for (; now < 10 * 60 * 1000; now += SAMPLE_PERIOD) {
+        wifi.exchange(mon.link(WIFI), now, SAMPLE_PERIOD / 1000);
+        if (now % PROBE_PERIOD == 0) {
+            cellular.exchange(mon.link(CELLULAR), now, 3);
+        }
+    }
+    REQUIRE(mon.failoverTarget(WIFI, ready, now) < 0);
+    // Wi-Fi starts dropping half of the messages
+    const Link degraded = { 50, 500 };
+    const auto start = now;
+    for (; mon.failoverTarget(WIFI, ready, now) < 0; now += SAMPLE_PERIOD) {
+        REQUIRE(now - start < LEGACY_CHECK_PERIOD);
+        degraded.exchange(mon.link(WIFI), now, SAMPLE_PERIOD / 1000);
+        if (now % PROBE_PERIOD == 0) {
+            cellular.exchange(mon.link(CELLULAR), now, 3);
+        }
+    }
+    return now - start;
+}
+
+} // namespace
+
+TEST_CASE("LinkQuality") {
+    LinkQuality q;
+
+    SECTION("has no score until a round trip is observed") {
+        CHECK_FALSE(q.valid());
+        CHECK(q.score() == LinkQuality::INVALID_SCORE);
+        q.update(1000, 0, 3, 0);
+        CHECK_FALSE(q.valid());
+        CHECK(q.loss() == LinkQuality::LOSS_SCALE);
+        CHECK(q.score() == LinkQuality::INVALID_SCORE);
+        q.update(2000, 1, 0, 100);
+        CHECK(q.valid());
+        CHECK(q.lastUpdate() == 2000);
+        CHECK(q.windows() == 2);
+    }
+
+    SECTION("smooths the round-trip time") {
+        q.update(0, 1, 0, 100);
+        CHECK(q.roundTrip() == 100);
+        CHECK(q.roundTripVar() == 50);
+        q.update(0, 1, 0, 180);
+        CHECK(q.roundTrip() == 110);
+        CHECK(q.roundTripVar() == 57);
+        for (int i = 0; i < 100; ++i) {
+            q.update(0, 1, 0, 180);
+        }
+        CHECK(q.roundTrip() >= 175);
+        CHECK(q.roundTripVar() <= 5);
+    }
+
+    SECTION("scales the score up with the loss rate") {
+        for (int i = 0; i < 100; ++i) {
+            q.update(0, 10, 0, 100);
+        }
+        const auto lossless = q.score();
+        CHECK(lossless >= 100);
+        CHECK(lossless <= 110);
+        CHECK_FALSE(q.degraded());
+        for (int i = 0; i < 10; ++i) {
+            q.update(0, 5, 5, 100);
+        }
+        CHECK(q.degraded());
+        CHECK(q.score() > lossless * 3 / 2);
+        q.reset();
+        CHECK_FALSE(q.valid());
+        CHECK(q.windows() == 0);
+    }
+}
+
+TEST_CASE("LinkQualityMonitor") {
+    LinkQualityMonitor mon;
+    const uint32_t ready = (1 << WIFI) | (1 << CELLULAR);
+    const Link wifi = { 50, 0 };
+    const Link cellular = { 300, 0 };
+
+    SECTION("stays on a link that has too few observations") {
+        cellular.exchange(mon.link(CELLULAR), 0, 3);
+        Link { 50, 1000 }.exchange(mon.link(WIFI), 0, 3);
+        CHECK(mon.failoverTarget(WIFI, ready, 0) < 0);
+    }
+
+    SECTION("moves away from a lossy link") {
+        cellular.exchange(mon.link(CELLULAR), 0, 3);
+        for (int i = 0; i < 5; ++i) {
+            wifi.exchange(mon.link(WIFI), 0, 2);
+        }
+        CHECK(mon.failoverTarget(WIFI, ready, 0) < 0);
+        for (int i = 0; i < 5; ++i) {
+            Link { 50, 1000 }.exchange(mon.link(WIFI), 0, 2);
+        }
+        CHECK(mon.failoverTarget(WIFI, ready, 0) == (int)CELLULAR);
+        // Only to a ready interface
+        CHECK(mon.failoverTarget(WIFI, 1 << WIFI, 0) < 0);
+    }
+
+    SECTION("moves to a faster link only by a margin") {
+        for (int i = 0; i < 5; ++i) {
+            Link { 70, 0 }.exchange(mon.link(CELLULAR), 0, 2);
+            wifi.exchange(mon.link(WIFI), 0, 2);
+        }
+        CHECK(mon.failoverTarget(CELLULAR, ready, 0) < 0);
+        for (int i = 0; i < 20; ++i) {
+            cellular.exchange(mon.link(CELLULAR), 0, 2);
+        }
+        CHECK(mon.failoverTarget(CELLULAR, ready, 0) == (int)WIFI);
+    }
+
+    SECTION("ignores stale estimates") {
+        cellular.exchange(mon.link(CELLULAR), 0, 3);
+        for (int i = 0; i < 5; ++i) {
+            Link { 50, 1000 }.exchange(mon.link(WIFI), LinkQualityMonitor::MAX_AGE + 1, 2);
+        }
+        CHECK(mon.score(CELLULAR, LinkQualityMonitor::MAX_AGE + 1) == LinkQuality::INVALID_SCORE);
+        CHECK(mon.failoverTarget(WIFI, ready, LinkQualityMonitor::MAX_AGE + 1) < 0);
+    }
+
+    SECTION("fails over from a degraded link within 30 seconds") {
+        CHECK(timeToFailover(mon) <= 30000);
+    }
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_idle_events.h"
+#include "system_idle_scheduler.h"
+#include "system_task.h"
+#include "system_cloud.h"
+#include "system_cloud_internal.h"
+#include "system_mode.h"
+#include "system_network.h"
+#include "system_network_internal.h"
+#include "system_update.h"
+#include "system_threading.h"
+#include "firmware_update.h"
+#include "timer_hal.h"
+#include "diagnostics.h"
+#include "spark_wiring_diagnostics.h"
+
+#include "util/catch.h"
+
+using namespace particle;
+using namespace particle::system;
+
+namespace {
+
+// Time it takes each subsystem to be polled, in milliseconds
+const system_tick_t POLL_TIME = 1;
+
+system_tick_t g_millis = 0;
+
+// State of the subsystems that the system loop manages
+struct Subsystems {
+    bool networkConnecting = false;
+    bool cloudWanted = false;
+    bool cloudBusy = false;
+    unsigned networkPolls = 0;
+    unsigned cloudPolls = 0;
+} g_state;
+
+} // namespace
+
+// Fake clock
+system_tick_t HAL_Timer_Get_Milli_Seconds() {
+    return g_millis;
+}
+
+system_tick_t HAL_Timer_Get_Micro_Seconds() {
+    return g_millis * 1000;
+}
+
+// Collaborators of the system loop
+volatile uint8_t SPARK_WLAN_RESET = 0;
+volatile uint8_t SPARK_CLOUD_SOCKETED = 0;
+volatile uint8_t SPARK_CLOUD_CONNECTED = 0;
+volatile uint8_t SPARK_FLASH_UPDATE = 0;
+volatile uint8_t SYSTEM_POWEROFF = 0;
+volatile system_tick_t spark_loop_total_millis = 0;
+
+namespace particle {
+
+ISRTaskQueue SystemISRTaskQueue(system_loop_wakeup);
+
+namespace system {
+
+FirmwareUpdate::FirmwareUpdate() :
+        lastActiveTime_(0),
+        updating_(false),
+        ledOverridden_(false) {
+}
+
+void FirmwareUpdate::process() {
+}
+
+FirmwareUpdate* FirmwareUpdate::instance() {
+    static FirmwareUpdate instance;
+    return &instance;
+}
+
+} // namespace system
+
+} // namespace particle
+
+void manage_network_connection() {
+    ++g_state.networkPolls;
+    g_millis += POLL_TIME;
+}
+
+void manage_smart_config() {
+}
+
+void manage_ip_config() {
+}
+
+void manage_cloud_connection(bool force_events) {
+    ++g_state.cloudPolls;
+    g_millis += POLL_TIME;
+}
+
+void manage_listening_mode_flag() {
+}
+
+bool network_connecting(network_handle_t network, uint32_t param1, void* reserved) {
+    return g_state.networkConnecting;
+}
+
+bool network_listening(network_handle_t network, uint32_t param1, void* reserved) {
+    return false;
+}
+
+bool spark_cloud_flag_auto_connect() {
+    return g_state.cloudWanted;
+}
+
+bool Spark_Communication_Busy() {
+    return g_state.cloudBusy;
+}
+
+System_Mode_TypeDef system_mode() {
+    return AUTOMATIC;
+}
+
+spark::feature::State system_thread_get_state(void*) {
+    return spark::feature::ENABLED;
+}
+
+void system_pending_shutdown(System_Reset_Reason reason) {
+}
+
+void system_shutdown_if_needed() {
+}
+
+namespace {
+
+// Runs the idle system thread for `duration` milliseconds of the fake clock. Between the passes
+// of the loop the thread blocks for as long as the loop asks it to
+void runSystemThread(system_tick_t duration) {
+    const auto start = g_millis;
+    while (g_millis - start < duration) {
+        g_millis += runIdleEvents();
+    }
+}
+
+unsigned getDiag(uint16_t id) {
+    AbstractUnsignedIntegerDiagnosticData::IntType val = 0;
+    REQUIRE(AbstractUnsignedIntegerDiagnosticData::get(id, val) == 0);
+    return val;
+}
+
+class SystemLoopTest {
+public:
+    SystemLoopTest() {
+        // The diagnostic sources of the loop register themselves during static initialization
+        REQUIRE(diag_command(DIAG_SERVICE_CMD_START, nullptr, nullptr) == 0);
+        g_state = Subsystems();
+        SPARK_CLOUD_SOCKETED = 0;
+        SPARK_CLOUD_CONNECTED = 0;
+        // Let any previous test's deadline expire
+        runSystemThread(IdleScheduler::DEFAULT_MAX_TIMEOUT);
+        wakeups_ = IdleScheduler::instance()->wakeups();
+        wakeupsDiag_ = getDiag(DIAG_ID_SYSTEM_LOOP_WAKEUPS);
+        networkTimeDiag_ = getDiag(DIAG_ID_SYSTEM_LOOP_NETWORK_TIME);
+        cloudTimeDiag_ = getDiag(DIAG_ID_SYSTEM_LOOP_CLOUD_TIME);
+    }
+
+    unsigned wakeups() const {
+        return IdleScheduler::instance()->wakeups() - wakeups_;
+    }
+
+    unsigned wakeupsDiag() const {
+        return getDiag(DIAG_ID_SYSTEM_LOOP_WAKEUPS) - wakeupsDiag_;
+    }
+
+    unsigned networkTimeDiag() const {
+        return getDiag(DIAG_ID_SYSTEM_LOOP_NETWORK_TIME) - networkTimeDiag_;
+    }
+
+    unsigned cloudTimeDiag() const {
+        return getDiag(DIAG_ID_SYSTEM_LOOP_CLOUD_TIME) - cloudTimeDiag_;
+    }
+
+private:
+    unsigned wakeups_;
+    unsigned wakeupsDiag_;
+    unsigned networkTimeDiag_;
+    unsigned cloudTimeDiag_;
+};
+
+} // namespace
+
+TEST_CASE("System loop") {
+    SystemLoopTest test;
+
+    SECTION("wakes up once per idle second when the cloud is not wanted") {
+        g_state.networkPolls = 0;
+        runSystemThread(1000);
+        CHECK(test.wakeups() == 1);
+        CHECK(test.wakeupsDiag() == 1);
+        CHECK(g_state.networkPolls == 1);
+        CHECK(test.networkTimeDiag() == POLL_TIME);
+    }
+
+    SECTION("wakes up once per idle second while the cloud is connected and idle") {
+        g_state.cloudWanted = true;
+        SPARK_CLOUD_SOCKETED = 1;
+        SPARK_CLOUD_CONNECTED = 1;
+        runSystemThread(1000);
+        CHECK(test.wakeups() == 1);
+        CHECK(test.wakeupsDiag() == 1);
+        CHECK(test.cloudTimeDiag() == POLL_TIME);
+    }
+
+    SECTION("polls the cloud while an exchange is in progress") {
+        g_state.cloudWanted = true;
+        SPARK_CLOUD_SOCKETED = 1;
+        SPARK_CLOUD_CONNECTED = 1;
+        g_state.cloudBusy = true;
+        runSystemThread(1000);
+        const unsigned passes = 1000 / IdleScheduler::ACTIVE_POLL_PERIOD;
+        CHECK(test.wakeups() == passes);
+        CHECK(test.wakeupsDiag() == passes);
+        CHECK(test.cloudTimeDiag() == passes * POLL_TIME);
+    }
+
+    SECTION("polls the network while it is connecting") {
+        g_state.networkConnecting = true;
+        runSystemThread(1000);
+        const unsigned passes = 1000 / IdleScheduler::ACTIVE_POLL_PERIOD;
+        CHECK(test.wakeups() == passes);
+        CHECK(test.wakeupsDiag() == passes);
+        CHECK(test.networkTimeDiag() == passes * POLL_TIME);
+    }
+
+    SECTION("wakes up for an ISR task and blocks again once the task is processed") {
+        struct Task: ISRTaskQueue::Task {
+            bool done = false;
+        } task;
+        task.func = [](ISRTaskQueue::Task* t) {
+            static_cast<Task*>(t)->done = true;
+        };
+        SystemISRTaskQueue.enqueue(&task);
+        // Repeated events don't cause extra wakeups
+        system_loop_wakeup();
+        CHECK(IdleScheduler::instance()->timeout(g_millis) == 0);
+        CHECK(runIdleEvents() == IdleScheduler::DEFAULT_MAX_TIMEOUT - 2 * POLL_TIME);
+        CHECK(task.done);
+        CHECK(test.wakeups() == 1);
+        CHECK(test.wakeupsDiag() == 1);
+    }
+}
@@ -0,0 +1,201 @@
+#include "system_resolver_cache.h"
+#include "system_error.h"
+
+#include "util/catch.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+
+using namespace particle::system;
+
+HAL_IPAddress ipv4(uint32_t addr) {
+    HAL_IPAddress a = {};
+    a.ipv4 = addr;
+    return a;
+}
+
+// Resolver that answers the lookups that miss the cache from a fixed table of host names
+class FakeResolver {
+public:
+    explicit FakeResolver(ResolverCache* cache) :
+            cache_(cache),
+            queries_(0) {
+    }
+
+    int resolve(const char* name, system_tick_t now, HAL_IPAddress* addrs, size_t maxCount) {
+        const int r = cache_->get(name, now, addrs, maxCount);
+        if (r != 0) {
+            return r;
+        }
+        ++queries_;
+        if (strcmp(name, "device.udp.particle.io") != 0) {
+            cache_->put(name, nullptr, 0, 0 /* ttl */, now);
+            return SYSTEM_ERROR_NOT_FOUND;
+        }
+        const HAL_IPAddress resolved[] = { ipv4(0x01020304) };
+        cache_->put(name, resolved, 1, 0 /* ttl */, now);
+        addrs[0] = resolved[0];
+        return 1;
+    }
+
+    unsigned queries() const {
+        return queries_;
+    }
+
+private:
+    ResolverCache* cache_;
+    unsigned queries_;
+};
+
+} // namespace
+
+TEST_CASE("ResolverCache") {
+    ResolverCache cache;
+    const HAL_IPAddress addrs[] = { ipv4(0x01020304), ipv4(0x05060708) };
+    HAL_IPAddress out[ResolverCache::MAX_ADDRESSES] = {};
+
+    SECTION("returns the stored addresses") {
+        CHECK(cache.get("example.com", 0, out, 2) == 0);
+        cache.put("example.com", addrs, 2, 0 /* ttl */, 0);
+        CHECK(cache.get("example.com", 1000, out, 2) == 2);
+        CHECK(out[0].ipv4 == addrs[0].ipv4);
+        CHECK(out[1].ipv4 == addrs[1].ipv4);
+        CHECK(cache.get("example.com", 1000, out, 1) == 1);
+        CHECK(cache.get("example.org", 1000, out, 2) == 0);
+        CHECK(cache.hits() == 2);
+        CHECK(cache.misses() == 2);
+    }
+
+    SECTION("matches host names regardless of case") {
+        cache.put("Device.UDP.Particle.io", addrs, 1, 0 /* ttl */, 0);
+        CHECK(cache.get("device.udp.particle.io", 0, out, 2) == 1);
+    }
+
+    SECTION("expires entries") {
+        cache.put("a.com", addrs, 1, 0 /* ttl */, 0);
+        cache.put("b.com", addrs, 1, 5000, 0);
+        cache.put("c.com", addrs, 1, ResolverCache::MAX_TTL * 2, 0);
+        CHECK(cache.get("b.com", 4999, out, 2) == 1);
+        CHECK(cache.get("b.com", 5000, out, 2) == 0);
+        CHECK(cache.get("a.com", ResolverCache::DEFAULT_TTL - 1, out, 2) == 1);
+        CHECK(cache.get("a.com", ResolverCache::DEFAULT_TTL, out, 2) == 0);
+        CHECK(cache.get("c.com", ResolverCache::MAX_TTL - 1, out, 2) == 1);
+        CHECK(cache.get("c.com", ResolverCache::MAX_TTL, out, 2) == 0);
+    }
+
+    SECTION("expires entries across a tick counter overflow") {
+        const system_tick_t now = UINT32_MAX - 100;
+        cache.put("a.com", addrs, 1, 1000, now);
+        CHECK(cache.get("a.com", now + 999, out, 2) == 1);
+        CHECK(cache.get("a.com", now + 1000, out, 2) == 0);
+    }
+
+    SECTION("caches failed lookups for a short time") {
+        cache.put("nx.example.com", nullptr, 0, 0 /* ttl */, 0);
+        CHECK(cache.get("nx.example.com", ResolverCache::NEGATIVE_TTL - 1, out, 2) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(cache.get("nx.example.com", ResolverCache::NEGATIVE_TTL, out, 2) == 0);
+        // A successful lookup replaces the failed one
+        cache.put("nx.example.com", nullptr, 0, 0 /* ttl */, 0);
+        cache.put("nx.example.com", addrs, 1, 0 /* ttl */, 0);
+        CHECK(cache.get("nx.example.com", 0, out, 2) == 1);
+    }
+
+    SECTION("replaces the least recently used entry when full") {
+        char name[16] = {};
+        for (size_t i = 0; i < ResolverCache::MAX_ENTRIES; ++i) {
+            snprintf(name, sizeof(name), "host%u.com", (unsigned)i);
+            cache.put(name, addrs, 1, 0 /* ttl */, i);
+        }
+        // Use the oldest entry so that the second oldest one gets replaced
+        CHECK(cache.get("host0.com", 100, out, 2) == 1);
+        cache.put("new.com", addrs, 1, 0 /* ttl */, 200);
+        CHECK(cache.get("new.com", 200, out, 2) == 1);
+        CHECK(cache.get("host0.com", 200, out, 2) == 1);
+        CHECK(cache.get("host1.com", 200, out, 2) == 0);
+        CHECK(cache.get("host2.com", 200, out, 2) == 1);
+    }
+
+    SECTION("doesn't cache names that are too long") {
+        const std::string name(ResolverCache::MAX_NAME_LENGTH + 1, 'a');
+        cache.put(name.c_str(), addrs, 1, 0 /* ttl */, 0);
+        CHECK(cache.get(name.c_str(), 0, out, 2) == 0);
+    }
+
+    SECTION("removes entries") {
+        cache.put("a.com", addrs, 1, 0 /* ttl */, 0);
+        cache.put("b.com", addrs, 1, 0 /* ttl */, 0);
+        cache.remove("A.com");
+        CHECK(cache.get("a.com", 0, out, 2) == 0);
+        CHECK(cache.get("b.com", 0, out, 2) == 1);
+        cache.clear();
+        CHECK(cache.get("b.com", 0, out, 2) == 0);
+    }
+
+    SECTION("clamps the time-to-live of the entries to the configured limit") {
+        cache.maxTtl(3000);
+        cache.put("a.com", addrs, 1, 0 /* ttl */, 0);
+        cache.put("b.com", addrs, 1, 2000, 0);
+        cache.put("nx.example.com", nullptr, 0, 0 /* ttl */, 0);
+        CHECK(cache.get("b.com", 1999, out, 2) == 1);
+        CHECK(cache.get("b.com", 2000, out, 2) == 0);
+        CHECK(cache.get("a.com", 2999, out, 2) == 1);
+        CHECK(cache.get("nx.example.com", 2999, out, 2) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(cache.get("a.com", 3000, out, 2) == 0);
+        CHECK(cache.get("nx.example.com", 3000, out, 2) == 0);
+    }
+
+    SECTION("doesn't cache anything if the limit for the time-to-live is 0") {
+        cache.maxTtl(0);
+        cache.put("a.com", addrs, 1, 0 /* ttl */, 0);
+        CHECK(cache.get("a.com", 0, out, 2) == 0);
+    }
+}
+
+TEST_CASE("ResolverCache in front of a resolver") {
+    ResolverCache cache;
+    FakeResolver resolver(&cache);
+    HAL_IPAddress out[ResolverCache::MAX_ADDRESSES] = {};
+
+    SECTION("answers repeated lookups from the cache until the entry expires") {
+        CHECK(resolver.resolve("device.udp.particle.io", 0, out, 2) == 1);
+        CHECK(out[0].ipv4 == 0x01020304);
+        CHECK(resolver.queries() == 1);
+        CHECK(cache.misses() == 1);
+        // A device reconnecting every 15 seconds
+        for (system_tick_t now = 15000; now < ResolverCache::DEFAULT_TTL; now += 15000) {
+            out[0] = {};
+            CHECK(resolver.resolve("device.udp.particle.io", now, out, 2) == 1);
+            CHECK(out[0].ipv4 == 0x01020304);
+        }
+        CHECK(resolver.queries() == 1);
+        CHECK(cache.hits() == 3);
+        CHECK(cache.misses() == 1);
+        CHECK(resolver.resolve("device.udp.particle.io", ResolverCache::DEFAULT_TTL, out, 2) == 1);
+        CHECK(resolver.queries() == 2);
+        CHECK(cache.misses() == 2);
+        CHECK(resolver.resolve("device.udp.particle.io", ResolverCache::DEFAULT_TTL + 1, out, 2) == 1);
+        CHECK(resolver.queries() == 2);
+        CHECK(cache.hits() == 4);
+    }
+
+    SECTION("answers repeated lookups of a name that doesn't resolve from the cache") {
+        CHECK(resolver.resolve("nx.example.com", 0, out, 2) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(resolver.resolve("nx.example.com", ResolverCache::NEGATIVE_TTL - 1, out, 2) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(resolver.queries() == 1);
+        CHECK(cache.hits() == 1);
+        CHECK(resolver.resolve("nx.example.com", ResolverCache::NEGATIVE_TTL, out, 2) == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(resolver.queries() == 2);
+        CHECK(cache.misses() == 2);
+    }
+
+    SECTION("queries the resolver again after the entry is removed") {
+        CHECK(resolver.resolve("device.udp.particle.io", 0, out, 2) == 1);
+        cache.remove("device.udp.particle.io");
+        CHECK(resolver.resolve("device.udp.particle.io", 1, out, 2) == 1);
+        CHECK(resolver.queries() == 2);
+        CHECK(cache.hits() == 0);
+    }
+}
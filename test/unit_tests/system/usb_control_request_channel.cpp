@@ -265,6 +265,10 @@ public:
         return poolAlloc_;
     }
 
+    const ControlBufferPool& bufferPool() const {
+        return channel_->bufferPool();
+    }
+
     void reset() {
         processAllTasks();
         channel_.reset();
@@ -275,6 +279,10 @@ public:
         channel_.reset(new UsbControlRequestChannel(this));
     }
 
+    void releaseCachedBuffers() {
+        channel_->bufferPool().clear();
+    }
+
     void checkMemory() {
         heapAlloc_.check();
         poolAlloc_.check();
@@ -448,7 +456,7 @@ TEST_CASE("UsbControlRequestChannel") {
             CHECK(rep.status() == ServiceReply::PENDING); // Buffer allocation is pending
             CHECK(rep.id() != USB_REQUEST_INVALID_ID);
             CHECK(processNextTask());
-            CHECK(channel.heapAllocator().allocSize() == size);
+            CHECK(channel.heapAllocator().allocSize() == ControlBufferPool::blockSize(size));
         }
         SECTION("allocates a request buffer on the heap when there's no enough memory in the system pool") {
             CHECK(channel.serviceRequest(ServiceRequest::INIT).type(TEST_REQ).send());
@@ -461,7 +469,7 @@ TEST_CASE("UsbControlRequestChannel") {
             CHECK(rep.status() == ServiceReply::PENDING); // Buffer allocation is pending
             CHECK(rep.id() != USB_REQUEST_INVALID_ID);
             CHECK(processNextTask());
-            CHECK(channel.heapAllocator().allocSize() == size);
+            CHECK(channel.heapAllocator().allocSize() == ControlBufferPool::blockSize(size));
         }
         SECTION("can initiate a limited number of concurrent requests") {
             for (unsigned i = 0; i < USB_REQUEST_MAX_ACTIVE_COUNT; ++i) {
@@ -902,6 +910,56 @@ TEST_CASE("UsbControlRequestChannel") {
         }
 
         processAllTasks(); // Process remaining asynchronous tasks
+        channel.releaseCachedBuffers(); // Free the buffers kept by the channel for reuse
         channel.checkMemory(); // Ensure there are no memory leaks
     }
 }
+
+namespace {
+
+const unsigned ECHO_REQUEST_COUNT = 2000;
+
+// Sends a series of echo requests of different sizes
+void sendEchoRequests(Channel& channel, unsigned count) {
+    const uint16_t TEST_REQ = 1234;
+    const size_t PAYLOAD_SIZES[] = { 100, 200, 500, 1000 };
+
+    channel.requestHandler([](ctrl_request* req, ControlRequestChannel* ch) {
+        // Echo request data back to the client
+        REQUIRE(ch->allocReplyData(req, req->request_size) == 0);
+        memcpy(req->reply_data, req->request_data, req->request_size);
+        ch->setResult(req, SYSTEM_ERROR_NONE);
+    });
+
+    for (unsigned i = 0; i < count; ++i) {
+        const auto data = randomBytes(PAYLOAD_SIZES[i % (sizeof(PAYLOAD_SIZES) / sizeof(PAYLOAD_SIZES[0]))]);
+        REQUIRE(channel.serviceRequest(ServiceRequest::INIT).type(TEST_REQ).size(data.size()).send());
+        const uint16_t id = channel.serviceReply().id();
+        REQUIRE(channel.serviceReply().status() == ServiceReply::PENDING);
+        REQUIRE(processNextTask()); // Allocate the request buffer
+        REQUIRE(channel.serviceRequest(ServiceRequest::SEND).id(id).data(data).send());
+        REQUIRE(processNextTask()); // Invoke the request handler
+        REQUIRE(channel.serviceRequest(ServiceRequest::CHECK).id(id).send());
+        REQUIRE(channel.serviceReply().status() == ServiceReply::OK);
+        REQUIRE(channel.serviceRequest(ServiceRequest::RECV).id(id).size(data.size()).send());
+        REQUIRE(channel.serviceReply().data() == data);
+        processAllTasks(); // Free the request and reply buffers
+    }
+}
+
+} // namespace
+
+TEST_CASE("UsbControlRequestChannel buffer reuse") {
+    Channel channel;
+    sendEchoRequests(channel, ECHO_REQUEST_COUNT);
+
+    const auto& pool = channel.bufferPool();
+    const unsigned bufCount = pool.heapAllocCount() + pool.reuseCount();
+    // Each request needs a request buffer and a reply buffer
+    CHECK(bufCount == ECHO_REQUEST_COUNT * 2);
+    // Once the buffers of each size class are cached, no more heap allocations are made
+    CHECK(pool.heapAllocCount() <= 2 * CONTROL_BUFFER_POOL_SIZE_CLASS_COUNT);
+    channel.releaseCachedBuffers();
+    CHECK(pool.cachedSize() == 0);
+    channel.checkMemory();
+}
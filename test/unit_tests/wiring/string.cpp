@@ -238,6 +238,41 @@ TEST_CASE("String resize") {
     }
 }
 
+TEST_CASE("String growth") {
+    SECTION("concatenation grows the capacity geometrically") {
+        String s("x");
+        unsigned reallocs = 0;
+        unsigned capacity = s.capacity();
+        for (int i = 1; i < 1000; ++i) {
+            s += 'x';
+            if (s.capacity() != capacity) {
+                CHECK(s.capacity() >= capacity + capacity / 2);
+                capacity = s.capacity();
+                ++reallocs;
+            }
+        }
+        CHECK(s.length() == 1000);
+        CHECK(reallocs < 20);
+    }
+
+    SECTION("reserve() allocates the exact size") {
+        String s("abc");
+        CHECK(s.reserve(100));
+        CHECK(s.capacity() == 100);
+        CHECK(s == "abc");
+    }
+
+    SECTION("default and empty strings are invalid until they are modified") {
+        String s;
+        CHECK(s.c_str() == nullptr);
+        CHECK(String("").c_str() == nullptr);
+        s += "abc";
+        CHECK(s.c_str() != nullptr);
+        CHECK(s.capacity() == 3);
+        CHECK(s == "abc");
+    }
+}
+
 TEST_CASE("Comparison operators") {
     SECTION("operator==") {
         CHECK(String("") == String(""));
@@ -0,0 +1,49 @@
+#include <cstdio>
+
+#include "spark_wiring_string.h"
+
+#include "util/catch.h"
+
+namespace {
+
+struct BenchResult {
+    String str;
+    unsigned reallocs; // Number of times the string buffer had to be reallocated
+};
+
+// Builds a JSON document field by field, the way an application would format an event payload
+BenchResult buildJson(unsigned fields, bool exactGrowth) {
+    BenchResult r = {};
+    String json("{");
+    unsigned capacity = json.capacity();
+    char field[32] = {};
+    for (unsigned i = 0; i < fields; ++i) {
+        const int n = snprintf(field, sizeof(field), "\"sensor%u\":%u.%u,", i, i * 7 % 100, i % 10);
+        if (exactGrowth) {
+            // Emulates the previous allocation strategy where each append reallocated to the exact size
+            json.reserve(json.length() + n);
+        }
+        json.concat(field, n);
+        if (json.capacity() != capacity) {
+            capacity = json.capacity();
+            ++r.reallocs;
+        }
+    }
+    json.setCharAt(json.length() - 1, '}');
+    r.str = std::move(json);
+    return r;
+}
+
+const unsigned FIELD_COUNT = 200;
+
+} // namespace
+
+TEST_CASE("String benchmark") {
+    SECTION("JSON building") {
+        const auto exact = buildJson(FIELD_COUNT, true /* exactGrowth */);
+        const auto geometric = buildJson(FIELD_COUNT, false /* exactGrowth */);
+        CHECK(geometric.str == exact.str);
+        CHECK(geometric.reallocs < 20);
+        CHECK(geometric.reallocs * 5 < exact.reallocs);
+    }
+}
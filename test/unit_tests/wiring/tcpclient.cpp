@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "spark_wiring_tcpclient.h"
+#include "system_network.h"
+
+#include "hippomocks.h"
+#include "wiring/tcpclient_write_buffer.h"
+#include "util/catch.h"
+
+namespace {
+
+const sock_handle_t SOCKET_HANDLE = 1;
+
+// Maximum segment size
+const size_t TCP_MSS = 1460;
+
+// Size of the TCP and IPv4 headers
+const size_t TCP_HEADER_SIZE = 40;
+
+// Maximum number of bytes a socket read can return, i.e. the size of the receive window
+const size_t TCP_WINDOW = 4 * TCP_MSS;
+
+// Model of a TCP peer that consumes everything the client sends. Each socket send is assumed to be
+// transmitted as soon as possible, i.e. in as many segments as there are MSS-sized chunks in it.
+// The peer also sends `rxData` to the client as fast as the receive window allows
+class TcpSink {
+public:
+    TcpSink() {
+        reset();
+    }
+
+    void reset() {
+        data.clear();
+        rxData.clear();
+        rxOffset = 0;
+        receiveCalls = 0;
+        segments = 0;
+        sendCalls = 0;
+        open = false;
+        sendLimit = 0;
+        sendBudget = SIZE_MAX;
+        sendError = 0;
+        nonBlockingSend = false;
+    }
+
+    size_t wireBytes() const {
+        return data.size() + segments * TCP_HEADER_SIZE;
+    }
+
+    std::string data; // Received data
+    std::string rxData; // Data sent to the client
+    size_t rxOffset; // Number of bytes of `rxData` read by the client
+    size_t receiveCalls; // Number of socket reads
+    size_t segments; // Number of received segments
+    size_t sendCalls; // Number of socket sends
+    size_t sendLimit; // Maximum number of bytes accepted by a socket send (0 if unlimited)
+    size_t sendBudget; // Number of bytes that can be sent before the socket's send buffer is full
+    int sendError; // Error code reported by socket sends
+    bool nonBlockingSend; // Whether the last socket send was made with SOCKET_SEND_NO_WAIT
+    bool open; // Whether the connection is open
+};
+
+TcpSink sink;
+
+std::string makeRequest(TCPClient& client, unsigned index) {
+    client.printf("GET /api/v1/devices/%u HTTP/1.1", index);
+    client.println();
+    client.println("Host: api.example.com");
+    client.print("Content-Length: ");
+    client.println(0);
+    client.println("Connection: keep-alive");
+    client.println();
+    return std::string("GET /api/v1/devices/") + std::to_string(index) + " HTTP/1.1\r\n"
+            "Host: api.example.com\r\nContent-Length: 0\r\nConnection: keep-alive\r\n\r\n";
+}
+
+class ConnectedClient {
+public:
+    ConnectedClient() {
+        sink.reset();
+        mocks_.OnCallFunc(network_ready).Return(true);
+        REQUIRE(client_.connect(IPAddress(127, 0, 0, 1), 80) == 1);
+    }
+
+    TCPClient* operator->() {
+        return &client_;
+    }
+
+    TCPClient& operator*() {
+        return client_;
+    }
+
+private:
+    MockRepository mocks_;
+    TCPClient client_;
+};
+
+// Statistics of a series of requests sent by the client
+struct RequestStats {
+    size_t segments; // Number of segments sent
+    size_t wireBytes; // Number of bytes sent, including the headers
+};
+
+RequestStats sendRequests(TCPClient& client, unsigned count, size_t bufferSize) {
+    sink.data.clear();
+    sink.segments = 0;
+    REQUIRE(client.setWriteBuffer(bufferSize, 1000));
+    std::string expected;
+    for (unsigned i = 0; i < count; ++i) {
+        expected += makeRequest(client, i);
+        client.flush();
+    }
+    REQUIRE(sink.data == expected);
+    return { sink.segments, sink.wireBytes() };
+}
+
+// Statistics of a download received by the client
+struct DownloadStats {
+    size_t socketReads; // Number of socket reads
+};
+
+std::string makePayload(size_t size) {
+    std::string payload(size, '\0');
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = (char)(i * 31 + (i >> 8));
+    }
+    return payload;
+}
+
+// Reads `payload` byte by byte or, if `inPlace` is true, via peekBuffer() and consume()
+DownloadStats download(TCPClient& client, const std::string& payload, size_t bufferSize, bool inPlace) {
+    sink.rxData = payload;
+    sink.rxOffset = 0;
+    sink.receiveCalls = 0;
+    REQUIRE(client.setReceiveBuffer(bufferSize));
+    uint32_t sum = 0;
+    size_t received = 0;
+    if (!inPlace) {
+        while (received < payload.size()) {
+            const int c = client.read();
+            if (c < 0) {
+                break;
+            }
+            sum = sum * 33 + c;
+            ++received;
+        }
+    } else {
+        while (received < payload.size()) {
+            const uint8_t* data = nullptr;
+            const int n = client.peekBuffer(&data);
+            if (n <= 0) {
+                break;
+            }
+            for (int i = 0; i < n; ++i) {
+                sum = sum * 33 + data[i];
+            }
+            client.consume(n);
+            received += n;
+        }
+    }
+    uint32_t expected = 0;
+    for (size_t i = 0; i < payload.size(); ++i) {
+        expected = expected * 33 + (uint8_t)payload[i];
+    }
+    REQUIRE(received == payload.size());
+    REQUIRE(sum == expected);
+    return { sink.receiveCalls };
+}
+
+} // namespace
+
+extern "C" {
+
+uint8_t socket_active_status(sock_handle_t socket) {
+    return sink.open ? SOCKET_STATUS_ACTIVE : SOCKET_STATUS_INACTIVE;
+}
+
+uint8_t socket_handle_valid(sock_handle_t handle) {
+    return handle == SOCKET_HANDLE;
+}
+
+sock_handle_t socket_handle_invalid() {
+    return -1;
+}
+
+sock_handle_t socket_create(uint8_t family, uint8_t type, uint8_t protocol, uint16_t port, network_interface_t nif) {
+    return SOCKET_HANDLE;
+}
+
+sock_result_t socket_connect(sock_handle_t sd, const sockaddr_t* addr, long addrlen) {
+    sink.open = true;
+    return 0;
+}
+
+sock_result_t socket_receive(sock_handle_t sd, void* buffer, socklen_t len, system_tick_t timeout) {
+    if (!sink.open) {
+        return -1;
+    }
+    ++sink.receiveCalls;
+    const size_t n = std::min<size_t>(std::min<size_t>(len, TCP_WINDOW), sink.rxData.size() - sink.rxOffset);
+    memcpy(buffer, sink.rxData.data() + sink.rxOffset, n);
+    sink.rxOffset += n;
+    return n;
+}
+
+sock_result_t socket_send_ex(sock_handle_t sd, const void* buffer, socklen_t len, uint32_t flags, system_tick_t timeout,
+        void* reserved) {
+    if (!sink.open) {
+        return -1;
+    }
+    ++sink.sendCalls;
+    sink.nonBlockingSend = flags & SOCKET_SEND_NO_WAIT;
+    if (sink.sendError) {
+        return -sink.sendError;
+    }
+    if (sink.sendLimit && len > sink.sendLimit) {
+        len = sink.sendLimit;
+    }
+    len = std::min<size_t>(len, sink.sendBudget);
+    if (!len) {
+        // The send buffer of the socket is full
+        return 0;
+    }
+    sink.sendBudget -= len;
+    sink.data.append((const char*)buffer, len);
+    sink.segments += (len + TCP_MSS - 1) / TCP_MSS;
+    return len;
+}
+
+sock_result_t socket_close(sock_handle_t sd) {
+    sink.open = false;
+    return 0;
+}
+
+} // extern "C"
+
+TEST_CASE("TCPClient") {
+    ConnectedClient client;
+
+    test::checkWriteBufferErrors(*client, sink);
+
+    SECTION("sends every write separately when buffering is disabled") {
+        const auto req = makeRequest(*client, 1);
+        CHECK(sink.data == req);
+        CHECK(sink.sendCalls >= 10);
+    }
+
+    SECTION("coalesces small writes when buffering is enabled") {
+        REQUIRE(client->setWriteBuffer(512, 1000));
+        const auto req = makeRequest(*client, 1);
+        CHECK(sink.sendCalls == 0);
+        client->flush();
+        CHECK(sink.data == req);
+        CHECK(sink.sendCalls == 1);
+    }
+
+    SECTION("sends the buffer when it becomes full") {
+        REQUIRE(client->setWriteBuffer(16, 1000));
+        CHECK(client->write((const uint8_t*)"0123456789", 10) == 10);
+        CHECK(sink.sendCalls == 0);
+        CHECK(client->write((const uint8_t*)"abcdef", 6) == 6);
+        CHECK(sink.data == "0123456789abcdef");
+        CHECK(client->write((const uint8_t*)"ghij", 4) == 4);
+        CHECK(client->write((const uint8_t*)"0123456789abcdef", 16) == 16);
+        // The buffered data is sent before the data that doesn't fit in the buffer
+        CHECK(sink.data == "0123456789abcdefghij0123456789abcdef");
+    }
+
+    SECTION("sends writes larger than the buffer directly") {
+        REQUIRE(client->setWriteBuffer(16, 1000));
+        const std::string data(100, 'x');
+        CHECK(client->write((const uint8_t*)data.data(), data.size()) == data.size());
+        CHECK(sink.data == data);
+        CHECK(sink.sendCalls == 1);
+    }
+
+    SECTION("resends the rest of the buffer after a partial send") {
+        REQUIRE(client->setWriteBuffer(64, 1000));
+        client->print("0123456789");
+        sink.sendLimit = 4;
+        client->flush();
+        CHECK(sink.data == "0123456789");
+        CHECK(sink.sendCalls == 3);
+    }
+
+    SECTION("sends the buffered data before reading") {
+        REQUIRE(client->setWriteBuffer(64, 1000));
+        client->print("request");
+        CHECK(sink.data.empty());
+        client->available();
+        CHECK(sink.data == "request");
+    }
+
+    SECTION("sends the buffered data when the client is stopped") {
+        REQUIRE(client->setWriteBuffer(64, 1000));
+        client->print("request");
+        client->stop();
+        CHECK(sink.data == "request");
+    }
+
+    SECTION("sends the buffered data on a write after the flush timeout") {
+        REQUIRE(client->setWriteBuffer(64, 10));
+        client->print("abc");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        client->print("def");
+        CHECK(sink.data == "abcdef");
+    }
+
+    SECTION("sends the buffered data when buffering is disabled") {
+        REQUIRE(client->setWriteBuffer(64, 1000));
+        client->print("abc");
+        REQUIRE(client->setWriteBuffer(0));
+        CHECK(sink.data == "abc");
+        client->print("def");
+        CHECK(sink.data == "abcdef");
+    }
+
+    SECTION("reports an error if the buffered data cannot be sent") {
+        REQUIRE(client->setWriteBuffer(64, 1000));
+        client->print("abc");
+        sink.open = false;
+        client->flush();
+        CHECK(client->getWriteError() != 0);
+    }
+
+    SECTION("sends one segment per HTTP-style request when buffering is enabled") {
+        const unsigned REQUEST_COUNT = 100;
+        const auto unbuffered = sendRequests(*client, REQUEST_COUNT, 0 /* bufferSize */);
+        const auto buffered = sendRequests(*client, REQUEST_COUNT, 256 /* bufferSize */);
+        // One segment per request instead of one per print call
+        CHECK(buffered.segments == REQUEST_COUNT);
+        CHECK(unbuffered.segments >= REQUEST_COUNT * 10);
+        CHECK(buffered.wireBytes < unbuffered.wireBytes);
+    }
+
+    SECTION("reads data through a larger receive buffer") {
+        sink.rxData = std::string(1000, 'x');
+        REQUIRE(client->setReceiveBuffer(1024));
+        CHECK(client->available() == 1000);
+        CHECK(sink.receiveCalls == 1);
+        CHECK(client->read() == 'x');
+        CHECK(client->available() == 999);
+    }
+
+    SECTION("keeps the buffered data when the receive buffer is resized") {
+        sink.rxData = "0123456789";
+        CHECK(client->read() == '0');
+        REQUIRE(client->setReceiveBuffer(512));
+        CHECK(client->available() == 9);
+        char buf[16] = {};
+        CHECK(client->read((uint8_t*)buf, sizeof(buf)) == 9);
+        CHECK(std::string(buf) == "123456789");
+        // The buffered data doesn't fit in a smaller buffer
+        sink.rxData += "abcdefghij";
+        CHECK(client->available() == 10);
+        CHECK_FALSE(client->setReceiveBuffer(4));
+        CHECK(client->setReceiveBuffer(10));
+        CHECK(client->peek() == 'a');
+    }
+
+    SECTION("reads data in place") {
+        sink.rxData = "0123456789";
+        const uint8_t* data = nullptr;
+        CHECK(client->peekBuffer(&data) == 10);
+        CHECK(std::string((const char*)data, 4) == "0123");
+        client->consume(4);
+        CHECK(client->peekBuffer(&data) == 6);
+        CHECK(std::string((const char*)data, 6) == "456789");
+        client->consume(100);
+        CHECK(client->peekBuffer(&data) == 0);
+    }
+
+    SECTION("reads directly into the caller's buffer when the receive buffer is empty") {
+        sink.rxData = std::string(500, 'x');
+        uint8_t buf[500] = {};
+        CHECK(client->read(buf, sizeof(buf)) == 500);
+        CHECK(sink.receiveCalls == 1);
+        CHECK(std::string((const char*)buf, sizeof(buf)) == sink.rxData);
+    }
+
+    SECTION("downloads data with fewer socket reads through a larger receive buffer") {
+        const auto payload = makePayload(256 * 1024);
+        const auto byteReads = download(*client, payload, TCPCLIENT_BUF_MAX_SIZE, false /* inPlace */);
+        const auto bufferedReads = download(*client, payload, 4096, false /* inPlace */);
+        const auto inPlaceReads = download(*client, payload, 4096, true /* inPlace */);
+        CHECK(byteReads.socketReads >= payload.size() / TCPCLIENT_BUF_MAX_SIZE);
+        CHECK(bufferedReads.socketReads <= payload.size() / 4096 * 2);
+        CHECK(inPlaceReads.socketReads <= payload.size() / 4096 * 2);
+    }
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
+
+#include "spark_wiring_tcpclient.h"
+#include "socket_hal.h"
+#include "logging.h"
+
+#include "wiring/tcpclient_write_buffer.h"
+#include "util/catch.h"
+
+namespace {
+
+const int SOCKET_HANDLE = 1;
+
+// Model of a TCP peer. Socket sends fail with EAGAIN once `sendBudget` bytes have been accepted,
+// as they would when the send buffer of the socket is full
+class TcpPeer {
+public:
+    TcpPeer() {
+        reset();
+    }
+
+    void reset() {
+        data.clear();
+        rxData.clear();
+        rxOffset = 0;
+        sendCalls = 0;
+        nonBlockingSend = false;
+        sendBudget = SIZE_MAX;
+        sendError = 0;
+        eof = false;
+        open = false;
+    }
+
+    std::string data; // Received data
+    std::string rxData; // Data sent to the client
+    size_t rxOffset; // Number of bytes of `rxData` read by the client
+    size_t sendCalls; // Number of socket sends
+    bool nonBlockingSend; // Whether the last socket send was made with MSG_DONTWAIT
+    size_t sendBudget; // Number of bytes that can be sent before the socket's send buffer is full
+    int sendError; // Error code reported by socket sends
+    bool eof; // Whether the peer has closed its side of the connection
+    bool open; // Whether the connection is open
+};
+
+TcpPeer peer;
+
+class ConnectedClient {
+public:
+    ConnectedClient() {
+        peer.reset();
+        REQUIRE(client_.connect(IPAddress(127, 0, 0, 1), 80) == 1);
+    }
+
+    TCPClient* operator->() {
+        return &client_;
+    }
+
+    TCPClient& operator*() {
+        return client_;
+    }
+
+private:
+    TCPClient client_;
+};
+
+} // namespace
+
+extern "C" {
+
+int sock_socket(int domain, int type, int protocol) {
+    return SOCKET_HANDLE;
+}
+
+int sock_connect(int s, const struct sockaddr* name, socklen_t namelen) {
+    peer.open = true;
+    return 0;
+}
+
+int sock_setsockopt(int s, int level, int optname, const void* optval, socklen_t optlen) {
+    return 0;
+}
+
+ssize_t sock_send(int s, const void* dataptr, size_t size, int flags) {
+    if (!peer.open) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    ++peer.sendCalls;
+    peer.nonBlockingSend = flags & MSG_DONTWAIT;
+    if (peer.sendError) {
+        errno = peer.sendError;
+        return -1;
+    }
+    const size_t n = std::min(size, peer.sendBudget);
+    if (!n) {
+        errno = EAGAIN;
+        return -1;
+    }
+    peer.data.append((const char*)dataptr, n);
+    peer.sendBudget -= n;
+    return n;
+}
+
+ssize_t sock_recv(int s, void* mem, size_t len, int flags) {
+    if (!peer.open) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    const size_t n = std::min(len, peer.rxData.size() - peer.rxOffset);
+    if (!n) {
+        if (peer.eof) {
+            return 0;
+        }
+        errno = EAGAIN;
+        return -1;
+    }
+    memcpy(mem, peer.rxData.data() + peer.rxOffset, n);
+    peer.rxOffset += n;
+    return n;
+}
+
+int sock_close(int s) {
+    peer.open = false;
+    return 0;
+}
+
+void log_message(int level, const char* category, LogAttributes* attr, void* reserved, const char* fmt, ...) {
+}
+
+} // extern "C"
+
+TEST_CASE("TCPClient (POSIX)") {
+    ConnectedClient client;
+
+    test::checkWriteBufferErrors(*client, peer);
+
+    SECTION("reports the socket error if the buffered data cannot be sent") {
+        REQUIRE(client->setWriteBuffer(64, 1000));
+        client->print("request");
+        peer.sendError = ECONNRESET;
+        client->available();
+        CHECK(client->getWriteError() == ECONNRESET);
+        client->print("request");
+        client->stop();
+        CHECK(client->getWriteError() == ECONNRESET);
+    }
+
+    SECTION("reports ETIMEDOUT if the buffered data cannot be sent completely") {
+        REQUIRE(client->setWriteBuffer(16, 1000));
+        peer.sendBudget = 0;
+        CHECK(client->write((const uint8_t*)"0123456789abcdef", 16) == 16);
+        CHECK(client->getWriteError() == 0);
+        CHECK(client->write((const uint8_t*)"ij", 2) == 0);
+        CHECK(client->getWriteError() == ETIMEDOUT);
+        client->flush();
+        CHECK(client->getWriteError() == ETIMEDOUT);
+    }
+
+    SECTION("closes the socket when the peer closes the connection") {
+        peer.eof = true;
+        CHECK(client->available() == 0);
+        CHECK_FALSE(client->status());
+        CHECK_FALSE(peer.open);
+    }
+
+    SECTION("closes the socket when the peer closes the connection while reading directly into the caller's buffer") {
+        peer.eof = true;
+        uint8_t buf[TCPCLIENT_BUF_MAX_SIZE] = {};
+        CHECK(client->read(buf, sizeof(buf)) == -1);
+        CHECK_FALSE(client->status());
+        CHECK_FALSE(peer.open);
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "spark_wiring_tcpclient.h"
+
+#include "util/catch.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+
+namespace test {
+
+/**
+ * Test sections for the write buffer error handling, shared by the socket HAL compat and POSIX
+ * implementations of `TCPClient`.
+ *
+ * `peer` is the model of the remote end that backs the fake socket layer of the implementation.
+ * It needs to provide the following fields:
+ *
+ * - `data`: data received from the client;
+ * - `rxData`: data sent to the client;
+ * - `sendBudget`: number of bytes that can be sent before the send buffer of the socket is full;
+ * - `sendError`: error code reported by socket sends (a positive `errno` value or 0);
+ * - `nonBlockingSend`: whether the last socket send was made without waiting;
+ * - `open`: whether the connection is open.
+ */
+template<typename PeerT>
+inline void checkWriteBufferErrors(TCPClient& client, PeerT& peer) {
+    SECTION("waits for the data to be sent if the write buffer is not used and the timeout is zero") {
+        CHECK(client.write((const uint8_t*)"request", 7, 0 /* timeout */) == 7);
+        CHECK_FALSE(peer.nonBlockingSend);
+        CHECK(client.getWriteError() == 0);
+        CHECK(peer.data == "request");
+    }
+
+    SECTION("doesn't wait for the buffered data to be sent before reading") {
+        REQUIRE(client.setWriteBuffer(64, 1000));
+        client.print("request");
+        peer.sendBudget = 0;
+        CHECK(client.available() == 0);
+        CHECK(peer.nonBlockingSend);
+        CHECK(client.getWriteError() == 0);
+        peer.sendBudget = SIZE_MAX;
+        peer.rxData = "response";
+        CHECK(client.available() == 8);
+        CHECK(peer.data == "request");
+    }
+
+    SECTION("reports an error if the buffered data cannot be sent before reading") {
+        REQUIRE(client.setWriteBuffer(64, 1000));
+        client.print("request");
+        peer.sendError = ECONNRESET;
+        client.available();
+        CHECK(client.getWriteError() != 0);
+    }
+
+    SECTION("reports an error if the buffered data cannot be sent when the client is stopped") {
+        REQUIRE(client.setWriteBuffer(64, 1000));
+        client.print("request");
+        peer.sendError = ECONNRESET;
+        client.stop();
+        CHECK(client.getWriteError() != 0);
+        CHECK_FALSE(peer.open);
+    }
+
+    SECTION("reports an error if the buffered data cannot be sent completely when the client is stopped") {
+        REQUIRE(client.setWriteBuffer(64, 1000));
+        client.print("request");
+        peer.sendBudget = 3;
+        client.stop();
+        CHECK(client.getWriteError() != 0);
+        CHECK(peer.data == "req");
+        CHECK_FALSE(peer.open);
+    }
+
+    SECTION("reports a timeout if the buffered data cannot be sent completely") {
+        REQUIRE(client.setWriteBuffer(64, 1000));
+        client.print("request");
+        peer.sendBudget = 3;
+        client.flush();
+        CHECK(client.getWriteError() != 0);
+        CHECK(peer.data == "req");
+        peer.sendBudget = SIZE_MAX;
+        client.flush();
+        CHECK(client.getWriteError() == 0);
+        CHECK(peer.data == "request");
+    }
+
+    SECTION("buffers as much of the data as fits after a partial flush") {
+        REQUIRE(client.setWriteBuffer(16, 1000));
+        CHECK(client.write((const uint8_t*)"0123456789", 10) == 10);
+        peer.sendBudget = 2;
+        CHECK(client.write((const uint8_t*)"abcdefghij", 10) == 8);
+        CHECK(client.getWriteError() == 0);
+        CHECK(peer.data == "01");
+        // None of the buffered data can be sent
+        client.write((const uint8_t*)"ij", 2);
+        CHECK(client.getWriteError() != 0);
+        peer.sendBudget = SIZE_MAX;
+        CHECK(client.write((const uint8_t*)"ij", 2) == 2);
+        client.flush();
+        CHECK(peer.data == "0123456789abcdefghij");
+    }
+}
+
+} // namespace test
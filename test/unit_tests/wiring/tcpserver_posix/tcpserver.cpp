@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstdarg>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "spark_wiring_tcpclient.h"
+#include "spark_wiring_tcpserver.h"
+#include "socket_hal.h"
+#include "logging.h"
+
+#include "util/catch.h"
+
+namespace {
+
+const int LISTEN_SOCKET = 1;
+const int FIRST_CLIENT_SOCKET = 100;
+
+const size_t MAX_CLIENTS = 32;
+const size_t CLIENT_BUFFER_SIZE = 256;
+
+// Model of a TCP peer connected to the server. Socket sends fail with EAGAIN once `sendBudget`
+// bytes have been accepted, as they would when the send buffer of the socket is full
+struct TcpPeer {
+    std::string data; // Received data
+    std::string rxData; // Data sent to the server
+    size_t rxOffset = 0; // Number of bytes of `rxData` read by the server
+    size_t sendBudget = SIZE_MAX; // Number of bytes that can be sent before the socket's send buffer is full
+    bool open = true; // Whether the connection is open
+};
+
+// Model of the network stack
+struct Stack {
+    std::vector<TcpPeer> peers; // Accepted connections, indexed by socket handle
+    unsigned pending = 0; // Number of connections waiting to be accepted
+    bool listening = false;
+    bool nonBlockingListen = false; // Whether the listening socket is in non-blocking mode
+    unsigned blockingAccepts = 0; // Number of accepts that would block
+    unsigned blockingSends = 0; // Number of socket sends made without MSG_DONTWAIT
+} stack;
+
+TcpPeer* getPeer(int s) {
+    if (s < FIRST_CLIENT_SOCKET || s - FIRST_CLIENT_SOCKET >= (int)stack.peers.size()) {
+        return nullptr;
+    }
+    return &stack.peers[s - FIRST_CLIENT_SOCKET];
+}
+
+// Returns the socket of the n-th accepted connection
+int clientSocket(size_t n) {
+    return FIRST_CLIENT_SOCKET + n;
+}
+
+class Server {
+public:
+    Server() :
+            server_(23) {
+        stack = Stack();
+        REQUIRE(server_.setMaxClients(MAX_CLIENTS, CLIENT_BUFFER_SIZE));
+        REQUIRE(server_.begin());
+    }
+
+    TCPServer* operator->() {
+        return &server_;
+    }
+
+private:
+    TCPServer server_;
+};
+
+} // namespace
+
+extern "C" {
+
+int sock_socket(int domain, int type, int protocol) {
+    return LISTEN_SOCKET;
+}
+
+int sock_connect(int s, const struct sockaddr* name, socklen_t namelen) {
+    errno = ENOTSUP;
+    return -1;
+}
+
+int sock_setsockopt(int s, int level, int optname, const void* optval, socklen_t optlen) {
+    return 0;
+}
+
+int sock_fcntl(int s, int cmd, ...) {
+    if (cmd == F_GETFL) {
+        return stack.nonBlockingListen ? O_NONBLOCK : 0;
+    }
+    if (cmd == F_SETFL) {
+        va_list args;
+        va_start(args, cmd);
+        stack.nonBlockingListen = va_arg(args, int) & O_NONBLOCK;
+        va_end(args);
+        return 0;
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+int sock_bind(int s, const struct sockaddr* name, socklen_t namelen) {
+    return 0;
+}
+
+int sock_listen(int s, int backlog) {
+    stack.listening = true;
+    return 0;
+}
+
+int sock_accept(int s, struct sockaddr* addr, socklen_t* addrlen) {
+    if (!stack.pending) {
+        if (!stack.nonBlockingListen) {
+            ++stack.blockingAccepts;
+        }
+        errno = EAGAIN;
+        return -1;
+    }
+    --stack.pending;
+    stack.peers.push_back(TcpPeer());
+    return clientSocket(stack.peers.size() - 1);
+}
+
+int sock_getpeername(int s, struct sockaddr* name, socklen_t* namelen) {
+    errno = ENOTCONN;
+    return -1;
+}
+
+int sock_poll(struct pollfd* fds, nfds_t nfds, int timeout) {
+    int n = 0;
+    for (nfds_t i = 0; i < nfds; ++i) {
+        auto& fd = fds[i];
+        fd.revents = 0;
+        if (fd.fd == LISTEN_SOCKET) {
+            if (stack.pending) {
+                fd.revents |= POLLIN;
+            }
+        } else {
+            const auto peer = getPeer(fd.fd);
+            if (!peer) {
+                fd.revents |= POLLNVAL;
+            } else if (!peer->open) {
+                fd.revents |= POLLHUP;
+            } else {
+                if (peer->rxOffset < peer->rxData.size()) {
+                    fd.revents |= POLLIN;
+                }
+                if (peer->sendBudget) {
+                    fd.revents |= POLLOUT;
+                }
+            }
+        }
+        fd.revents &= fd.events | POLLERR | POLLHUP | POLLNVAL;
+        if (fd.revents) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+ssize_t sock_send(int s, const void* dataptr, size_t size, int flags) {
+    const auto peer = getPeer(s);
+    if (!peer || !peer->open) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    if (!(flags & MSG_DONTWAIT)) {
+        ++stack.blockingSends;
+    }
+    const size_t n = std::min(size, peer->sendBudget);
+    if (!n) {
+        errno = EAGAIN;
+        return -1;
+    }
+    peer->data.append((const char*)dataptr, n);
+    peer->sendBudget -= n;
+    return n;
+}
+
+ssize_t sock_recv(int s, void* mem, size_t len, int flags) {
+    const auto peer = getPeer(s);
+    if (!peer || !peer->open) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    const size_t n = std::min(len, peer->rxData.size() - peer->rxOffset);
+    if (!n) {
+        errno = EAGAIN;
+        return -1;
+    }
+    memcpy(mem, peer->rxData.data() + peer->rxOffset, n);
+    peer->rxOffset += n;
+    return n;
+}
+
+int sock_close(int s) {
+    if (s == LISTEN_SOCKET) {
+        stack.listening = false;
+    } else if (const auto peer = getPeer(s)) {
+        peer->open = false;
+    }
+    return 0;
+}
+
+void log_message(int level, const char* category, LogAttributes* attr, void* reserved, const char* fmt, ...) {
+}
+
+} // extern "C"
+
+TEST_CASE("TCPServer (POSIX)") {
+    Server server;
+
+    SECTION("accepts connections without blocking") {
+        CHECK(stack.listening);
+        CHECK(stack.nonBlockingListen);
+        CHECK(server->poll() == 0);
+        stack.pending = 3;
+        CHECK(server->poll() == 3);
+        CHECK(server->clientCount() == 3);
+        CHECK(server->poll() == 3);
+        CHECK(stack.blockingAccepts == 0);
+    }
+
+    SECTION("doesn't accept more connections than the maximum number of clients") {
+        stack.pending = MAX_CLIENTS + 8;
+        CHECK(server->poll() == (int)MAX_CLIENTS);
+        CHECK(stack.peers.size() == MAX_CLIENTS);
+        CHECK(stack.pending == 8);
+        // A slot is freed when the application closes a client
+        stack.peers[0].rxData = "bye";
+        auto client = server->available();
+        REQUIRE(client.status());
+        client.stop();
+        CHECK_FALSE(stack.peers[0].open);
+        CHECK(server->poll() == (int)MAX_CLIENTS);
+        CHECK(stack.peers.size() == MAX_CLIENTS + 1);
+        CHECK(stack.pending == 7);
+    }
+
+    SECTION("broadcasts the written data to all clients without blocking") {
+        stack.pending = MAX_CLIENTS;
+        REQUIRE(server->poll() == (int)MAX_CLIENTS);
+        CHECK(server->write((const uint8_t*)"hello", 5) == 5);
+        CHECK(server->getWriteError() == 0);
+        for (const auto& peer: stack.peers) {
+            CHECK(peer.data == "hello");
+        }
+        CHECK(stack.blockingSends == 0);
+    }
+
+    SECTION("drops a stalled client and keeps sending to the others") {
+        stack.pending = MAX_CLIENTS;
+        REQUIRE(server->poll() == (int)MAX_CLIENTS);
+        const size_t stalled = 5;
+        stack.peers[stalled].sendBudget = 0;
+        const std::string chunk(100, 'x');
+        std::string expected;
+        for (size_t i = 0; i < 3; ++i) {
+            CHECK(server->write((const uint8_t*)chunk.data(), chunk.size()) == chunk.size());
+            CHECK(server->getWriteError() == 0);
+            expected += chunk;
+        }
+        // The third chunk doesn't fit in the buffer of the stalled client
+        CHECK(server->droppedClients() == 1);
+        CHECK(server->clientCount() == MAX_CLIENTS - 1);
+        CHECK_FALSE(stack.peers[stalled].open);
+        CHECK(stack.peers[stalled].data.empty());
+        for (size_t i = 0; i < MAX_CLIENTS; ++i) {
+            if (i != stalled) {
+                CHECK(stack.peers[i].open);
+                CHECK(stack.peers[i].data == expected);
+            }
+        }
+        CHECK(stack.blockingSends == 0);
+        // A new client takes the freed slot
+        stack.pending = 1;
+        CHECK(server->poll() == (int)MAX_CLIENTS);
+    }
+
+    SECTION("sends the buffered data to a slow client once its socket can take it") {
+        stack.pending = MAX_CLIENTS;
+        REQUIRE(server->poll() == (int)MAX_CLIENTS);
+        stack.peers[0].sendBudget = 2;
+        CHECK(server->write((const uint8_t*)"hello", 5) == 5);
+        CHECK(stack.peers[0].data == "he");
+        CHECK(stack.peers[1].data == "hello");
+        stack.peers[0].sendBudget = SIZE_MAX;
+        server->poll();
+        CHECK(stack.peers[0].data == "hello");
+        CHECK(server->droppedClients() == 0);
+    }
+
+    SECTION("reports an error if all the clients are dropped") {
+        stack.pending = 2;
+        REQUIRE(server->poll() == 2);
+        stack.peers[0].sendBudget = 0;
+        stack.peers[1].sendBudget = 0;
+        const std::string data(CLIENT_BUFFER_SIZE + 1, 'x');
+        CHECK(server->write((const uint8_t*)data.data(), data.size()) == 0);
+        CHECK(server->getWriteError() == ENOBUFS);
+        CHECK(server->droppedClients() == 2);
+        CHECK(server->clientCount() == 0);
+    }
+
+    SECTION("returns the clients that have data to read in turn") {
+        stack.pending = 3;
+        REQUIRE(server->poll() == 3);
+        stack.peers[0].rxData = "a";
+        stack.peers[2].rxData = "c";
+        auto client = server->available();
+        REQUIRE(client.status());
+        CHECK(client.read() == 'a');
+        client = server->available();
+        REQUIRE(client.status());
+        CHECK(client.read() == 'c');
+        CHECK_FALSE(server->available().status());
+    }
+}
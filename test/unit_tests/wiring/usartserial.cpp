@@ -0,0 +1,246 @@
+#include <cstring>
+#include <deque>
+#include <string>
+
+#include "spark_wiring_usartserial.h"
+#include "system_error.h"
+
+#include "util/catch.h"
+
+namespace {
+
+using namespace particle;
+
+const size_t TX_BUFFER_SIZE = 64;
+
+// Loopback model of a USART: transmitted bytes are queued in a bounded TX buffer and appear in the
+// RX buffer once they are "sent over the wire"
+class Loopback {
+public:
+    Loopback() {
+        reset();
+    }
+
+    void reset() {
+        tx.clear();
+        rx.clear();
+        halCalls = 0;
+        bulk = true;
+    }
+
+    // Moves the contents of the TX buffer to the RX buffer
+    void transmit() {
+        rx.insert(rx.end(), tx.begin(), tx.end());
+        tx.clear();
+    }
+
+    size_t space() const {
+        return TX_BUFFER_SIZE - tx.size();
+    }
+
+    std::deque<uint8_t> tx;
+    std::deque<uint8_t> rx;
+    size_t halCalls; // Number of HAL calls made to transfer data
+    bool bulk; // Whether the bulk functions are supported
+};
+
+Loopback loopback;
+
+const size_t DATA_SIZE = 64 * 1024;
+
+std::string makeData(size_t size) {
+    std::string s;
+    s.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        s += (char)(i * 31 + (i >> 8));
+    }
+    return s;
+}
+
+// Writes the data to the serial and reads it back
+std::string loopbackTransfer(USARTSerial& serial, const std::string& data) {
+    std::string buf(data.size(), '\0');
+    serial.write((const uint8_t*)data.data(), data.size());
+    serial.readBytes(&buf[0], buf.size());
+    return buf;
+}
+
+} // namespace
+
+extern "C" {
+
+int hal_usart_init_ex(hal_usart_interface_t serial, const hal_usart_buffer_config_t* config, void*) {
+    return 0;
+}
+
+void hal_usart_begin_config(hal_usart_interface_t serial, uint32_t baud, uint32_t config, void*) {
+}
+
+void hal_usart_end(hal_usart_interface_t serial) {
+}
+
+void hal_usart_half_duplex(hal_usart_interface_t serial, bool enable) {
+}
+
+void hal_usart_flush(hal_usart_interface_t serial) {
+    loopback.transmit();
+}
+
+bool hal_usart_is_enabled(hal_usart_interface_t serial) {
+    return true;
+}
+
+void hal_usart_send_break(hal_usart_interface_t serial, void* reserved) {
+}
+
+uint8_t hal_usart_break_detected(hal_usart_interface_t serial) {
+    return 0;
+}
+
+int32_t hal_usart_available_data_for_write(hal_usart_interface_t serial) {
+    return loopback.space();
+}
+
+int32_t hal_usart_available(hal_usart_interface_t serial) {
+    return loopback.rx.size();
+}
+
+uint32_t hal_usart_write(hal_usart_interface_t serial, uint8_t data) {
+    ++loopback.halCalls;
+    if (!loopback.space()) {
+        // Block until the TX buffer is drained
+        loopback.transmit();
+    }
+    loopback.tx.push_back(data);
+    return 1;
+}
+
+uint32_t hal_usart_write_nine_bits(hal_usart_interface_t serial, uint16_t data) {
+    return hal_usart_write(serial, (uint8_t)data);
+}
+
+int32_t hal_usart_read(hal_usart_interface_t serial) {
+    ++loopback.halCalls;
+    loopback.transmit();
+    if (loopback.rx.empty()) {
+        return -1;
+    }
+    const uint8_t c = loopback.rx.front();
+    loopback.rx.pop_front();
+    return c;
+}
+
+int32_t hal_usart_peek(hal_usart_interface_t serial) {
+    loopback.transmit();
+    if (loopback.rx.empty()) {
+        return -1;
+    }
+    return loopback.rx.front();
+}
+
+ssize_t hal_usart_write_buffer(hal_usart_interface_t serial, const void* buffer, size_t size, size_t elementSize) {
+    ++loopback.halCalls;
+    if (!loopback.bulk) {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+    const size_t n = std::min(size, loopback.space());
+    if (!n) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    loopback.tx.insert(loopback.tx.end(), (const uint8_t*)buffer, (const uint8_t*)buffer + n);
+    return n;
+}
+
+ssize_t hal_usart_read_buffer(hal_usart_interface_t serial, void* buffer, size_t size, size_t elementSize) {
+    ++loopback.halCalls;
+    if (!loopback.bulk) {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+    loopback.transmit();
+    const size_t n = std::min(size, loopback.rx.size());
+    if (!n) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    std::copy(loopback.rx.begin(), loopback.rx.begin() + n, (uint8_t*)buffer);
+    loopback.rx.erase(loopback.rx.begin(), loopback.rx.begin() + n);
+    return n;
+}
+
+} // extern "C"
+
+TEST_CASE("USARTSerial") {
+    loopback.reset();
+    hal_usart_buffer_config_t conf = {};
+    USARTSerial serial(HAL_USART_SERIAL1, conf);
+    serial.setTimeout(0);
+
+    SECTION("write(const uint8_t*, size_t)") {
+        SECTION("writes the data in bulk and waits for room in blocking mode") {
+            const auto data = makeData(1000);
+            CHECK(serial.write((const uint8_t*)data.data(), data.size()) == data.size());
+            loopback.transmit();
+            CHECK(std::string(loopback.rx.begin(), loopback.rx.end()) == data);
+            // A bulk write per buffer's worth of data, plus a failed bulk write and a blocking write
+            // whenever the TX buffer fills up
+            CHECK(loopback.halCalls <= 3 * (data.size() / TX_BUFFER_SIZE + 1));
+        }
+        SECTION("stops when the TX buffer is full in non-blocking mode") {
+            serial.blockOnOverrun(false);
+            const auto data = makeData(1000);
+            CHECK(serial.write((const uint8_t*)data.data(), data.size()) == TX_BUFFER_SIZE);
+            CHECK(std::string(loopback.tx.begin(), loopback.tx.end()) == data.substr(0, TX_BUFFER_SIZE));
+        }
+        SECTION("falls back to writing one byte at a time if bulk writes are not supported") {
+            loopback.bulk = false;
+            const auto data = makeData(100);
+            CHECK(serial.write((const uint8_t*)data.data(), data.size()) == data.size());
+            loopback.transmit();
+            CHECK(std::string(loopback.rx.begin(), loopback.rx.end()) == data);
+        }
+    }
+
+    SECTION("readBytes()") {
+        SECTION("reads the data in bulk") {
+            const auto data = makeData(1000);
+            loopback.rx.assign(data.begin(), data.end());
+            std::string buf(data.size() + 10, '\0');
+            CHECK(serial.readBytes(&buf[0], buf.size()) == data.size());
+            buf.resize(data.size());
+            CHECK(buf == data);
+            CHECK(loopback.halCalls <= 3);
+        }
+        SECTION("falls back to reading one byte at a time if bulk reads are not supported") {
+            loopback.bulk = false;
+            const auto data = makeData(100);
+            loopback.rx.assign(data.begin(), data.end());
+            std::string buf(data.size(), '\0');
+            CHECK(serial.readBytes(&buf[0], buf.size()) == data.size());
+            CHECK(buf == data);
+        }
+    }
+
+    SECTION("transfers data in bulk with fewer HAL calls") {
+        const auto data = makeData(DATA_SIZE);
+        // Byte-by-byte transfer, same as the default implementations in Print and Stream
+        loopback.bulk = false;
+        CHECK(loopbackTransfer(serial, data) == data);
+        const size_t byteCalls = loopback.halCalls;
+        loopback.reset();
+        CHECK(loopbackTransfer(serial, data) == data);
+        const size_t bulkCalls = loopback.halCalls;
+        CHECK(bulkCalls * 16 < byteCalls);
+    }
+}
+
+TEST_CASE("Stream::readBytes()") {
+    SECTION("reads the available data in bulk") {
+        const auto data = makeData(1000);
+        InputBufferStream stream(data.data(), data.size());
+        stream.setTimeout(0);
+        std::string buf(data.size() + 1, '\0');
+        CHECK(stream.readBytes(&buf[0], buf.size()) == data.size());
+        buf.resize(data.size());
+        CHECK(buf == data);
+        CHECK(stream.readBytes(&buf[0], buf.size()) == 0);
+    }
+}
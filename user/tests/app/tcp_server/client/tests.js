@@ -27,6 +27,36 @@ exports.EchoTest = (test) => {
   });
 };
 
+exports.BroadcastTest = (test) => {
+  // Number of bytes each client receives
+  const BYTES_PER_CLIENT = 256 * 1024;
+  let clients = [];
+  let startTime = 0;
+  // Start server
+  return test.startServer('BroadcastServer')
+  // Establish maximum number of connections
+  .then(() => {
+    for (let i = 0; i < MAX_CONNECTIONS; ++i) {
+      clients.push(test.newClient(Client));
+    }
+    return Promise.each(clients, (client) => {
+      return client.connect();
+    });
+  })
+  // Receive data on all connections concurrently
+  .then(() => {
+    startTime = Date.now();
+    return Promise.map(clients, (client) => {
+      return client.read(BYTES_PER_CLIENT);
+    });
+  })
+  .then(() => {
+    const sec = (Date.now() - startTime) / 1000;
+    console.log('Clients: %d, aggregate throughput: %d bytes/s', clients.length,
+        Math.round(clients.length * BYTES_PER_CLIENT / sec));
+  });
+};
+
 exports.MaxConnectionsTest = (test) => {
   let clients = [];
   // Start server
@@ -428,6 +428,46 @@ private:
 
 REGISTER_SERVER(EchoServer);
 
+// Server broadcasting a stream of data to all connected clients in the multi-client mode
+class BroadcastServer: public Server {
+public:
+    explicit BroadcastServer(const char* id, unsigned port) :
+            Server(id, port),
+            init_(false) {
+        for (size_t i = 0; i < sizeof(buf_); ++i) {
+            buf_[i] = 'a' + i % 26;
+        }
+    }
+
+protected:
+    virtual void run(TCPServer& server) override {
+        if (!init_) {
+            CHECK(server.setMaxClients(MAX_CLIENTS));
+            init_ = true;
+        }
+        server.poll(10);
+        // Discard the data sent by the clients
+        TCPClient client;
+        while ((client = server.available())) {
+            while (client.read((uint8_t*)tmp_, sizeof(tmp_)) > 0) {
+            }
+        }
+        if (server.clientCount() > 0) {
+            server.write((const uint8_t*)buf_, sizeof(buf_));
+        }
+    }
+
+private:
+    // Maximum number of TCP connections supported by the device (see client/tests.js)
+    static const size_t MAX_CLIENTS = 5;
+
+    char buf_[512];
+    char tmp_[128];
+    bool init_;
+};
+
+REGISTER_SERVER(BroadcastServer);
+
 // Test-specific servers (see client/tests.js)
 class TcpClientClosesOnDestructionTestServer: public Server {
 public:
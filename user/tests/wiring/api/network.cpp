@@ -70,6 +70,22 @@ test(api_tcpserver_write_timeout) {
     API_COMPILE(server.write((const uint8_t*)&server, sizeof(server), 123456));
 }
 
+test(api_tcpserver_multiple_clients) {
+    TCPServer server(1000);
+    bool ok = false;
+    int count = 0;
+    unsigned dropped = 0;
+    API_COMPILE(ok = server.setMaxClients(4));
+    API_COMPILE(ok = server.setMaxClients(4, 2048));
+    API_COMPILE(count = server.poll());
+    API_COMPILE(count = server.poll(100));
+    API_COMPILE(count = server.clientCount());
+    API_COMPILE(dropped = server.droppedClients());
+    (void)ok;
+    (void)count;
+    (void)dropped;
+}
+
 test(api_tcpclient_write_timeout) {
     TCPClient client;
     API_COMPILE(client.write(0xff, 123456));
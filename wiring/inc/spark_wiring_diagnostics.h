@@ -533,6 +533,70 @@ private:
     }
 };
 
+// Base abstract class for a data source containing a histogram
+class AbstractHistogramDiagnosticData: public AbstractTypeDiagnosticData<diag_histogram> {
+public:
+    static int get(DiagnosticDataId id, diag_histogram& val);
+    static int get(const diag_source* src, diag_histogram& val);
+
+    // Returns the index of the bucket that counts a given sample
+    static unsigned bucketIndex(uint32_t val);
+
+protected:
+    explicit AbstractHistogramDiagnosticData(DiagnosticDataId id, const char* name = nullptr);
+
+    virtual int get(diag_histogram& val) = 0;
+};
+
+// Histogram backed by lock-free counters. Samples can be recorded from any thread or ISR.
+// The sample count is derived from the bucket counters, so it is always consistent with them,
+// while the sum, minimum and maximum may include samples that are being recorded concurrently
+class HistogramDiagnosticData: public AbstractHistogramDiagnosticData {
+public:
+    explicit HistogramDiagnosticData(DiagnosticDataId id, const char* name = nullptr) :
+            AbstractHistogramDiagnosticData(id, name) {
+        reset();
+    }
+
+    void record(uint32_t val) {
+        buckets_[bucketIndex(val)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(val, std::memory_order_relaxed);
+        uint32_t cur = min_.load(std::memory_order_relaxed);
+        while (val < cur && !min_.compare_exchange_weak(cur, val, std::memory_order_relaxed)) {
+        }
+        cur = max_.load(std::memory_order_relaxed);
+        while (val > cur && !max_.compare_exchange_weak(cur, val, std::memory_order_relaxed)) {
+        }
+    }
+
+    void reset() {
+        for (auto& b: buckets_) {
+            b.store(0, std::memory_order_relaxed);
+        }
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(UINT32_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> buckets_[DIAG_HISTOGRAM_BUCKET_COUNT];
+    std::atomic<uint32_t> sum_;
+    std::atomic<uint32_t> min_;
+    std::atomic<uint32_t> max_;
+
+    virtual int get(diag_histogram& val) override { // AbstractHistogramDiagnosticData
+        val.count = 0;
+        for (unsigned i = 0; i < DIAG_HISTOGRAM_BUCKET_COUNT; ++i) {
+            val.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+            val.count += val.buckets[i];
+        }
+        val.sum = sum_.load(std::memory_order_relaxed);
+        val.min = val.count ? min_.load(std::memory_order_relaxed) : 0;
+        val.max = max_.load(std::memory_order_relaxed);
+        return SYSTEM_ERROR_NONE;
+    }
+};
+
 template<typename ValueT>
 class RetainedDiagnosticDataStorage {
 public:
@@ -693,4 +757,25 @@ inline int AbstractUnsignedIntegerDiagnosticData::get(const diag_source* src, In
     return AbstractTypeDiagnosticData<IntType>::get(src, val);
 }
 
+inline AbstractHistogramDiagnosticData::AbstractHistogramDiagnosticData(DiagnosticDataId id, const char* name) :
+        AbstractTypeDiagnosticData<diag_histogram>(id, name, DIAG_TYPE_HISTOGRAM) {
+}
+
+inline int AbstractHistogramDiagnosticData::get(DiagnosticDataId id, diag_histogram& val) {
+    return AbstractTypeDiagnosticData<diag_histogram>::get(id, val);
+}
+
+inline int AbstractHistogramDiagnosticData::get(const diag_source* src, diag_histogram& val) {
+    SPARK_ASSERT(src->type == DIAG_TYPE_HISTOGRAM);
+    return AbstractTypeDiagnosticData<diag_histogram>::get(src, val);
+}
+
+inline unsigned AbstractHistogramDiagnosticData::bucketIndex(uint32_t val) {
+    if (!val) {
+        return 0;
+    }
+    const unsigned i = 32 - __builtin_clz(val);
+    return (i < DIAG_HISTOGRAM_BUCKET_COUNT) ? i : DIAG_HISTOGRAM_BUCKET_COUNT - 1;
+}
+
 } // namespace particle
@@ -28,6 +28,7 @@
 
 #include "spark_wiring_ipaddress.h"
 #include "system_network.h"
+#include "spark_wiring_async.h"
 #include <chrono>
 
 namespace spark {
@@ -95,6 +96,8 @@ public:
     virtual bool listening();
     virtual NetworkClass& prefer(bool prefer = true);
     virtual bool isPreferred();
+    virtual NetworkClass& redundant(bool redundant = true);
+    virtual bool isRedundant();
 
     operator network_interface_t() const {
         return iface_;
@@ -104,6 +107,14 @@ public:
 
     virtual IPAddress resolve(const char* name, bool flushCache = false);
 
+    /**
+     * Resolve a host name without blocking the calling thread.
+     *
+     * The A and AAAA records are queried in parallel, and the result is shared with `resolve()`
+     * and the cloud connection through the system's DNS cache.
+     */
+    particle::Future<IPAddress> resolveAsync(const char* name, bool flushCache = false);
+
     explicit NetworkClass(network_interface_t iface)
             : iface_(iface) {
     }
@@ -31,6 +31,7 @@
 #include "spark_wiring_print.h"
 #include "spark_wiring_error.h"
 #include "system_tick_hal.h"
+#include <algorithm>
 
 // compatability macros for testing
 /*
@@ -50,6 +51,17 @@ class Stream : public Print
     int timedRead();    // private method to read stream with timeout
     int timedPeek();    // private method to peek stream with timeout
     int peekNextDigit(); // returns the next numeric digit in the stream or -1 if timeout
+    /**
+     * Reads the chars that are available without waiting.
+     *
+     * The default implementation calls read() for each char. Streams with direct access to their
+     * receive buffer should override this method to speed up readBytes().
+     *
+     * @param buffer Destination buffer.
+     * @param length Maximum number of chars to read.
+     * @return Number of chars read.
+     */
+    virtual size_t readAvailable(char *buffer, size_t length);
 
   public:
     virtual int available() = 0;
@@ -137,6 +149,14 @@ public:
   void flush() override {
   }
 
+protected:
+  size_t readAvailable(char* buffer, size_t size) override {
+    size = std::min(size, (size_t)(end_ - p_));
+    memcpy(buffer, p_, size);
+    p_ += size;
+    return size;
+  }
+
 private:
   const char* p_;
   const char* end_;
@@ -88,6 +88,9 @@ public:
     ~String(void);
 
     // memory management
+    // when a string is grown by concatenation, its capacity is increased
+    // geometrically so that appending in a loop takes amortized linear time.
+    // reserve() and resize() allocate exactly the requested size.
     // return true on success, false on failure (in which case, the string
     // is left unchanged).  reserve(0), if successful, will validate an
     // invalid string (i.e., "if (s)" will be true afterwards)
@@ -229,6 +232,7 @@ protected:
     void init(void);
     void invalidate(void);
     unsigned char changeBuffer(unsigned int maxStrLen);
+    unsigned char grow(unsigned int size);
 
     // copy and move
     String & copy(const char *cstr, unsigned int length);
@@ -37,6 +37,8 @@
 #define TCPCLIENT_BUF_MAX_SIZE  128
 /* 30 seconds */
 #define SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT (30000)
+/* Maximum time data can stay in the write buffer, in milliseconds */
+#define SPARK_WIRING_TCPCLIENT_DEFAULT_FLUSH_TIMEOUT (50)
 
 class TCPClient : public Client {
 
@@ -58,6 +60,56 @@ public:
     virtual int peek();
     virtual void flush();
     void flush_buffer();
+
+    /**
+     * Enable buffering of the outgoing data.
+     *
+     * Small writes, such as the ones made by `print()` and `printf()`, are collected in a buffer
+     * and sent together when the buffer is full, when `flush()` is called, before data is read
+     * from the client, when the client is stopped, or when a write is made after the oldest
+     * buffered byte has waited for longer than `flushTimeout` milliseconds. Writes that don't fit
+     * in the buffer are sent directly.
+     *
+     * An error that occurs while sending the buffered data is reported by the write or `flush()`
+     * call that caused the data to be sent.
+     *
+     * @param size Buffer size. If 0, any buffered data is sent and buffering is disabled.
+     * @param flushTimeout Maximum time data can stay in the buffer, in milliseconds.
+     * @return `true` on success, or `false` if the buffer cannot be allocated.
+     */
+    bool setWriteBuffer(size_t size, system_tick_t flushTimeout = SPARK_WIRING_TCPCLIENT_DEFAULT_FLUSH_TIMEOUT);
+
+    /**
+     * Set the size of the receive buffer.
+     *
+     * By default, data is received from the socket in chunks of up to `TCPCLIENT_BUF_MAX_SIZE`
+     * bytes. A larger buffer reduces the number of socket reads needed to receive a large amount
+     * of data. Any data in the current buffer is kept.
+     *
+     * @param size Buffer size.
+     * @return `true` on success, or `false` if the buffer cannot be allocated or the buffered data
+     *         doesn't fit in it.
+     */
+    bool setReceiveBuffer(size_t size);
+
+    /**
+     * Get a pointer to the received data.
+     *
+     * This method lets the application process the received data in place, without copying it.
+     * The data stays in the buffer until it's discarded with `consume()`. If the buffer is empty,
+     * it's refilled from the socket first.
+     *
+     * @param[out] data Pointer to the data.
+     * @return Number of bytes available at `data`.
+     */
+    int peekBuffer(const uint8_t** data);
+
+    /**
+     * Discard received data.
+     *
+     * @param size Number of bytes to discard.
+     */
+    void consume(size_t size);
     virtual void stop();
     virtual uint8_t connected();
     virtual operator bool();
@@ -75,9 +127,17 @@ private:
     struct Data {
         sock_handle_t sock;
         uint8_t buffer[TCPCLIENT_BUF_MAX_SIZE];
-        uint16_t offset;
-        uint16_t total;
+        std::unique_ptr<uint8_t[]> rxBufData;
+        uint8_t* rxBuf;
+        size_t rxBufSize;
+        size_t offset;
+        size_t total;
         IPAddress remoteIP;
+        std::unique_ptr<uint8_t[]> writeBuf;
+        size_t writeBufSize;
+        size_t writeBufLen;
+        system_tick_t writeBufTime;
+        system_tick_t flushTimeout;
 
         explicit Data(sock_handle_t sock);
         ~Data();
@@ -86,6 +146,9 @@ private:
     std::shared_ptr<Data> d_;
 
     inline int bufferCount();
+    int sendWriteBuffer(system_tick_t timeout, bool noWait = false);
+    void sendWriteBufferNoWait();
+    int sendData(const uint8_t* buffer, size_t size, system_tick_t timeout, bool noWait = false);
 };
 
 #endif
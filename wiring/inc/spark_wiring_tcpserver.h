@@ -29,14 +29,26 @@
 #include "spark_wiring.h"
 #include "system_network.h"
 
+#include <memory>
+
+/* Default size of the per-client send buffer in the multi-client mode */
+#define SPARK_WIRING_TCPSERVER_DEFAULT_CLIENT_BUFFER_SIZE (1024)
+
 class TCPClient;
 
 class TCPServer : public Print {
 private:
+    struct Clients;
+
     uint16_t _port;
     network_interface_t _nif;
     sock_handle_t _sock;
     TCPClient _client;
+    std::shared_ptr<Clients> _clients;
+
+    bool acceptClient();
+    void sendClientData(size_t index);
+    void closeClient(size_t index);
 
 public:
     TCPServer(uint16_t, network_interface_t nif=0);
@@ -49,6 +61,51 @@ public:
     virtual size_t write(uint8_t, system_tick_t timeout);
     virtual size_t write(const uint8_t *buf, size_t size, system_tick_t timeout);
     void stop();
+
+    /**
+     * Enable serving several clients at once.
+     *
+     * In this mode, the server keeps up to `maxClients` connections open and services all of them
+     * from `poll()` without blocking: new connections are accepted, and the data written to the
+     * server is queued in a per-client buffer of `bufferSize` bytes and sent to each peer as soon
+     * as its socket can take it. `write()` broadcasts the data to all connected clients. If a
+     * write doesn't fit in a client's buffer, that client is disconnected so that a slow peer
+     * doesn't hold up the others. The data is never dropped from the middle of a client's stream.
+     * A write returns 0 and sets the write error if the data couldn't be queued for any client.
+     * `available()` returns the next client that has data to read.
+     *
+     * This mode is only supported on platforms with POSIX sockets.
+     *
+     * @param maxClients Maximum number of clients. If 0, the multi-client mode is disabled.
+     * @param bufferSize Size of the per-client send buffer.
+     * @return `true` on success, or `false` if the mode is not supported or the buffers cannot
+     *         be allocated.
+     */
+    bool setMaxClients(size_t maxClients, size_t bufferSize = SPARK_WIRING_TCPSERVER_DEFAULT_CLIENT_BUFFER_SIZE);
+
+    /**
+     * Service the clients in the multi-client mode.
+     *
+     * Waits for at most `timeout` milliseconds for any of the sockets to become ready, then
+     * accepts pending connections, sends the queued data and releases the closed connections.
+     * `available()` and `write()` call this method with a zero timeout.
+     *
+     * @param timeout Maximum time to wait, in milliseconds.
+     * @return Number of connected clients, or -1 on error.
+     */
+    int poll(system_tick_t timeout = 0);
+
+    /**
+     * Get the number of connected clients in the multi-client mode.
+     */
+    size_t clientCount() const;
+
+    /**
+     * Get the number of clients disconnected in the multi-client mode because they didn't keep
+     * up with the written data.
+     */
+    unsigned droppedClients() const;
+
     using Print::write;
 };
 
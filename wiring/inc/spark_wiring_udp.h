@@ -201,6 +201,21 @@ public:
     virtual int read(char* buffer, size_t len) { return read((unsigned char*)buffer, len); };
     virtual int peek();
 
+    /**
+     * Get a pointer to the unread data of the received packet. Available after parsePacket().
+     *
+     * @param[out] data Pointer to the data.
+     * @return Number of bytes available at `data`.
+     */
+    int peekBuffer(const uint8_t** data);
+
+    /**
+     * Discard unread data of the received packet.
+     *
+     * @param size Number of bytes to discard.
+     */
+    void consume(size_t size);
+
     /**
      * Blocks until all data has been sent out
      */
@@ -53,6 +53,7 @@ public:
   virtual void flush(void);
   size_t write(uint16_t);
   virtual size_t write(uint8_t);
+  virtual size_t write(const uint8_t*, size_t);
 
   // LIN
   void breakTx(void);
@@ -74,6 +75,9 @@ public:
   }
 
   static USARTSerial& from(hal_usart_interface_t iface);
+
+protected:
+  virtual size_t readAvailable(char*, size_t);
 };
 
 #if Wiring_Serial2
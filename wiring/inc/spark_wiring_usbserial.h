@@ -52,6 +52,7 @@ public:
 	int peek();
 
 	virtual size_t write(uint8_t byte);
+	virtual size_t write(const uint8_t* buffer, size_t size);
 	virtual int read();
 	virtual int availableForWrite(void);
 	virtual int available();
@@ -91,6 +92,9 @@ public:
 
 	using Print::write;
 
+protected:
+	virtual size_t readAvailable(char* buffer, size_t size);
+
 private:
     HAL_USB_USART_Serial _serial;
 	bool _blocking;
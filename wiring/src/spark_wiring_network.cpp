@@ -121,55 +121,25 @@ bool NetworkClass::isPreferred() {
     return network_is_preferred(*this, nullptr);
 }
 
+NetworkClass& NetworkClass::redundant(bool redundant) {
+    network_handle_t network = network_redundant(*this, redundant, nullptr);
+    return Network.from(network);
+}
+
+bool NetworkClass::isRedundant() {
+    return network_is_redundant(*this, nullptr);
+}
+
 IPAddress NetworkClass::resolve(const char* name, bool flushCache) {
     IPAddress addr;
 #if HAL_USE_INET_HAL_POSIX
-    struct addrinfo *ai = nullptr;
-    struct addrinfo hints = {};
-    hints.ai_flags = AI_ADDRCONFIG;
-    if (flushCache) {
-        hints.ai_flags |= AI_FLUSHCACHE;
-    }
-    hints.ai_family = AF_UNSPEC;
-    if_t iface = nullptr;
-    if ((network_interface_t)*this != NETWORK_INTERFACE_ALL) {
-        if_get_by_index((network_interface_t)*this, &iface);
-    }
-    const int r = netdb_getaddrinfo_ex(name, nullptr, &hints, &ai, iface);
-    if (!r) {
-        bool ok = false;
-        // This is not really needed if AI_ADDRCONFIG is properly supported
-        bool ipv4 = network_ready(*this, NETWORK_READY_TYPE_IPV4, nullptr);
-        bool ipv6 = network_ready(*this, NETWORK_READY_TYPE_IPV6, nullptr);
-        for (auto cur = ai; cur != nullptr && !ok; cur = cur->ai_next) {
-            // NOTE: using only the first entry that matches the current state of IPv4/IPv6 connectivity
-            switch (cur->ai_family) {
-                case AF_INET: {
-                    if (!ipv4) {
-                        continue;
-                    }
-                    // NOTE: HAL_IPAddress is little-endian
-                    auto in = (struct sockaddr_in*)cur->ai_addr;
-                    addr = (const uint8_t*)(&in->sin_addr.s_addr);
-                    ok = true;
-                    break;
-                }
-                case AF_INET6: {
-                    if (!ipv6) {
-                        continue;
-                    }
-                    auto in6 = (struct sockaddr_in6*)cur->ai_addr;
-                    HAL_IPAddress a = {};
-                    a.v = 6;
-                    memcpy(a.ipv6, in6->sin6_addr.s6_addr, sizeof(a.ipv6));
-                    addr = IPAddress(a);
-                    ok = true;
-                    break;
-                }
-            }
-        }
+    // The system resolver only returns the addresses that match the current state of IPv4/IPv6
+    // connectivity, and shares its cache with the cloud connection and the socket wrappers
+    HAL_IPAddress a = {};
+    const unsigned flags = flushCache ? NETWORK_RESOLVE_FLAG_FLUSH_CACHE : NETWORK_RESOLVE_FLAG_NONE;
+    if (network_resolve(*this, name, &a, 1, flags, nullptr) > 0) {
+        addr = IPAddress(a);
     }
-    freeaddrinfo(ai);
 #else
 
     // Compatibility calls into interface-specific methods for platforms
@@ -184,6 +154,31 @@ IPAddress NetworkClass::resolve(const char* name, bool flushCache) {
     return addr;
 }
 
+namespace {
+
+void resolveCompletionCallback(int error, const void* data, void* callbackData, void* reserved) {
+    auto p = particle::Promise<IPAddress>::fromDataPtr(callbackData);
+    if (error != particle::Error::NONE) {
+        p.setError(particle::Error((particle::Error::Type)error));
+    } else {
+        p.setResult(IPAddress(*static_cast<const HAL_IPAddress*>(data)));
+    }
+}
+
+} // namespace
+
+particle::Future<IPAddress> NetworkClass::resolveAsync(const char* name, bool flushCache) {
+    particle::Promise<IPAddress> p;
+    const auto data = p.dataPtr();
+    const unsigned flags = flushCache ? NETWORK_RESOLVE_FLAG_FLUSH_CACHE : NETWORK_RESOLVE_FLAG_NONE;
+    const int r = network_resolve_async(*this, name, flags, resolveCompletionCallback, data, nullptr);
+    if (r < 0) {
+        p.fromDataPtr(data); // Free wrapper object
+        p.setError(particle::Error((particle::Error::Type)r));
+    }
+    return p.future();
+}
+
 #if HAL_USE_SOCKET_HAL_POSIX
 
 int NetworkClass::ping(IPAddress remoteIP, unsigned nTries, unsigned timeoutMs) {
@@ -61,6 +61,18 @@ int Stream::timedPeek()
   return -1;     // -1 indicates timeout
 }
 
+// reads the chars that are immediately available, one at a time
+size_t Stream::readAvailable(char *buffer, size_t length)
+{
+  size_t count = 0;
+  while (count < length) {
+    int c = read();
+    if (c < 0) break;
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
 // returns peek of the next digit in the stream or -1 if timeout
 // discards non-numeric characters
 int Stream::peekNextDigit()
@@ -242,13 +254,17 @@ size_t Stream::readBytes(char *buffer, size_t length)
     {
         return 0;
     }
+  // same timeout semantics as timedRead(): the timer restarts whenever new data arrives
   size_t count = 0;
-  while (count < length) {
-    int c = timedRead();
-    if (c < 0) break;
-    *buffer++ = (char)c;
-    count++;
-  }
+  size_t n = 0;
+  _startMillis = millis();
+  do {
+    n = readAvailable(buffer + count, length - count);
+    if (n > 0) {
+      count += n;
+      _startMillis = millis();
+    }
+  } while (count < length && (n > 0 || millis() - _startMillis < _timeout));
   return count;
 }
 
@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <charconv>
 #include <cstring>
+#include <algorithm>
 #include "string_convert.h"
 
 using namespace particle;
@@ -257,6 +258,22 @@ bool String::resize(size_t size) {
     return true;
 }
 
+unsigned char String::grow(unsigned int size)
+{
+    if (buffer && capacity_ >= size) {
+        return 1;
+    }
+    // grow by 1.5x when appending to an existing string, but fall back to
+    // the exact size if the larger allocation fails
+    if (buffer && size <= (UINT_MAX - 1) - size / 2) {
+        const unsigned int n = std::max(size, capacity_ + capacity_ / 2);
+        if (reserve(n)) {
+            return 1;
+        }
+    }
+    return reserve(size);
+}
+
 unsigned char String::changeBuffer(unsigned int maxStrLen)
 {
     char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
@@ -392,7 +409,7 @@ unsigned char String::concat(const char *cstr, unsigned int length)
     if (length == 0) {
         return 1;
     }
-    if (!reserve(newlen)) {
+    if (!grow(newlen)) {
         return 0;
     }
     memcpy(buffer + len, cstr, length);
@@ -31,11 +31,17 @@
 
 #include "spark_wiring_tcpclient.h"
 #include "spark_wiring_network.h"
+#include "spark_wiring_ticks.h"
 #include "system_task.h"
 #include "socket_hal.h"
 #include "inet_hal.h"
 #include "spark_macros.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
 using namespace spark;
 
 static bool inline isOpen(sock_handle_t sd)
@@ -130,7 +136,33 @@ size_t TCPClient::write(uint8_t b, system_tick_t timeout)
 size_t TCPClient::write(const uint8_t *buffer, size_t size, system_tick_t timeout)
 {
     clearWriteError();
-    int ret = status() ? socket_send_ex(d_->sock, buffer, size, 0, timeout, nullptr) : -1;
+    int ret = 0;
+    if (!d_->writeBufSize) {
+        ret = sendData(buffer, size, timeout);
+    } else if (d_->writeBufLen + size > d_->writeBufSize && (ret = sendWriteBuffer(timeout)) < 0) {
+        // Failed to send the buffered data
+    } else if (!d_->writeBufLen && size > d_->writeBufSize) {
+        // The data doesn't fit in the buffer
+        ret = sendData(buffer, size, timeout);
+    } else if (d_->writeBufLen < d_->writeBufSize) {
+        // Buffer as much of the data as fits if the buffered data could be sent only partially
+        const size_t n = std::min(size, d_->writeBufSize - d_->writeBufLen);
+        if (!d_->writeBufLen) {
+            d_->writeBufTime = millis();
+        }
+        memcpy(d_->writeBuf.get() + d_->writeBufLen, buffer, n);
+        d_->writeBufLen += n;
+        ret = n;
+        if (d_->writeBufLen == d_->writeBufSize || millis() - d_->writeBufTime >= d_->flushTimeout) {
+            const int r = sendWriteBuffer(timeout);
+            if (r < 0) {
+                ret = r;
+            }
+        }
+    } else {
+        // None of the buffered data could be sent within the timeout
+        ret = -ETIMEDOUT;
+    }
     if (ret < 0) {
         setWriteError(ret);
     }
@@ -141,6 +173,69 @@ size_t TCPClient::write(const uint8_t *buffer, size_t size, system_tick_t timeou
     return ret;
 }
 
+int TCPClient::sendData(const uint8_t* buffer, size_t size, system_tick_t timeout, bool noWait)
+{
+    const uint32_t flags = noWait ? SOCKET_SEND_NO_WAIT : 0;
+    return status() ? socket_send_ex(d_->sock, buffer, size, flags, timeout, nullptr) : -1;
+}
+
+int TCPClient::sendWriteBuffer(system_tick_t timeout, bool noWait)
+{
+    size_t offset = 0;
+    int ret = 0;
+    while (offset < d_->writeBufLen) {
+        ret = sendData(d_->writeBuf.get() + offset, d_->writeBufLen - offset, timeout, noWait);
+        if (ret <= 0) {
+            break;
+        }
+        offset += ret;
+    }
+    if (ret < 0) {
+        // The connection is no longer usable
+        d_->writeBufLen = 0;
+        return ret;
+    }
+    if (offset > 0) {
+        d_->writeBufLen -= offset;
+        memmove(d_->writeBuf.get(), d_->writeBuf.get() + offset, d_->writeBufLen);
+        d_->writeBufTime = millis();
+    }
+    return 0;
+}
+
+// Reading from the client shouldn't block until the buffered data is sent
+void TCPClient::sendWriteBufferNoWait()
+{
+    if (d_->writeBufLen) {
+        const int ret = sendWriteBuffer(0 /* timeout */, true /* noWait */);
+        if (ret < 0) {
+            setWriteError(ret);
+        }
+    }
+}
+
+bool TCPClient::setWriteBuffer(size_t size, system_tick_t flushTimeout)
+{
+    sendWriteBuffer(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+    if (d_->writeBufLen > size) {
+        return false;
+    }
+    std::unique_ptr<uint8_t[]> buf;
+    if (size > 0) {
+        buf.reset(new(std::nothrow) uint8_t[size]);
+        if (!buf) {
+            return false;
+        }
+        if (d_->writeBufLen) {
+            memcpy(buf.get(), d_->writeBuf.get(), d_->writeBufLen);
+        }
+    }
+    d_->writeBuf = std::move(buf);
+    d_->writeBufSize = size;
+    d_->flushTimeout = flushTimeout;
+    return true;
+}
+
 int TCPClient::bufferCount()
 {
   return d_->total - d_->offset;
@@ -150,6 +245,9 @@ int TCPClient::available()
 {
     int avail = 0;
 
+    // Send the pending request before waiting for the response
+    sendWriteBufferNoWait();
+
     // At EOB => Flush it
     if (d_->total && (d_->offset == d_->total))
     {
@@ -158,10 +256,17 @@ int TCPClient::available()
 
     if(Network.from(nif_).ready() && isOpen(d_->sock))
     {
+        // Make room at the end of the buffer if most of it has been consumed
+        if (d_->offset > 0 && d_->rxBufSize - d_->total < d_->rxBufSize / 2)
+        {
+            d_->total -= d_->offset;
+            memmove(d_->rxBuf, d_->rxBuf + d_->offset, d_->total);
+            d_->offset = 0;
+        }
         // Have room
-        if ( d_->total < arraySize(d_->buffer))
+        if ( d_->total < d_->rxBufSize)
         {
-            int ret = socket_receive(d_->sock, d_->buffer + d_->total , arraySize(d_->buffer)-d_->total, 0);
+            int ret = socket_receive(d_->sock, d_->rxBuf + d_->total , d_->rxBufSize - d_->total, 0);
             if (ret > 0)
             {
                 DEBUG("recv(=%d)",ret);
@@ -176,7 +281,7 @@ int TCPClient::available()
 
 int TCPClient::read()
 {
-  return (bufferCount() || available()) ? d_->buffer[d_->offset++] : -1;
+  return (bufferCount() || available()) ? d_->rxBuf[d_->offset++] : -1;
 }
 
 int TCPClient::read(uint8_t *buffer, size_t size)
@@ -186,18 +291,70 @@ int TCPClient::read(uint8_t *buffer, size_t size)
         return -1;
     }
         int read = -1;
-        if (bufferCount() || available())
+        if (!bufferCount() && size >= d_->rxBufSize && Network.from(nif_).ready() && isOpen(d_->sock))
+        {
+          // Receive directly into the caller's buffer
+          sendWriteBufferNoWait();
+          const int ret = socket_receive(d_->sock, buffer, size, 0);
+          if (ret > 0)
+          {
+            read = ret;
+          }
+        }
+        else if (bufferCount() || available())
         {
           read = (size > (size_t) bufferCount()) ? bufferCount() : size;
-          memcpy(buffer, &d_->buffer[d_->offset], read);
+          memcpy(buffer, &d_->rxBuf[d_->offset], read);
           d_->offset += read;
         }
         return read;
 }
 
+int TCPClient::peekBuffer(const uint8_t** data)
+{
+    const int avail = (bufferCount() || available()) ? bufferCount() : 0;
+    if (data)
+    {
+        *data = d_->rxBuf + d_->offset;
+    }
+    return avail;
+}
+
+void TCPClient::consume(size_t size)
+{
+    d_->offset += std::min(size, (size_t)bufferCount());
+}
+
+bool TCPClient::setReceiveBuffer(size_t size)
+{
+    const size_t count = bufferCount();
+    if (size == 0 || size < count)
+    {
+        return false;
+    }
+    std::unique_ptr<uint8_t[]> buf;
+    uint8_t* p = d_->buffer;
+    if (size > arraySize(d_->buffer))
+    {
+        buf.reset(new(std::nothrow) uint8_t[size]);
+        if (!buf)
+        {
+            return false;
+        }
+        p = buf.get();
+    }
+    memmove(p, d_->rxBuf + d_->offset, count);
+    d_->rxBufData = std::move(buf);
+    d_->rxBuf = p;
+    d_->rxBufSize = size;
+    d_->offset = 0;
+    d_->total = count;
+    return true;
+}
+
 int TCPClient::peek()
 {
-  return  (bufferCount() || available()) ? d_->buffer[d_->offset] : -1;
+  return  (bufferCount() || available()) ? d_->rxBuf[d_->offset] : -1;
 }
 
 void TCPClient::flush_buffer()
@@ -208,6 +365,16 @@ void TCPClient::flush_buffer()
 
 void TCPClient::flush()
 {
+    if (d_->writeBufLen)
+    {
+        clearWriteError();
+        const int ret = sendWriteBuffer(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+        if (ret < 0) {
+            setWriteError(ret);
+        } else if (d_->writeBufLen) {
+            setWriteError(-ETIMEDOUT);
+        }
+    }
 }
 
 
@@ -216,6 +383,16 @@ void TCPClient::stop()
   // This log line pollutes the log too much
   // DEBUG("sock %d closesocket", d_->sock);
 
+  if (d_->writeBufLen) {
+      const int ret = sendWriteBuffer(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+      if (ret < 0) {
+          setWriteError(ret);
+      } else if (d_->writeBufLen) {
+          setWriteError(-ETIMEDOUT);
+      }
+  }
+  d_->writeBufLen = 0;
+
   if (isOpen(d_->sock))
       socket_close(d_->sock);
   d_->sock = socket_handle_invalid();
@@ -256,8 +433,14 @@ IPAddress TCPClient::remoteIP()
 
 TCPClient::Data::Data(sock_handle_t sock)
         : sock(sock),
+          rxBuf(buffer),
+          rxBufSize(TCPCLIENT_BUF_MAX_SIZE),
           offset(0),
-          total(0) {
+          total(0),
+          writeBufSize(0),
+          writeBufLen(0),
+          writeBufTime(0),
+          flushTimeout(SPARK_WIRING_TCPCLIENT_DEFAULT_FLUSH_TIMEOUT) {
 }
 
 TCPClient::Data::~Data() {
@@ -34,6 +34,11 @@
 #include <arpa/inet.h>
 #include "spark_wiring_constants.h"
 #include "spark_wiring_posix_common.h"
+#include "spark_wiring_ticks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
 
 using namespace spark;
 
@@ -52,34 +57,12 @@ TCPClient::TCPClient(sock_handle_t sock)
 
 // return 0 on error, 1 on success
 int TCPClient::connect(const char* host, uint16_t port, network_interface_t nif) {
-    Log.info("Attempting to connect to host: %s on port: %d", host, port);
-
-    // Example: Add logic to handle network state transitions
-    if (Network.ready()) {
-        Log.info("Network is ready. Proceeding with connection.");
-    } else {
-        Log.warn("Network is not ready. Cannot proceed with connection.");
-        return SYSTEM_ERROR_NETWORK_DOWN;
-    }
-
     stop();
 
-    struct addrinfo* ais = nullptr;
-    SCOPE_GUARD({
-        netdb_freeaddrinfo(ais);
-    });
-    CHECK_TRUE(netdb_getaddrinfo(host, nullptr, nullptr, &ais) == 0, 0); // return 0
-
-    // FIXME: for now using only the first entry
-    if (ais && ais->ai_addr) {
-        IPAddress addr;
-        detail::sockaddrToIpAddressPort(ais->ai_addr, addr, nullptr);
-        if (addr) {
-            return connect(addr, port, nif);
-        }
-    }
-
-    return 0; // error, could not connect
+    // Reconnecting to a known host doesn't wait for a DNS round trip
+    HAL_IPAddress addr = {};
+    CHECK_TRUE(network_resolve(nif, host, &addr, 1, 0 /* flags */, nullptr) > 0, 0); // return 0
+    return connect(IPAddress(addr), port, nif);
 }
 
 // return 0 on error, 1 on success
@@ -143,26 +126,123 @@ size_t TCPClient::write(uint8_t b, system_tick_t timeout) {
 
 size_t TCPClient::write(const uint8_t *buffer, size_t size, system_tick_t timeout) {
     clearWriteError();
-    struct timeval tv = {};
-    if (timeout != SOCKET_WAIT_FOREVER) {
-        tv.tv_sec = timeout / 1000;
-        tv.tv_usec = (timeout % 1000) * 1000;
+    int ret = 0;
+    if (!d_->writeBufSize) {
+        ret = sendData(buffer, size, timeout);
+    } else if (d_->writeBufLen + size > d_->writeBufSize && (ret = sendWriteBuffer(timeout)) < 0) {
+        // Failed to send the buffered data
+    } else if (!d_->writeBufLen && size > d_->writeBufSize) {
+        // The data doesn't fit in the buffer
+        ret = sendData(buffer, size, timeout);
+    } else if (d_->writeBufLen < d_->writeBufSize) {
+        // Buffer as much of the data as fits if the buffered data could be sent only partially
+        const size_t n = std::min(size, d_->writeBufSize - d_->writeBufLen);
+        if (!d_->writeBufLen) {
+            d_->writeBufTime = millis();
+        }
+        memcpy(d_->writeBuf.get() + d_->writeBufLen, buffer, n);
+        d_->writeBufLen += n;
+        ret = n;
+        if (d_->writeBufLen == d_->writeBufSize || millis() - d_->writeBufTime >= d_->flushTimeout) {
+            const int r = sendWriteBuffer(timeout);
+            if (r < 0) {
+                ret = r;
+            }
+        }
+    } else {
+        // None of the buffered data could be sent within the timeout
+        ret = -ETIMEDOUT;
     }
-    int ret = sock_setsockopt(d_->sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
     if (ret < 0) {
-        setWriteError(errno);
+        setWriteError(-ret);
         return 0;
     }
 
-    ret = sock_send(d_->sock, buffer, size, 0);
+    return ret;
+}
+
+int TCPClient::sendData(const uint8_t* buffer, size_t size, system_tick_t timeout, bool noWait) {
+    int flags = 0;
+    if (noWait) {
+        flags = MSG_DONTWAIT;
+    } else {
+        struct timeval tv = {};
+        if (timeout != SOCKET_WAIT_FOREVER) {
+            tv.tv_sec = timeout / 1000;
+            tv.tv_usec = (timeout % 1000) * 1000;
+        }
+        int ret = sock_setsockopt(d_->sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (ret < 0) {
+            return -errno;
+        }
+    }
+
+    int ret = sock_send(d_->sock, buffer, size, flags);
     if (ret < 0) {
-        setWriteError(errno);
-        return 0;
+        return -errno;
     }
 
     return ret;
 }
 
+int TCPClient::sendWriteBuffer(system_tick_t timeout, bool noWait) {
+    size_t offset = 0;
+    int ret = 0;
+    while (offset < d_->writeBufLen) {
+        ret = sendData(d_->writeBuf.get() + offset, d_->writeBufLen - offset, timeout, noWait);
+        if (ret <= 0) {
+            break;
+        }
+        offset += ret;
+    }
+    if (ret == -EAGAIN || ret == -EWOULDBLOCK) {
+        // The send buffer of the socket is full, keep the remaining data
+        ret = 0;
+    }
+    if (ret < 0) {
+        // The connection is no longer usable
+        d_->writeBufLen = 0;
+        return ret;
+    }
+    if (offset > 0) {
+        d_->writeBufLen -= offset;
+        memmove(d_->writeBuf.get(), d_->writeBuf.get() + offset, d_->writeBufLen);
+        d_->writeBufTime = millis();
+    }
+    return 0;
+}
+
+// Reading from the client shouldn't block until the buffered data is sent
+void TCPClient::sendWriteBufferNoWait() {
+    if (d_->writeBufLen) {
+        const int ret = sendWriteBuffer(0 /* timeout */, true /* noWait */);
+        if (ret < 0) {
+            setWriteError(-ret);
+        }
+    }
+}
+
+bool TCPClient::setWriteBuffer(size_t size, system_tick_t flushTimeout) {
+    sendWriteBuffer(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+    if (d_->writeBufLen > size) {
+        return false;
+    }
+    std::unique_ptr<uint8_t[]> buf;
+    if (size > 0) {
+        buf.reset(new(std::nothrow) uint8_t[size]);
+        if (!buf) {
+            return false;
+        }
+        if (d_->writeBufLen) {
+            memcpy(buf.get(), d_->writeBuf.get(), d_->writeBufLen);
+        }
+    }
+    d_->writeBuf = std::move(buf);
+    d_->writeBufSize = size;
+    d_->flushTimeout = flushTimeout;
+    return true;
+}
+
 int TCPClient::bufferCount() {
     return d_->total - d_->offset;
 }
@@ -171,26 +251,36 @@ int TCPClient::available()
 {
     int avail = 0;
 
+    // Send the pending request before waiting for the response
+    sendWriteBufferNoWait();
+
     // At EOB => Flush it
     if (d_->total && (d_->offset == d_->total)) {
         flush_buffer();
     }
 
     if (isOpen(d_->sock)) {
+        // Make room at the end of the buffer if most of it has been consumed
+        if (d_->offset > 0 && d_->rxBufSize - d_->total < d_->rxBufSize / 2) {
+            d_->total -= d_->offset;
+            memmove(d_->rxBuf, d_->rxBuf + d_->offset, d_->total);
+            d_->offset = 0;
+        }
         // Have room
-        if (d_->total < arraySize(d_->buffer)) {
-            int ret = sock_recv(d_->sock, d_->buffer + d_->total, arraySize(d_->buffer) - d_->total, MSG_DONTWAIT);
+        if (d_->total < d_->rxBufSize) {
+            int ret = sock_recv(d_->sock, d_->rxBuf + d_->total, d_->rxBufSize - d_->total, MSG_DONTWAIT);
             if (ret > 0) {
                 if (d_->total == 0) {
                     d_->offset = 0;
                 }
                 d_->total += ret;
-            } else {
-                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            } else if (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                // A return value of 0 means the peer has closed the connection
+                if (ret < 0) {
                     LOG(ERROR, "recv error = %d", errno);
-                    sock_close(d_->sock);
-                    d_->sock = -1;
                 }
+                sock_close(d_->sock);
+                d_->sock = -1;
             }
         } // Have Space
     } // isOpen(d_->sock)
@@ -199,21 +289,72 @@ int TCPClient::available()
 }
 
 int TCPClient::read() {
-    return (bufferCount() || available()) ? d_->buffer[d_->offset++] : -1;
+    return (bufferCount() || available()) ? d_->rxBuf[d_->offset++] : -1;
 }
 
 int TCPClient::read(uint8_t *buffer, size_t size) {
+    if (!buffer || size == 0) {
+        return -1;
+    }
     int read = -1;
-    if (bufferCount() || available()) {
+    if (!bufferCount() && size >= d_->rxBufSize && isOpen(d_->sock)) {
+        // Receive directly into the caller's buffer
+        sendWriteBufferNoWait();
+        const int ret = sock_recv(d_->sock, buffer, size, MSG_DONTWAIT);
+        if (ret > 0) {
+            read = ret;
+        } else if (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            if (ret < 0) {
+                LOG(ERROR, "recv error = %d", errno);
+            }
+            sock_close(d_->sock);
+            d_->sock = -1;
+        }
+    } else if (bufferCount() || available()) {
         read = (size > (size_t) bufferCount()) ? bufferCount() : size;
-        memcpy(buffer, &d_->buffer[d_->offset], read);
+        memcpy(buffer, &d_->rxBuf[d_->offset], read);
         d_->offset += read;
     }
     return read;
 }
 
 int TCPClient::peek() {
-    return (bufferCount() || available()) ? d_->buffer[d_->offset] : -1;
+    return (bufferCount() || available()) ? d_->rxBuf[d_->offset] : -1;
+}
+
+int TCPClient::peekBuffer(const uint8_t** data) {
+    const int avail = (bufferCount() || available()) ? bufferCount() : 0;
+    if (data) {
+        *data = d_->rxBuf + d_->offset;
+    }
+    return avail;
+}
+
+void TCPClient::consume(size_t size) {
+    d_->offset += std::min(size, (size_t)bufferCount());
+}
+
+bool TCPClient::setReceiveBuffer(size_t size) {
+    const size_t count = bufferCount();
+    if (size == 0 || size < count) {
+        return false;
+    }
+    std::unique_ptr<uint8_t[]> buf;
+    uint8_t* p = d_->buffer;
+    if (size > arraySize(d_->buffer)) {
+        buf.reset(new(std::nothrow) uint8_t[size]);
+        if (!buf) {
+            return false;
+        }
+        p = buf.get();
+    }
+    memmove(p, d_->rxBuf + d_->offset, count);
+    d_->rxBufData = std::move(buf);
+    d_->rxBuf = p;
+    d_->rxBufSize = size;
+    d_->offset = 0;
+    d_->total = count;
+    return true;
 }
 
 void TCPClient::flush_buffer() {
@@ -222,9 +363,27 @@ void TCPClient::flush_buffer() {
 }
 
 void TCPClient::flush() {
+    if (d_->writeBufLen) {
+        clearWriteError();
+        const int ret = sendWriteBuffer(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+        if (ret < 0) {
+            setWriteError(-ret);
+        } else if (d_->writeBufLen) {
+            setWriteError(ETIMEDOUT);
+        }
+    }
 }
 
 void TCPClient::stop() {
+    if (d_->writeBufLen) {
+        const int ret = sendWriteBuffer(SPARK_WIRING_TCPCLIENT_DEFAULT_SEND_TIMEOUT);
+        if (ret < 0) {
+            setWriteError(-ret);
+        } else if (d_->writeBufLen) {
+            setWriteError(ETIMEDOUT);
+        }
+    }
+    d_->writeBufLen = 0;
     if (isOpen(d_->sock)) {
         sock_close(d_->sock);
     }
@@ -258,8 +417,14 @@ IPAddress TCPClient::remoteIP() {
 
 TCPClient::Data::Data(sock_handle_t sock)
         : sock(sock),
+          rxBuf(buffer),
+          rxBufSize(TCPCLIENT_BUF_MAX_SIZE),
           offset(0),
-          total(0) {
+          total(0),
+          writeBufSize(0),
+          writeBufLen(0),
+          writeBufTime(0),
+          flushTimeout(SPARK_WIRING_TCPCLIENT_DEFAULT_FLUSH_TIMEOUT) {
 }
 
 TCPClient::Data::~Data() {
@@ -122,6 +122,27 @@ TCPClient TCPServer::available()
     return _client;
 }
 
+// The multi-client mode requires non-blocking accept() and poll(), which socket_hal_compat doesn't provide
+bool TCPServer::setMaxClients(size_t maxClients, size_t bufferSize)
+{
+    return maxClients == 0;
+}
+
+int TCPServer::poll(system_tick_t timeout)
+{
+    return -1;
+}
+
+size_t TCPServer::clientCount() const
+{
+    return 0;
+}
+
+unsigned TCPServer::droppedClients() const
+{
+    return 0;
+}
+
 size_t TCPServer::write(uint8_t b, system_tick_t timeout)
 {
     return write(&b, sizeof(b), timeout);
@@ -36,10 +36,31 @@
 #include "spark_wiring_thread.h"
 #include "spark_wiring_posix_common.h"
 
+#include <cstring>
+#include <new>
+
 using namespace spark;
 
 static TCPClient* s_invalid_client = nullptr;
 
+struct TCPServer::Clients {
+    struct Slot {
+        TCPClient client;
+        sock_handle_t sock = -1;
+        std::unique_ptr<uint8_t[]> buf; // Send buffer
+        size_t len = 0; // Number of bytes in the send buffer
+        bool readable = false;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::unique_ptr<struct pollfd[]> fds; // One entry per client plus the listening socket
+    size_t maxClients = 0;
+    size_t bufferSize = 0;
+    size_t count = 0; // Number of connected clients
+    size_t next = 0; // Client to check first in available()
+    unsigned dropped = 0; // Number of clients disconnected because their buffer was full
+};
+
 class TCPServerClient : public TCPClient {
 public:
     TCPServerClient(sock_handle_t sock) : TCPClient(sock) {
@@ -130,12 +151,36 @@ bool TCPServer::begin() {
 }
 
 void TCPServer::stop() {
+    if (_clients) {
+        for (size_t i = 0; i < _clients->maxClients; ++i) {
+            closeClient(i);
+        }
+    }
     _client.stop();
     sock_close(_sock);
     _sock = -1;
 }
 
 TCPClient TCPServer::available() {
+    if (_clients) {
+        poll(0);
+        auto& c = *_clients;
+        for (size_t i = 0; i < c.maxClients; ++i) {
+            const size_t index = (c.next + i) % c.maxClients;
+            auto& slot = c.slots[index];
+            if (slot.sock < 0 || !slot.readable) {
+                continue;
+            }
+            if (slot.client.available() > 0) {
+                // Let the other clients go first next time
+                c.next = (index + 1) % c.maxClients;
+                return slot.client;
+            }
+            slot.readable = false;
+        }
+        return *s_invalid_client;
+    }
+
     if (_sock < 0) {
         begin();
     }
@@ -162,11 +207,215 @@ TCPClient TCPServer::available() {
     return _client;
 }
 
+bool TCPServer::setMaxClients(size_t maxClients, size_t bufferSize) {
+    if (_clients) {
+        for (size_t i = 0; i < _clients->maxClients; ++i) {
+            closeClient(i);
+        }
+        _clients.reset();
+    }
+    if (maxClients == 0) {
+        return true;
+    }
+    auto c = std::make_shared<Clients>();
+    c->slots.reset(new(std::nothrow) Clients::Slot[maxClients]);
+    c->fds.reset(new(std::nothrow) struct pollfd[maxClients + 1]);
+    if (!c->slots || !c->fds) {
+        return false;
+    }
+    for (size_t i = 0; i < maxClients; ++i) {
+        c->slots[i].buf.reset(new(std::nothrow) uint8_t[bufferSize]);
+        if (!c->slots[i].buf) {
+            return false;
+        }
+    }
+    c->maxClients = maxClients;
+    c->bufferSize = bufferSize;
+    _clients = std::move(c);
+    return true;
+}
+
+int TCPServer::poll(system_tick_t timeout) {
+    if (!_clients) {
+        return -1;
+    }
+    if (_sock < 0 && !begin()) {
+        return -1;
+    }
+    auto& c = *_clients;
+    // Release the connections closed by the application
+    for (size_t i = 0; i < c.maxClients; ++i) {
+        if (c.slots[i].sock >= 0 && !c.slots[i].client.status()) {
+            closeClient(i);
+        }
+    }
+    // The listening socket is only polled while there's room for another client
+    nfds_t nfds = 0;
+    if (c.count < c.maxClients) {
+        c.fds[nfds].fd = _sock;
+        c.fds[nfds].events = POLLIN;
+        c.fds[nfds].revents = 0;
+        ++nfds;
+    }
+    for (size_t i = 0; i < c.maxClients; ++i) {
+        const auto& slot = c.slots[i];
+        if (slot.sock >= 0) {
+            c.fds[nfds].fd = slot.sock;
+            c.fds[nfds].events = POLLIN | (slot.len ? POLLOUT : 0);
+            c.fds[nfds].revents = 0;
+            ++nfds;
+        }
+    }
+    const int r = sock_poll(c.fds.get(), nfds, timeout);
+    if (r < 0) {
+        return -1;
+    }
+    if (r > 0) {
+        nfds_t n = 0;
+        if (c.count < c.maxClients) {
+            if (c.fds[n].revents & POLLIN) {
+                while (c.count < c.maxClients && acceptClient()) {
+                }
+            }
+            ++n;
+        }
+        for (size_t i = 0; i < c.maxClients && n < nfds; ++i) {
+            auto& slot = c.slots[i];
+            if (slot.sock < 0 || slot.sock != c.fds[n].fd) {
+                // Skip free slots and the clients accepted during this iteration
+                continue;
+            }
+            const short revents = c.fds[n++].revents;
+            if (revents & (POLLERR | POLLNVAL)) {
+                closeClient(i);
+                continue;
+            }
+            if (revents & (POLLIN | POLLHUP)) {
+                // The application reads the remaining data and detects the end of the stream
+                slot.readable = true;
+            }
+            if (revents & POLLOUT) {
+                sendClientData(i);
+            }
+        }
+    }
+    return c.count;
+}
+
+size_t TCPServer::clientCount() const {
+    return _clients ? _clients->count : 0;
+}
+
+unsigned TCPServer::droppedClients() const {
+    return _clients ? _clients->dropped : 0;
+}
+
+bool TCPServer::acceptClient() {
+    auto& c = *_clients;
+    const int s = sock_accept(_sock, nullptr, nullptr);
+    if (s < 0) {
+        return false;
+    }
+    for (size_t i = 0; i < c.maxClients; ++i) {
+        auto& slot = c.slots[i];
+        if (slot.sock < 0) {
+            TCPServerClient client(s);
+            client.d_->remoteIP = client.remoteIP();
+            slot.client = client;
+            slot.sock = s;
+            slot.len = 0;
+            slot.readable = false;
+            ++c.count;
+            return true;
+        }
+    }
+    sock_close(s);
+    return false;
+}
+
+void TCPServer::sendClientData(size_t index) {
+    auto& slot = _clients->slots[index];
+    size_t offset = 0;
+    while (offset < slot.len) {
+        const int r = sock_send(slot.sock, slot.buf.get() + offset, slot.len - offset, MSG_DONTWAIT);
+        if (r < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeClient(index);
+                return;
+            }
+            break;
+        }
+        offset += r;
+    }
+    slot.len -= offset;
+    memmove(slot.buf.get(), slot.buf.get() + offset, slot.len);
+}
+
+void TCPServer::closeClient(size_t index) {
+    auto& slot = _clients->slots[index];
+    if (slot.sock < 0) {
+        return;
+    }
+    slot.client.stop();
+    slot.client = *s_invalid_client;
+    slot.sock = -1;
+    slot.len = 0;
+    slot.readable = false;
+    --_clients->count;
+}
+
 size_t TCPServer::write(uint8_t b, system_tick_t timeout) {
     return write(&b, sizeof(b), timeout);
 }
 
 size_t TCPServer::write(const uint8_t *buf, size_t size, system_tick_t timeout) {
+    if (_clients) {
+        clearWriteError();
+        poll(0);
+        auto& c = *_clients;
+        size_t delivered = 0;
+        size_t dropped = 0;
+        for (size_t i = 0; i < c.maxClients; ++i) {
+            auto& slot = c.slots[i];
+            if (slot.sock < 0) {
+                continue;
+            }
+            const uint8_t* data = buf;
+            size_t n = size;
+            if (!slot.len && n > c.bufferSize) {
+                // Send what the socket can take right away so that a write larger than the buffer
+                // doesn't disconnect a client that keeps up
+                const int r = sock_send(slot.sock, data, n, MSG_DONTWAIT);
+                if (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    closeClient(i);
+                    continue;
+                }
+                if (r > 0) {
+                    data += r;
+                    n -= r;
+                }
+            }
+            if (slot.len + n > c.bufferSize) {
+                // Dropping the data would corrupt the stream, so disconnect the client instead
+                closeClient(i);
+                ++c.dropped;
+                ++dropped;
+                continue;
+            }
+            memcpy(slot.buf.get() + slot.len, data, n);
+            slot.len += n;
+            sendClientData(i);
+            if (slot.sock >= 0) {
+                ++delivered;
+            }
+        }
+        if (!delivered) {
+            // All clients were disconnected or there are no clients
+            setWriteError(dropped ? ENOBUFS : ENOTCONN);
+            return 0;
+        }
+        return size;
+    }
     _client.clearWriteError();
     size_t ret = _client.write(buf, size, timeout);
     setWriteError(_client.getWriteError());
@@ -256,6 +256,20 @@ int UDP::peek()
     return available() ? _buffer[_offset] : -1;
 }
 
+int UDP::peekBuffer(const uint8_t** data)
+{
+    if (data) {
+        *data = _buffer ? _buffer + _offset : nullptr;
+    }
+    return available();
+}
+
+void UDP::consume(size_t size)
+{
+    const size_t avail = available();
+    _offset += (size > avail) ? avail : size;
+}
+
 void UDP::flush()
 {
 }
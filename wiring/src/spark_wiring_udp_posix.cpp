@@ -210,22 +210,9 @@ void UDP::stop() {
 }
 
 int UDP::beginPacket(const char *host, uint16_t port) {
-    struct addrinfo* ais = nullptr;
-    SCOPE_GUARD({
-        netdb_freeaddrinfo(ais);
-    });
-    CHECK(netdb_getaddrinfo(host, nullptr, nullptr, &ais));
-
-    // FIXME: for now using only the first entry
-    if (ais && ais->ai_addr) {
-        IPAddress addr;
-        detail::sockaddrToIpAddressPort(ais->ai_addr, addr, nullptr);
-        if (addr) {
-            return beginPacket(addr, port);
-        }
-    }
-
-    return -1;
+    HAL_IPAddress addr = {};
+    CHECK(network_resolve(_nif, host, &addr, 1, 0 /* flags */, nullptr));
+    return beginPacket(IPAddress(addr), port);
 }
 
 int UDP::beginPacket(IPAddress ip, uint16_t port) {
@@ -331,6 +318,18 @@ int UDP::peek() {
     return available() ? _buffer[_offset] : -1;
 }
 
+int UDP::peekBuffer(const uint8_t** data) {
+    if (data) {
+        *data = _buffer ? _buffer + _offset : nullptr;
+    }
+    return available();
+}
+
+void UDP::consume(size_t size) {
+    const size_t avail = available();
+    _offset += (size > avail) ? avail : size;
+}
+
 void UDP::flush() {
 }
 
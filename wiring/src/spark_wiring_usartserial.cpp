@@ -27,6 +27,7 @@
 #include "spark_wiring_usartserial.h"
 #include "spark_wiring_constants.h"
 #include "module_info.h"
+#include "system_error.h"
 #include <algorithm>
 
 // Constructors ////////////////////////////////////////////////////////////////
@@ -109,6 +110,45 @@ size_t USARTSerial::write(uint8_t c)
   return 0;
 }
 
+size_t USARTSerial::write(const uint8_t* buffer, size_t size)
+{
+  size_t written = 0;
+  while (written < size) {
+    const ssize_t r = hal_usart_write_buffer(_serial, buffer + written, size - written, sizeof(uint8_t));
+    if (r > 0) {
+      written += r;
+    } else if (r == SYSTEM_ERROR_NO_MEMORY) {
+      // the TX buffer is full
+      if (!_blocking) {
+        break;
+      }
+      // let the HAL wait for room, then go back to copying in bulk
+      if (!hal_usart_write(_serial, buffer[written])) {
+        break;
+      }
+      ++written;
+    } else {
+      // bulk writes are not supported by this interface or in the current mode
+      written += Print::write(buffer + written, size - written);
+      break;
+    }
+  }
+  return written;
+}
+
+size_t USARTSerial::readAvailable(char* buffer, size_t size)
+{
+  const ssize_t r = hal_usart_read_buffer(_serial, buffer, size, sizeof(uint8_t));
+  if (r > 0) {
+    return r;
+  }
+  if (r == SYSTEM_ERROR_NO_MEMORY) {
+    // the RX buffer is empty
+    return 0;
+  }
+  return Stream::readAvailable(buffer, size);
+}
+
 size_t USARTSerial::write(uint16_t c)
 {
   return hal_usart_write_nine_bits(_serial, c);
@@ -86,6 +86,22 @@ size_t USBSerial::write(uint8_t byte)
   return 0;
 }
 
+size_t USBSerial::write(const uint8_t* buffer, size_t size)
+{
+  if (!_blocking) {
+    size = std::min(size, (size_t)availableForWrite());
+    if (!size) {
+      return 0;
+    }
+  }
+  return std::max(0, (int)HAL_USB_USART_Send_Data_Buffer(_serial, buffer, size));
+}
+
+size_t USBSerial::readAvailable(char* buffer, size_t size)
+{
+  return std::max(0, (int)HAL_USB_USART_Receive_Data_Buffer(_serial, (uint8_t*)buffer, size));
+}
+
 void USBSerial::flush()
 {
   HAL_USB_USART_Flush_Data(_serial);